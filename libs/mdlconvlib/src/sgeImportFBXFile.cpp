@@ -2,6 +2,9 @@
 #include "FBXSDKParser.h"
 #include "IAssetRelocationPolicy.h"
 #include "ModelParseSettings.h"
+#include "sge_core/model/ModelReader.h"
+#include "sge_core/model/ModelWriter.h"
+#include "sge_utils/utils/FileStream.h"
 #include "sge_utils/utils/Path.h"
 #include "sge_utils/utils/strings.h"
 #include <type_traits>
@@ -102,4 +105,27 @@ SGE_MDLCONVLIB_API bool sgeImportFBXFileAsMultiple(std::vector<MultiModelImportR
 	return true;
 }
 
+SGE_MDLCONVLIB_API bool sgeRebakeModelFile(const char* mdlFilename, const char* outputFilename) {
+	// Ensure that the typedef we provide in the header matches the actual function type.
+	static_assert(std::is_same<decltype(&sgeRebakeModelFile), sgeRebakeModelFileFn>::value);
+
+	// Without a device all the data of the model stays on the CPU, so it could be written again.
+	Model::Model model;
+	{
+		FileReadStream frs(mdlFilename);
+		if (!frs.isOpened()) {
+			return false;
+		}
+
+		Model::ModelReader modelReader;
+		if (!modelReader.Load(Model::LoadSettings(), nullptr, &frs, model)) {
+			printf("Failed to load %s!\n", mdlFilename);
+			return false;
+		}
+	}
+
+	ModelWriter modelWriter;
+	return modelWriter.write(model, outputFilename ? outputFilename : mdlFilename);
+}
+
 } // extern "C"
@@ -38,4 +38,11 @@ typedef bool (*sgeImportFBXFileAsMultipleFn)(std::vector<MultiModelImportResult>
                                              const char* fbxFilename,
                                              std::vector<std::string>* pOutReferencedTextures);
 
+/// Loads the specified *.mdl file and writes it again with the default header format of ModelWriter.
+/// Used for rebaking the existing models that still use the legacy JSON header, see ModelBinaryFormat.h.
+/// @param [in] mdlFilename is the model to be rebaked.
+/// @param [in] outputFilename is the file to be written, if nullptr the input file gets overwritten.
+/// @return true if the rebake was successful.
+typedef bool (*sgeRebakeModelFileFn)(const char* mdlFilename, const char* outputFilename);
+
 } // extern "C"
@@ -1,4 +1,5 @@
 #include "FWDDefault_buildShadowMaps.h"
+#include "skinning.shader"
 
 uniform float4x4 projView;
 uniform float4x4 world;
@@ -15,6 +16,17 @@ uniform float uPointLightFarPlaneDistance;
 struct VS_INPUT
 {
 	float3 a_position : a_position;
+#if OPT_Skinned == 1
+	float4 a_bonesIds : a_bonesIds;
+	float4 a_bonesWeights : a_bonesWeights;
+#endif
+#if OPT_Instanced == 1
+	// The columns of the world matrix of the instance.
+	float4 a_instWorldX : a_instWorldX;
+	float4 a_instWorldY : a_instWorldY;
+	float4 a_instWorldZ : a_instWorldZ;
+	float4 a_instWorldW : a_instWorldW;
+#endif
 };
 
 struct VS_OUTPUT {
@@ -27,7 +39,19 @@ struct VS_OUTPUT {
 VS_OUTPUT vsMain(VS_INPUT vsin)
 {
 	VS_OUTPUT res;
-	const float4 worldPos = mul(world, float4(vsin.a_position, 1.0));
+#if OPT_Skinned == 1
+	const float4x4 skinning = computeSkinningTransform(vsin.a_bonesIds, vsin.a_bonesWeights);
+	const float3 position = mul(skinning, float4(vsin.a_position, 1.0)).xyz;
+#else
+	const float3 position = vsin.a_position;
+#endif
+
+#if OPT_Instanced == 1
+	const float4 worldPos =
+	    vsin.a_instWorldX * position.x + vsin.a_instWorldY * position.y + vsin.a_instWorldZ * position.z + vsin.a_instWorldW;
+#else
+	const float4 worldPos = mul(world, float4(position, 1.0));
+#endif
 	const float4 posProjSpace = mul(projView, worldPos);
 	
 	res.SV_Position = posProjSpace;
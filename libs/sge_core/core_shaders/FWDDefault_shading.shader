@@ -8,6 +8,8 @@
 #include "ggx.shader"
 #endif
 
+#include "skinning.shader"
+
 //--------------------------------------------------------------------
 // Uniforms
 //--------------------------------------------------------------------
@@ -65,6 +67,15 @@ uniform float4 lightShadowRange;
 
 uniform samplerCUBE uPointLightShadowMap;
 
+#if OPT_Lighting == kLightingShadedClustered
+// Clustered lights uniforms, see ClusteredLightingData for the layout of the textures.
+uniform sampler2D uClusterLights;
+uniform sampler2D uClusterRanges;
+uniform sampler2D uClusterLightIndices;
+uniform float4x4 uClusterView;
+uniform float4 uClusterGrid;        // (numTilesX, numTilesY, numSlices, lightIndices width), numSlices is 0 if they should be skipped.
+uniform float4 uClusterDepthParams; // (near, numSlices / log(far / near), lights width, lightIndices height).
+#endif
 
 //--------------------------------------------------------------------
 // Vertex Shader
@@ -85,6 +96,20 @@ struct VS_INPUT {
 #if OPT_DiffuseColorSrc == kDiffuseColorSrcVertex
 	float4 a_color : a_color;
 #endif
+
+#if OPT_Skinned == 1
+	float4 a_bonesIds : a_bonesIds;
+	float4 a_bonesWeights : a_bonesWeights;
+#endif
+
+#if OPT_Instanced == 1
+	// Per-instance data, the columns of the world matrix and the diffuse color tint.
+	float4 a_instWorldX : a_instWorldX;
+	float4 a_instWorldY : a_instWorldY;
+	float4 a_instWorldZ : a_instWorldZ;
+	float4 a_instWorldW : a_instWorldW;
+	float4 a_instTint : a_instTint;
+#endif
 };
 
 struct VS_OUTPUT {
@@ -103,6 +128,10 @@ struct VS_OUTPUT {
 #if OPT_DiffuseColorSrc == kDiffuseColorSrcVertex
 	float4 v_vertexDiffuse : v_vertexDiffuse;
 #endif
+
+#if OPT_Instanced == 1
+	float4 v_diffuseColorTint : v_diffuseColorTint;
+#endif
 };
 
 #if OPT_DiffuseColorSrc == kDiffuseColorSrcFluid
@@ -132,17 +161,48 @@ float lavafn(float x, float y) {
 VS_OUTPUT vsMain(VS_INPUT vsin) {
 	VS_OUTPUT res;
 
-	float4 worldPos = mul(world, float4(vsin.a_position, 1.0));
+	// The vertex in the space of the mesh, skinned if needed.
+#if OPT_Skinned == 1
+	const float4x4 skinning = computeSkinningTransform(vsin.a_bonesIds, vsin.a_bonesWeights);
+	const float3 position = mul(skinning, float4(vsin.a_position, 1.0)).xyz;
+	const float3 normal = mul(skinning, float4(vsin.a_normal, 0.0)).xyz;
+#if OPT_UseNormalMap == 1
+	const float3 tangent = mul(skinning, float4(vsin.a_tangent, 0.0)).xyz;
+	const float3 binormal = mul(skinning, float4(vsin.a_binormal, 0.0)).xyz;
+#endif
+#else
+	const float3 position = vsin.a_position;
+	const float3 normal = vsin.a_normal;
+#if OPT_UseNormalMap == 1
+	const float3 tangent = vsin.a_tangent;
+	const float3 binormal = vsin.a_binormal;
+#endif
+#endif
+
+#if OPT_Instanced == 1
+	// The world matrix comes as columns from the instance data, transform the vectors by them directly.
+	float4 worldPos = vsin.a_instWorldX * position.x + vsin.a_instWorldY * position.y + vsin.a_instWorldZ * position.z + vsin.a_instWorldW;
+	const float4 worldNormal = vsin.a_instWorldX * normal.x + vsin.a_instWorldY * normal.y + vsin.a_instWorldZ * normal.z;
+	res.v_diffuseColorTint = vsin.a_instTint;
+#else
+	float4 worldPos = mul(world, float4(position, 1.0));
+	const float4 worldNormal = mul(world, float4(normal, 0.0));
+#endif
+
 #if OPT_DiffuseColorSrc == kDiffuseColorSrcFluid
 	worldPos.y += lavafn(worldPos.x, worldPos.z);
 #endif
 
-	const float4 worldNormal = mul(world, float4(vsin.a_normal, 0.0));
 	const float4 posProjSpace = mul(projView, worldPos);
 
 #if OPT_UseNormalMap == 1
-	res.v_tangent = mul(world, float4(vsin.a_tangent, 0.0)).xyz;
-	res.v_binormal = mul(world, float4(vsin.a_binormal, 0.0)).xyz;
+#if OPT_Instanced == 1
+	res.v_tangent = (vsin.a_instWorldX * tangent.x + vsin.a_instWorldY * tangent.y + vsin.a_instWorldZ * tangent.z).xyz;
+	res.v_binormal = (vsin.a_instWorldX * binormal.x + vsin.a_instWorldY * binormal.y + vsin.a_instWorldZ * binormal.z).xyz;
+#else
+	res.v_tangent = mul(world, float4(tangent, 0.0)).xyz;
+	res.v_binormal = mul(world, float4(binormal, 0.0)).xyz;
+#endif
 #endif
 
 	res.v_normal = worldNormal.xyz;
@@ -165,9 +225,113 @@ VS_OUTPUT vsMain(VS_INPUT vsin) {
 // Pixel Shader
 //--------------------------------------------------------------------
 #ifdef SGE_PIXEL_SHADER
+#if OPT_Lighting != kLightingForceNoLighting
+// Returns the radiance of the light reaching the specified point, without taking the shadows into account.
+float3 computeLightRadiance(float4 lightPosF4, float3 lightColor, float4 spotDirAndCosAngle, float lightRange, float3 posWS) {
+	float3 lightRadiance = float3(0.f, 0.f, 0.f);
+	const float range2 = lightRange * lightRange;
+
+	if (lightPosF4.w == 0.f) {
+		// Point Light.
+		const float3 toLightWs = lightPosF4.xyz - posWS;
+		float k = 1.f - lerp(0.f, 1.f, saturate(dot(toLightWs, toLightWs) / range2));
+		lightRadiance.xyz = lightColor * saturate(k * k);
+	} else if (lightPosF4.w == 1.f) {
+		// Direction Light.
+		lightRadiance.xyz = lightColor;
+	} else if (lightPosF4.w == 2.f) {
+		// Spot Light.
+		const float3 toLightWs = lightPosF4.xyz - posWS;
+		const float3 revSpotLightDirWs = -spotDirAndCosAngle.xyz;
+		const float spotLightAngleCosine = spotDirAndCosAngle.w;
+		const float visibilityCosine = saturate(dot(normalize(toLightWs), revSpotLightDirWs));
+		const float c = saturate(visibilityCosine - spotLightAngleCosine);
+		const float range = 1.f - spotLightAngleCosine;
+		const float scale = saturate(c / range);
+		const float k = 1.f - lerp(0.f, 1.f, saturate(dot(toLightWs, toLightWs) / range2));
+		lightRadiance.xyz = lightColor * (scale * saturate(k * k));
+	}
+
+	return lightRadiance;
+}
+
+// Returns the direction from the specified point towards the light.
+float3 computeLightDirection(float4 lightPosF4, float3 posWS) {
+	if (lightPosF4.w == 1.f) {
+		return lightPosF4.xyz;
+	}
+
+	return normalize(lightPosF4.xyz - posWS);
+}
+
+// Returns the Cook-Torrance BRDF multiplied by NdotL.
+float3 computeCookTorrance(float3 N, float3 V, float3 L, float3 diffuseColor, float metallic, float roughness, float3 F0) {
+	const float3 H = normalize(V + L);
+
+	const float NDF = DistributionGGX(N, H, roughness);
+	const float G = GeometrySmith(N, V, L, roughness);
+	const float3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+	const float3 kS = F;
+	const float3 kD = (float3(1.f, 1.f, 1.f) - kS) * (1.0 - metallic);
+
+	const float3 numerator = NDF * G * F;
+	const float denominator = 4.f * max(dot(N, V), 0.f) * max(dot(N, L), 0.f);
+	const float3 specular = numerator / max(denominator, 0.001f);
+
+	return (kD * diffuseColor / PI + specular) * max(dot(N, L), 0.0);
+}
+#endif
+
+#if OPT_Lighting == kLightingShadedClustered
+// Returns the lighting from all lights in the cluster containing the specified point. These lights have no shadow maps.
+float3 computeClusteredLighting(float3 posWS, float3 N, float3 V, float3 diffuseColor, float metallic, float roughness, float3 F0) {
+	float3 lighting = float3(0.f, 0.f, 0.f);
+
+	// Find the cluster of the point, in the same way as LightClusters::findClusterIndex.
+	const float4 posCS = mul(projView, float4(posWS, 1.f));
+	const float2 tileCoord = saturate((posCS.xy / posCS.w) * 0.5f + float2(0.5f, 0.5f));
+	const float2 tile = min(floor(tileCoord * uClusterGrid.xy), uClusterGrid.xy - float2(1.f, 1.f));
+	const float depth = -mul(uClusterView, float4(posWS, 1.f)).z;
+	const float slice = clamp(floor(log(max(depth / uClusterDepthParams.x, 1.f)) * uClusterDepthParams.y), 0.f, uClusterGrid.z - 1.f);
+
+	const float numTiles = uClusterGrid.x * uClusterGrid.y;
+	const float2 rangeUV = float2((tile.x + tile.y * uClusterGrid.x + 0.5f) / numTiles, (slice + 0.5f) / uClusterGrid.z);
+	const float4 clusterRange = tex2Dlod(uClusterRanges, float4(rangeUV, 0.f, 0.f));
+	const int numLights = (int)clusterRange.y;
+
+	for (int t = 0; t < numLights; t += 1) {
+		const float indexLocation = clusterRange.x + float(t);
+		const float indexRow = floor(indexLocation / uClusterGrid.w);
+		const float indexColumn = indexLocation - indexRow * uClusterGrid.w;
+		const float2 indexUV = float2((indexColumn + 0.5f) / uClusterGrid.w, (indexRow + 0.5f) / uClusterDepthParams.w);
+		const float iLight = tex2Dlod(uClusterLightIndices, float4(indexUV, 0.f, 0.f)).x;
+
+		// Every light is a column of 4 texels.
+		const float lightU = (iLight + 0.5f) / uClusterDepthParams.z;
+		const float4 lightPosF4 = tex2Dlod(uClusterLights, float4(lightU, 0.125f, 0.f, 0.f));
+		const float4 lightColorWFlags = tex2Dlod(uClusterLights, float4(lightU, 0.375f, 0.f, 0.f));
+		const float4 spotDirAndCosAngle = tex2Dlod(uClusterLights, float4(lightU, 0.625f, 0.f, 0.f));
+		const float lightRange = tex2Dlod(uClusterLights, float4(lightU, 0.875f, 0.f, 0.f)).x;
+
+		const float3 L = computeLightDirection(lightPosF4, posWS);
+		if (dot(N, L) > 1e-6f) {
+			const float3 lightRadiance = computeLightRadiance(lightPosF4, lightColorWFlags.xyz, spotDirAndCosAngle, lightRange, posWS);
+			lighting += computeCookTorrance(N, V, L, diffuseColor, metallic, roughness, F0) * lightRadiance;
+		}
+	}
+
+	return lighting;
+}
+#endif
+
 float4 psMain(VS_OUTPUT IN)
     : SV_Target0 {
+#if OPT_Instanced == 1
+	float4 diffuseColor = pow(IN.v_diffuseColorTint, 2.2f);
+#else
 	float4 diffuseColor = pow(uDiffuseColorTint, 2.2f);
+#endif
 
 #if OPT_DiffuseColorSrc == kDiffuseColorSrcVertex
 	diffuseColor = IN.v_vertexDiffuse;
@@ -243,58 +407,32 @@ float4 psMain(VS_OUTPUT IN)
 
 	float3 lighting = float3(0.f, 0.f, 0.f);
 #if OPT_Lighting != kLightingForceNoLighting
-	// Lighting.
-	const int fLightFlags = (int)lightColorWFlag.w;
-	const bool dontLight = (fLightFlags & kLightFlt_DontLight) != 0;
-	if (dontLight == false) {
-		// GGX Material crap:
-		float metallic = uMetalness;
+	// GGX Material crap:
+	float metallic = uMetalness;
 #if (OPT_UseNormalMap == 1) || (OPT_DiffuseColorSrc == kDiffuseColorSrcTexture)
-		if ((uPBRMtlFlags & kPBRMtl_Flags_HasMetalnessMap) != 0) {
-			metallic *= pow(tex2D(uTexMetalness, IN.v_uv).r, 2.2f);
-		}
+	if ((uPBRMtlFlags & kPBRMtl_Flags_HasMetalnessMap) != 0) {
+		metallic *= pow(tex2D(uTexMetalness, IN.v_uv).r, 2.2f);
+	}
 #endif
 
-		float roughness = uRoughness;
+	float roughness = uRoughness;
 #if (OPT_UseNormalMap == 1) || (OPT_DiffuseColorSrc == kDiffuseColorSrcTexture)
-		if ((uPBRMtlFlags & kPBRMtl_Flags_HasRoughnessMap) != 0) {
-			roughness *= pow(tex2D(uTexRoughness, IN.v_uv).r, 2.2f);
-		}
+	if ((uPBRMtlFlags & kPBRMtl_Flags_HasRoughnessMap) != 0) {
+		roughness *= pow(tex2D(uTexRoughness, IN.v_uv).r, 2.2f);
+	}
 #endif
 
-		const float3 F0 = lerp(float3(0.04f, 0.04f, 0.04f), diffuseColor.xyz, metallic);
-
-		float3 lightRadiance = float3(0.f, 0.f, 0.f);
-		float3 L = float3(0.f, 0.f, 0.f);
+	const float3 F0 = lerp(float3(0.04f, 0.04f, 0.04f), diffuseColor.xyz, metallic);
 
+	// Lighting.
+	const int fLightFlags = (int)lightColorWFlag.w;
+	const bool dontLight = (fLightFlags & kLightFlt_DontLight) != 0;
+	if (dontLight == false) {
 		const float4 lightPosF4 = lightPosition;
 		const float3 lightColor = lightColorWFlag.xyz;
-		const float range2 = lightShadowRange.x * lightShadowRange.x;
-
-
-		if (lightPosF4.w == 0.f) {
-			// Point Light.
-			const float3 toLightWs = lightPosF4.xyz - IN.v_posWS;
-			float k = 1.f - lerp(0.f, 1.f, saturate(dot(toLightWs, toLightWs) / range2));
-			lightRadiance.xyz = lightColor * saturate(k * k);
-			L = normalize(toLightWs);
-		} else if (lightPosF4.w == 1.f) {
-			// Direction Light.
-			lightRadiance.xyz = lightColor;
-			L = lightPosF4.xyz;
-		} else if (lightPosF4.w == 2.f) {
-			// Spot Light.
-			const float3 toLightWs = lightPosF4.xyz - IN.v_posWS;
-			const float3 revSpotLightDirWs = -lightSpotDirAndCosAngle.xyz;
-			const float spotLightAngleCosine = lightSpotDirAndCosAngle.w;
-			const float visibilityCosine = saturate(dot(normalize(toLightWs), revSpotLightDirWs));
-			const float c = saturate(visibilityCosine - spotLightAngleCosine);
-			const float range = 1.f - spotLightAngleCosine;
-			const float scale = saturate(c / range);
-			const float k = 1.f - lerp(0.f, 1.f, saturate(dot(toLightWs, toLightWs) / range2));
-			lightRadiance.xyz = lightColor * (scale * saturate(k * k));
-			L = normalize(toLightWs);
-		}
+
+		const float3 lightRadiance = computeLightRadiance(lightPosF4, lightColor, lightSpotDirAndCosAngle, lightShadowRange.x, IN.v_posWS);
+		const float3 L = computeLightDirection(lightPosF4, IN.v_posWS);
 
 		const float NdotL = max(dot(N, L), 0.0);
 
@@ -369,27 +507,7 @@ float4 psMain(VS_OUTPUT IN)
 #endif // shadow map enabled
 
 		if (NdotL > 1e-6f && shadowScale > 1e-6f) {
-			const float3 H = normalize(V + L);
-
-			// cook-torrance brdf
-#if 1
-			const float NDF = DistributionGGX(N, H, roughness);
-			const float G = GeometrySmith(N, V, L, roughness);
-			const float3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
-
-			const float3 kS = F;
-			const float3 kD = (float3(1.f, 1.f, 1.f) - kS) * (1.0 - metallic);
-
-			const float3 numerator = NDF * G * F;
-			const float denominator = 4.f * max(dot(N, V), 0.f) * max(dot(N, L), 0.f);
-			const float3 specular = numerator / max(denominator, 0.001f);
-
-
-			lighting += shadowScale * (kD * diffuseColor.xyz / PI + specular) * lightRadiance * NdotL;
-#else
-			const float3 lightLighting = shadowScale * diffuseColor.xyz * lightRadiance * NdotL;
-			lighting += lightLighting;
-#endif
+			lighting += shadowScale * computeCookTorrance(N, V, L, diffuseColor.xyz, metallic, roughness, F0) * lightRadiance;
 		}
 
 		if (NdotL < 0.f) {
@@ -397,9 +515,15 @@ float4 psMain(VS_OUTPUT IN)
 			lighting += ((normal.y * 0.5f + 0.5f) * ambience + ambience * 0.05f) * diffuseColor.xyz;
 		}
 	}
+
+#if OPT_Lighting == kLightingShadedClustered
+	if (uClusterGrid.z > 0.f) {
+		lighting += computeClusteredLighting(IN.v_posWS, N, V, diffuseColor.xyz, metallic, roughness, F0);
+	}
+#endif
 #endif
 
-#if OPT_Lighting == kLightingShaded
+#if (OPT_Lighting == kLightingShaded) || (OPT_Lighting == kLightingShadedClustered)
 	const float3 ambientLightColorLinear = ambientLightColor; // pow(ambientLightColor, 2.2f);
 	const float3 fakeAmbientDetail =
 	    ((normal.y * 0.5f + 0.5f) * ambientLightColorLinear + ambientLightColorLinear * 0.05f) * diffuseColor.xyz;
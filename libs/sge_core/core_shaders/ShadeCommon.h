@@ -19,6 +19,11 @@
 // Settings for OPT_Lighting
 #define kLightingShaded 0
 #define kLightingForceNoLighting 1
+#define kLightingShadedClustered 2 // Same as kLightingShaded, but also applies the lights in the clusters of the pixel.
+
+// The size of the bone transforms array used for skinning in the vertex shader (OPT_Skinned).
+// Meshes with more bones are skinned on the CPU.
+#define kMaxSkinningBones 64
 
 // Lights flags encoded as float use up to 23
 // These are going to be casted as float in the shader BTW.
@@ -89,6 +89,26 @@ void Animator::pickAnimation(EvalMomentSets& moment, int const animid, float pev
 	moment = EvalMomentSets(&pSrcModel->get()->asModel()->model, animation.animationName, pevanimProgress, 1.f);
 }
 
+int Animator::addLayer(int const animid, const char* const maskRootNodeName, AnimatorLayerBlend const blend, float const weight) {
+	if (isAssetLoaded(m_model) == false) {
+		sgeAssert(false && "addLayer expects the animated model to be loaded");
+		return -1;
+	}
+
+	const Model::Model& model = m_model->asModel()->model;
+	const Model::Node* const maskRootNode = model.FindFirstNodeByName(maskRootNodeName ? maskRootNodeName : "");
+	sgeAssert(maskRootNode != nullptr && "The mask root node was not found");
+
+	AnimatorLayer layer;
+	pickAnimation(layer.moment, animid, 0.f);
+	layer.moment.weight = weight;
+	layer.blend = blend;
+	computeNodeMask(layer.nodeMask, model, maskRootNode);
+
+	m_layers.emplace_back(std::move(layer));
+	return int(m_layers.size()) - 1;
+}
+
 void Animator::update(float const dt) {
 	float totalNonFocusWeight = 0.f;
 
@@ -157,6 +177,54 @@ void Animator::update(float const dt) {
 
 	if (animtoplay >= 0)
 		playAnimation(animtoplay, false);
+
+	// The layers are always looping.
+	for (AnimatorLayer& layer : m_layers) {
+		EvalMomentSets& moment = layer.moment;
+		if (moment.model == nullptr) {
+			continue;
+		}
+
+		moment.time += dt;
+
+		const Model::AnimationInfo* const animInfo = moment.model->findAnimation(moment.animationName);
+		if (animInfo != nullptr && animInfo->duration > 0.f) {
+			moment.time = fmodf(moment.time, animInfo->duration);
+			if (moment.time < 0.f) {
+				moment.time += animInfo->duration;
+			}
+		}
+	}
+}
+
+bool Animator::evaluate(EvaluatedModel& evalModel) {
+	if (isAssetLoaded(m_model) == false || evalModel.m_model != &m_model->asModel()->model) {
+		sgeAssert(false && "The evaluated model must be initialized with the animated model");
+		return false;
+	}
+
+	evalModel.samplePose(m_pose, m_moments);
+
+	for (AnimatorLayer& layer : m_layers) {
+		const EvalMomentSets& moment = layer.moment;
+		if (moment.model == nullptr || moment.weight <= 0.f) {
+			continue;
+		}
+
+		if (layer.blend == animatorLayerBlend_additive && layer.referencePose.getNumNodes() != m_pose.getNumNodes()) {
+			evalModel.samplePose(layer.referencePose, moment.model, moment.animationName, 0.f);
+		}
+
+		evalModel.samplePose(m_layerPose, moment.model, moment.animationName, moment.time);
+
+		if (layer.blend == animatorLayerBlend_additive) {
+			m_pose.addAdditive(m_layerPose, layer.referencePose, moment.weight, layer.nodeMask.data());
+		} else {
+			m_pose.setBlend(m_pose, m_layerPose, moment.weight, layer.nodeMask.data());
+		}
+	}
+
+	return evalModel.evaluateFromPose(m_pose);
 }
 
 } // namespace sge
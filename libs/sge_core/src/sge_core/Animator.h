@@ -42,6 +42,23 @@ struct AnimatorAnimation {
 	std::vector<AnimationSrc> animationSources;
 };
 
+enum AnimatorLayerBlend : int {
+	animatorLayerBlend_override, // The layer replaces the animation of the nodes in its mask.
+	animatorLayerBlend_additive, // The difference between the layer animation and its 1st frame is added to the nodes in its mask.
+};
+
+/// An animation played on top of the main animation of the Animator, affecting only some of the nodes.
+/// For example an upper body "shoot" layer over a lower body "run" animation.
+struct AnimatorLayer {
+	EvalMomentSets moment; // The animation of the layer, always looping. The weight of the moment is the weight of the layer.
+	AnimatorLayerBlend blend = animatorLayerBlend_override;
+	std::vector<float> nodeMask; // The weight of the layer for every node of the animated model, see computeNodeMask().
+
+	/// For additive layers, the 1st frame of the animation. Sampled once by Animator::evaluate(), as sampling it
+	/// together with the layer every frame would move the key cursors back and forth.
+	ModelPose referencePose;
+};
+
 struct SGE_CORE_API Animator {
 	Animator() = default;
 
@@ -56,9 +73,20 @@ struct SGE_CORE_API Animator {
 
 	void playAnimation(int const animid, bool dontBlend = true);
 
+	/// Adds a layer playing the specified animation on top of the main animation.
+	/// The layer affects the node named @maskRootNodeName in the animated model and all nodes below it.
+	/// Returns the index of the layer.
+	int addLayer(int const animid, const char* const maskRootNodeName, AnimatorLayerBlend const blend, float const weight = 1.f);
+	void setLayerWeight(int const layerIndex, float const weight) { m_layers[layerIndex].moment.weight = weight; }
+	void clearLayers() { m_layers.clear(); }
+
 	// Advanced the animation.
 	void update(float const dt);
 
+	/// Evaluates @evalModel, initialized with the animated model, to the current state of the animator.
+	/// The playing animations and the layers are combined as poses, the global transforms of the nodes are computed only once.
+	bool evaluate(EvaluatedModel& evalModel);
+
   private:
 	void pickAnimation(EvalMomentSets& moment, int const animid, float pevanimProgress);
 
@@ -85,6 +113,11 @@ struct SGE_CORE_API Animator {
 
 	// Intrernal state data.
 	std::vector<EvalMomentSets> m_moments;
+	std::vector<AnimatorLayer> m_layers;
+
+	// The poses used by evaluate(), kept to avoid reallocating them.
+	ModelPose m_pose;
+	ModelPose m_layerPose;
 };
 
 } // namespace sge
@@ -11,8 +11,12 @@
 #include "sge_utils/utils/json.h"
 #include "sge_utils/utils/strings.h"
 #include "sge_utils/utils/timer.h"
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <mutex>
 #include <stb_image.h>
+#include <thread>
 
 namespace sge {
 
@@ -76,28 +80,6 @@ AssetType assetType_guessFromExtension(const char* const ext, bool includeExtern
 	return AssetType::None;
 }
 
-template <typename T>
-struct TAssetAllocatorDefault : public IAssetAllocator {
-	void* allocate() final {
-		data.push_back(new T);
-		return data.back();
-	}
-
-	void deallocate(void* ptr) final {
-		auto itr = std::find(data.begin(), data.end(), ptr);
-
-		if (itr != data.end()) {
-			delete *itr;
-			data.erase(itr);
-		} else {
-			// TODO; now wut?
-			sgeAssert(false);
-		}
-	}
-
-	std::vector<T*> data;
-};
-
 //-------------------------------------------------------
 // ModelAssetFactory
 //-------------------------------------------------------
@@ -108,8 +90,43 @@ struct ModelAssetFactory : public IAssetFactory {
 		sgeAssert(pMngr != nullptr);
 
 		AssetModel& modelAsset = *(AssetModel*)(pAsset);
+		if (readModel(modelAsset, pPath, pMngr->getDevice()) == false) {
+			return false;
+		}
 
-		FileReadStream frs(pPath);
+		evaluateStaticMoment(modelAsset, pMngr);
+		return true;
+	}
+
+	bool prepareLoad(void* const pAsset,
+	                 const char* const pPath,
+	                 AssetLibrary* const UNUSED(pMngr),
+	                 std::unique_ptr<IAssetLoadData>& UNUSED(loadData)) final {
+		sgeAssert(pAsset != nullptr);
+		sgeAssert(pPath != nullptr);
+
+		// The GPU resources are created by finalizeLoad().
+		AssetModel& modelAsset = *(AssetModel*)(pAsset);
+		return readModel(modelAsset, pPath, nullptr);
+	}
+
+	bool finalizeLoad(void* const pAsset,
+	                  const char* const UNUSED(pPath),
+	                  AssetLibrary* const pMngr,
+	                  IAssetLoadData* UNUSED(loadData)) final {
+		sgeAssert(pAsset != nullptr);
+		sgeAssert(pMngr != nullptr);
+
+		AssetModel& modelAsset = *(AssetModel*)(pAsset);
+		Model::ModelReader::createRenderResources(pMngr->getDevice(), modelAsset.model);
+		evaluateStaticMoment(modelAsset, pMngr);
+
+		return true;
+	}
+
+	bool readModel(AssetModel& modelAsset, const char* const pPath, SGEDevice* const sgedev) {
+		// The file is mapped in memory, so the data chunks get read without going through a stream.
+		MappedFileReadStream frs(pPath);
 
 		if (frs.isOpened() == false) {
 			SGE_DEBUG_ERR("Unable to find model asset: '%s'!\n", pPath);
@@ -121,7 +138,7 @@ struct ModelAssetFactory : public IAssetFactory {
 		loadSettings.assetDir = extractFileDir(pPath, true);
 
 		Model::ModelReader modelReader;
-		const bool succeeded = modelReader.Load(loadSettings, pMngr->getDevice(), &frs, modelAsset.model);
+		const bool succeeded = modelReader.Load(loadSettings, sgedev, &frs, modelAsset.model);
 
 		if (!succeeded) {
 			SGE_DEBUG_ERR("Unable to load model asset: '%s'!\n", pPath);
@@ -129,13 +146,12 @@ struct ModelAssetFactory : public IAssetFactory {
 			return false;
 		}
 
+		return true;
+	}
+
+	void evaluateStaticMoment(AssetModel& modelAsset, AssetLibrary* const pMngr) {
 		modelAsset.staticEval.initialize(pMngr, &modelAsset.model);
 		modelAsset.staticEval.evaluate(nullptr, 0);
-
-		modelAsset.sharedEval.initialize(pMngr, &modelAsset.model);
-		modelAsset.sharedEval.evaluate(nullptr, 0);
-
-		return succeeded;
 	}
 
 	void unload(void* const pAsset, [[maybe_unused]] AssetLibrary* const pMngr) final {
@@ -145,9 +161,9 @@ struct ModelAssetFactory : public IAssetFactory {
 		AssetModel& model = *(AssetModel*)(pAsset);
 
 		model.staticEval = EvaluatedModel();
-		model.sharedEval = EvaluatedModel();
 
-		// TOOD: Should we do something here?
+		// The node remap tables of the model are rebuilt when needed after reloading, drop the ones for the unloaded nodes.
+		Model::invalidateNodeRemaps(model.model);
 	}
 };
 
@@ -211,48 +227,47 @@ struct TextureViewAssetFactory : public IAssetFactory {
 		return result;
 	}
 
+	/// The decoded texture waiting to be uploaded to the GPU.
+	struct TextureLoadData : public IAssetLoadData {
+		~TextureLoadData() {
+			if (stbPixels != nullptr) {
+				stbi_image_free(stbPixels);
+				stbPixels = nullptr;
+			}
+		}
+
+		TextureDesc desc;
+		std::vector<TextureData> initalData;
+		SamplerDesc samplerDesc;
+
+		std::vector<char> ddsDataRaw;       // The contents of the DDS file, if used, referenced by initalData.
+		unsigned char* stbPixels = nullptr; // The pixels decoded by stb_image, if used, referenced by initalData.
+	};
+
 	// Check if the file version in DDS already exists, if not or the import fails the function returns false;
-	DDSLoadCode loadDDS(void* const pAsset, const char* const pPath, AssetLibrary* const pMngr) {
+	DDSLoadCode loadDDS(const char* const pPath, TextureLoadData& loadData) {
 		std::string const ddsPath = (extractFileExtension(pPath) == "dds") ? pPath : std::string(pPath) + ".dds";
 
 		// Load the File contents.
-		std::vector<char> ddsDataRaw;
-		if (FileReadStream::readFile(ddsPath.c_str(), ddsDataRaw) == false) {
+		if (FileReadStream::readFile(ddsPath.c_str(), loadData.ddsDataRaw) == false) {
 			return ddsLoadCode_fileDoesntExist;
 		}
 
-
 		// Parse the file and generate the texture creation strctures.
 		DDSLoader loader;
-		TextureDesc desc;
-		std::vector<TextureData> initalData;
-
-		if (loader.load(ddsDataRaw.data(), ddsDataRaw.size(), desc, initalData) == false) {
-			return ddsLoadCode_importOrCreationFailed;
-		}
-
-		// Create the texture.
-		GpuHandle<Texture>& texture = *(GpuHandle<Texture>*)(pAsset);
-		texture = pMngr->getDevice()->requestResource<Texture>();
-
-		const SamplerDesc samplerDesc = getTextureSamplerDesc(pPath);
-		bool const createSucceeded = texture->create(desc, &initalData[0], samplerDesc);
-
-		if (createSucceeded == false) {
-			texture.Release();
+		if (loader.load(loadData.ddsDataRaw.data(), loadData.ddsDataRaw.size(), loadData.desc, loadData.initalData) == false) {
 			return ddsLoadCode_importOrCreationFailed;
 		}
 
 		return ddsLoadCode_fine;
 	}
 
-	bool load(void* const pAsset, const char* const pPath, AssetLibrary* const pMngr) final {
-		sgeAssert(pAsset != nullptr);
-		sgeAssert(pPath != nullptr);
-		sgeAssert(pMngr != nullptr);
+	/// Reads and decodes the texture, without using the device.
+	bool readTexture(const char* const pPath, TextureLoadData& loadData) {
+		loadData.samplerDesc = getTextureSamplerDesc(pPath);
 
 #if !defined(__EMSCRIPTEN__)
-		DDSLoadCode const ddsLoadStatus = loadDDS(pAsset, pPath, pMngr);
+		DDSLoadCode const ddsLoadStatus = loadDDS(pPath, loadData);
 
 		if (ddsLoadStatus == ddsLoadCode_fine) {
 			return true;
@@ -264,9 +279,6 @@ struct TextureViewAssetFactory : public IAssetFactory {
 
 		// If we are here than the DDS file doesn't exist and
 		// we must try to load the exact file that we were asked for.
-		GpuHandle<Texture>& texture = *(GpuHandle<Texture>*)(pAsset);
-
-		// Now check for the actual asset that is requested.
 		FileReadStream frs(pPath);
 		if (!frs.isOpened()) {
 			SGE_DEBUG_ERR("Unable to find texture view asset: '%s'!\n", pPath);
@@ -274,9 +286,13 @@ struct TextureViewAssetFactory : public IAssetFactory {
 		}
 
 		int width, height, components;
-		const unsigned char* textureData = stbi_load(pPath, &width, &height, &components, 4);
+		loadData.stbPixels = stbi_load(pPath, &width, &height, &components, 4);
+		if (loadData.stbPixels == nullptr) {
+			SGE_DEBUG_ERR("Unable to decode texture view asset: '%s'!\n", pPath);
+			return false;
+		}
 
-		TextureDesc textureDesc;
+		TextureDesc& textureDesc = loadData.desc;
 
 		textureDesc.textureType = UniformType::Texture2D;
 		textureDesc.format = TextureFormat::R8G8B8A8_UNORM;
@@ -289,22 +305,57 @@ struct TextureViewAssetFactory : public IAssetFactory {
 		textureDesc.texture2D.height = height;
 
 		TextureData textureDataDesc;
-		textureDataDesc.data = textureData;
+		textureDataDesc.data = loadData.stbPixels;
 		textureDataDesc.rowByteSize = width * 4;
+		loadData.initalData.push_back(textureDataDesc);
+
+		return true;
+	}
 
+	bool createTexture(void* const pAsset, const char* const pPath, AssetLibrary* const pMngr, const TextureLoadData& loadData) {
+		GpuHandle<Texture>& texture = *(GpuHandle<Texture>*)(pAsset);
 		texture = pMngr->getDevice()->requestResource<Texture>();
 
-		const SamplerDesc samplerDesc = getTextureSamplerDesc(pPath);
-		texture->create(textureDesc, &textureDataDesc, samplerDesc);
+		const bool createSucceeded = texture->create(loadData.desc, loadData.initalData.data(), loadData.samplerDesc);
+		if (createSucceeded == false) {
+			SGE_DEBUG_ERR("Failed to create the texture for '%s'!\n", pPath);
+			texture.Release();
+			return false;
+		}
 
-		if (textureData != nullptr) {
-			stbi_image_free((void*)textureData);
-			textureData = nullptr;
+		return texture.IsResourceValid();
+	}
+
+	bool load(void* const pAsset, const char* const pPath, AssetLibrary* const pMngr) final {
+		sgeAssert(pAsset != nullptr);
+		sgeAssert(pPath != nullptr);
+		sgeAssert(pMngr != nullptr);
+
+		TextureLoadData loadData;
+		return readTexture(pPath, loadData) && createTexture(pAsset, pPath, pMngr, loadData);
+	}
+
+	bool prepareLoad(void* const UNUSED(pAsset),
+	                 const char* const pPath,
+	                 AssetLibrary* const UNUSED(pMngr),
+	                 std::unique_ptr<IAssetLoadData>& loadData) final {
+		sgeAssert(pPath != nullptr);
+
+		std::unique_ptr<TextureLoadData> textureLoadData = std::make_unique<TextureLoadData>();
+		if (readTexture(pPath, *textureLoadData) == false) {
+			return false;
 		}
 
-		const bool succeeded = texture.IsResourceValid();
+		loadData = std::move(textureLoadData);
+		return true;
+	}
 
-		return succeeded;
+	bool finalizeLoad(void* const pAsset, const char* const pPath, AssetLibrary* const pMngr, IAssetLoadData* const loadData) final {
+		sgeAssert(pAsset != nullptr);
+		sgeAssert(pMngr != nullptr);
+		sgeAssert(loadData != nullptr);
+
+		return createTexture(pAsset, pPath, pMngr, *static_cast<TextureLoadData*>(loadData));
 	}
 
 	void unload([[maybe_unused]] void* const pAsset, [[maybe_unused]] AssetLibrary* const pMngr) final {
@@ -333,6 +384,21 @@ struct TextAssetFactory : public IAssetFactory {
 		return true;
 	}
 
+	bool prepareLoad(void* const pAsset,
+	                 const char* const pPath,
+	                 AssetLibrary* const pMngr,
+	                 std::unique_ptr<IAssetLoadData>& UNUSED(loadData)) final {
+		// Loading text doesn't need anything else, it is done entierly on the loading thread.
+		return load(pAsset, pPath, pMngr);
+	}
+
+	bool finalizeLoad(void* const UNUSED(pAsset),
+	                  const char* const UNUSED(pPath),
+	                  AssetLibrary* const UNUSED(pMngr),
+	                  IAssetLoadData* UNUSED(loadData)) final {
+		return true;
+	}
+
 	void unload(void* const pAsset, AssetLibrary* const UNUSED(pMngr)) final {
 		std::string& text = *(std::string*)(pAsset);
 		text = std::string();
@@ -370,6 +436,21 @@ struct AudioAssetFactory : public IAssetFactory {
 		return true;
 	}
 
+	bool prepareLoad(void* const pAsset,
+	                 const char* const pPath,
+	                 AssetLibrary* const pMngr,
+	                 std::unique_ptr<IAssetLoadData>& UNUSED(loadData)) final {
+		// The audio tracks are decoded while playing, loading them doesn't need anything else.
+		return load(pAsset, pPath, pMngr);
+	}
+
+	bool finalizeLoad(void* const UNUSED(pAsset),
+	                  const char* const UNUSED(pPath),
+	                  AssetLibrary* const UNUSED(pMngr),
+	                  IAssetLoadData* UNUSED(loadData)) final {
+		return true;
+	}
+
 	void unload(void* const pAsset, AssetLibrary* const UNUSED(pMngr)) final {
 		AudioAsset& audio = *reinterpret_cast<AudioAsset*>(pAsset);
 		audio.reset();
@@ -379,6 +460,161 @@ struct AudioAssetFactory : public IAssetFactory {
 //-------------------------------------------------------
 // AssetLibrary
 //-------------------------------------------------------
+
+/// Returns the path used as the key of the asset, or an empty string if the path is invalid.
+static std::string getAssetPathNormalized(const char* const pPath) {
+	// Now make the path relative to the current directory, as some assets
+	// might refer it relative to them, and this wolud lead us loading the same asset
+	// via different path and we don't want that.
+	std::error_code pathToAssetRelativeError;
+	const std::filesystem::path pathToAssetRelative = std::filesystem::relative(pPath, pathToAssetRelativeError);
+
+	// The commented code below, not only makes the path cannonical, but it also makes it absolute, which we don't want.
+	// std::error_code pathToAssetCanonicalError;
+	// const std::filesystem::path pathToAssetCanonical = std::filesystem::weakly_canonical(pathToAssetRelative, pathToAssetCanonicalError);
+
+	// canonizePathRespectOS makes makes the slashes UNUX Style.
+	const std::string pathToAsset = canonizePathRespectOS(pathToAssetRelative.string());
+
+	if (pathToAssetRelativeError) {
+		sgeAssert(false && "Failed to transform the asset path to relative");
+	}
+
+	return pathToAsset;
+}
+
+/// Scrambles the path ids, as the ids of the assets of the same type are usually not consecutive.
+static size_t hashPathId(const int pathId) {
+	uint32 hash = uint32(pathId) * 2654435769u;
+	hash ^= hash >> 16;
+	return size_t(hash);
+}
+
+int AssetLibrary::AssetRegistry::find(const int pathId) const {
+	if (slots.empty()) {
+		return -1;
+	}
+
+	// At least half of the slots are always empty, so the probing will stop.
+	const size_t mask = slots.size() - 1;
+	for (size_t iSlot = hashPathId(pathId) & mask;; iSlot = (iSlot + 1) & mask) {
+		const Slot& slot = slots[iSlot];
+		if (slot.pathId == pathId) {
+			return slot.assetIndex;
+		}
+
+		if (slot.pathId == 0) {
+			return -1;
+		}
+	}
+}
+
+void AssetLibrary::AssetRegistry::add(const int pathId, const int assetIndex) {
+	sgeAssert(pathId > 0 && assetIndex >= 0);
+
+	// Keep at least half of the slots empty, so the probing stays short.
+	if ((numUsedSlots + 1) * 2 > int(slots.size())) {
+		const std::vector<Slot> oldSlots = std::move(slots);
+		slots.assign(std::max<size_t>(64, oldSlots.size() * 2), Slot());
+		numUsedSlots = 0;
+
+		for (const Slot& slot : oldSlots) {
+			if (slot.pathId != 0) {
+				add(slot.pathId, slot.assetIndex);
+			}
+		}
+	}
+
+	const size_t mask = slots.size() - 1;
+	size_t iSlot = hashPathId(pathId) & mask;
+	while (slots[iSlot].pathId != 0) {
+		sgeAssert(slots[iSlot].pathId != pathId && "The path is already present");
+		iSlot = (iSlot + 1) & mask;
+	}
+
+	slots[iSlot].pathId = pathId;
+	slots[iSlot].assetIndex = assetIndex;
+	numUsedSlots++;
+}
+
+/// An asset requested with AssetLibrary::getAssetAsync() which loading isn't finished yet.
+struct AssetLibrary::AsyncLoad {
+	std::shared_ptr<Asset> asset;
+	std::string path;
+	IAssetFactory* factory = nullptr;
+
+	/// The storage of the asset being loaded. It is assigned to the asset when the loading is finished.
+	void* pAsset = nullptr;
+
+	// The result of IAssetFactory::prepareLoad(), written by the loading threads.
+	std::unique_ptr<IAssetLoadData> loadData;
+	bool isPrepared = false;
+	bool prepareSucceeded = false;
+};
+
+/// The loading threads and the assets waiting to be loaded by them.
+/// The loading threads only call IAssetFactory::prepareLoad(), everything else is done on the main thread.
+struct AssetLibrary::AsyncLoadQueue {
+	AsyncLoadQueue(AssetLibrary* const assetLibrary, const int numThreads) {
+		for (int t = 0; t < numThreads; ++t) {
+			threads.emplace_back([this, assetLibrary]() { threadMain(assetLibrary); });
+		}
+	}
+
+	~AsyncLoadQueue() {
+		{
+			const std::lock_guard<std::mutex> guard(lock);
+			shouldExit = true;
+		}
+
+		wakeCondition.notify_all();
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	static void prepare(AsyncLoad& load, AssetLibrary* const assetLibrary) {
+		std::unique_ptr<IAssetLoadData> loadData;
+		const bool succeeded = load.factory->prepareLoad(load.pAsset, load.path.c_str(), assetLibrary, loadData);
+
+		load.loadData = std::move(loadData);
+		load.prepareSucceeded = succeeded;
+	}
+
+	void threadMain(AssetLibrary* const assetLibrary) {
+		std::unique_lock<std::mutex> guard(lock);
+		while (true) {
+			wakeCondition.wait(guard, [this]() { return shouldExit || queuedLoads.empty() == false; });
+			if (shouldExit) {
+				return;
+			}
+
+			std::shared_ptr<AsyncLoad> load = queuedLoads.front();
+			queuedLoads.pop_front();
+
+			guard.unlock();
+			prepare(*load, assetLibrary);
+			guard.lock();
+
+			load->isPrepared = true;
+			preparedCondition.notify_all();
+		}
+	}
+
+	std::vector<std::thread> threads;
+
+	std::mutex lock;
+	std::condition_variable wakeCondition;     // Notified when a load is queued.
+	std::condition_variable preparedCondition; // Notified when a load gets prepared.
+	bool shouldExit = false;
+
+	// The loads waiting for a loading thread. Guarded by the lock.
+	std::deque<std::shared_ptr<AsyncLoad>> queuedLoads;
+
+	// All loads which aren't finished yet, in the order they were requested. Used only by the main thread.
+	std::deque<std::shared_ptr<AsyncLoad>> pendingLoads;
+};
+
 AssetLibrary::AssetLibrary(SGEDevice* const sgedev) {
 	m_sgedev = sgedev;
 
@@ -390,15 +626,51 @@ AssetLibrary::AssetLibrary(SGEDevice* const sgedev) {
 	this->registerAssetType(AssetType::Audio, new TAssetAllocatorDefault<sge::AudioAsset>(), new AudioAssetFactory());
 }
 
+AssetLibrary::~AssetLibrary() {
+	if (m_asyncLoadQueue) {
+		// Stop the loading threads and drop the loads that didn't finish.
+		std::deque<std::shared_ptr<AsyncLoad>> pendingLoads = std::move(m_asyncLoadQueue->pendingLoads);
+		m_asyncLoadQueue.reset();
+
+		for (const std::shared_ptr<AsyncLoad>& load : pendingLoads) {
+			getAllocator(load->asset->getType())->deallocate(load->pAsset);
+		}
+	}
+}
+
 void AssetLibrary::registerAssetType(const AssetType type, IAssetAllocator* const pAllocator, IAssetFactory* const pFactory) {
 	sgeAssert(pAllocator != nullptr);
 	sgeAssert(pFactory != nullptr);
 
-	m_assetAllocators[type] = pAllocator;
-	m_assetFactories[type] = pFactory;
-	// CAUTION: This is here to ensure that the element "type" is present in "std::map<...> m_assets" from nwo on. This is pretty stupid and
-	// has to be fixed.
-	m_assets[type];
+	m_assetAllocators[int(type)] = pAllocator;
+	m_assetFactories[int(type)] = pFactory;
+}
+
+int AssetLibrary::getNormalizedPathId(const char* const pPath) {
+	const int requestedPathId = m_pathRegister.getIndex(pPath);
+	if (requestedPathId >= int(m_normalizedPathIds.size())) {
+		m_normalizedPathIds.resize(requestedPathId + 1, 0);
+	}
+
+	if (m_normalizedPathIds[requestedPathId] == 0) {
+		const std::string pathToAsset = getAssetPathNormalized(pPath);
+
+		// Because std::filesystem::canonical() returns empty string if the path doesn't exists
+		// we assume that the path is invalid.
+		m_normalizedPathIds[requestedPathId] = pathToAsset.empty() ? -1 : m_pathRegister.getIndex(pathToAsset);
+	}
+
+	return std::max(m_normalizedPathIds[requestedPathId], 0);
+}
+
+int AssetLibrary::addAsset(const int pathId, std::shared_ptr<Asset> asset) {
+	AssetRegistry& registry = m_assets[int(asset->getType())];
+
+	const int assetIndex = int(registry.assets.size());
+	registry.assets.emplace_back(std::move(asset));
+	registry.add(pathId, assetIndex);
+
+	return assetIndex;
 }
 
 std::shared_ptr<Asset> AssetLibrary::makeRuntimeAsset(AssetType type, const char* path) {
@@ -408,10 +680,11 @@ std::shared_ptr<Asset> AssetLibrary::makeRuntimeAsset(AssetType type, const char
 	}
 
 	// Check if the asset already exists.
-	std::map<std::string, std::shared_ptr<Asset>>& assets = m_assets[type];
+	const int pathId = m_pathRegister.getIndex(path);
+	AssetRegistry& registry = m_assets[int(type)];
 
-	auto findItr = assets.find(path);
-	if (findItr != assets.end() && isAssetLoaded(findItr->second)) {
+	const int existingIndex = registry.find(pathId);
+	if (existingIndex >= 0 && isAssetLoaded(registry.assets[existingIndex])) {
 		sgeAssertFalse("Asset with the same path already exists");
 		// The asset already exists, we cannot make a new one.
 		return nullptr;
@@ -424,101 +697,104 @@ std::shared_ptr<Asset> AssetLibrary::makeRuntimeAsset(AssetType type, const char
 	}
 
 	std::shared_ptr<Asset> result = std::make_shared<Asset>(pAsset, type, AssetStatus::Loaded, path);
-	assets[path] = result;
+	if (existingIndex >= 0) {
+		registry.assets[existingIndex] = result;
+	} else {
+		addAsset(pathId, result);
+	}
 
 	return result;
 }
 
-std::shared_ptr<Asset> AssetLibrary::getAsset(AssetType type, const char* pPath, const bool loadIfMissing) {
+AssetHandle AssetLibrary::getAssetHandle(AssetType type, const char* pPath, const bool loadIfMissing) {
 	if (!pPath || pPath[0] == '\0') {
 		sgeAssert(false);
-		return std::shared_ptr<Asset>();
+		return AssetHandle();
 	}
 
 	if (AssetType::None == type) {
-		return std::shared_ptr<Asset>();
+		return AssetHandle();
 	}
 
-	const double loadStartTime = Timer::now_seconds();
-
-	// Now make the path relative to the current directory, as some assets
-	// might refer it relative to them, and this wolud lead us loading the same asset
-	// via different path and we don't want that.
-	std::error_code pathToAssetRelativeError;
-	const std::filesystem::path pathToAssetRelative = std::filesystem::relative(pPath, pathToAssetRelativeError);
-
-	// The commented code below, not only makes the path cannonical, but it also makes it absolute, which we don't want.
-	// std::error_code pathToAssetCanonicalError;
-	// const std::filesystem::path pathToAssetCanonical = std::filesystem::weakly_canonical(pathToAssetRelative, pathToAssetCanonicalError);
-
-	// canonizePathRespectOS makes makes the slashes UNUX Style.
-	const std::string pathToAsset = canonizePathRespectOS(pathToAssetRelative.string());
-
-	if (pathToAssetRelativeError) {
-		sgeAssert(false && "Failed to transform the asset path to relative");
-	}
-
-	if (pathToAsset.empty()) {
-		// Because std::filesystem::canonical() returns empty string if the path doesn't exists
-		// we assume that the loading failed.
-		return std::shared_ptr<Asset>();
+	const int pathId = getNormalizedPathId(pPath);
+	if (pathId == 0) {
+		// We assume that the loading failed.
+		return AssetHandle();
 	}
 
 	// Check if the asset already exists.
-	std::map<std::string, std::shared_ptr<Asset>>& assets = m_assets[type];
+	AssetHandle handle;
+	handle.type = type;
+	handle.index = m_assets[int(type)].find(pathId);
+
+	if (handle.index >= 0) {
+		Asset* const existingAsset = m_assets[int(type)].assets[handle.index].get();
+		if (existingAsset->getStatus() == AssetStatus::Loaded) {
+			return handle;
+		}
 
-	auto findItr = assets.find(pathToAsset);
-	if (findItr != assets.end() && isAssetLoaded(findItr->second)) {
-		return findItr->second;
+		// The asset is being loaded asynchronously, finish the loading now.
+		if (existingAsset->getStatus() == AssetStatus::Loading) {
+			if (loadIfMissing) {
+				finishAsyncLoad(existingAsset);
+			}
+			return handle;
+		}
 	}
 
 	if (!loadIfMissing) {
-		// Empty asset shared ptr.
 		// TODO: Should I create an empty asset to that path with unknown state? It sounds logical?
-		return findItr != assets.end() ? findItr->second : std::shared_ptr<Asset>();
+		return handle;
 	}
 
 	// Load the asset.
+	const double loadStartTime = Timer::now_seconds();
+
 	IAssetAllocator* const pAllocator = getAllocator(type);
 	IAssetFactory* const pFactory = getFactory(type);
 
 	if (!pAllocator || !pFactory) {
 		sgeAssert(false && "Cannot lode an asset of the specified type");
-		return std::shared_ptr<Asset>();
+		return AssetHandle();
 	}
 
+	// The factory might load other assets, so don't keep any references to the registry during the loading.
+	// @pPath might be the path of the asset itself (see loadAsset()), which gets overwritten below.
+	const std::string pathToAsset = m_pathRegister.getString(pathId);
+
 	void* pAsset = pAllocator->allocate();
 
 	const bool succeeded = pFactory->load(pAsset, pathToAsset.c_str(), this);
 	if (succeeded == false) {
-		SGE_DEBUG_ERR("Failed on asset %s\n", pPath);
+		SGE_DEBUG_ERR("Failed on asset %s\n", pathToAsset.c_str());
 		pAllocator->deallocate(pAsset);
 		pAsset = NULL;
 	}
 
-	std::shared_ptr<Asset> result;
+	const AssetStatus status = (pAsset) ? AssetStatus::Loaded : AssetStatus::LoadFailed;
 
-	if (findItr == assets.end()) {
+	if (handle.index < 0) {
 		// Add the asset to the library.
-		std::shared_ptr<Asset> asset =
-		    std::make_shared<Asset>(pAsset, type, (pAsset) ? AssetStatus::Loaded : AssetStatus::LoadFailed, pathToAsset.c_str());
-
-		asset->m_loadedModifiedTime = FileReadStream::getFileModTime(pPath);
+		std::shared_ptr<Asset> asset = std::make_shared<Asset>(pAsset, type, status, pathToAsset.c_str());
+		asset->m_loadedModifiedTime = FileReadStream::getFileModTime(pathToAsset.c_str());
 
-		assets[pathToAsset] = asset;
-		result = asset;
+		handle.index = addAsset(pathId, std::move(asset));
 	} else {
-		sgeAssert(findItr->second->asVoid() == nullptr);
-		*findItr->second = Asset(pAsset, type, (pAsset) ? AssetStatus::Loaded : AssetStatus::LoadFailed, pathToAsset.c_str());
-		findItr->second->m_loadedModifiedTime = FileReadStream::getFileModTime(pPath);
-		result = findItr->second;
+		Asset& asset = *m_assets[int(type)].assets[handle.index];
+		sgeAssert(asset.asVoid() == nullptr);
+		asset = Asset(pAsset, type, status, pathToAsset.c_str());
+		asset.m_loadedModifiedTime = FileReadStream::getFileModTime(pathToAsset.c_str());
 	}
 
 	// Measure the loading time.
 	const float loadEndTime = Timer::now_seconds();
 	SGE_DEBUG_LOG("Asset '%s' loaded in %f seconds.\n", pathToAsset.c_str(), loadEndTime - loadStartTime);
 
-	return result;
+	return handle;
+}
+
+std::shared_ptr<Asset> AssetLibrary::getAsset(AssetType type, const char* pPath, const bool loadIfMissing) {
+	return getAsset(getAssetHandle(type, pPath, loadIfMissing));
 }
 
 std::shared_ptr<Asset> AssetLibrary::getAsset(const char* pPath, bool loadIfMissing) {
@@ -534,6 +810,177 @@ bool AssetLibrary::loadAsset(Asset* asset) {
 	return false;
 }
 
+std::shared_ptr<Asset> AssetLibrary::getAssetAsync(AssetType type, const char* pPath) {
+	if (!pPath || pPath[0] == '\0') {
+		sgeAssert(false);
+		return std::shared_ptr<Asset>();
+	}
+
+	if (AssetType::None == type) {
+		return std::shared_ptr<Asset>();
+	}
+
+	const int pathId = getNormalizedPathId(pPath);
+	if (pathId == 0) {
+		return std::shared_ptr<Asset>();
+	}
+
+	// Check if the asset is already loaded or being loaded.
+	const int existingIndex = m_assets[int(type)].find(pathId);
+	std::shared_ptr<Asset> asset = existingIndex >= 0 ? m_assets[int(type)].assets[existingIndex] : std::shared_ptr<Asset>();
+	if (asset && (asset->getStatus() == AssetStatus::Loaded || asset->getStatus() == AssetStatus::Loading)) {
+		return asset;
+	}
+
+	IAssetAllocator* const pAllocator = getAllocator(type);
+	IAssetFactory* const pFactory = getFactory(type);
+
+	if (!pAllocator || !pFactory) {
+		sgeAssert(false && "Cannot lode an asset of the specified type");
+		return std::shared_ptr<Asset>();
+	}
+
+	const std::string& pathToAsset = m_pathRegister.getString(pathId);
+
+	if (asset) {
+		sgeAssert(asset->asVoid() == nullptr);
+		*asset = Asset(nullptr, type, AssetStatus::Loading, pathToAsset.c_str());
+	} else {
+		asset = std::make_shared<Asset>(nullptr, type, AssetStatus::Loading, pathToAsset.c_str());
+		addAsset(pathId, asset);
+	}
+
+	std::shared_ptr<AsyncLoad> load = std::make_shared<AsyncLoad>();
+	load->asset = asset;
+	load->path = pathToAsset;
+	load->factory = pFactory;
+	load->pAsset = pAllocator->allocate();
+
+	if (!m_asyncLoadQueue) {
+		const int kNumLoadingThreads = 2;
+		m_asyncLoadQueue = std::make_unique<AsyncLoadQueue>(this, kNumLoadingThreads);
+	}
+
+	m_asyncLoadQueue->pendingLoads.push_back(load);
+	{
+		const std::lock_guard<std::mutex> guard(m_asyncLoadQueue->lock);
+		m_asyncLoadQueue->queuedLoads.push_back(load);
+	}
+	m_asyncLoadQueue->wakeCondition.notify_one();
+
+	return asset;
+}
+
+std::shared_ptr<Asset> AssetLibrary::getAssetAsync(const char* pPath) {
+	AssetType assetType = assetType_guessFromExtension(extractFileExtension(pPath).c_str(), false);
+	return getAssetAsync(assetType, pPath);
+}
+
+int AssetLibrary::finalizeAsyncLoads(const float timeBudgetSeconds) {
+	if (!m_asyncLoadQueue) {
+		return 0;
+	}
+
+	const double startTime = Timer::now_seconds();
+
+	int numFinalized = 0;
+	std::deque<std::shared_ptr<AsyncLoad>>& pendingLoads = m_asyncLoadQueue->pendingLoads;
+	while (pendingLoads.empty() == false) {
+		if (numFinalized > 0 && Timer::now_seconds() - startTime >= timeBudgetSeconds) {
+			break;
+		}
+
+		// Finish the assets in the order they were requested, wait for the next frame if the first one isn't prepared yet.
+		{
+			const std::lock_guard<std::mutex> guard(m_asyncLoadQueue->lock);
+			if (pendingLoads.front()->isPrepared == false) {
+				break;
+			}
+		}
+
+		const std::shared_ptr<AsyncLoad> load = pendingLoads.front();
+		pendingLoads.pop_front();
+
+		finalizeAsyncLoad(*load);
+		numFinalized++;
+	}
+
+	return numFinalized;
+}
+
+void AssetLibrary::waitForAsyncLoads() {
+	if (!m_asyncLoadQueue) {
+		return;
+	}
+
+	while (m_asyncLoadQueue->pendingLoads.empty() == false) {
+		finishAsyncLoad(m_asyncLoadQueue->pendingLoads.front()->asset.get());
+	}
+}
+
+int AssetLibrary::getNumPendingAsyncLoads() const {
+	return m_asyncLoadQueue ? int(m_asyncLoadQueue->pendingLoads.size()) : 0;
+}
+
+void AssetLibrary::finalizeAsyncLoad(AsyncLoad& load) {
+	const double finalizeStartTime = Timer::now_seconds();
+
+	void* pAsset = load.pAsset;
+	const bool succeeded =
+	    load.prepareSucceeded && load.factory->finalizeLoad(pAsset, load.path.c_str(), this, load.loadData.get());
+	load.loadData.reset();
+
+	if (succeeded == false) {
+		SGE_DEBUG_ERR("Failed on asset %s\n", load.path.c_str());
+		getAllocator(load.asset->getType())->deallocate(pAsset);
+		pAsset = nullptr;
+	}
+
+	Asset& asset = *load.asset;
+	sgeAssert(asset.getStatus() == AssetStatus::Loading);
+	asset.m_pAsset = pAsset;
+	asset.m_status = pAsset ? AssetStatus::Loaded : AssetStatus::LoadFailed;
+	asset.m_loadedModifiedTime = FileReadStream::getFileModTime(load.path.c_str());
+
+	const double finalizeEndTime = Timer::now_seconds();
+	SGE_DEBUG_LOG("Asset '%s' finalized in %f seconds.\n", load.path.c_str(), finalizeEndTime - finalizeStartTime);
+}
+
+void AssetLibrary::finishAsyncLoad(Asset* const asset) {
+	sgeAssert(m_asyncLoadQueue && asset && asset->getStatus() == AssetStatus::Loading);
+
+	std::deque<std::shared_ptr<AsyncLoad>>& pendingLoads = m_asyncLoadQueue->pendingLoads;
+	auto itrLoad = std::find_if(pendingLoads.begin(), pendingLoads.end(),
+	                            [asset](const std::shared_ptr<AsyncLoad>& load) { return load->asset.get() == asset; });
+	if (itrLoad == pendingLoads.end()) {
+		sgeAssert(false && "The asset is marked as loading, but there isn't such request");
+		return;
+	}
+
+	const std::shared_ptr<AsyncLoad> load = *itrLoad;
+	pendingLoads.erase(itrLoad);
+
+	// If no loading thread has picked the asset yet, prepare it here instead of waiting.
+	bool shouldPrepareHere = false;
+	{
+		std::unique_lock<std::mutex> guard(m_asyncLoadQueue->lock);
+		std::deque<std::shared_ptr<AsyncLoad>>& queuedLoads = m_asyncLoadQueue->queuedLoads;
+		auto itrQueued = std::find(queuedLoads.begin(), queuedLoads.end(), load);
+		if (itrQueued != queuedLoads.end()) {
+			queuedLoads.erase(itrQueued);
+			shouldPrepareHere = true;
+		} else {
+			m_asyncLoadQueue->preparedCondition.wait(guard, [&load]() { return load->isPrepared; });
+		}
+	}
+
+	if (shouldPrepareHere) {
+		AsyncLoadQueue::prepare(*load, this);
+	}
+
+	finalizeAsyncLoad(*load);
+}
+
 
 
 bool AssetLibrary::reloadAssetModified(Asset* const asset) {
@@ -604,10 +1051,11 @@ void AssetLibrary::scanForAvailableAssets(const char* const path) {
 }
 
 void AssetLibrary::reloadChangedAssets() {
-	for (auto& assetsPerType : m_assets) {
-		for (auto& assetPair : assetsPerType.second) {
-			std::shared_ptr<Asset>& asset = assetPair.second;
-			reloadAssetModified(asset.operator->());
+	// Reloading an asset might add new assets to the library, so iterate by index.
+	for (const AssetRegistry& registry : m_assets) {
+		for (size_t iAsset = 0; iAsset < registry.assets.size(); ++iAsset) {
+			const std::shared_ptr<Asset> asset = registry.assets[iAsset];
+			reloadAssetModified(asset.get());
 		}
 	}
 }
@@ -617,15 +1065,13 @@ void AssetLibrary::markThatAssetExists(const char* path, AssetType const type) {
 		return;
 	}
 
-	std::map<std::string, std::shared_ptr<Asset>>& assets = m_assets[type];
-	std::shared_ptr<Asset>& asset = assets[path];
-
 	// Check if the asset is allocaded.
-	if (asset) {
+	const int pathId = m_pathRegister.getIndex(path);
+	if (m_assets[int(type)].find(pathId) >= 0) {
 		return;
 	}
 
-	asset = std::make_shared<Asset>(nullptr, type, AssetStatus::NotLoaded, canonizePathRespectOS(path).c_str());
+	addAsset(pathId, std::make_shared<Asset>(nullptr, type, AssetStatus::NotLoaded, canonizePathRespectOS(path).c_str()));
 }
 
 } // namespace sge
@@ -1,11 +1,15 @@
 #pragma once
 
-#include <map>
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 #include "sge_core/Sprite.h"
 #include "sge_core/model/EvaluatedModel.h"
 #include "sge_core/model/Model.h"
+#include "sge_utils/utils/StringRegister.h"
 #include "sge_utils/utils/vector_map.h"
 #include "sgecore_api.h"
 
@@ -16,8 +20,8 @@ using AudioAsset = std::shared_ptr<AudioTrack>;
 struct AssetLibrary;
 struct AssetModel {
 	Model::Model model;
+	/// The model evaluated with no animation. Animated instances should evaluate their own EvaluatedModel.
 	EvaluatedModel staticEval;
-	EvaluatedModel sharedEval;
 };
 
 // Defines all posible asset types.
@@ -49,11 +53,84 @@ struct SGE_CORE_API IAssetAllocator {
 	virtual void deallocate(void* ptr) = 0;
 };
 
+/// The default IAssetAllocator, allocating every asset with new.
+/// Every allocation has a header before the asset, holding its index in the list of allocations,
+/// so deallocating doesn't need to search.
+template <typename T>
+struct TAssetAllocatorDefault : public IAssetAllocator {
+	void* allocate() final {
+		Allocation* const allocation = new Allocation;
+		allocation->dataIndex = data.size();
+		data.push_back(allocation);
+		return new (allocation->storage) T;
+	}
+
+	/// @ptr must be returned by allocate() of this allocator and not deallocated yet, as the header
+	/// of the allocation is read before checking it. The check is only a sanity check for misuse.
+	void deallocate(void* ptr) final {
+		if (ptr == nullptr) {
+			sgeAssert(false);
+			return;
+		}
+
+		Allocation* const allocation = reinterpret_cast<Allocation*>(static_cast<char*>(ptr) - offsetof(Allocation, storage));
+		if (allocation->dataIndex >= data.size() || data[allocation->dataIndex] != allocation) {
+			// TODO; now wut?
+			sgeAssert(false);
+			return;
+		}
+
+		// Move the last allocation in place of the freed one.
+		data[allocation->dataIndex] = data.back();
+		data[allocation->dataIndex]->dataIndex = allocation->dataIndex;
+		data.pop_back();
+
+		static_cast<T*>(ptr)->~T();
+		delete allocation;
+	}
+
+	/// Returns the number of assets allocated and not deallocated yet.
+	size_t getNumAllocated() const { return data.size(); }
+
+  private:
+	struct Allocation {
+		size_t dataIndex; // The index of the allocation in @data.
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	// offsetof() is well defined only for standard layout types, which is why the asset is stored as raw bytes.
+	static_assert(std::is_standard_layout<Allocation>::value, "The allocation header must have a standard layout");
+
+	std::vector<Allocation*> data;
+};
+
+/// The data produced by IAssetFactory::prepareLoad() and consumed by IAssetFactory::finalizeLoad(),
+/// like the decoded pixels of a texture waiting to be uploaded to the GPU.
+struct SGE_CORE_API IAssetLoadData {
+	virtual ~IAssetLoadData() = default;
+};
+
 /// Provides an interface that is used to load/unload/ect a particular asset of a type.
 struct SGE_CORE_API IAssetFactory {
 	virtual void getDependancyList(void* UNUSED(asset), std::vector<std::string>& UNUSED(deps)) {}
 	virtual bool load(void* const pAsset, const char* const pPath, AssetLibrary* const mpMngrngr) = 0;
 	virtual void unload(void* const pAsset, AssetLibrary* const pMngr) = 0;
+
+	/// The asynchronous loading is split in two steps, see AssetLibrary::getAssetAsync().
+	/// prepareLoad() is called on a loading thread and should do the file reading and the CPU decoding. It must not use the device
+	/// or other assets. Anything that finalizeLoad() needs, which doesn't fit in @pAsset, should be returned in @loadData.
+	/// finalizeLoad() is called later on the main thread to finish the loading, usually by creating the GPU resources.
+	/// By default the whole loading is done by finalizeLoad().
+	virtual bool prepareLoad(void* const UNUSED(pAsset),
+	                         const char* const UNUSED(pPath),
+	                         AssetLibrary* const UNUSED(pMngr),
+	                         std::unique_ptr<IAssetLoadData>& UNUSED(loadData)) {
+		return true;
+	}
+
+	virtual bool finalizeLoad(void* const pAsset, const char* const pPath, AssetLibrary* const pMngr, IAssetLoadData* UNUSED(loadData)) {
+		return load(pAsset, pPath, pMngr);
+	}
 };
 
 /// @brief Describes the current status of an asset.
@@ -64,6 +141,8 @@ enum class AssetStatus : int {
 	Loaded,
 	/// Loading the asset failed. Maybe the files is broken or it does not exist.
 	LoadFailed,
+	/// The asset is being loaded asynchronously, see AssetLibrary::getAssetAsync().
+	Loading,
 };
 
 /// @brief Asset provides a data storage and and status tracker for all assets.
@@ -138,10 +217,24 @@ struct SGE_CORE_API Asset {
 using PAsset = std::shared_ptr<Asset>;
 using WAsset = std::weak_ptr<Asset>;
 
+/// @brief A stable reference to an asset in the AssetLibrary, see AssetLibrary::getAssetHandle().
+/// The assets are never removed from the library, so the handle stays valid for the lifetime of the library,
+/// even if the asset gets reloaded. Retrieving the asset by handle doesn't need any path lookups.
+struct AssetHandle {
+	AssetType type = AssetType::None;
+	int index = -1; ///< The index of the asset in the library, for the specified type.
+
+	bool isValid() const { return type != AssetType::None && index >= 0; }
+
+	bool operator==(const AssetHandle& ref) const { return type == ref.type && index == ref.index; }
+	bool operator!=(const AssetHandle& ref) const { return !(*this == ref); }
+};
+
 /// @brief AssetLibrary provides a way for loading and tracking used assets of any kind.
 struct SGE_CORE_API AssetLibrary {
   public:
 	AssetLibrary(SGEDevice* const sgedev);
+	~AssetLibrary();
 
 	/// Make runtime asset
 	std::shared_ptr<Asset> makeRuntimeAsset(AssetType type, const char* path);
@@ -152,26 +245,53 @@ struct SGE_CORE_API AssetLibrary {
 	/// Retrieves the asset and loading it by guess the Asset Type based on the file extension.
 	std::shared_ptr<Asset> getAsset(const char* pPath, const bool loadIfMissing);
 
+	/// Does the same as getAsset(), but returns a handle to the asset, that could be cached to skip the path lookups.
+	/// Returns an invalid handle if the asset isn't in the library (and @loadIfMissing is false) or if the path is invalid.
+	AssetHandle getAssetHandle(AssetType type, const char* pPath, const bool loadIfMissing);
+
+	/// Retrieves the asset by a handle returned by getAssetHandle(). Doesn't load the asset.
+	std::shared_ptr<Asset> getAsset(const AssetHandle& handle) const {
+		if (!handle.isValid()) {
+			return std::shared_ptr<Asset>();
+		}
+
+		const std::vector<std::shared_ptr<Asset>>& assets = m_assets[int(handle.type)].assets;
+		sgeAssert(handle.index < int(assets.size()));
+		return assets[handle.index];
+	}
+
 	bool loadAsset(Asset* asset);
 
+	/// Requests the asset to be loaded asynchronously and returns it immediately, with AssetStatus::Loading if it isn't loaded yet.
+	/// The file reading and the decoding are done by the loading threads, the rest is done by finalizeAsyncLoads().
+	/// Requesting an asset that is already being loaded returns the same asset without loading it again.
+	/// Calling getAsset() for an asset that is being loaded waits for it and finishes the loading immediately.
+	std::shared_ptr<Asset> getAssetAsync(AssetType type, const char* pPath);
+	std::shared_ptr<Asset> getAssetAsync(const char* pPath);
+
+	/// Finishes the loading of the assets already prepared by the loading threads, in the order they were requested.
+	/// Should be called every frame on the main thread. Stops when @timeBudgetSeconds are spent, but finishes at least one asset.
+	/// Returns the number of assets that were finished.
+	int finalizeAsyncLoads(float timeBudgetSeconds);
+
+	/// Waits for all requested assets to get loaded and finishes their loading.
+	void waitForAsyncLoads();
+
+	/// Returns the number of assets requested with getAssetAsync() which loading isn't finished yet.
+	int getNumPendingAsyncLoads() const;
+
 	// Reloads an asset is the source file modified time has changed.
 	bool reloadAssetModified(Asset* const asset);
 
-	IAssetAllocator* getAllocator(const AssetType type) { return m_assetAllocators[type]; }
-	IAssetFactory* getFactory(const AssetType type) { return m_assetFactories[type]; }
+	IAssetAllocator* getAllocator(const AssetType type) { return m_assetAllocators[int(type)]; }
+	IAssetFactory* getFactory(const AssetType type) { return m_assetFactories[int(type)]; }
 
 	SGEDevice* getDevice() { return m_sgedev; }
 
-	std::map<std::string, std::shared_ptr<Asset>>& getAllAssets(AssetType type) {
-		const auto& itr = m_assets.find(type);
-		sgeAssert(itr != m_assets.end());
-		return itr->second;
-	}
-
-	const std::map<std::string, std::shared_ptr<Asset>>& getAllAssets(AssetType type) const {
-		const auto& itr = m_assets.find(type);
-		sgeAssert(itr != m_assets.end());
-		return itr->second;
+	/// Returns all assets of the specified type, in the order they were added to the library.
+	const std::vector<std::shared_ptr<Asset>>& getAllAssets(AssetType type) const {
+		sgeAssert(int(type) >= 0 && int(type) < int(AssetType::Count));
+		return m_assets[int(type)].assets;
 	}
 
 	void scanForAvailableAssets(const char* const path);
@@ -184,18 +304,62 @@ struct SGE_CORE_API AssetLibrary {
 
 	void markThatAssetExists(const char* path, AssetType const type);
 
+	/// The assets of a single type, with an open addressing hash map from a path id (in m_pathRegister) to the asset.
+	/// The assets are never removed, so the indices in @assets are used as AssetHandle::index.
+	struct AssetRegistry {
+		struct Slot {
+			int pathId = 0; // Zero if the slot is empty, the path register never assigns it.
+			int assetIndex = -1;
+		};
+
+		/// Returns the index of the asset with the specified path, or -1 if there isn't such asset.
+		int find(const int pathId) const;
+
+		/// Adds an asset to the hash map. The path must not be present.
+		void add(const int pathId, const int assetIndex);
+
+		std::vector<std::shared_ptr<Asset>> assets;
+		std::vector<Slot> slots; // The size is always a power of two.
+		int numUsedSlots = 0;
+	};
+
+	/// Returns the id of the normalized version of the specified path (see getAssetPathNormalized() in the .cpp),
+	/// or zero if the path is invalid. The normalization is cached for every requested path, as it is relative to
+	/// the current directory it is assumed that the current directory doesn't change while the library is in use.
+	int getNormalizedPathId(const char* const pPath);
+
+	/// Adds a new asset to the registry of its type, the path must not be present.
+	int addAsset(const int pathId, std::shared_ptr<Asset> asset);
+
+	struct AsyncLoad;
+	struct AsyncLoadQueue;
+
+	/// Finishes the loading of an asset prepared by the loading threads.
+	void finalizeAsyncLoad(AsyncLoad& load);
+
+	/// Waits for the asynchronous loading of the specified asset to get prepared and finishes it.
+	void finishAsyncLoad(Asset* const asset);
+
 	// TODO: Maybe we should make this public in order to support "more" asset types on the go... but who cares!?
 	// Registers a new asset type
 	void registerAssetType(const AssetType type, IAssetAllocator* const pAllocator, IAssetFactory* const pFactory);
 
-	std::map<AssetType, IAssetAllocator*> m_assetAllocators;
-	std::map<AssetType, IAssetFactory*> m_assetFactories;
+	IAssetAllocator* m_assetAllocators[int(AssetType::Count)] = {};
+	IAssetFactory* m_assetFactories[int(AssetType::Count)] = {};
 
 	// TODO: in order not to automatically unload assets shared_ptr is used. This should be optional. An example emplementation is to
 	// use weak_ptr here, and another vector<shared_ptr> that holds those special assets(like characters, menu textures, ect.).
-	std::map<AssetType, std::map<std::string, std::shared_ptr<Asset>>> m_assets;
+	AssetRegistry m_assets[int(AssetType::Count)];
+
+	/// The ids of all paths used as a key of an asset or requested by the user.
+	StringRegister m_pathRegister;
+	/// For every path id in m_pathRegister, the id of its normalized path. Zero if not computed yet, -1 if the path is invalid.
+	std::vector<int> m_normalizedPathIds;
 
 	SGEDevice* m_sgedev;
+
+	/// The loading threads and the assets requested with getAssetAsync(), created on the first request.
+	std::unique_ptr<AsyncLoadQueue> m_asyncLoadQueue;
 };
 
 // Some helpers.
@@ -49,6 +49,11 @@ struct Geometry {
 	int stride = 0;                                 // The size of a whole vertex in bytes.
 	UniformType::Enum ibFmt = UniformType::Unknown; // The format the index buffer, if unknown this mesh doesn't use index buffers.
 	uint32 numElements = 0;                         // The number of vertices/indices used by this mesh.
+
+	// Skinning in the vertex shader. If used, the vertex declaration has the bone indices and weights
+	// (a_bonesIds and a_bonesWeights) in vertex buffer slot 2, see Model::SkinningVertex.
+	Buffer* skinningVertexBuffer = nullptr;
+	const mat4f* skinningBones = nullptr; // Model::kMaxGpuSkinningBones bone transforms, nullptr if no skinning is needed.
 };
 
 struct Material {
@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "CompiledAnimation.h"
+#include "Parameter.h"
+
+namespace sge {
+namespace Model {
+
+	namespace {
+		/// Samples the track with the specified keys, with the same rules as ParameterCurve::Evaluate.
+		template <typename T, typename TInterpolateFn>
+		T sampleTrack(const float* const times,
+		              const T* const values,
+		              const int numKeys,
+		              const float time,
+		              int* const keyCursor,
+		              TInterpolateFn interpolate) {
+			sgeAssert(numKeys > 0);
+
+			// Most of the tracks that aren't animated have a single key.
+			if (numKeys == 1) {
+				return values[0];
+			}
+
+			const int keyIdx = keyCursor ? findKeyIndex(times, numKeys, time, *keyCursor)
+			                             : int(std::lower_bound(times, times + numKeys, time) - times);
+
+			if (keyIdx == 0) {
+				// The requested evaluation time is before the 1st keyframe.
+				return values[0];
+			} else if (keyIdx == numKeys) {
+				// The requested evaluation time is after the last keyframe.
+				return values[numKeys - 1];
+			}
+
+			// Between 2 keys.
+			const float timeRange = times[keyIdx] - times[keyIdx - 1];
+			const float interpolationCoeff = (time - times[keyIdx - 1]) / timeRange;
+			return interpolate(values[keyIdx - 1], values[keyIdx], interpolationCoeff);
+		}
+
+		vec3f interpolateVec3(const vec3f& a, const vec3f& b, const float t) {
+			return lerp(a, b, t);
+		}
+
+		quatf interpolateQuat(const quatf& a, const quatf& b, const float t) {
+			return slerp(a, b, t);
+		}
+	} // namespace
+
+	transf3d CompiledAnimation::evaluateNode(const int iNode, const float time, int* const keyCursors) const {
+		sgeAssert(iNode >= 0 && iNode < getNumNodes());
+
+		const KeyRange* const tracks = &keyRanges[iNode * AnimationChannel_Count];
+		const KeyRange& translation = tracks[AnimationChannel_Translation];
+		const KeyRange& rotation = tracks[AnimationChannel_Rotation];
+		const KeyRange& scaling = tracks[AnimationChannel_Scaling];
+
+		int* const translationCursor = keyCursors ? &keyCursors[AnimationChannel_Translation] : nullptr;
+		int* const rotationCursor = keyCursors ? &keyCursors[AnimationChannel_Rotation] : nullptr;
+		int* const scalingCursor = keyCursors ? &keyCursors[AnimationChannel_Scaling] : nullptr;
+
+		transf3d result;
+		result.p = sampleTrack(translationKeyTimes.data() + translation.firstKey, translationKeyValues.data() + translation.firstKey,
+		                       translation.numKeys, time, translationCursor, interpolateVec3);
+		result.r = sampleTrack(rotationKeyTimes.data() + rotation.firstKey, rotationKeyValues.data() + rotation.firstKey, rotation.numKeys,
+		                       time, rotationCursor, interpolateQuat);
+		result.s = sampleTrack(scalingKeyTimes.data() + scaling.firstKey, scalingKeyValues.data() + scaling.firstKey, scaling.numKeys,
+		                       time, scalingCursor, interpolateVec3);
+
+		return result;
+	}
+
+	void CompiledAnimation::evaluateNodes(const float time, transf3d* const result, int* const keyCursors) const {
+		const int numNodes = getNumNodes();
+		for (int iNode = 0; iNode < numNodes; ++iNode) {
+			result[iNode] = evaluateNode(iNode, time, keyCursors ? &keyCursors[iNode * AnimationChannel_Count] : nullptr);
+		}
+	}
+
+} // namespace Model
+} // namespace sge
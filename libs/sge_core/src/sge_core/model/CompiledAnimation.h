@@ -0,0 +1,63 @@
+#pragma once
+
+#include "sge_core/sgecore_api.h"
+#include "sge_utils/math/transform.h"
+#include <string>
+#include <vector>
+
+namespace sge {
+namespace Model {
+
+	/// The animated components of the local transform of a node.
+	enum AnimationChannel : int {
+		AnimationChannel_Translation,
+		AnimationChannel_Rotation,
+		AnimationChannel_Scaling,
+
+		AnimationChannel_Count,
+	};
+
+	/// An animation of a model compiled for evaluation without any string lookups, see Model::compileAnimations().
+	/// Every node has a track for every channel. The keys of all tracks are stored in typed arrays (structure of arrays),
+	/// each track refers to a range in them. Tracks of channels that aren't animated have a single key with the static value.
+	struct SGE_CORE_API CompiledAnimation {
+		struct KeyRange {
+			int firstKey = 0;
+			int numKeys = 0;
+		};
+
+		/// Evaluates the local transform of the node with the specified index in Model::m_nodes.
+		/// @time is relative to the start of the animation.
+		/// @keyCursors are optional cursors of the key search for each channel of the node (AnimationChannel_Count of them),
+		/// kept between evaluations by the caller, see findKeyIndex(). Initialize them with -1.
+		transf3d evaluateNode(int iNode, float time, int* keyCursors = nullptr) const;
+
+		/// Evaluates the local transforms of all nodes, @result must have getNumNodes() elements.
+		/// @keyCursors are optional cursors of the key search for every track (keyRanges.size() of them), see evaluateNode().
+		void evaluateNodes(float time, transf3d* result, int* keyCursors = nullptr) const;
+
+		int getNumNodes() const { return int(keyRanges.size()) / AnimationChannel_Count; }
+
+		/// Returns the track of the specified node channel.
+		const KeyRange& getKeyRange(int iNode, AnimationChannel channel) const {
+			return keyRanges[iNode * AnimationChannel_Count + channel];
+		}
+
+	  public:
+		std::string name; // The name of the curves of the animation, see AnimationInfo::curveName. Empty for the static moment.
+		float duration = 0.f;
+
+		// The tracks of every node, indexed by [iNode * AnimationChannel_Count + channel].
+		std::vector<KeyRange> keyRanges;
+
+		// The keys of all tracks. The times are relative to the start of the animation.
+		std::vector<float> translationKeyTimes;
+		std::vector<vec3f> translationKeyValues;
+		std::vector<float> rotationKeyTimes;
+		std::vector<quatf> rotationKeyValues;
+		std::vector<float> scalingKeyTimes;
+		std::vector<vec3f> scalingKeyValues;
+	};
+
+} // namespace Model
+} // namespace sge
@@ -1,7 +1,7 @@
-#include <functional>
-
 #include "sge_core/AssetLibrary.h"
+#include "sge_utils/math/Skinning.h"
 #include "sge_utils/math/transform.h"
+#include "sge_utils/utils/JobSystem.h"
 #include "sge_utils/utils/range_loop.h"
 
 #include "EvaluatedModel.h"
@@ -12,64 +12,68 @@ namespace sge {
 const char s_DiffuseTextureParamName[] = "texDiffuse";
 const char s_TexNormalMap[] = "texNormal";
 
+// Meshes with at least that many vertices are skinned on the CPU with multiple jobs, each skinning kSkinningJobNumVertices vertices.
+const int kMinVerticesForSkinningJobs = 8192;
+const int kSkinningJobNumVertices = 4096;
+
 void EvaluatedModel::initialize(AssetLibrary* const assetLibrary, Model::Model* model) {
 	sgeAssert(assetLibrary != NULL);
 	sgeAssert(model);
 
 	// Reset the object's state.
+	JobSystem* const jobSystem = m_jobSystem;
 	*this = EvaluatedModel();
 
+	m_jobSystem = jobSystem;
 	m_assetLibrary = assetLibrary;
 	m_model = model;
 }
 
-void EvaluatedModel::buildNodeRemappingLUT(const Model::Model* otherModel) {
-	if (!otherModel) {
+void EvaluatedModel::resetIfModelChanged() {
+	if (m_modelRevision == m_model->m_revision) {
 		return;
 	}
 
-	// Skip if the remapping is already there.
-	if (m_nodeRemapping.find_element(otherModel) != nullptr) {
-		return;
-	}
+	// The model got reloaded in place, everything cached for its previous nodes, meshes and materials is invalid.
+	m_modelRevision = m_model->m_revision;
+	m_nodes.clear();
+	meshes.clear();
+	m_materials.clear();
+	m_nodeRemapping.clear();
+	m_animationKeyCursors.clear();
+}
 
-	vector_map<const Model::Node*, const Model::Node*>& nodeRemap = m_nodeRemapping[otherModel];
+const Model::NodeRemap& EvaluatedModel::getNodeRemap(const Model::Model& animationModel) {
+	// The tables are shared between all evaluated models, only the first binding of a pair of models does the name matching.
+	std::shared_ptr<const Model::NodeRemap>& nodeRemap = m_nodeRemapping[&animationModel];
+	if (!nodeRemap || !nodeRemap->isUpToDate(*m_model, animationModel)) {
+		nodeRemap = Model::findNodeRemap(*m_model, animationModel);
+	}
 
-	// Find the equvalent node in the otherModel node and cache it.
-	for (Model::Node* node : m_model->m_nodes) {
-		// CAUTION: Currently the retargeting is mapping node-to-node using names.
-		// This is highly unreliable as there may be multiple nodes with the same name in a single model.
-		// A possible fix is to search these nodes using the hierarchy
-		// for example if we are looking for a node named "hand":
-		// "upper_torso|left_arm|hand".
-		const Model::Node* const foundNode = otherModel->FindFirstNodeByName(node->name.c_str());
+	return *nodeRemap;
+}
 
-		if (foundNode != nullptr) {
-			nodeRemap[node] = foundNode;
-		}
+int* EvaluatedModel::getAnimationKeyCursors(const Model::CompiledAnimation& animation) {
+	std::vector<int>& keyCursors = m_animationKeyCursors[&animation];
+	if (keyCursors.size() != animation.keyRanges.size()) {
+		keyCursors.assign(animation.keyRanges.size(), -1);
 	}
+
+	// The pointer stays valid when adding other animations, as moving the std::vector doesn't move its elements.
+	return keyCursors.data();
 }
 
 bool EvaluatedModel::evaluate(const char* const curveName, float const time) {
-	std::vector<EvalMomentSets> evalSets;
-	evalSets.push_back(EvalMomentSets{m_model, std::string(curveName ? curveName : ""), time, 1.f});
-
-	return evaluate(evalSets);
+	samplePose(m_blendedPose, m_model, std::string(curveName ? curveName : ""), time);
+	return evaluateFromPose(m_blendedPose);
 }
 
 bool EvaluatedModel::evaluate(const std::vector<EvalMomentSets>& evalSets) {
 	if (evalSets.size() == 0)
 		return false;
 
-	for (auto& moment : evalSets) {
-		buildNodeRemappingLUT(moment.model);
-	}
-
-	evaluateNodesFromMoments(evalSets);
-	evaluateMaterials();
-	evaluateSkinning();
-
-	return true;
+	samplePose(m_blendedPose, evalSets);
+	return evaluateFromPose(m_blendedPose);
 }
 
 bool EvaluatedModel::evaluate(vector_map<const Model::Node*, mat4f>& boneOverrides) {
@@ -79,76 +83,119 @@ bool EvaluatedModel::evaluate(vector_map<const Model::Node*, mat4f>& boneOverrid
 	return true;
 }
 
-bool EvaluatedModel::evaluateNodes_common() {
-	aabox.setEmpty();
-	m_nodes.clear();
+void EvaluatedModel::samplePose(ModelPose& result, const Model::Model* animationModel, const std::string& animationName, float time) {
+	resetIfModelChanged();
+	result.resize(int(m_model->m_nodes.size()));
 
-	// Initialize the attachments to the node.
-	for (const Model::Node* const originalNode : m_model->m_nodes) {
-		EvaluatedNode& evalNode = m_nodes[originalNode];
-		evalNode.name = originalNode->name.empty() ? "" : originalNode->name.c_str();
+	if (animationModel == nullptr) {
+		animationModel = m_model;
+	}
 
-		// Obtain the inital bounding box by getting the unevaluated attached meshes bounding boxes.
-		for (const Model::MeshAttachment& meshAttachment : originalNode->meshAttachments) {
-			evalNode.aabb.expand(meshAttachment.mesh->aabox);
-		}
+	if (animationModel->hasCompiledAnimations() == false || m_model->hasCompiledAnimations() == false) {
+		sgeAssert(false && "The animations of the models need to be compiled, see Model::compileAnimations()");
+		return;
 	}
 
-	return true;
+	const std::vector<int>& nodeRemap = getNodeRemap(*animationModel).sourceNodeIndices;
+
+	// The nodes missing in the specified Model use the animation with the same name in our model.
+	const Model::CompiledAnimation& animation = animationModel->findCompiledAnimation(animationName);
+	const Model::CompiledAnimation& fallbackAnimation = m_model->findCompiledAnimation(animationName);
+	int* const keyCursors = getAnimationKeyCursors(animation);
+	int* const fallbackKeyCursors = getAnimationKeyCursors(fallbackAnimation);
+
+	for (int iNode = 0; iNode < int(m_model->m_nodes.size()); ++iNode) {
+		const int iRemappedNode = nodeRemap[iNode];
+		const transf3d transf =
+		    iRemappedNode >= 0
+		        ? animation.evaluateNode(iRemappedNode, time, &keyCursors[iRemappedNode * Model::AnimationChannel_Count])
+		        : fallbackAnimation.evaluateNode(iNode, time, &fallbackKeyCursors[iNode * Model::AnimationChannel_Count]);
+
+		result.setNodeTransform(iNode, transf);
+	}
 }
 
-bool EvaluatedModel::evaluateNodesFromMoments(const std::vector<EvalMomentSets>& evalSets) {
-	evaluateNodes_common();
+void EvaluatedModel::samplePose(ModelPose& result, const std::vector<EvalMomentSets>& evalSets) {
+	if (evalSets.empty()) {
+		samplePose(result, m_model, std::string(), 0.f);
+		return;
+	}
+
+	// Blend the moments one by one, each moment gets blended with its share of the weight accumulated so far.
+	samplePose(result, evalSets[0].model, evalSets[0].animationName, evalSets[0].time);
+	float totalWeight = evalSets[0].weight;
 
-	// Evaluates the nodes. They may be effecte by multiple models (stealing animations and blending them)
-	for (int const iMoment : range_int(int(evalSets.size()))) {
+	for (int iMoment = 1; iMoment < int(evalSets.size()); ++iMoment) {
 		const EvalMomentSets& moment = evalSets[iMoment];
-		auto& nodeRemap = m_nodeRemapping[moment.model];
 
-		const Model::AnimationInfo* const animInfo = moment.model->findAnimation(moment.animationName);
-		const float evalTime = animInfo ? moment.time + animInfo->startTime : moment.time;
+		totalWeight += moment.weight;
+		if (totalWeight > 0.f) {
+			samplePose(m_momentPose, moment.model, moment.animationName, moment.time);
+			result.setBlend(result, m_momentPose, moment.weight / totalWeight);
+		}
+	}
+}
+
+bool EvaluatedModel::evaluateFromPose(const ModelPose& pose) {
+	if (pose.getNumNodes() != int(m_model->m_nodes.size())) {
+		sgeAssert(false && "The pose doesn't match the model");
+		return false;
+	}
 
-		for (const Model::Node* const originalNode : m_model->m_nodes) {
-			// Use the node form the specified Model in the node, if such node doesn't exists, fallback to the originalNode.
-			const Model::Node** ppFoundNode = nodeRemap.find_element(originalNode);
-			const Model::Node* nodeToUse = ppFoundNode ? *ppFoundNode : originalNode;
+	evaluateNodesFromPose(pose);
+	evaluateMaterials();
+	evaluateSkinning();
 
-			const Parameter* const scalingPrm = nodeToUse->paramBlock.FindParameter("scaling");
-			const Parameter* const rotationPrm = nodeToUse->paramBlock.FindParameter("rotation");
-			const Parameter* const translationPrm = nodeToUse->paramBlock.FindParameter("translation");
+	return true;
+}
 
-			EvaluatedNode& evalNode = m_nodes[originalNode];
+bool EvaluatedModel::evaluateNodes_common() {
+	resetIfModelChanged();
+	aabox.setEmpty();
 
-			transf3d transf;
-			scalingPrm->Evalute(&transf.s, moment.animationName.c_str(), evalTime);
-			rotationPrm->Evalute(&transf.r, moment.animationName.c_str(), evalTime);
-			translationPrm->Evalute(&transf.p, moment.animationName.c_str(), evalTime);
+	// The evaluated nodes are created once, the only thing that changes between evaluations are their transforms.
+	if (m_nodes.size() != m_model->m_nodes.size()) {
+		m_nodes.clear();
+		m_nodes.resize(m_model->m_nodes.size());
 
-			mat4f const transfMtx = transf.toMatrix();
+		for (int iNode = 0; iNode < int(m_model->m_nodes.size()); ++iNode) {
+			const Model::Node* const originalNode = m_model->m_nodes[iNode];
+			EvaluatedNode& evalNode = m_nodes[iNode];
+			evalNode.name = originalNode->name.empty() ? "" : originalNode->name.c_str();
 
-			// CAUTION: We assume that all transforms in evalNode are initialized to zero!
-			evalNode.evalLocalTransform += transfMtx * moment.weight; // Hmm... is this at least semi correct?
+			// Obtain the inital bounding box by getting the unevaluated attached meshes bounding boxes.
+			for (const Model::MeshAttachment& meshAttachment : originalNode->meshAttachments) {
+				evalNode.aabb.expand(meshAttachment.mesh->aabox);
+			}
 		}
 	}
 
-	// Evaluate the node global transform by traversing the node hierarchy using the local transform computed above.
-	// Evaluate attached meshes to the evaluated nodes.
-	std::function<void(Model::Node*, mat4f)> traverseGlobalTransform;
-	traverseGlobalTransform = [&](Model::Node* node, const mat4f& parentTransfrom) -> void {
-		EvaluatedNode* evalNode = m_nodes.find_element(node);
-		evalNode->evalGlobalTransform = parentTransfrom * evalNode->evalLocalTransform;
+	return true;
+}
 
-		for (auto& childNode : node->childNodes) {
-			traverseGlobalTransform(childNode, evalNode->evalGlobalTransform);
-		}
+bool EvaluatedModel::evaluateNodesFromPose(const ModelPose& pose) {
+	evaluateNodes_common();
 
-		if (evalNode->aabb.IsEmpty() == false) {
-			aabox.expand(evalNode->aabb.getTransformed(evalNode->evalGlobalTransform));
-		}
-	};
+	if (m_model->hasNodeHierarchy() == false) {
+		sgeAssert(false && "The node hierarchy of the model needs to be computed, see Model::computeNodeHierarchy()");
+		return false;
+	}
+
+	// Evaluate the node global transforms using the local transforms from the pose.
+	// The nodes are visited in order where the parents come before their children, so a single pass is enough.
+	const std::vector<int>& parentIndices = m_model->m_nodeParentIndices;
+	for (const int iNode : m_model->m_nodeOrder) {
+		EvaluatedNode& evalNode = m_nodes[iNode];
+		evalNode.evalLocalTransform = pose.getNodeTransform(iNode).toMatrix();
 
-	traverseGlobalTransform(m_model->m_rootNode, mat4f::getIdentity());
+		const int iParent = parentIndices[iNode];
+		evalNode.evalGlobalTransform =
+		    iParent >= 0 ? m_nodes[iParent].evalGlobalTransform * evalNode.evalLocalTransform : evalNode.evalLocalTransform;
 
+		if (evalNode.aabb.IsEmpty() == false) {
+			aabox.expand(evalNode.aabb.getTransformed(evalNode.evalGlobalTransform));
+		}
+	}
 
 	return true;
 }
@@ -156,10 +203,10 @@ bool EvaluatedModel::evaluateNodesFromMoments(const std::vector<EvalMomentSets>&
 bool EvaluatedModel::evaluateNodesFromExternalBones(vector_map<const Model::Node*, mat4f>& boneGlobalTrasnformOverrides) {
 	evaluateNodes_common();
 
-	for (const Model::Node* const originalNode : m_model->m_nodes) {
-		EvaluatedNode& evalNode = m_nodes[originalNode];
+	for (int iNode = 0; iNode < int(m_model->m_nodes.size()); ++iNode) {
+		EvaluatedNode& evalNode = m_nodes[iNode];
 		// evalNode.evalLocalTransform is not computed as it isn't needed by skinning.
-		evalNode.evalGlobalTransform = boneGlobalTrasnformOverrides[originalNode];
+		evalNode.evalGlobalTransform = boneGlobalTrasnformOverrides[m_model->m_nodes[iNode]];
 		aabox.expand(evalNode.aabb.getTransformed(evalNode.evalGlobalTransform));
 	}
 
@@ -167,9 +214,13 @@ bool EvaluatedModel::evaluateNodesFromExternalBones(vector_map<const Model::Node
 }
 
 bool EvaluatedModel::evaluateMaterials() {
-	m_materials.clear();
-	m_materials.reserve(m_model->m_materials.size());
-
+	// The evaluated materials are created once, and the loaded textures are kept, as the asset library
+	// updates the assets in place when they get reloaded. The textures that aren't loaded are looked up again,
+	// as they might have become available since then.
+	if (m_materials.size() != m_model->m_materials.size()) {
+		m_materials.clear();
+		m_materials.reserve(m_model->m_materials.size());
+	}
 
 	// Evaluate the materials.
 	// TODO:
@@ -177,6 +228,22 @@ bool EvaluatedModel::evaluateMaterials() {
 	{
 		std::string texPath;
 
+		// Returns true if the material has the specified texture parameter.
+		const auto evaluateTexture = [&](const Model::Material* mtl, const char* const paramName, std::shared_ptr<Asset>& texture) -> bool {
+			const Parameter* const tex = mtl->paramBlock.FindParameter(paramName);
+			if (tex == nullptr || tex->GetType() != ParameterType::String) {
+				return false;
+			}
+
+			if (isAssetLoaded(texture) == false) {
+				tex->Evalute(&texPath, "", 0.f);
+				texPath = m_model->m_loadSets.assetDir + texPath;
+				texture = m_assetLibrary->getAsset(AssetType::TextureView, texPath.c_str(), true);
+			}
+
+			return true;
+		};
+
 		for (Model::Material* mtl : m_model->m_materials) {
 			EvaluatedMaterial& evalMtl = m_materials[mtl];
 
@@ -204,38 +271,14 @@ bool EvaluatedModel::evaluateMaterials() {
 			}
 
 			// Check if there is a diffuse texture attached here.
-			if (const Parameter* const tex = mtl->paramBlock.FindParameter(s_DiffuseTextureParamName);
-			    tex && tex->GetType() == ParameterType::String) {
-				tex->Evalute(&texPath, "", 0.f);
-				texPath = m_model->m_loadSets.assetDir + texPath;
-				evalMtl.diffuseTexture = m_assetLibrary->getAsset(AssetType::TextureView, texPath.c_str(), true);
-
+			if (evaluateTexture(mtl, s_DiffuseTextureParamName, evalMtl.diffuseTexture)) {
 				// If there is a texture force the diffuse color to be 1, as Maya doesn't respet it when there is a texture involved.
 				evalMtl.diffuseColor = vec4f(1.f);
 			}
 
-			// Normal map.
-			if (const Parameter* const tex = mtl->paramBlock.FindParameter(s_TexNormalMap);
-			    tex && tex->GetType() == ParameterType::String) {
-				tex->Evalute(&texPath, "", 0.f);
-				texPath = m_model->m_loadSets.assetDir + texPath;
-				evalMtl.texNormalMap = m_assetLibrary->getAsset(AssetType::TextureView, texPath.c_str(), true);
-			}
-
-			// Metallic map.
-			if (const Parameter* const tex = mtl->paramBlock.FindParameter("texMetallic"); tex && tex->GetType() == ParameterType::String) {
-				tex->Evalute(&texPath, "", 0.f);
-				texPath = m_model->m_loadSets.assetDir + texPath;
-				evalMtl.texMetallic = m_assetLibrary->getAsset(AssetType::TextureView, texPath.c_str(), true);
-			}
-
-			// Roughness map.
-			if (const Parameter* const tex = mtl->paramBlock.FindParameter("texRoughness");
-			    tex && tex->GetType() == ParameterType::String) {
-				tex->Evalute(&texPath, "", 0.f);
-				texPath = m_model->m_loadSets.assetDir + texPath;
-				evalMtl.texRoughness = m_assetLibrary->getAsset(AssetType::TextureView, texPath.c_str(), true);
-			}
+			evaluateTexture(mtl, s_TexNormalMap, evalMtl.texNormalMap);
+			evaluateTexture(mtl, "texMetallic", evalMtl.texMetallic);
+			evaluateTexture(mtl, "texRoughness", evalMtl.texRoughness);
 		}
 	}
 
@@ -251,7 +294,6 @@ bool EvaluatedModel::evaluateSkinning() {
 			EvaluatedMesh& evalMesh = meshes[mesh];
 			evalMesh.pReferenceMesh = mesh;
 
-			evalMesh.vertexDeclIndex = context->getDevice()->getVertexDeclIndex(mesh->vertexDecl.data(), int(mesh->vertexDecl.size()));
 			bool vertexDeclHasVertexColor = false;
 			bool vertexDeclHasUv = false;
 			bool vertexDeclHasNormals = false;
@@ -285,65 +327,73 @@ bool EvaluatedModel::evaluateSkinning() {
 
 			evalMesh.indexBuffer = meshData->indexBuffer;
 
-			if (mesh->bones.empty()) {
-				evalMesh.vertexBuffer = meshData->vertexBuffer;
-			} else // If the mesh has software skinning perform CPU skinning.
-			{
-				const int posByteOffset = mesh->vbPositionOffsetBytes;
-				const int normalByteOffset = mesh->vbNormalOffsetBytes;
-
-				// Duplicate the raw vertex buffer data and zero the vertex position.
-				std::vector<char> vbdata(meshData->vertexBufferRaw.size());
+			const bool isSkinnedOnGpu = mesh->skinningVertexBuffer.IsResourceValid();
+
+			if (evalMesh.vertexDeclIndex == VertexDeclIndex_Null) {
+				if (isSkinnedOnGpu) {
+					// The bone indices and weights come from a separate vertex buffer.
+					std::vector<VertexDecl> skinnedVertexDecl = mesh->vertexDecl;
+					skinnedVertexDecl.push_back(VertexDecl(2, "a_bonesIds", UniformType::Float4, 0));
+					skinnedVertexDecl.push_back(VertexDecl(2, "a_bonesWeights", UniformType::Float4, 16));
+					static_assert(sizeof(SkinningVertex) == 32, "The vertex declaration above must match SkinningVertex");
+
+					evalMesh.vertexDeclIndex =
+					    context->getDevice()->getVertexDeclIndex(skinnedVertexDecl.data(), int(skinnedVertexDecl.size()));
+				} else {
+					evalMesh.vertexDeclIndex =
+					    context->getDevice()->getVertexDeclIndex(mesh->vertexDecl.data(), int(mesh->vertexDecl.size()));
+				}
+			}
 
-				sgeAssert((vbdata.size() % mesh->stride) == 0);
-				const int numVerts = int(vbdata.size() / mesh->stride);
-				for (size_t t = 0; t < numVerts; ++t) {
-					const char* const srcVertex = meshData->vertexBufferRaw.data() + mesh->stride * t;
-					char* const destVertex = vbdata.data() + mesh->stride * t;
+			// Compute the bone transforms, the GPU skinning always needs all kMaxGpuSkinningBones of them.
+			const size_t numSkinningBones = isSkinnedOnGpu ? size_t(Model::kMaxGpuSkinningBones) : mesh->bones.size();
+			evalMesh.skinningBones.resize(numSkinningBones, mat4f::getIdentity());
+			for (int iBone = 0; iBone < int(mesh->bones.size()); ++iBone) {
+				const Model::Bone& bone = mesh->bones[iBone];
+				if (bone.nodeIndex < 0) {
+					sgeAssert(false && "The bone node isn't resolved, see Model::computeNodeHierarchy()");
+					continue;
+				}
 
-					memcpy(destVertex, srcVertex, mesh->stride);
+				evalMesh.skinningBones[iBone] = m_nodes[bone.nodeIndex].evalGlobalTransform * bone.offsetMatrix;
+			}
 
-					vec3f& pos_w = *(vec3f*)(destVertex + posByteOffset);
-					pos_w = vec3f(0);
+			const std::vector<char>& bindPoseVertices = meshData->vertexBufferRaw;
+			const bool canSkinOnCpu = mesh->skinningVertices.empty() == false &&
+			                          bindPoseVertices.size() >= mesh->vbByteOffset + mesh->skinningVertices.size() * mesh->stride;
 
-					if (normalByteOffset >= 0) {
-						vec3f& normal_w = *(vec3f*)(destVertex + normalByteOffset);
-						normal_w = vec3f(0);
-					}
+			if (mesh->bones.empty() || isSkinnedOnGpu) {
+				evalMesh.vertexBuffer = meshData->vertexBuffer;
+			} else if (canSkinOnCpu == false) {
+				// The CPU skinning needs the mesh data on the CPU, see Model::LoadSettings::cpuMeshData.
+				sgeAssert(false && "The mesh cannot be skinned!");
+				evalMesh.vertexBuffer = meshData->vertexBuffer;
+			} else {
+				// The mesh cannot be skinned on the GPU, perform CPU skinning.
+				// The skinned vertices are initialized once with the bind pose, after that only the positions and the normals change.
+				if (evalMesh.cpuSkinnedVertices.size() != bindPoseVertices.size()) {
+					evalMesh.cpuSkinnedVertices = bindPoseVertices;
 				}
 
-				for (const auto& bone : mesh->bones) {
-					const mat4f m = m_nodes.find_element(bone.node)->evalGlobalTransform * bone.offsetMatrix;
-
-					for (size_t t = 0; t < bone.vertexIds.size(); ++t) {
-						// CAUTION:
-						// With ASSIMP converted models this line was :
-						//
-						// bool const hasIndices = (mesh->ibFmt != UniformType::Unknown);
-						// const int vid = hasIndices ? ibd[bone.vertexIds[t]] : bone.vertexIds[t];
-						//
-						// However after implementing the index buffer generation in FBX SDK converter
-						// the index buffer here really did not make any sense.
-						const int vid = bone.vertexIds[t];
-
-						// Accumulate the transformed vertex.
-						const size_t posOffset = mesh->stride * vid + posByteOffset;
-						const vec3f pos_r = *(vec3f*)(mesh->pMeshData->vertexBufferRaw.data() + posOffset);
-						vec3f& pos_w = *(vec3f*)(vbdata.data() + mesh->vbByteOffset + posOffset);
-						pos_w += mat_mul_pos(m, pos_r) * bone.weights[t];
-
-						if (normalByteOffset >= 0) {
-							const size_t normalOffset = mesh->stride * vid + normalByteOffset;
-							const vec3f norm_r = *(vec3f*)(mesh->pMeshData->vertexBufferRaw.data() + normalOffset);
-							vec3f& normal_w = *(vec3f*)(vbdata.data() + mesh->vbByteOffset + normalOffset);
-							normal_w += mat_mul_dir(m, norm_r) * bone.weights[t];
-						}
-
-						// TODO: TBN in the future.
-					}
+				SkinningVerticesDesc skinningDesc;
+				skinningDesc.srcVertices = bindPoseVertices.data() + mesh->vbByteOffset;
+				skinningDesc.destVertices = evalMesh.cpuSkinnedVertices.data() + mesh->vbByteOffset;
+				skinningDesc.stride = mesh->stride;
+				skinningDesc.posByteOffset = mesh->vbPositionOffsetBytes;
+				skinningDesc.normalByteOffset = mesh->vbNormalOffsetBytes;
+				skinningDesc.skinningVertices = mesh->skinningVertices.data();
+				skinningDesc.bones = evalMesh.skinningBones.data();
+
+				const int numVertices = int(mesh->skinningVertices.size());
+				if (m_jobSystem != nullptr && numVertices >= kMinVerticesForSkinningJobs) {
+					m_jobSystem->parallelFor(numVertices, kSkinningJobNumVertices,
+					                         [&skinningDesc](int begin, int end) -> void { skinVertices(skinningDesc, begin, end); });
+				} else {
+					skinVertices(skinningDesc, 0, numVertices);
 				}
 
 				// Update the vertex buffers.
+				const std::vector<char>& vbdata = evalMesh.cpuSkinnedVertices;
 				if (evalMesh.vertexBuffer.IsResourceValid() == false) {
 					evalMesh.vertexBuffer = context->getDevice()->requestResource<Buffer>();
 				}
@@ -366,27 +416,31 @@ bool EvaluatedModel::evaluateSkinning() {
 			             evalMesh.pReferenceMesh->ibFmt, evalMesh.pReferenceMesh->numElements);
 		}
 
-	// Attach the meshes to the evaluated nodes.
-	std::function<void(Model::Node*)> meshTraverse = [&](Model::Node* node) -> void {
-		EvaluatedNode* evalNode = m_nodes.find_element(node);
-
-		if (evalNode->attachedMeshes.size() != node->meshAttachments.size()) {
-			evalNode->attachedMeshes.clear();
-			for (const Model::MeshAttachment& attachmentMesh : node->meshAttachments) {
-				EvaluatedMeshAttachment evalMeshAttachment;
-				evalMeshAttachment.pMesh = meshes.find_element(attachmentMesh.mesh);
-				evalMeshAttachment.pMaterial = (attachmentMesh.material) ? m_materials.find_element(attachmentMesh.material) : nullptr;
-
-				evalNode->attachedMeshes.push_back(evalMeshAttachment);
-			}
+	// Point the geometries to their bone transforms.
+	// This is done after all meshes are added, as adding them may relocate the transforms.
+	for (int iMesh = 0; iMesh < meshes.size(); ++iMesh) {
+		EvaluatedMesh& evalMesh = meshes.valueAtIdx(iMesh);
+		if (evalMesh.pReferenceMesh->skinningVertexBuffer.IsResourceValid()) {
+			evalMesh.geom.skinningVertexBuffer = evalMesh.pReferenceMesh->skinningVertexBuffer.GetPtr();
+			evalMesh.geom.skinningBones = evalMesh.skinningBones.data();
 		}
+	}
 
-		for (auto& childNode : node->childNodes) {
-			meshTraverse(childNode);
+	// Attach the meshes to the evaluated nodes.
+	// The attachments are updated on every evaluation as the evaluated materials may get relocated.
+	for (int iNode = 0; iNode < int(m_model->m_nodes.size()); ++iNode) {
+		const Model::Node* const node = m_model->m_nodes[iNode];
+		EvaluatedNode& evalNode = m_nodes[iNode];
+
+		evalNode.attachedMeshes.resize(node->meshAttachments.size());
+		for (int iAttachment = 0; iAttachment < int(node->meshAttachments.size()); ++iAttachment) {
+			const Model::MeshAttachment& attachmentMesh = node->meshAttachments[iAttachment];
+			EvaluatedMeshAttachment& evalMeshAttachment = evalNode.attachedMeshes[iAttachment];
+
+			evalMeshAttachment.pMesh = meshes.find_element(attachmentMesh.mesh);
+			evalMeshAttachment.pMaterial = (attachmentMesh.material) ? m_materials.find_element(attachmentMesh.material) : nullptr;
 		}
-	};
-
-	meshTraverse(m_model->m_rootNode);
+	}
 
 	return true;
 }
@@ -395,8 +449,9 @@ float EvaluatedModel::Raycast(const Ray& ray, Model::Node** ppNode, const char*
 	float mint = FLT_MAX;
 	Model::Node* minNode = NULL;
 
-	for (Model::Node* const node : m_model->m_nodes) {
-		mat4f const invTransf = inverse(m_nodes.find_element(node)->evalGlobalTransform);
+	for (int iNode = 0; iNode < int(m_model->m_nodes.size()); ++iNode) {
+		Model::Node* const node = m_model->m_nodes[iNode];
+		mat4f const invTransf = inverse(m_nodes[iNode].evalGlobalTransform);
 
 		Ray invRay;
 		invRay.pos = mat_mul_pos(invTransf, ray.pos);
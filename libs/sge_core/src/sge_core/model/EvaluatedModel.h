@@ -10,12 +10,15 @@
 #include "sge_utils/utils/vector_map.h"
 
 #include "Model.h"
+#include "ModelPose.h"
+#include "NodeRemap.h"
 #include "sge_core/Geometry.h"
 
 namespace sge {
 
 struct AssetLibrary;
 struct Asset;
+struct JobSystem;
 
 struct EvaluatedMesh;
 
@@ -50,6 +53,13 @@ struct EvaluatedMesh {
 	VertexDeclIndex vertexDeclIndex = VertexDeclIndex_Null;
 	Model::Mesh* pReferenceMesh = nullptr;
 	Geometry geom;
+
+	/// The bone transforms used for skinning the mesh, empty if the mesh has no bones.
+	/// When skinning in the vertex shader there are always Model::kMaxGpuSkinningBones elements.
+	std::vector<mat4f> skinningBones;
+
+	/// The vertices skinned on the CPU, kept between the evaluations to avoid reallocating them.
+	std::vector<char> cpuSkinnedVertices;
 };
 
 struct EvalMomentSets {
@@ -87,13 +97,24 @@ struct SGE_CORE_API EvaluatedModel {
 	bool evaluate(const std::vector<EvalMomentSets>& evalSets);
 	bool evaluate(vector_map<const Model::Node*, mat4f>& boneGlobalTrasnformOverrides);
 
+	/// Samples the specified animation into @result, which can then be blended and layered with other poses.
+	/// The animation may come from another model, the nodes are matched to the nodes of this model.
+	/// If @animationModel has no such animation, the static moment is used.
+	void samplePose(ModelPose& result, const Model::Model* animationModel, const std::string& animationName, float time);
+
+	/// Samples and blends the specified moments into @result, using the weights of the moments.
+	void samplePose(ModelPose& result, const std::vector<EvalMomentSets>& evalSets);
+
+	/// Evaluates the model using the local transforms of the nodes in the pose.
+	bool evaluateFromPose(const ModelPose& pose);
+
 	// Returns true if an evaluation was performed.
 	float Raycast(const Ray& ray, Model::Node** ppNode = NULL, const char* const positionSemantic = "a_position") const;
 
 	const EvaluatedNode* findNode(const char* name) const {
-		for (auto pair : m_nodes) {
-			if (pair.value().name == name) {
-				return &pair.value();
+		for (const EvaluatedNode& node : m_nodes) {
+			if (node.name == name) {
+				return &node;
 			}
 		}
 
@@ -102,9 +123,11 @@ struct SGE_CORE_API EvaluatedModel {
 
   private:
 	bool evaluateNodes_common();
-	bool evaluateNodesFromMoments(const std::vector<EvalMomentSets>& evalSets);
+	bool evaluateNodesFromPose(const ModelPose& pose);
 	bool evaluateNodesFromExternalBones(vector_map<const Model::Node*, mat4f>& boneGlobalTrasnformOverrides);
-	void buildNodeRemappingLUT(const Model::Model* otherModel);
+	void resetIfModelChanged();
+	const Model::NodeRemap& getNodeRemap(const Model::Model& animationModel);
+	int* getAnimationKeyCursors(const Model::CompiledAnimation& animation);
 	bool evaluateMaterials();
 	bool evaluateSkinning();
 
@@ -115,12 +138,28 @@ struct SGE_CORE_API EvaluatedModel {
 	Model::Model* m_model = nullptr;
 	AssetLibrary* m_assetLibrary = nullptr;
 
+	/// If specified, the CPU skinning of big meshes is split into jobs executed by it. Not reset by initialize().
+	JobSystem* m_jobSystem = nullptr;
+
 	// The evaluated state.
-	vector_map<const Model::Node*, EvaluatedNode> m_nodes;
+	std::vector<EvaluatedNode> m_nodes; // Indexed as Model::m_nodes.
 	vector_map<const Model::Mesh*, EvaluatedMesh> meshes;
 	vector_map<const Model::Material*, EvaluatedMaterial> m_materials;
 
-	vector_map<const Model::Model*, vector_map<const Model::Node*, const Model::Node*>> m_nodeRemapping;
+	/// The revision of m_model the evaluated state was made for, see Model::m_revision.
+	uint32 m_modelRevision = 0;
+
+	/// For every model providing animations, the table mapping the nodes of m_model to the nodes of that model.
+	/// The tables are shared with the other evaluated models using the same pair of models, see findNodeRemap().
+	vector_map<const Model::Model*, std::shared_ptr<const Model::NodeRemap>> m_nodeRemapping;
+
+	/// The cursors of the key search in every compiled animation evaluated by this model, one for every track.
+	/// Keeping them between the evaluations makes sampling animations played forward amortized O(1), see findKeyIndex().
+	vector_map<const Model::CompiledAnimation*, std::vector<int>> m_animationKeyCursors;
+
+	// Poses used when evaluating moments, kept to avoid reallocating them.
+	ModelPose m_momentPose; // Used only by samplePose().
+	ModelPose m_blendedPose;
 
 	AABox3f aabox;
 };
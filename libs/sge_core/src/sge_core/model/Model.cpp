@@ -1,6 +1,9 @@
+#include <atomic>
 #include <functional>
 
 #include "Model.h"
+#include "NodeRemap.h"
+#include "sge_utils/utils/vector_map.h"
 
 namespace sge {
 
@@ -22,6 +25,11 @@ namespace Model {
 	//	}
 	//}
 
+	Model::~Model() {
+		// The cached tables are keyed by the address of the model, which might get reused by another model.
+		invalidateNodeRemaps(*this);
+	}
+
 	Material* Model::FindMaterial(const int id) {
 		for (Material* mtl : m_materials) {
 			if (mtl->id == id) {
@@ -83,6 +91,140 @@ namespace Model {
 		return nullptr;
 	}
 
+	int Model::findNodeIndex(const Node* const node) const {
+		for (int iNode = 0; iNode < int(m_nodes.size()); ++iNode) {
+			if (m_nodes[iNode] == node) {
+				return iNode;
+			}
+		}
+
+		return -1;
+	}
+
+	void Model::computeNodeHierarchy() {
+		static std::atomic<uint32> nextRevision(1);
+		m_revision = nextRevision++;
+
+		m_nodeOrder.clear();
+		m_nodeParentIndices.assign(m_nodes.size(), -1);
+
+		vector_map<const Node*, int> nodeIndices;
+		for (int iNode = 0; iNode < int(m_nodes.size()); ++iNode) {
+			nodeIndices[m_nodes[iNode]] = iNode;
+		}
+
+		// Traverse the hierarchy breadth first, so the parents get added before their children.
+		if (const int* const pRootIndex = nodeIndices.find_element(m_rootNode)) {
+			m_nodeOrder.reserve(m_nodes.size());
+			m_nodeOrder.push_back(*pRootIndex);
+
+			for (size_t iOrder = 0; iOrder < m_nodeOrder.size(); ++iOrder) {
+				const int iNode = m_nodeOrder[iOrder];
+				for (const Node* const childNode : m_nodes[iNode]->childNodes) {
+					const int* const pChildIndex = nodeIndices.find_element(childNode);
+					if (pChildIndex == nullptr) {
+						sgeAssert(false && "The child node isn't part of the model!");
+						continue;
+					}
+
+					m_nodeParentIndices[*pChildIndex] = iNode;
+					m_nodeOrder.push_back(*pChildIndex);
+				}
+			}
+		}
+
+		for (MeshData* const meshData : m_meshesData) {
+			for (Mesh* const mesh : meshData->meshes) {
+				for (Bone& bone : mesh->bones) {
+					const int* const pNodeIndex = nodeIndices.find_element(bone.node);
+					bone.nodeIndex = pNodeIndex ? *pNodeIndex : -1;
+				}
+			}
+		}
+	}
+
+	namespace {
+		/// Appends the keys of the curve @curveName of the parameter to the key arrays and returns their range.
+		/// If the parameter isn't animated by that curve a single key with its static value is appended.
+		template <typename T>
+		CompiledAnimation::KeyRange compileTrack(std::vector<float>& keyTimes,
+		                                         std::vector<T>& keyValues,
+		                                         const Parameter* const param,
+		                                         const ParameterType::Enum expectedType,
+		                                         const T& defaultValue,
+		                                         const char* const curveName,
+		                                         const float startTime) {
+			CompiledAnimation::KeyRange range;
+			range.firstKey = int(keyTimes.size());
+
+			if (param == nullptr || param->GetType() != expectedType) {
+				sgeAssert(param == nullptr && "The parameter has unexpected type!");
+				keyTimes.push_back(0.f);
+				keyValues.push_back(defaultValue);
+			} else if (const ParameterCurve* const curve = param->GetCurve(curveName); curve && curve->keys.empty() == false) {
+				const T* const curveValues = (const T*)curve->data.data();
+				for (size_t iKey = 0; iKey < curve->keys.size(); ++iKey) {
+					keyTimes.push_back(curve->keys[iKey] - startTime);
+					keyValues.push_back(curveValues[iKey]);
+				}
+			} else {
+				keyTimes.push_back(0.f);
+				keyValues.push_back(*(const T*)param->GetStaticValue());
+			}
+
+			range.numKeys = int(keyTimes.size()) - range.firstKey;
+			return range;
+		}
+
+		void compileAnimation(CompiledAnimation& result,
+		                      const std::vector<Node*>& nodes,
+		                      const char* const curveName,
+		                      const float startTime) {
+			result.keyRanges.resize(nodes.size() * AnimationChannel_Count);
+
+			for (int iNode = 0; iNode < int(nodes.size()); ++iNode) {
+				const ParameterBlock& paramBlock = nodes[iNode]->paramBlock;
+				CompiledAnimation::KeyRange* const tracks = &result.keyRanges[iNode * AnimationChannel_Count];
+
+				tracks[AnimationChannel_Translation] =
+				    compileTrack(result.translationKeyTimes, result.translationKeyValues, paramBlock.FindParameter("translation"),
+				                 ParameterType::Float3, vec3f(0.f), curveName, startTime);
+				tracks[AnimationChannel_Rotation] =
+				    compileTrack(result.rotationKeyTimes, result.rotationKeyValues, paramBlock.FindParameter("rotation"),
+				                 ParameterType::Quaternion, quatf::getIdentity(), curveName, startTime);
+				tracks[AnimationChannel_Scaling] = compileTrack(result.scalingKeyTimes, result.scalingKeyValues,
+				                                                paramBlock.FindParameter("scaling"), ParameterType::Float3, vec3f(1.f),
+				                                                curveName, startTime);
+			}
+		}
+	} // namespace
+
+	void Model::compileAnimations() {
+		m_compiledStaticMoment = CompiledAnimation();
+		compileAnimation(m_compiledStaticMoment, m_nodes, nullptr, 0.f);
+
+		m_compiledAnimations.clear();
+		m_compiledAnimations.resize(m_animations.size());
+		for (size_t iAnim = 0; iAnim < m_animations.size(); ++iAnim) {
+			const AnimationInfo& animInfo = m_animations[iAnim];
+			CompiledAnimation& compiledAnim = m_compiledAnimations[iAnim];
+
+			compiledAnim.name = animInfo.curveName;
+			compiledAnim.duration = animInfo.duration;
+			compileAnimation(compiledAnim, m_nodes, animInfo.curveName.c_str(), animInfo.startTime);
+		}
+	}
+
+	const CompiledAnimation& Model::findCompiledAnimation(const std::string& name) const {
+		for (const CompiledAnimation& anim : m_compiledAnimations) {
+			if (anim.name == name) {
+				return anim;
+			}
+		}
+
+		return m_compiledStaticMoment;
+	}
+
 	float Mesh::Raycast(const Ray& ray, const char* positionSemantic) const {
 		if (pMeshData == nullptr || pMeshData->vertexBufferRaw.size() == 0 || primTopo != PrimitiveTopology::TriangleList ||
 		    positionSemantic == nullptr) {
@@ -129,6 +271,54 @@ namespace Model {
 		return RaycastVertexBufferOnly(ray, posByteOffset);
 	}
 
+	bool Mesh::computeSkinningVertices(std::vector<SkinningVertex>& result) const {
+		result.clear();
+
+		if (bones.empty()) {
+			return false;
+		}
+
+		result.resize(numVertices);
+
+		for (int iBone = 0; iBone < int(bones.size()); ++iBone) {
+			const Bone& bone = bones[iBone];
+			for (size_t t = 0; t < bone.vertexIds.size(); ++t) {
+				const int vid = bone.vertexIds[t];
+				const float weight = bone.weights[t];
+
+				if (vid < 0 || vid >= numVertices) {
+					sgeAssert(false && "Bone vertex id is out of range!");
+					result.clear();
+					return false;
+				}
+
+				// Replace the bone with the smallest weight, if the new one is more significant.
+				SkinningVertex& vertex = result[vid];
+				int iSmallest = 0;
+				for (int iSlot = 1; iSlot < 4; ++iSlot) {
+					if (vertex.bonesWeights[iSlot] < vertex.bonesWeights[iSmallest]) {
+						iSmallest = iSlot;
+					}
+				}
+
+				if (weight > vertex.bonesWeights[iSmallest]) {
+					vertex.bonesIds[iSmallest] = float(iBone);
+					vertex.bonesWeights[iSmallest] = weight;
+				}
+			}
+		}
+
+		// Renormalize the weights as some of the bones might have been dropped.
+		for (SkinningVertex& vertex : result) {
+			const float weightsSum = vertex.bonesWeights.x + vertex.bonesWeights.y + vertex.bonesWeights.z + vertex.bonesWeights.w;
+			if (weightsSum > 0.f) {
+				vertex.bonesWeights /= weightsSum;
+			}
+		}
+
+		return true;
+	}
+
 	template <typename T>
 	float Mesh::RaycastIndexBuffer(const Ray& ray, const int posByteOffset, std::vector<float>* pAllIntersections) const {
 		const char* const vb = (char*)pMeshData->vertexBufferRaw.data();
@@ -4,6 +4,7 @@
 #include "sge_core/sgecore_api.h"
 #include "sge_renderer/renderer/renderer.h"
 #include "sge_utils/math/Box.h"
+#include "sge_utils/math/Skinning.h"
 #include "sge_utils/math/mat4.h"
 #include "sge_utils/math/primitives.h"
 #include "sge_utils/math/transform.h"
@@ -12,6 +13,7 @@
 #include <string>
 
 #include "CollisionMesh.h"
+#include "CompiledAnimation.h"
 
 namespace sge {
 
@@ -96,8 +98,14 @@ namespace Model {
 		std::vector<int> vertexIds;
 		std::vector<float> weights;
 		struct Node* node = nullptr;
+		int nodeIndex = -1; // The index of @node in Model::m_nodes, see Model::computeNodeHierarchy().
 	};
 
+	/// The maximum number of bones of a mesh skinned in the vertex shader, the meshes with more bones are skinned on the CPU.
+	/// Must match kMaxSkinningBones in core_shaders/ShadeCommon.h.
+	static constexpr int kMaxGpuSkinningBones = 64;
+
+
 	struct SGE_CORE_API Mesh {
 		int id = -1; // The "id" used to identify this piece of data in the file.
 		std::string name;
@@ -115,6 +123,12 @@ namespace Model {
 
 		std::vector<Bone> bones;
 
+		/// A vertex buffer with a SkinningVertex for every vertex, used for skinning the mesh in the vertex shader.
+		/// Created at load time only for meshes that could be skinned on the GPU.
+		GpuHandle<Buffer> skinningVertexBuffer;
+		/// The bones affecting every vertex, used for skinning the meshes that cannot be skinned on the GPU.
+		std::vector<SkinningVertex> skinningVertices;
+
 		AABox3f aabox;
 
 		// Few precached values for every mesh.
@@ -124,6 +138,10 @@ namespace Model {
 		int vbUVOffsetBytes = -1;
 		float Raycast(const Ray& ray, const char* positionSemantic = "a_position") const;
 
+		/// Computes the SkinningVertex of every vertex from the bones, keeping the 4 bones with the biggest weights for every vertex.
+		/// Returns false if the mesh has no bones.
+		bool computeSkinningVertices(std::vector<SkinningVertex>& result) const;
+
 	  private:
 		// The function expects validated data.
 		// T  could be ushort or uint32
@@ -180,6 +198,9 @@ namespace Model {
 	// IO - means that the member is used by both.
 	//--------------------------------------------------------------
 	struct SGE_CORE_API Model {
+		Model() = default;
+		~Model();
+
 		// Searches for an object. If the object is missing these functions will return nullptr.
 		Material* FindMaterial(const int id);
 		Node* FindNode(const int id);
@@ -188,6 +209,27 @@ namespace Model {
 		Mesh* FindMesh(const int id);
 		const AnimationInfo* findAnimation(const std::string& name) const;
 
+		/// Returns the index of the node in m_nodes, or -1 if the node isn't part of the model.
+		int findNodeIndex(const Node* node) const;
+
+		/// Computes m_nodeOrder, m_nodeParentIndices and Bone::nodeIndex of all bones from the node hierarchy.
+		/// Needs to be called again if the nodes get changed. ModelReader calls it after loading.
+		/// Assigns a new m_revision to the model.
+		void computeNodeHierarchy();
+
+		/// Returns true if computeNodeHierarchy() was called for the current nodes.
+		bool hasNodeHierarchy() const { return m_nodeParentIndices.size() == m_nodes.size(); }
+
+		/// Compiles the static moment and the animations of the nodes for evaluation without string lookups, see CompiledAnimation.
+		/// Needs to be called again if the nodes or the animations get changed. ModelReader calls it after loading.
+		void compileAnimations();
+
+		/// Returns true if compileAnimations() was called for the current nodes.
+		bool hasCompiledAnimations() const { return m_compiledStaticMoment.getNumNodes() == int(m_nodes.size()); }
+
+		/// Returns the compiled animation with the specified name, if there is no such animation the compiled static moment is returned.
+		const CompiledAnimation& findCompiledAnimation(const std::string& name) const;
+
 	  public:
 		// The actual storage for most of the models data.
 		ChunkContainer<Mesh> m_containerMesh;
@@ -210,6 +252,18 @@ namespace Model {
 		std::vector<CollisionShapeCylinder> m_collisionCylinders; // IO
 		std::vector<CollisionShapeSphere> m_collisionSpheres;     // IO
 
+		// The node hierarchy as indices in m_nodes, computed by computeNodeHierarchy().
+		std::vector<int> m_nodeOrder;         // I The nodes reachable from the root node, every node comes after its parent.
+		std::vector<int> m_nodeParentIndices; // I The index of the parent of every node, -1 for the nodes without a parent.
+
+		// A number unique for every computeNodeHierarchy() call, used to detect the data cached for the previous nodes of the model
+		// (for example by NodeRemap) when the model gets reloaded at the same address.
+		uint32 m_revision = 0; // I
+
+		// The animations compiled by compileAnimations(), in the same order as m_animations.
+		std::vector<CompiledAnimation> m_compiledAnimations; // I
+		CompiledAnimation m_compiledStaticMoment;            // I
+
 		// Cached loading settings.
 		LoadSettings m_loadSets; // I
 	};
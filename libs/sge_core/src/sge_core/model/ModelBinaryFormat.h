@@ -0,0 +1,175 @@
+#pragma once
+
+#include "sge_utils/sge_utils.h"
+
+namespace sge {
+
+namespace Model {
+
+	/// The binary header of the *.mdl files, written by ModelWriter by default. Unlike the legacy JSON header it doesn't
+	/// need parsing, the tables are read directly from the file.
+	///
+	/// The layout of the file is:
+	/// [MdlBinaryHeader][tables][data chunks]
+	/// Every table is an array of fixed-size records, described by MdlTableDesc in MdlBinaryHeader::tables.
+	/// The records reference each other by index ranges (for example MdlNode::firstParameter, numParameters),
+	/// the data chunks by chunk id (the same as in the JSON header) and the strings by a byte offset in the string table.
+	/// The strings are null terminated. The enums are stored as strings (the same as in the JSON header) so the engine enums
+	/// could change without breaking the existing files.
+	///
+	/// Any change to the layout must increment kMdlBinaryVersion. The data is little-endian.
+	static constexpr char kMdlBinaryMagic[8] = {'S', 'G', 'E', 'M', 'D', 'L', 'B', '\0'};
+	static constexpr uint32 kMdlBinaryVersion = 1;
+
+	/// The string offset used for missing strings (for example a mesh without an index buffer has no index format).
+	static constexpr uint32 kMdlNoString = 0xFFFFFFFFu;
+
+	/// The alignment of the tables and the data chunks in the file.
+	static constexpr uint32 kMdlBinaryAlignment = 16;
+
+	enum MdlTable : uint32 {
+		MdlTable_Strings,            // char
+		MdlTable_DataChunks,         // MdlDataChunk
+		MdlTable_Animations,         // MdlAnimation
+		MdlTable_Materials,          // MdlMaterial
+		MdlTable_Parameters,         // MdlParameter
+		MdlTable_Curves,             // MdlCurve
+		MdlTable_MeshesData,         // MdlMeshData
+		MdlTable_Meshes,             // MdlMesh
+		MdlTable_VertexDecls,        // MdlVertexDecl
+		MdlTable_Bones,              // MdlBone
+		MdlTable_Nodes,              // MdlNode
+		MdlTable_MeshAttachments,    // MdlMeshAttachment
+		MdlTable_ChildNodes,         // sint32, the ids of the child nodes.
+		MdlTable_ConvexHulls,        // MdlCollisionMesh
+		MdlTable_ConcaveHulls,       // MdlCollisionMesh
+		MdlTable_CollisionBoxes,     // MdlCollisionShape
+		MdlTable_CollisionCapsules,  // MdlCollisionShape
+		MdlTable_CollisionCylinders, // MdlCollisionShape
+		MdlTable_CollisionSpheres,   // MdlCollisionShape
+
+		MdlTable_Count,
+	};
+
+	struct MdlTableDesc {
+		uint32 byteOffset;      // The offset from the beginning of MdlBinaryHeader.
+		uint32 numRecords;      // The number of records in the table.
+		uint32 recordSizeBytes; // The size of a single record, used for validation.
+	};
+
+	struct MdlBinaryHeader {
+		char magic[8];          // kMdlBinaryMagic.
+		uint32 version;         // kMdlBinaryVersion.
+		uint32 headerSizeBytes; // The size of the header and the tables, the data chunks start right after them.
+		sint32 rootNodeId;
+		uint32 numTables; // MdlTable_Count.
+		MdlTableDesc tables[MdlTable_Count];
+	};
+
+	struct MdlDataChunk {
+		sint32 id;
+		uint32 byteOffset; // The offset from the beginning of the data chunks.
+		uint32 sizeBytes;
+	};
+
+	struct MdlAnimation {
+		uint32 curveName;
+		float startTime;
+		float duration;
+	};
+
+	struct MdlMaterial {
+		sint32 id;
+		uint32 name;
+		uint32 firstParameter;
+		uint32 numParameters;
+	};
+
+	struct MdlParameter {
+		uint32 name;
+		uint32 type;          // The name of the ParameterType.
+		float staticValue[4]; // The static value of the numeric parameters.
+		uint32 staticString;  // The static value of the string parameters.
+		uint32 firstCurve;
+		uint32 numCurves;
+	};
+
+	struct MdlCurve {
+		uint32 name;
+		sint32 keyframesChunkId;
+		sint32 valuesChunkId;
+	};
+
+	struct MdlMeshData {
+		sint32 vertexDataChunkId;
+		sint32 indexDataChunkId; // -1 if there is no index buffer.
+		uint32 firstMesh;
+		uint32 numMeshes;
+	};
+
+	struct MdlMesh {
+		sint32 id;
+		uint32 name;
+		uint32 primitiveTopology;
+		sint32 vbByteOffset;
+		sint32 ibByteOffset;
+		uint32 ibFormat; // kMdlNoString if the mesh doesn't use an index buffer.
+		sint32 numElements;
+		sint32 numVertices;
+		sint32 materialId; // -1 if the mesh has no material.
+		uint32 firstVertexDecl;
+		uint32 numVertexDecls;
+		uint32 firstBone;
+		uint32 numBones;
+		float aaboxMin[3];
+		float aaboxMax[3];
+	};
+
+	struct MdlVertexDecl {
+		uint32 semantic;
+		uint32 byteOffset;
+		uint32 format;
+	};
+
+	struct MdlBone {
+		sint32 nodeId;
+		sint32 vertexIdsChunkId;
+		sint32 weightsChunkId;
+		float offsetMatrix[16];
+	};
+
+	struct MdlNode {
+		sint32 id;
+		uint32 name;
+		uint32 firstParameter;
+		uint32 numParameters;
+		uint32 firstMeshAttachment;
+		uint32 numMeshAttachments;
+		uint32 firstChildNode;
+		uint32 numChildNodes;
+	};
+
+	struct MdlMeshAttachment {
+		sint32 meshId;
+		sint32 materialId; // -1 if the attachment has no material.
+	};
+
+	struct MdlCollisionMesh {
+		sint32 vertsChunkId;
+		sint32 indicesChunkId;
+	};
+
+	/// A single record type used for all collision shapes, the members not used by the shape are zero.
+	struct MdlCollisionShape {
+		uint32 name;
+		float position[3];
+		float rotation[4];
+		float scaling[3];
+		float halfDiagonal[3]; // Boxes and cylinders.
+		float halfHeight;      // Capsules.
+		float radius;          // Capsules and spheres.
+	};
+
+} // namespace Model
+
+} // namespace sge
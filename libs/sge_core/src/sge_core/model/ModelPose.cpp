@@ -0,0 +1,85 @@
+#include "ModelPose.h"
+#include "Model.h"
+
+namespace sge {
+
+void ModelPose::resize(const int numNodes) {
+	translations.resize(numNodes, vec3f(0.f));
+	rotations.resize(numNodes, quatf::getIdentity());
+	scalings.resize(numNodes, vec3f(1.f));
+}
+
+void ModelPose::setNodeTransform(const int iNode, const transf3d& transform) {
+	translations[iNode] = transform.p;
+	rotations[iNode] = transform.r;
+	scalings[iNode] = transform.s;
+}
+
+void ModelPose::setBlend(const ModelPose& a, const ModelPose& b, const float t, const float* const nodeMask) {
+	sgeAssert(a.getNumNodes() == b.getNumNodes());
+
+	const int numNodes = a.getNumNodes();
+	resize(numNodes);
+
+	for (int iNode = 0; iNode < numNodes; ++iNode) {
+		const float nodeT = nodeMask ? t * nodeMask[iNode] : t;
+		translations[iNode] = lerp(a.translations[iNode], b.translations[iNode], nodeT);
+		rotations[iNode] = slerp(a.rotations[iNode], b.rotations[iNode], nodeT);
+		scalings[iNode] = lerp(a.scalings[iNode], b.scalings[iNode], nodeT);
+	}
+}
+
+void ModelPose::addAdditive(const ModelPose& additive,
+                            const ModelPose& additiveReference,
+                            const float weight,
+                            const float* const nodeMask) {
+	sgeAssert(additive.getNumNodes() == getNumNodes() && additiveReference.getNumNodes() == getNumNodes());
+
+	const int numNodes = getNumNodes();
+	for (int iNode = 0; iNode < numNodes; ++iNode) {
+		const float nodeWeight = nodeMask ? weight * nodeMask[iNode] : weight;
+		if (nodeWeight == 0.f) {
+			continue;
+		}
+
+		const vec3f deltaTranslation = additive.translations[iNode] - additiveReference.translations[iNode];
+		const quatf deltaRotation = additiveReference.rotations[iNode].inverse() * additive.rotations[iNode];
+
+		vec3f deltaScaling = vec3f(1.f);
+		for (int t = 0; t < 3; ++t) {
+			if (additiveReference.scalings[iNode][t] != 0.f) {
+				deltaScaling[t] = additive.scalings[iNode][t] / additiveReference.scalings[iNode][t];
+			}
+		}
+
+		translations[iNode] += deltaTranslation * nodeWeight;
+		rotations[iNode] = rotations[iNode] * slerp(quatf::getIdentity(), deltaRotation, nodeWeight);
+		scalings[iNode] = scalings[iNode] * lerp(vec3f(1.f), deltaScaling, nodeWeight);
+	}
+}
+
+void computeNodeMask(std::vector<float>& mask, const Model::Model& model, const Model::Node* const layerRootNode) {
+	mask.assign(model.m_nodes.size(), 0.f);
+
+	// The nodes below the layer root are found by walking the hierarchy.
+	std::vector<const Model::Node*> nodesToVisit;
+	if (layerRootNode) {
+		nodesToVisit.push_back(layerRootNode);
+	}
+
+	while (nodesToVisit.empty() == false) {
+		const Model::Node* const node = nodesToVisit.back();
+		nodesToVisit.pop_back();
+
+		const int iNode = model.findNodeIndex(node);
+		if (iNode >= 0) {
+			mask[iNode] = 1.f;
+		}
+
+		for (const Model::Node* const childNode : node->childNodes) {
+			nodesToVisit.push_back(childNode);
+		}
+	}
+}
+
+} // namespace sge
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "sge_core/sgecore_api.h"
+#include "sge_utils/math/transform.h"
+#include <vector>
+
+namespace sge {
+
+namespace Model {
+	struct Model;
+	struct Node;
+} // namespace Model
+
+/// The local transforms of all nodes of a model, stored as separate arrays for every channel and indexed as Model::m_nodes.
+/// Animations are sampled into poses, which then get blended and layered without computing the global transforms of the nodes.
+/// The final pose is applied with EvaluatedModel::evaluateFromPose().
+struct SGE_CORE_API ModelPose {
+	void resize(int numNodes);
+	int getNumNodes() const { return int(translations.size()); }
+
+	transf3d getNodeTransform(int iNode) const { return transf3d(translations[iNode], rotations[iNode], scalings[iNode]); }
+	void setNodeTransform(int iNode, const transf3d& transform);
+
+	/// Sets the pose to the blend between @a and @b. A @t of 0 results in @a, 1 results in @b.
+	/// @nodeMask is an optional weight for every node which multiplies @t. Used for layers affecting only some of the nodes.
+	/// The result may be @a or @b.
+	void setBlend(const ModelPose& a, const ModelPose& b, float t, const float* nodeMask = nullptr);
+
+	/// Adds the difference between @additive and @additiveReference on top of this pose, scaled by @weight.
+	/// @nodeMask is an optional weight for every node which multiplies @weight.
+	void addAdditive(const ModelPose& additive, const ModelPose& additiveReference, float weight, const float* nodeMask = nullptr);
+
+  public:
+	std::vector<vec3f> translations;
+	std::vector<quatf> rotations;
+	std::vector<vec3f> scalings;
+};
+
+/// Computes a mask for ModelPose operations, indexed as Model::m_nodes.
+/// The mask is 1 for @layerRootNode and all nodes below it and 0 for the rest of the nodes.
+SGE_CORE_API void computeNodeMask(std::vector<float>& mask, const Model::Model& model, const Model::Node* layerRootNode);
+
+} // namespace sge
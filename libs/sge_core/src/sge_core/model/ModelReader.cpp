@@ -4,6 +4,7 @@
 #include <stdexcept>
 
 #include "Model.h"
+#include "ModelBinaryFormat.h"
 #include "ModelReader.h"
 
 namespace sge {
@@ -15,71 +16,132 @@ namespace Model {
 		    : std::logic_error(msg) {}
 	};
 
-	template <typename T>
-	void ModelReader::LoadDataChunk(std::vector<T>& resultBuffer, const int chunkId) {
-		const DataChunkDesc* chunkDesc = nullptr;
-		for (const auto& desc : dataChunksDesc) {
-			if (desc.chunkId == chunkId) {
-				chunkDesc = &desc;
-				break;
+	namespace {
+		/// Caches the vertex stride and the offsets of the commonly used semantics from the vertex declaration of the mesh.
+		void cacheVertexLayout(Mesh& mesh) {
+			if (mesh.vertexDecl.empty()) {
+				throw ModelParseExcept("Mesh without a vertex declaration!");
 			}
+
+			for (const VertexDecl& decl : mesh.vertexDecl) {
+				if (decl.semantic == "a_position") {
+					mesh.vbPositionOffsetBytes = (int)decl.byteOffset;
+				} else if (decl.semantic == "a_normal") {
+					mesh.vbNormalOffsetBytes = (int)decl.byteOffset;
+				} else if (decl.semantic == "a_uv") {
+					mesh.vbUVOffsetBytes = (int)decl.byteOffset;
+				}
+			}
+
+			// Bake the vertex stride.
+			mesh.stride = int(mesh.vertexDecl.back().byteOffset) + UniformType::GetSizeBytes(mesh.vertexDecl.back().format);
 		}
-		if (!chunkDesc) {
-			sgeAssert(false);
-			throw ModelParseExcept("Chunk desc not found!");
+
+		/// Throws if the range [first, first + count) isn't inside the table.
+		template <typename T>
+		void checkTableRange(const std::vector<T>& table, const uint32 first, const uint32 count) {
+			if (uint64(first) + uint64(count) > table.size()) {
+				throw ModelParseExcept("Invalid table range in the binary header!");
+			}
 		}
+	} // namespace
+
+	/// The tables of the binary header, see ModelBinaryFormat.h.
+	struct ModelReader::BinaryTables {
+		const char* getString(const uint32 offset) const {
+			// The string table is validated to end with a null terminator.
+			if (offset >= strings.size()) {
+				throw ModelParseExcept("Invalid string in the binary header!");
+			}
+			return strings.data() + offset;
+		}
+
+		std::vector<char> strings;
+		std::vector<MdlDataChunk> dataChunks;
+		std::vector<MdlAnimation> animations;
+		std::vector<MdlMaterial> materials;
+		std::vector<MdlParameter> parameters;
+		std::vector<MdlCurve> curves;
+		std::vector<MdlMeshData> meshesData;
+		std::vector<MdlMesh> meshes;
+		std::vector<MdlVertexDecl> vertexDecls;
+		std::vector<MdlBone> bones;
+		std::vector<MdlNode> nodes;
+		std::vector<MdlMeshAttachment> meshAttachments;
+		std::vector<sint32> childNodes;
+		std::vector<MdlCollisionMesh> convexHulls;
+		std::vector<MdlCollisionMesh> concaveHulls;
+		std::vector<MdlCollisionShape> collisionBoxes;
+		std::vector<MdlCollisionShape> collisionCapsules;
+		std::vector<MdlCollisionShape> collisionCylinders;
+		std::vector<MdlCollisionShape> collisionSpheres;
+	};
 
-		if (chunkDesc->sizeBytes % sizeof(T)) {
+	template <typename T>
+	void ModelReader::LoadDataChunk(std::vector<T>& resultBuffer, const int chunkId) {
+		const DataChunkDesc& chunkDesc = FindDataChunkDesc(chunkId);
+
+		if (chunkDesc.sizeBytes % sizeof(T)) {
 			sgeAssert(false);
 			throw ModelParseExcept("ChunkSize / sizeof(T) != 0!");
 		}
 
-		const size_t numElems = chunkDesc->sizeBytes / sizeof(T);
+		const size_t numElems = chunkDesc.sizeBytes / sizeof(T);
 		resultBuffer.resize(numElems);
 
-		const size_t firstChunkDataLocation = irs->pointerOffset();
-		irs->seek(SeekOrigin::Current, chunkDesc->byteOffset);
-		irs->read(resultBuffer.data(), chunkDesc->sizeBytes);
-
-		// Seek back to the 1st chunk.
-		irs->seek(SeekOrigin::Begining, firstChunkDataLocation);
+		LoadDataChunkRaw(resultBuffer.data(), chunkDesc.sizeBytes, chunkId);
 	}
 
 	void ModelReader::LoadDataChunkRaw(void* const ptr, const size_t ptrExpectedSize, const int chunkId) {
-		const DataChunkDesc* chunkDesc = nullptr;
-		for (const auto& desc : dataChunksDesc) {
-			if (desc.chunkId == chunkId) {
-				chunkDesc = &desc;
-				break;
-			}
-		}
+		const DataChunkDesc& chunkDesc = FindDataChunkDesc(chunkId);
 
-		if (!chunkDesc) {
+		if (ptrExpectedSize != chunkDesc.sizeBytes) {
 			sgeAssert(false);
-			throw ModelParseExcept("Chunk desc not found!");
+			throw ModelParseExcept("Could not load data chunk, because the preallocated memory isn't enough!");
 		}
 
-		if (ptrExpectedSize != chunkDesc->sizeBytes) {
-			sgeAssert(false);
-			throw ModelParseExcept("Could not load data chunk, because the preallocated memory isn't enough!");
+		if (chunkDesc.sizeBytes == 0) {
+			return;
 		}
 
-		const size_t firstChunkDataLocation = irs->pointerOffset();
-		irs->seek(SeekOrigin::Current, chunkDesc->byteOffset);
-		irs->read(ptr, chunkDesc->sizeBytes);
+		// If the file is in memory copy the data directly, no need to go through the stream.
+		size_t chunkSizeBytes = 0;
+		if (const char* const chunkData = GetDataChunkMemory(chunkId, chunkSizeBytes)) {
+			memcpy(ptr, chunkData, chunkSizeBytes);
+			return;
+		}
 
-		// Seek back to the 1st chunk.
-		irs->seek(SeekOrigin::Begining, firstChunkDataLocation);
+		irs->seek(SeekOrigin::Begining, dataChunksOffset + chunkDesc.byteOffset);
+		if (irs->read(ptr, chunkDesc.sizeBytes) != chunkDesc.sizeBytes) {
+			throw ModelParseExcept("Could not read the data chunk!");
+		}
+	}
+
+	const char* ModelReader::GetDataChunkMemory(const int chunkId, size_t& outSizeBytes) {
+		const DataChunkDesc& chunkDesc = FindDataChunkDesc(chunkId);
+
+		const char* const memory = irs->getMemory();
+		if (memory == nullptr) {
+			outSizeBytes = 0;
+			return nullptr;
+		}
+
+		if (dataChunksOffset + chunkDesc.byteOffset + chunkDesc.sizeBytes > irs->getMemorySizeBytes()) {
+			throw ModelParseExcept("The data chunk is outside of the file!");
+		}
+
+		outSizeBytes = chunkDesc.sizeBytes;
+		return memory + dataChunksOffset + chunkDesc.byteOffset;
 	}
 
 	const ModelReader::DataChunkDesc& ModelReader::FindDataChunkDesc(const int chunkId) const {
-		for (const auto& desc : dataChunksDesc) {
-			if (desc.chunkId == chunkId) {
-				return desc;
-			}
+		const DataChunkDesc* const chunkDesc = dataChunksDesc.find_element(chunkId);
+		if (chunkDesc == nullptr) {
+			sgeAssert(false);
+			throw ModelParseExcept("Chunk desc not found!");
 		}
 
-		throw ModelParseExcept("Chunk desc not found!");
+		return *chunkDesc;
 	}
 
 	bool ModelReader::LoadParamBlock(const JsonValue* jParamBlock, ParameterBlock& paramBlock) {
@@ -190,405 +252,804 @@ namespace Model {
 		throw ModelParseExcept("Unknown uniform type!");
 	}
 
-	bool ModelReader::Load(const LoadSettings loadSets, SGEDevice* sgedev, IReadStream* const iReadStream, Model& model) {
-		try {
-			dataChunksDesc.clear();
-			irs = iReadStream;
+	void ModelReader::createRenderResources(SGEDevice* const sgedev, Model& model) {
+		sgeAssert(sgedev != nullptr);
+		for (MeshData* const meshData : model.m_meshesData) {
+			createRenderResources(sgedev, model.m_loadSets, *meshData, meshData->vertexBufferRaw.data(),
+			                      meshData->vertexBufferRaw.size(), meshData->indexBufferRaw.data(), meshData->indexBufferRaw.size());
+		}
+	}
 
-			model = Model();
-			model.m_loadSets = loadSets;
+	bool ModelReader::shouldKeepCPUBuffers(const LoadSettings& loadSets, const MeshData& meshData) {
+		bool hasBones = false;
+		for (const Mesh* const mesh : meshData.meshes) {
+			hasBones |= mesh->bones.empty() == false;
+		}
+
+		return (loadSets.cpuMeshData == LoadSettings::KeepMeshData_Skin && hasBones) ||
+		       (loadSets.cpuMeshData == LoadSettings::KeepMeshData_All);
+	}
+
+	void ModelReader::createRenderResources(SGEDevice* const sgedev,
+	                                        const LoadSettings& loadSets,
+	                                        MeshData& meshData,
+	                                        const char* const vertexData,
+	                                        const size_t vertexDataSizeBytes,
+	                                        const char* const indexData,
+	                                        const size_t indexDataSizeBytes) {
+		bool hasBones = false;
+		for (const Mesh* const mesh : meshData.meshes) {
+			hasBones |= mesh->bones.empty() == false;
+		}
+
+		const ResourceUsage::Enum usage = (hasBones) ? ResourceUsage::Dynamic : ResourceUsage::Immutable;
+
+		meshData.vertexBuffer = sgedev->requestResource<Buffer>();
+		const BufferDesc vbd = BufferDesc::GetDefaultVertexBuffer((uint32)vertexDataSizeBytes, usage);
+		meshData.vertexBuffer->create(vbd, vertexData);
+
+		// The index buffer is any.
+		if (indexDataSizeBytes != 0) {
+			meshData.indexBuffer = sgedev->requestResource<Buffer>();
+			const BufferDesc ibd = BufferDesc::GetDefaultIndexBuffer((uint32)indexDataSizeBytes, usage);
+			meshData.indexBuffer->create(ibd, indexData);
+		}
 
-			JsonParser jsonParser;
-			if (!jsonParser.parse(irs)) {
-				throw ModelParseExcept("Parsing the json header failed!");
+		// Meshes with few enough bones are skinned in the vertex shader and need the baked bone indices and weights only
+		// in a vertex buffer, the rest keep them on the CPU for the CPU skinning.
+		// GLES targets always skin on the CPU, as they may not have enough vertex shader uniforms for the bones.
+		for (Mesh* const mesh : meshData.meshes) {
+			if (mesh->skinningVertices.empty()) {
+				continue;
 			}
 
-			// This point here is pretty important.
-			// The irs pointer currently points at the beggining of the
-			// data chunks. This pointer will jump around that section
-			// in order to load the specific buffer data(like mesh data parameter data ect...)
+#if !defined(__EMSCRIPTEN__)
+			const bool canSkinOnGpu = mesh->bones.size() <= kMaxGpuSkinningBones;
+#else
+			const bool canSkinOnGpu = false;
+#endif
+			if (canSkinOnGpu) {
+				mesh->skinningVertexBuffer = sgedev->requestResource<Buffer>();
+				const BufferDesc skinningVbd = BufferDesc::GetDefaultVertexBuffer(
+				    uint32(mesh->skinningVertices.size() * sizeof(SkinningVertex)), ResourceUsage::Immutable);
+				mesh->skinningVertexBuffer->create(skinningVbd, mesh->skinningVertices.data());
+				mesh->skinningVertices = std::vector<SkinningVertex>();
+			}
+		}
 
-			// [CAUTION] From this point DO NOT use directly irs
-			// If you want to load a data chunk use LoadDataChunk
+		if (shouldKeepCPUBuffers(loadSets, meshData) == false) {
+			meshData.vertexBufferRaw = std::vector<char>();
+			meshData.indexBufferRaw = std::vector<char>();
+		}
+	}
 
-			const JsonValue* const jRoot = jsonParser.getRoot();
+	void ModelReader::LoadMeshDataBuffers(const LoadSettings& loadSets,
+	                                      SGEDevice* const sgedev,
+	                                      MeshData& meshData,
+	                                      const int vertexDataChunkId,
+	                                      const int indexDataChunkId) {
+		// Skinned meshes must be stored into separate meshData buffers
+		if (meshData.meshes.size() != 1) {
+			for (const Mesh* const mesh : meshData.meshes) {
+				if (mesh->bones.empty() == false) {
+					sgeAssert(false);
+					throw ModelParseExcept("Mesh data isn't stored into a separate mesh data!");
+				}
+			}
+		}
 
-			// Load the data chunk desc.
-			{
-				const JsonValue* const jDataChunksDesc = jRoot->getMember("dataChunksDesc");
-				dataChunksDesc.reserve(jDataChunksDesc->arrSize() / 3);
+		// Bake the bone indices and weights of the vertices.
+		for (Mesh* const mesh : meshData.meshes) {
+			mesh->computeSkinningVertices(mesh->skinningVertices);
+		}
 
-				for (size_t t = 0; t < jDataChunksDesc->arrSize(); t += 3) {
-					DataChunkDesc chunkDesc;
+		// If the file is in memory (for example memory mapped) and the CPU copies aren't needed,
+		// the GPU resources are created straight from the file, without copying the data.
+		// Without a device the GPU resources are created later with createRenderResources(), so the data is always copied.
+		const bool needsCPUBuffers = sgedev == nullptr || shouldKeepCPUBuffers(loadSets, meshData);
+
+		size_t vertexDataSizeBytes = 0;
+		const char* vertexData = needsCPUBuffers ? nullptr : GetDataChunkMemory(vertexDataChunkId, vertexDataSizeBytes);
+		if (vertexData == nullptr) {
+			LoadDataChunk(meshData.vertexBufferRaw, vertexDataChunkId);
+			vertexData = meshData.vertexBufferRaw.data();
+			vertexDataSizeBytes = meshData.vertexBufferRaw.size();
+		}
 
-					chunkDesc.chunkId = jDataChunksDesc->arrAt(t)->getNumberAs<int>();
-					chunkDesc.byteOffset = jDataChunksDesc->arrAt(t + 1)->getNumberAs<int>();
-					chunkDesc.sizeBytes = jDataChunksDesc->arrAt(t + 2)->getNumberAs<int>();
+		size_t indexDataSizeBytes = 0;
+		const char* indexData = nullptr;
+		if (indexDataChunkId >= 0) {
+			indexData = needsCPUBuffers ? nullptr : GetDataChunkMemory(indexDataChunkId, indexDataSizeBytes);
+			if (indexData == nullptr) {
+				LoadDataChunk(meshData.indexBufferRaw, indexDataChunkId);
+				indexData = meshData.indexBufferRaw.data();
+				indexDataSizeBytes = meshData.indexBufferRaw.size();
+			}
+		}
 
-					dataChunksDesc.push_back(chunkDesc);
+		if (sgedev != nullptr) {
+			createRenderResources(sgedev, loadSets, meshData, vertexData, vertexDataSizeBytes, indexData, indexDataSizeBytes);
+		}
+	}
+
+	void ModelReader::LoadBinaryParamBlock(const BinaryTables& tables,
+	                                       const uint32 firstParameter,
+	                                       const uint32 numParameters,
+	                                       ParameterBlock& paramBlock) {
+		checkTableRange(tables.parameters, firstParameter, numParameters);
+		for (uint32 iParam = firstParameter; iParam < firstParameter + numParameters; ++iParam) {
+			const MdlParameter& mdlParam = tables.parameters[iParam];
+
+			const ParameterType::Enum paramType = ParameterType::FromString(tables.getString(mdlParam.type));
+			if (paramType == ParameterType::FromStringError) {
+				sgeAssert(false && "Failed to convert string to ParameterType!");
+				throw ModelParseExcept("Unknown parameter type!");
+			}
+
+			const void* const pStaticValue =
+			    (paramType == ParameterType::String) ? (const void*)tables.getString(mdlParam.staticString) : mdlParam.staticValue;
+			Parameter* const param = paramBlock.FindParameter(tables.getString(mdlParam.name), paramType, pStaticValue);
+
+			checkTableRange(tables.curves, mdlParam.firstCurve, mdlParam.numCurves);
+			for (uint32 iCurve = mdlParam.firstCurve; iCurve < mdlParam.firstCurve + mdlParam.numCurves; ++iCurve) {
+				const MdlCurve& mdlCurve = tables.curves[iCurve];
+
+				if (param->CreateCurve(tables.getString(mdlCurve.name))) {
+					ParameterCurve& curve = *param->GetCurve(tables.getString(mdlCurve.name));
+
+					curve.type = param->GetType();
+					LoadDataChunk(curve.keys, mdlCurve.keyframesChunkId);
+					LoadDataChunk(curve.data, mdlCurve.valuesChunkId);
+
+					sgeAssert(curve.debug_VerifyData());
+				} else {
+					sgeAssert(false);
 				}
 			}
+		}
+	}
 
-			// Load the animations.
-			auto jAnimations = jRoot->getMember("animations");
-			if (jAnimations) {
-				for (size_t t = 0; t < jAnimations->arrSize(); ++t) {
-					auto jAnimation = jAnimations->arrAt(t);
+	void ModelReader::LoadBinaryHeader(const LoadSettings& loadSets,
+	                                   SGEDevice* const sgedev,
+	                                   Model& model,
+	                                   vector_map<Bone*, int>& bone2nodeResolve) {
+		const size_t headerOffset = irs->pointerOffset();
 
-					AnimationInfo animationInfo;
+		MdlBinaryHeader header;
+		if (irs->read(&header, sizeof(header)) != sizeof(header)) {
+			throw ModelParseExcept("Failed to read the binary header!");
+		}
 
-					animationInfo.curveName = std::string(jAnimation->getMember("curve")->GetString());
-					animationInfo.startTime = jAnimation->getMember("timeOffset")->getNumberAs<float>();
-					animationInfo.duration = jAnimation->getMember("duration")->getNumberAs<float>();
+		if (header.version != kMdlBinaryVersion) {
+			throw ModelParseExcept("Unsupported binary header version!");
+		}
+
+		if (header.numTables != MdlTable_Count || header.headerSizeBytes < sizeof(header)) {
+			throw ModelParseExcept("Invalid binary header!");
+		}
+
+		// Read the tables, directly from the memory if the stream is in memory.
+		std::vector<char> headerDataStorage;
+		const char* headerData = nullptr;
+		if (irs->getMemory() != nullptr) {
+			if (headerOffset + header.headerSizeBytes > irs->getMemorySizeBytes()) {
+				throw ModelParseExcept("The binary header is outside of the file!");
+			}
+			headerData = irs->getMemory() + headerOffset;
+		} else {
+			headerDataStorage.resize(header.headerSizeBytes);
+			irs->seek(SeekOrigin::Begining, headerOffset);
+			if (irs->read(headerDataStorage.data(), headerDataStorage.size()) != headerDataStorage.size()) {
+				throw ModelParseExcept("Failed to read the binary header!");
+			}
+			headerData = headerDataStorage.data();
+		}
+
+		// The data chunks are right after the tables.
+		dataChunksOffset = headerOffset + header.headerSizeBytes;
+
+		BinaryTables tables;
+		const auto readTable = [&header, headerData](const MdlTable table, auto& records) -> void {
+			const size_t recordSizeBytes = sizeof(records[0]);
+			const MdlTableDesc& tableDesc = header.tables[table];
+
+			if (tableDesc.numRecords != 0 && tableDesc.recordSizeBytes != recordSizeBytes) {
+				throw ModelParseExcept("Unexpected record size in the binary header!");
+			}
+
+			const uint64 tableSizeBytes = uint64(tableDesc.numRecords) * recordSizeBytes;
+			if (uint64(tableDesc.byteOffset) + tableSizeBytes > header.headerSizeBytes) {
+				throw ModelParseExcept("The table is outside of the binary header!");
+			}
 
-					model.m_animations.push_back(animationInfo);
+			records.resize(tableDesc.numRecords);
+			if (tableSizeBytes != 0) {
+				memcpy(records.data(), headerData + tableDesc.byteOffset, size_t(tableSizeBytes));
+			}
+		};
+
+		readTable(MdlTable_Strings, tables.strings);
+		readTable(MdlTable_DataChunks, tables.dataChunks);
+		readTable(MdlTable_Animations, tables.animations);
+		readTable(MdlTable_Materials, tables.materials);
+		readTable(MdlTable_Parameters, tables.parameters);
+		readTable(MdlTable_Curves, tables.curves);
+		readTable(MdlTable_MeshesData, tables.meshesData);
+		readTable(MdlTable_Meshes, tables.meshes);
+		readTable(MdlTable_VertexDecls, tables.vertexDecls);
+		readTable(MdlTable_Bones, tables.bones);
+		readTable(MdlTable_Nodes, tables.nodes);
+		readTable(MdlTable_MeshAttachments, tables.meshAttachments);
+		readTable(MdlTable_ChildNodes, tables.childNodes);
+		readTable(MdlTable_ConvexHulls, tables.convexHulls);
+		readTable(MdlTable_ConcaveHulls, tables.concaveHulls);
+		readTable(MdlTable_CollisionBoxes, tables.collisionBoxes);
+		readTable(MdlTable_CollisionCapsules, tables.collisionCapsules);
+		readTable(MdlTable_CollisionCylinders, tables.collisionCylinders);
+		readTable(MdlTable_CollisionSpheres, tables.collisionSpheres);
+
+		if (tables.strings.empty() == false && tables.strings.back() != '\0') {
+			throw ModelParseExcept("The string table isn't null terminated!");
+		}
+
+		// The data chunk descs.
+		dataChunksDesc.reserve(tables.dataChunks.size());
+		for (const MdlDataChunk& mdlChunk : tables.dataChunks) {
+			DataChunkDesc chunkDesc;
+			chunkDesc.chunkId = mdlChunk.id;
+			chunkDesc.byteOffset = mdlChunk.byteOffset;
+			chunkDesc.sizeBytes = mdlChunk.sizeBytes;
+			dataChunksDesc[chunkDesc.chunkId] = chunkDesc;
+		}
+
+		// The animations.
+		model.m_animations.reserve(tables.animations.size());
+		for (const MdlAnimation& mdlAnimation : tables.animations) {
+			model.m_animations.emplace_back(tables.getString(mdlAnimation.curveName), mdlAnimation.startTime, mdlAnimation.duration);
+		}
+
+		// The materials.
+		model.m_materials.reserve(tables.materials.size());
+		for (const MdlMaterial& mdlMaterial : tables.materials) {
+			Material* const mtl = model.m_containerMaterial.new_element();
+			model.m_materials.push_back(mtl);
+
+			mtl->id = mdlMaterial.id;
+			mtl->name = tables.getString(mdlMaterial.name);
+			LoadBinaryParamBlock(tables, mdlMaterial.firstParameter, mdlMaterial.numParameters, mtl->paramBlock);
+		}
+
+		// The mesh data and the meshes.
+		model.m_meshesData.reserve(tables.meshesData.size());
+		for (const MdlMeshData& mdlMeshData : tables.meshesData) {
+			model.m_meshesData.push_back(model.m_containerMeshData.new_element());
+			MeshData& meshData = *model.m_meshesData.back();
+
+			checkTableRange(tables.meshes, mdlMeshData.firstMesh, mdlMeshData.numMeshes);
+			meshData.meshes.reserve(mdlMeshData.numMeshes);
+			for (uint32 iMesh = mdlMeshData.firstMesh; iMesh < mdlMeshData.firstMesh + mdlMeshData.numMeshes; ++iMesh) {
+				const MdlMesh& mdlMesh = tables.meshes[iMesh];
+
+				meshData.meshes.push_back(model.m_containerMesh.new_element());
+				Mesh& mesh = *meshData.meshes.back();
+
+				mesh.pMeshData = &meshData;
+				mesh.id = mdlMesh.id;
+				mesh.name = tables.getString(mdlMesh.name);
+				mesh.primTopo = PrimitiveTolologyFromString(tables.getString(mdlMesh.primitiveTopology));
+				mesh.vbByteOffset = mdlMesh.vbByteOffset;
+				mesh.numElements = mdlMesh.numElements;
+				mesh.numVertices = mdlMesh.numVertices;
+				mesh.aabox.min = vec3f(mdlMesh.aaboxMin[0], mdlMesh.aaboxMin[1], mdlMesh.aaboxMin[2]);
+				mesh.aabox.max = vec3f(mdlMesh.aaboxMax[0], mdlMesh.aaboxMax[1], mdlMesh.aaboxMax[2]);
+
+				// Note that there may be no index buffer.
+				if (mdlMesh.ibFormat != kMdlNoString) {
+					mesh.ibByteOffset = mdlMesh.ibByteOffset;
+					mesh.ibFmt = UniformTypeFromString(tables.getString(mdlMesh.ibFormat));
+				}
+
+				checkTableRange(tables.vertexDecls, mdlMesh.firstVertexDecl, mdlMesh.numVertexDecls);
+				mesh.vertexDecl.reserve(mdlMesh.numVertexDecls);
+				for (uint32 iDecl = mdlMesh.firstVertexDecl; iDecl < mdlMesh.firstVertexDecl + mdlMesh.numVertexDecls; ++iDecl) {
+					const MdlVertexDecl& mdlDecl = tables.vertexDecls[iDecl];
+
+					VertexDecl decl;
+					decl.bufferSlot = 0;
+					decl.semantic = tables.getString(mdlDecl.semantic);
+					decl.byteOffset = mdlDecl.byteOffset;
+					decl.format = UniformTypeFromString(tables.getString(mdlDecl.format));
+					mesh.vertexDecl.push_back(decl);
+				}
+
+				cacheVertexLayout(mesh);
+
+				if (mdlMesh.materialId >= 0) {
+					mesh.pMaterial = model.FindMaterial(mdlMesh.materialId);
+					sgeAssert(mesh.pMaterial);
+				}
+
+				checkTableRange(tables.bones, mdlMesh.firstBone, mdlMesh.numBones);
+				mesh.bones.resize(mdlMesh.numBones);
+				for (uint32 iBone = 0; iBone < mdlMesh.numBones; ++iBone) {
+					const MdlBone& mdlBone = tables.bones[mdlMesh.firstBone + iBone];
+					Bone& bone = mesh.bones[iBone];
+
+					bone2nodeResolve[&bone] = mdlBone.nodeId;
+					LoadDataChunk(bone.vertexIds, mdlBone.vertexIdsChunkId);
+					LoadDataChunk(bone.weights, mdlBone.weightsChunkId);
+					memcpy(&bone.offsetMatrix, mdlBone.offsetMatrix, sizeof(bone.offsetMatrix));
 				}
 			}
 
-			// Load the materials.
-			auto jMaterials = jRoot->getMember("materials");
-			if (jMaterials) {
-				model.m_materials.reserve(jMaterials->arrSize());
-				for (size_t t = 0; t < jMaterials->arrSize(); ++t) {
-					const JsonValue* const jMaterial = jMaterials->arrAt(t);
+			LoadMeshDataBuffers(loadSets, sgedev, meshData, mdlMeshData.vertexDataChunkId, mdlMeshData.indexDataChunkId);
+		}
 
-					model.m_materials.push_back(model.m_containerMaterial.new_element());
-					Material* const mtl = model.m_materials.back();
+		// The nodes.
+		model.m_nodes.reserve(tables.nodes.size());
+		for (const MdlNode& mdlNode : tables.nodes) {
+			Node* const node = model.m_containerNode.new_element();
+			model.m_nodes.push_back(node);
+
+			node->id = mdlNode.id;
+			node->name = tables.getString(mdlNode.name);
+			LoadBinaryParamBlock(tables, mdlNode.firstParameter, mdlNode.numParameters, node->paramBlock);
+
+			checkTableRange(tables.meshAttachments, mdlNode.firstMeshAttachment, mdlNode.numMeshAttachments);
+			node->meshAttachments.reserve(mdlNode.numMeshAttachments);
+			for (uint32 iAttachment = 0; iAttachment < mdlNode.numMeshAttachments; ++iAttachment) {
+				const MdlMeshAttachment& mdlAttachment = tables.meshAttachments[mdlNode.firstMeshAttachment + iAttachment];
+
+				MeshAttachment attachmentMesh;
+				attachmentMesh.mesh = model.FindMesh(mdlAttachment.meshId);
+				if (mdlAttachment.materialId >= 0) {
+					attachmentMesh.material = model.FindMaterial(mdlAttachment.materialId);
+				}
 
-					mtl->id = jMaterial->getMember("id")->getNumberAs<int>();
-					mtl->name = jMaterial->getMember("name")->GetString();
-					LoadParamBlock(jMaterial->getMember("paramBlock"), mtl->paramBlock);
+				if (attachmentMesh.mesh != nullptr) {
+					node->meshAttachments.push_back(attachmentMesh);
+				} else {
+					sgeAssert(false); // Should never happen.
 				}
 			}
+		}
 
-			// Load the MeshData.
-			vector_map<Bone*, int> bone2nodeResolve;
+		// The node hierarchy, after all nodes are created.
+		model.m_rootNode = model.FindNode(header.rootNodeId);
+		for (int iNode = 0; iNode < int(tables.nodes.size()); ++iNode) {
+			const MdlNode& mdlNode = tables.nodes[iNode];
+			Node* const node = model.m_nodes[iNode];
 
-			auto jMeshesData = jRoot->getMember("meshesData");
-			if (jMeshesData) {
-				model.m_meshesData.reserve(jMeshesData->arrSize());
-				for (size_t t = 0; t < jMeshesData->arrSize(); ++t) {
-					model.m_meshesData.push_back(model.m_containerMeshData.new_element());
-					MeshData& meshData = *model.m_meshesData.back();
+			checkTableRange(tables.childNodes, mdlNode.firstChildNode, mdlNode.numChildNodes);
+			node->childNodes.reserve(mdlNode.numChildNodes);
+			for (uint32 iChild = mdlNode.firstChildNode; iChild < mdlNode.firstChildNode + mdlNode.numChildNodes; ++iChild) {
+				node->childNodes.push_back(model.FindNode(tables.childNodes[iChild]));
+			}
+		}
 
-					auto jMeshData = jMeshesData->arrAt(t);
+		// The collision geometry.
+		const auto loadCollisionMeshes = [this](const std::vector<MdlCollisionMesh>& mdlHulls, std::vector<CollisionMesh>& hulls) -> void {
+			hulls.reserve(mdlHulls.size());
+			for (const MdlCollisionMesh& mdlHull : mdlHulls) {
+				std::vector<vec3f> verts;
+				LoadDataChunk(verts, mdlHull.vertsChunkId);
 
-					const int vertexDataChunkID = jMeshData->getMember("vertexDataChunkId")->getNumberAs<int>();
-					const JsonValue* jIndexBufferChunkID = jMeshData->getMember("indexDataChunkId");
+				std::vector<int> indices;
+				LoadDataChunk(indices, mdlHull.indicesChunkId);
 
-					LoadDataChunk(meshData.vertexBufferRaw, vertexDataChunkID);
-					const int indexDataChunkID = jIndexBufferChunkID ? jIndexBufferChunkID->getNumberAs<int>() : -1;
-					if (indexDataChunkID > 0)
-						LoadDataChunk(meshData.indexBufferRaw, indexDataChunkID);
+				hulls.emplace_back(CollisionMesh(std::move(verts), std::move(indices)));
+			}
+		};
+
+		loadCollisionMeshes(tables.convexHulls, model.m_convexHulls);
+		loadCollisionMeshes(tables.concaveHulls, model.m_concaveHulls);
+
+		const auto getShapeTransform = [](const MdlCollisionShape& mdlShape) -> transf3d {
+			transf3d tr;
+			tr.p = vec3f(mdlShape.position[0], mdlShape.position[1], mdlShape.position[2]);
+			tr.r = quatf(mdlShape.rotation[0], mdlShape.rotation[1], mdlShape.rotation[2], mdlShape.rotation[3]);
+			tr.s = vec3f(mdlShape.scaling[0], mdlShape.scaling[1], mdlShape.scaling[2]);
+			return tr;
+		};
+
+		for (const MdlCollisionShape& mdlShape : tables.collisionBoxes) {
+			const vec3f halfDiagonal(mdlShape.halfDiagonal[0], mdlShape.halfDiagonal[1], mdlShape.halfDiagonal[2]);
+			model.m_collisionBoxes.emplace_back(tables.getString(mdlShape.name), getShapeTransform(mdlShape), halfDiagonal);
+		}
 
-					// Load the described meshes.
+		for (const MdlCollisionShape& mdlShape : tables.collisionCapsules) {
+			model.m_collisionCapsules.emplace_back(tables.getString(mdlShape.name), getShapeTransform(mdlShape), mdlShape.halfHeight,
+			                                       mdlShape.radius);
+		}
 
-					// True if at least one mesh have bones. BTW currently only all Skinned meshes are stored into separate meshDatas.
-					bool hasBones = false;
+		for (const MdlCollisionShape& mdlShape : tables.collisionCylinders) {
+			const vec3f halfDiagonal(mdlShape.halfDiagonal[0], mdlShape.halfDiagonal[1], mdlShape.halfDiagonal[2]);
+			model.m_collisionCylinders.emplace_back(tables.getString(mdlShape.name), getShapeTransform(mdlShape), halfDiagonal);
+		}
 
-					auto jMeshes = jMeshData->getMember("meshes");
+		for (const MdlCollisionShape& mdlShape : tables.collisionSpheres) {
+			model.m_collisionSpheres.emplace_back(tables.getString(mdlShape.name), getShapeTransform(mdlShape), mdlShape.radius);
+		}
+	}
 
-					meshData.meshes.reserve(jMeshes->arrSize());
+	void ModelReader::LoadJsonHeader(const LoadSettings& loadSets,
+	                                 SGEDevice* const sgedev,
+	                                 Model& model,
+	                                 vector_map<Bone*, int>& bone2nodeResolve) {
+		JsonParser jsonParser;
+		if (!jsonParser.parse(irs)) {
+			throw ModelParseExcept("Parsing the json header failed!");
+		}
 
-					for (size_t s = 0; s < jMeshes->arrSize(); ++s) {
-						meshData.meshes.push_back(model.m_containerMesh.new_element());
-						Mesh& mesh = *meshData.meshes.back();
+		dataChunksOffset = irs->pointerOffset();
 
-						auto jMesh = jMeshes->arrAt(s);
+		// This point here is pretty important.
+		// The irs pointer currently points at the beggining of the
+		// data chunks. This pointer will jump around that section
+		// in order to load the specific buffer data(like mesh data parameter data ect...)
 
-						mesh.pMeshData = &meshData;
-						mesh.id = jMesh->getMember("id")->getNumberAs<int>();
-						mesh.name = jMesh->getMember("name")->GetString();
-						mesh.primTopo = PrimitiveTolologyFromString(jMesh->getMember("primitiveTopology")->GetString());
-						mesh.vbByteOffset = jMesh->getMember("vbByteOffset")->getNumberAs<uint32>();
-						mesh.numElements = jMesh->getMember("numElements")->getNumberAs<uint32>();
-						mesh.numVertices = jMesh->getMember("numVertices")->getNumberAs<uint32>();
+		// [CAUTION] From this point DO NOT use directly irs
+		// If you want to load a data chunk use LoadDataChunk
 
-						// Load the index buffer. Note that there may be no index buffer.
-						if (jMesh->getMember("ibByteOffset") && jMesh->getMember("ibFormat")) {
-							mesh.ibByteOffset = jMesh->getMember("ibByteOffset")->getNumberAs<uint32>();
-							mesh.ibFmt = UniformTypeFromString(jMesh->getMember("ibFormat")->GetString());
-						}
+		const JsonValue* const jRoot = jsonParser.getRoot();
 
-						// The AABB of the mesh.
-						jMesh->getMember("AABoxMin")->getNumberArrayAs<float>(mesh.aabox.min.data, 3);
-						jMesh->getMember("AABoxMax")->getNumberArrayAs<float>(mesh.aabox.max.data, 3);
-
-						// The vertex declaration.
-						auto jVertexDecl = jMesh->getMember("vertexDecl");
-						for (size_t iDecl = 0; iDecl < jVertexDecl->arrSize(); ++iDecl) {
-							auto jDecl = jVertexDecl->arrAt(iDecl);
-
-							VertexDecl decl;
-							decl.bufferSlot = 0;
-							decl.semantic = jDecl->getMember("semantic")->GetString();
-							decl.byteOffset = jDecl->getMember("byteOffset")->getNumberAs<int>();
-							decl.format = UniformTypeFromString(jDecl->getMember("format")->GetString());
-
-							mesh.vertexDecl.push_back(decl);
-
-							// Cache some commonly used semantics offsets.
-							if (decl.semantic == "a_position") {
-								mesh.vbPositionOffsetBytes = (int)decl.byteOffset;
-							} else if (decl.semantic == "a_normal") {
-								mesh.vbNormalOffsetBytes = (int)decl.byteOffset;
-							} else if (decl.semantic == "a_uv") {
-								mesh.vbUVOffsetBytes = (int)decl.byteOffset;
-							}
-						}
+		// Load the data chunk desc.
+		{
+			const JsonValue* const jDataChunksDesc = jRoot->getMember("dataChunksDesc");
 
-						// Bake the vertex stride.
-						mesh.stride = int(mesh.vertexDecl.back().byteOffset) + UniformType::GetSizeBytes(mesh.vertexDecl.back().format);
+			for (size_t t = 0; t < jDataChunksDesc->arrSize(); t += 3) {
+				DataChunkDesc chunkDesc;
 
-						// The attached material (if any).
-						if (jMesh->getMember("material_id")) {
-							const int material_id = jMesh->getMember("material_id")->getNumberAs<int>();
-							mesh.pMaterial = model.FindMaterial(material_id);
-							sgeAssert(mesh.pMaterial);
-						}
+				chunkDesc.chunkId = jDataChunksDesc->arrAt(t)->getNumberAs<int>();
+				chunkDesc.byteOffset = jDataChunksDesc->arrAt(t + 1)->getNumberAs<int>();
+				chunkDesc.sizeBytes = jDataChunksDesc->arrAt(t + 2)->getNumberAs<int>();
 
-						// The bones.
-						auto jBones = jMesh->getMember("bones");
-						if (jBones) {
-							hasBones = true;
+				dataChunksDesc[chunkDesc.chunkId] = chunkDesc;
+			}
+		}
 
-							mesh.bones.resize(jBones->arrSize());
-							for (size_t iBone = 0; iBone < jBones->arrSize(); ++iBone) {
-								auto jBone = jBones->arrAt(iBone);
-								Bone& bone = mesh.bones[iBone];
+		// Load the animations.
+		auto jAnimations = jRoot->getMember("animations");
+		if (jAnimations) {
+			for (size_t t = 0; t < jAnimations->arrSize(); ++t) {
+				auto jAnimation = jAnimations->arrAt(t);
 
-								// Becase nodes are loded before meshes, we must do that gymnastic.
-								bone2nodeResolve[&bone] = jBone->getMember("node_id")->getNumberAs<int>();
+				AnimationInfo animationInfo;
 
-								LoadDataChunk(bone.vertexIds, jBone->getMember("vertIdsChunkId")->getNumberAs<int>());
-								LoadDataChunk(bone.weights, jBone->getMember("weightsChunkId")->getNumberAs<int>());
-								LoadDataChunkRaw(&bone.offsetMatrix, sizeof(bone.offsetMatrix),
-								                 jBone->getMember("offsetMatrixChunkId")->getNumberAs<int>());
-							}
-						}
-					}
+				animationInfo.curveName = std::string(jAnimation->getMember("curve")->GetString());
+				animationInfo.startTime = jAnimation->getMember("timeOffset")->getNumberAs<float>();
+				animationInfo.duration = jAnimation->getMember("duration")->getNumberAs<float>();
 
-					// Skinned meshes must be stored into separate meshData buffers
-					if (hasBones && meshData.meshes.size() != 1) {
-						sgeAssert(false);
-						throw ModelParseExcept("Mesh data isn't stored into a separate mesh data!");
+				model.m_animations.push_back(animationInfo);
+			}
+		}
+
+		// Load the materials.
+		auto jMaterials = jRoot->getMember("materials");
+		if (jMaterials) {
+			model.m_materials.reserve(jMaterials->arrSize());
+			for (size_t t = 0; t < jMaterials->arrSize(); ++t) {
+				const JsonValue* const jMaterial = jMaterials->arrAt(t);
+
+				model.m_materials.push_back(model.m_containerMaterial.new_element());
+				Material* const mtl = model.m_materials.back();
+
+				mtl->id = jMaterial->getMember("id")->getNumberAs<int>();
+				mtl->name = jMaterial->getMember("name")->GetString();
+				LoadParamBlock(jMaterial->getMember("paramBlock"), mtl->paramBlock);
+			}
+		}
+
+		// Load the MeshData.
+		auto jMeshesData = jRoot->getMember("meshesData");
+		if (jMeshesData) {
+			model.m_meshesData.reserve(jMeshesData->arrSize());
+			for (size_t t = 0; t < jMeshesData->arrSize(); ++t) {
+				model.m_meshesData.push_back(model.m_containerMeshData.new_element());
+				MeshData& meshData = *model.m_meshesData.back();
+
+				auto jMeshData = jMeshesData->arrAt(t);
+
+				const int vertexDataChunkID = jMeshData->getMember("vertexDataChunkId")->getNumberAs<int>();
+				const JsonValue* jIndexBufferChunkID = jMeshData->getMember("indexDataChunkId");
+
+				const int indexDataChunkID = jIndexBufferChunkID ? jIndexBufferChunkID->getNumberAs<int>() : -1;
+
+				// Load the described meshes.
+				auto jMeshes = jMeshData->getMember("meshes");
+
+				meshData.meshes.reserve(jMeshes->arrSize());
+
+				for (size_t s = 0; s < jMeshes->arrSize(); ++s) {
+					meshData.meshes.push_back(model.m_containerMesh.new_element());
+					Mesh& mesh = *meshData.meshes.back();
+
+					auto jMesh = jMeshes->arrAt(s);
+
+					mesh.pMeshData = &meshData;
+					mesh.id = jMesh->getMember("id")->getNumberAs<int>();
+					mesh.name = jMesh->getMember("name")->GetString();
+					mesh.primTopo = PrimitiveTolologyFromString(jMesh->getMember("primitiveTopology")->GetString());
+					mesh.vbByteOffset = jMesh->getMember("vbByteOffset")->getNumberAs<uint32>();
+					mesh.numElements = jMesh->getMember("numElements")->getNumberAs<uint32>();
+					mesh.numVertices = jMesh->getMember("numVertices")->getNumberAs<uint32>();
+
+					// Load the index buffer. Note that there may be no index buffer.
+					if (jMesh->getMember("ibByteOffset") && jMesh->getMember("ibFormat")) {
+						mesh.ibByteOffset = jMesh->getMember("ibByteOffset")->getNumberAs<uint32>();
+						mesh.ibFmt = UniformTypeFromString(jMesh->getMember("ibFormat")->GetString());
 					}
 
-					// Finally Create the GPU resources.
-					const ResourceUsage::Enum usage = (hasBones) ? ResourceUsage::Dynamic : ResourceUsage::Immutable;
+					// The AABB of the mesh.
+					jMesh->getMember("AABoxMin")->getNumberArrayAs<float>(mesh.aabox.min.data, 3);
+					jMesh->getMember("AABoxMax")->getNumberArrayAs<float>(mesh.aabox.max.data, 3);
+
+					// The vertex declaration.
+					auto jVertexDecl = jMesh->getMember("vertexDecl");
+					for (size_t iDecl = 0; iDecl < jVertexDecl->arrSize(); ++iDecl) {
+						auto jDecl = jVertexDecl->arrAt(iDecl);
 
-					meshData.vertexBuffer = sgedev->requestResource<Buffer>();
-					const BufferDesc vbd = BufferDesc::GetDefaultVertexBuffer((uint32)meshData.vertexBufferRaw.size(), usage);
-					meshData.vertexBuffer->create(vbd, meshData.vertexBufferRaw.data());
+						VertexDecl decl;
+						decl.bufferSlot = 0;
+						decl.semantic = jDecl->getMember("semantic")->GetString();
+						decl.byteOffset = jDecl->getMember("byteOffset")->getNumberAs<int>();
+						decl.format = UniformTypeFromString(jDecl->getMember("format")->GetString());
 
-					// The index buffer is any.
-					if (meshData.indexBufferRaw.size() != 0) {
-						meshData.indexBuffer = sgedev->requestResource<Buffer>();
-						const BufferDesc ibd = BufferDesc::GetDefaultIndexBuffer((uint32)meshData.indexBufferRaw.size(), usage);
-						meshData.indexBuffer->create(ibd, meshData.indexBufferRaw.data());
+						mesh.vertexDecl.push_back(decl);
 					}
 
-					const bool shouldKeepCPUBuffers = (loadSets.cpuMeshData == LoadSettings::KeepMeshData_Skin && hasBones) ||
-					                                  (loadSets.cpuMeshData == LoadSettings::KeepMeshData_All);
+					cacheVertexLayout(mesh);
 
-					if (shouldKeepCPUBuffers == false) {
-						meshData.vertexBufferRaw = std::vector<char>();
-						meshData.indexBufferRaw = std::vector<char>();
+					// The attached material (if any).
+					if (jMesh->getMember("material_id")) {
+						const int material_id = jMesh->getMember("material_id")->getNumberAs<int>();
+						mesh.pMaterial = model.FindMaterial(material_id);
+						sgeAssert(mesh.pMaterial);
+					}
+
+					// The bones.
+					auto jBones = jMesh->getMember("bones");
+					if (jBones) {
+						mesh.bones.resize(jBones->arrSize());
+						for (size_t iBone = 0; iBone < jBones->arrSize(); ++iBone) {
+							auto jBone = jBones->arrAt(iBone);
+							Bone& bone = mesh.bones[iBone];
+
+							// Becase nodes are loded before meshes, we must do that gymnastic.
+							bone2nodeResolve[&bone] = jBone->getMember("node_id")->getNumberAs<int>();
+
+							LoadDataChunk(bone.vertexIds, jBone->getMember("vertIdsChunkId")->getNumberAs<int>());
+							LoadDataChunk(bone.weights, jBone->getMember("weightsChunkId")->getNumberAs<int>());
+							LoadDataChunkRaw(&bone.offsetMatrix, sizeof(bone.offsetMatrix),
+							                 jBone->getMember("offsetMatrixChunkId")->getNumberAs<int>());
+						}
 					}
 				}
+
+				LoadMeshDataBuffers(loadSets, sgedev, meshData, vertexDataChunkID, indexDataChunkID);
 			}
+		}
 
-			// Load the nodes.
-			auto jNodes = jRoot->getMember("nodes");
-			if (jNodes) {
-				model.m_nodes.reserve(jNodes->arrSize());
-				for (size_t t = 0; t < jNodes->arrSize(); ++t) {
-					auto jNode = jNodes->arrAt(t);
-					auto jParamBlock = jNode->getMember("paramBlock");
+		// Load the nodes.
+		auto jNodes = jRoot->getMember("nodes");
+		if (jNodes) {
+			model.m_nodes.reserve(jNodes->arrSize());
+			for (size_t t = 0; t < jNodes->arrSize(); ++t) {
+				auto jNode = jNodes->arrAt(t);
+				auto jParamBlock = jNode->getMember("paramBlock");
 
-					Node* node = model.m_containerNode.new_element();
+				Node* node = model.m_containerNode.new_element();
 
-					node->id = jNode->getMember("id")->getNumberAs<int>();
-					node->name = jNode->getMember("name")->GetString();
-					LoadParamBlock(jParamBlock, node->paramBlock);
+				node->id = jNode->getMember("id")->getNumberAs<int>();
+				node->name = jNode->getMember("name")->GetString();
+				LoadParamBlock(jParamBlock, node->paramBlock);
 
-					// Read the mesh attachments.
-					auto jMeshes = jNode->getMember("meshes");
-					if (jMeshes) {
-						for (size_t iMesh = 0; iMesh < jMeshes->arrSize(); ++iMesh) {
-							const JsonValue* const jAttachmentMesh = jMeshes->arrAt(iMesh);
+				// Read the mesh attachments.
+				auto jMeshes = jNode->getMember("meshes");
+				if (jMeshes) {
+					for (size_t iMesh = 0; iMesh < jMeshes->arrSize(); ++iMesh) {
+						const JsonValue* const jAttachmentMesh = jMeshes->arrAt(iMesh);
 
-							const JsonValue* const jMeshId = jAttachmentMesh->getMember("mesh_id");
-							const JsonValue* const jMaterialId = jAttachmentMesh->getMember("material_id");
+						const JsonValue* const jMeshId = jAttachmentMesh->getMember("mesh_id");
+						const JsonValue* const jMaterialId = jAttachmentMesh->getMember("material_id");
 
-							const int meshId = jMeshId->getNumberAs<int>();
-							MeshAttachment attachmentMesh;
+						const int meshId = jMeshId->getNumberAs<int>();
+						MeshAttachment attachmentMesh;
 
-							attachmentMesh.mesh = model.FindMesh(meshId);
-							if (jMaterialId) {
-								const int materialId = jMaterialId->getNumberAs<int>();
-								attachmentMesh.material = model.FindMaterial(materialId);
-							}
+						attachmentMesh.mesh = model.FindMesh(meshId);
+						if (jMaterialId) {
+							const int materialId = jMaterialId->getNumberAs<int>();
+							attachmentMesh.material = model.FindMaterial(materialId);
+						}
 
-							if (attachmentMesh.mesh != nullptr) {
-								node->meshAttachments.push_back(attachmentMesh);
-							} else {
-								sgeAssert(false); // Should never happen.
-							}
+						if (attachmentMesh.mesh != nullptr) {
+							node->meshAttachments.push_back(attachmentMesh);
+						} else {
+							sgeAssert(false); // Should never happen.
 						}
 					}
+				}
 
-					//
-					model.m_nodes.push_back(node);
+				//
+				model.m_nodes.push_back(node);
+			}
+		}
+
+		// Resolve Node hierarchy
+		auto jHierarchy = jRoot->getMember("nodeHierarchy");
+		if (jHierarchy) {
+			// the 1st element of that arrays is the name of the root node.
+			const int rootNodeId = jHierarchy->arrAt(0)->getNumberAs<int>();
+			model.m_rootNode = model.FindNode(rootNodeId);
+
+			for (size_t iNode = 1; iNode < jHierarchy->arrSize(); iNode += 2) {
+				const int nodeId = jHierarchy->arrAt(iNode)->getNumberAs<int>();
+				Node* const node = model.FindNode(nodeId);
+
+				// Add the child nodes.
+				const JsonValue* const jChilds = jHierarchy->arrAt(iNode + 1);
+				for (size_t iChild = 0; iChild < jChilds->arrSize(); ++iChild) {
+					const int childNodeId = jChilds->arrAt(iChild)->getNumberAs<int>();
+					node->childNodes.push_back(model.FindNode(childNodeId));
 				}
 			}
+		}
 
-			// Resolve Bone Node pointers.
-			{
-				for (const auto& pair : bone2nodeResolve) {
-					Bone* const bone = pair.key();
-					Node* const node = model.FindNode(pair.value());
-					sgeAssert(bone != nullptr && node != nullptr);
+		// Read the collision geometry:
 
-					bone->node = node;
-				}
+		// Convex hulls.
+		const JsonValue* const jStaticConvexHulls = jRoot->getMember("staticConvexHulls");
+		if (jStaticConvexHulls) {
+			int const numHulls = int(jStaticConvexHulls->arrSize());
+			for (int t = 0; t < numHulls; ++t) {
+				const int hullVertsChunkId = jStaticConvexHulls->arrAt(t)->getMember("vertsChunkId")->getNumberAs<int>();
+				const int hullIndicesChunkId = jStaticConvexHulls->arrAt(t)->getMember("indicesChunkId")->getNumberAs<int>();
+
+				std::vector<vec3f> verts;
+				LoadDataChunk(verts, hullVertsChunkId);
+
+				std::vector<int> indices;
+				LoadDataChunk(indices, hullIndicesChunkId);
+
+				model.m_convexHulls.emplace_back(CollisionMesh(std::move(verts), std::move(indices)));
 			}
+		}
 
-			// Resolve Node hierarchy
-			auto jHierarchy = jRoot->getMember("nodeHierarchy");
-			if (jHierarchy) {
-				// the 1st element of that arrays is the name of the root node.
-				const int rootNodeId = jHierarchy->arrAt(0)->getNumberAs<int>();
-				model.m_rootNode = model.FindNode(rootNodeId);
+		// Concave hulls
+		const JsonValue* const jStaticConcaveHulls = jRoot->getMember("staticConcaveHulls");
+		if (jStaticConcaveHulls) {
+			int const numHulls = int(jStaticConcaveHulls->arrSize());
+			for (int t = 0; t < numHulls; ++t) {
+				const int hullVertsChunkId = jStaticConcaveHulls->arrAt(t)->getMember("vertsChunkId")->getNumberAs<int>();
+				const int hullIndicesChunkId = jStaticConcaveHulls->arrAt(t)->getMember("indicesChunkId")->getNumberAs<int>();
 
-				for (size_t iNode = 1; iNode < jHierarchy->arrSize(); iNode += 2) {
-					const int nodeId = jHierarchy->arrAt(iNode)->getNumberAs<int>();
-					Node* const node = model.FindNode(nodeId);
+				std::vector<vec3f> verts;
+				LoadDataChunk(verts, hullVertsChunkId);
 
-					// Add the child nodes.
-					const JsonValue* const jChilds = jHierarchy->arrAt(iNode + 1);
-					for (size_t iChild = 0; iChild < jChilds->arrSize(); ++iChild) {
-						const int childNodeId = jChilds->arrAt(iChild)->getNumberAs<int>();
-						node->childNodes.push_back(model.FindNode(childNodeId));
-					}
-				}
+				std::vector<int> indices;
+				LoadDataChunk(indices, hullIndicesChunkId);
+
+				model.m_concaveHulls.emplace_back(CollisionMesh(std::move(verts), std::move(indices)));
 			}
+		}
 
-			// Read the collision geometry:
+		const auto jsonToTransf3d = [](const JsonValue* const j) -> transf3d {
+			transf3d tr = transf3d::getIdentity();
 
-			// Convex hulls.
-			const JsonValue* const jStaticConvexHulls = jRoot->getMember("staticConvexHulls");
-			if (jStaticConvexHulls) {
-				int const numHulls = int(jStaticConvexHulls->arrSize());
-				for (int t = 0; t < numHulls; ++t) {
-					const int hullVertsChunkId = jStaticConvexHulls->arrAt(t)->getMember("vertsChunkId")->getNumberAs<int>();
-					const int hullIndicesChunkId = jStaticConvexHulls->arrAt(t)->getMember("indicesChunkId")->getNumberAs<int>();
+			j->getMember("p")->getNumberArrayAs<float>(tr.p.data, 3);
+			j->getMember("r")->getNumberArrayAs<float>(tr.r.data, 4);
+			j->getMember("s")->getNumberArrayAs<float>(tr.s.data, 3);
 
-					std::vector<vec3f> verts;
-					LoadDataChunk(verts, hullVertsChunkId);
+			return tr;
+		};
 
-					std::vector<int> indices;
-					LoadDataChunk(indices, hullIndicesChunkId);
+		// Collision boxes
+		{
+			const JsonValue* const jShapes = jRoot->getMember("collisionBoxes");
+			if (jShapes) {
+				for (int t = 0; t < jShapes->arrSize(); ++t) {
+					const JsonValue* const jShape = jShapes->arrAt(t);
+					CollisionShapeBox shape;
+					shape.name = jShape->getMember("name")->GetString();
+					shape.transform = jsonToTransf3d(jShape->getMember("transform"));
+					jShape->getMember("halfDiagonal")->getNumberArrayAs<float>(shape.halfDiagonal.data, 3);
 
-					model.m_convexHulls.emplace_back(CollisionMesh(std::move(verts), std::move(indices)));
+					model.m_collisionBoxes.push_back(shape);
 				}
 			}
+		}
 
-			// Concave hulls
-			const JsonValue* const jStaticConcaveHulls = jRoot->getMember("staticConcaveHulls");
-			if (jStaticConcaveHulls) {
-				int const numHulls = int(jStaticConcaveHulls->arrSize());
-				for (int t = 0; t < numHulls; ++t) {
-					const int hullVertsChunkId = jStaticConcaveHulls->arrAt(t)->getMember("vertsChunkId")->getNumberAs<int>();
-					const int hullIndicesChunkId = jStaticConcaveHulls->arrAt(t)->getMember("indicesChunkId")->getNumberAs<int>();
-
-					std::vector<vec3f> verts;
-					LoadDataChunk(verts, hullVertsChunkId);
+		// Collision capsules
+		{
+			const JsonValue* const jShapes = jRoot->getMember("collisionCapsules");
+			if (jShapes) {
+				for (int t = 0; t < jShapes->arrSize(); ++t) {
+					const JsonValue* const jShape = jShapes->arrAt(t);
 
-					std::vector<int> indices;
-					LoadDataChunk(indices, hullIndicesChunkId);
+					CollisionShapeCapsule shape;
+					shape.name = jShape->getMember("name")->GetString();
+					shape.transform = jsonToTransf3d(jShape->getMember("transform"));
+					shape.halfHeight = jShape->getMember("halfHeight")->getNumberAs<float>();
+					shape.radius = jShape->getMember("radius")->getNumberAs<float>();
 
-					model.m_concaveHulls.emplace_back(CollisionMesh(std::move(verts), std::move(indices)));
+					model.m_collisionCapsules.push_back(shape);
 				}
 			}
+		}
 
-			const auto jsonToTransf3d = [](const JsonValue* const j) -> transf3d {
-				transf3d tr = transf3d::getIdentity();
-
-				j->getMember("p")->getNumberArrayAs<float>(tr.p.data, 3);
-				j->getMember("r")->getNumberArrayAs<float>(tr.r.data, 4);
-				j->getMember("s")->getNumberArrayAs<float>(tr.s.data, 3);
+		// Collision cylinders
+		{
+			const JsonValue* const jShapes = jRoot->getMember("collisionCylinders");
+			if (jShapes) {
+				for (int t = 0; t < jShapes->arrSize(); ++t) {
+					const JsonValue* const jShape = jShapes->arrAt(t);
 
-				return tr;
-			};
+					CollisionShapeCylinder shape;
+					shape.name = jShape->getMember("name")->GetString();
+					shape.transform = jsonToTransf3d(jShape->getMember("transform"));
+					jShape->getMember("halfDiagonal")->getNumberArrayAs<float>(shape.halfDiagonal.data, 3);
 
-			// Collision boxes
-			{
-				const JsonValue* const jShapes = jRoot->getMember("collisionBoxes");
-				if (jShapes) {
-					for (int t = 0; t < jShapes->arrSize(); ++t) {
-						const JsonValue* const jShape = jShapes->arrAt(t);
-						CollisionShapeBox shape;
-						shape.name = jShape->getMember("name")->GetString();
-						shape.transform = jsonToTransf3d(jShape->getMember("transform"));
-						jShape->getMember("halfDiagonal")->getNumberArrayAs<float>(shape.halfDiagonal.data, 3);
-
-						model.m_collisionBoxes.push_back(shape);
-					}
+					model.m_collisionCylinders.push_back(shape);
 				}
 			}
+		}
 
-			// Collision capsules
-			{
-				const JsonValue* const jShapes = jRoot->getMember("collisionCapsules");
-				if (jShapes) {
-					for (int t = 0; t < jShapes->arrSize(); ++t) {
-						const JsonValue* const jShape = jShapes->arrAt(t);
-
-						CollisionShapeCapsule shape;
-						shape.name = jShape->getMember("name")->GetString();
-						shape.transform = jsonToTransf3d(jShape->getMember("transform"));
-						shape.halfHeight = jShape->getMember("halfHeight")->getNumberAs<float>();
-						shape.halfHeight = jShape->getMember("radius")->getNumberAs<float>();
-
-						model.m_collisionCapsules.push_back(shape);
-					}
+		// Collision spheres
+		{
+			const JsonValue* const jShapes = jRoot->getMember("collisionSpheres");
+			if (jShapes) {
+				for (int t = 0; t < jShapes->arrSize(); ++t) {
+					const JsonValue* const jShape = jShapes->arrAt(t);
+
+					CollisionShapeSphere shape;
+					shape.name = jShape->getMember("name")->GetString();
+					shape.transform = jsonToTransf3d(jShape->getMember("transform"));
+					shape.radius = jShape->getMember("radius")->getNumberAs<float>();
+
+					model.m_collisionSpheres.push_back(shape);
 				}
 			}
+		}
+	}
 
-			// Collision cylinders
-			{
-				const JsonValue* const jShapes = jRoot->getMember("collisionCylinders");
-				if (jShapes) {
-					for (int t = 0; t < jShapes->arrSize(); ++t) {
-						const JsonValue* const jShape = jShapes->arrAt(t);
+	bool ModelReader::Load(const LoadSettings loadSets, SGEDevice* sgedev, IReadStream* const iReadStream, Model& model) {
+		try {
+			dataChunksDesc.clear();
+			irs = iReadStream;
 
-						CollisionShapeCylinder shape;
-						shape.name = jShape->getMember("name")->GetString();
-						shape.transform = jsonToTransf3d(jShape->getMember("transform"));
-						jShape->getMember("halfDiagonal")->getNumberArrayAs<float>(shape.halfDiagonal.data, 3);
+			model = Model();
+			model.m_loadSets = loadSets;
 
-						model.m_collisionCylinders.push_back(shape);
-					}
-				}
+			// The files with a binary header start with kMdlBinaryMagic, the legacy ones with the JSON header.
+			const size_t headerOffset = irs->pointerOffset();
+			char magic[sizeof(kMdlBinaryMagic)] = {0};
+			const bool isBinaryHeader =
+			    irs->read(magic, sizeof(magic)) == sizeof(magic) && memcmp(magic, kMdlBinaryMagic, sizeof(magic)) == 0;
+			irs->seek(SeekOrigin::Begining, headerOffset);
+
+			// Because nodes are loaded after the meshes, the bones store the node ids and get resolved after everything is loaded.
+			vector_map<Bone*, int> bone2nodeResolve;
+			if (isBinaryHeader) {
+				LoadBinaryHeader(loadSets, sgedev, model, bone2nodeResolve);
+			} else {
+				LoadJsonHeader(loadSets, sgedev, model, bone2nodeResolve);
 			}
 
-			// Collision spheres
+			// Resolve Bone Node pointers.
 			{
-				const JsonValue* const jShapes = jRoot->getMember("collisionSpheres");
-				if (jShapes) {
-					for (int t = 0; t < jShapes->arrSize(); ++t) {
-						const JsonValue* const jShape = jShapes->arrAt(t);
-
-						CollisionShapeSphere shape;
-						shape.name = jShape->getMember("name")->GetString();
-						shape.transform = jsonToTransf3d(jShape->getMember("transform"));
-						shape.radius = jShape->getMember("radius")->getNumberAs<float>();
+				for (const auto& pair : bone2nodeResolve) {
+					Bone* const bone = pair.key();
+					Node* const node = model.FindNode(pair.value());
+					sgeAssert(bone != nullptr && node != nullptr);
 
-						model.m_collisionSpheres.push_back(shape);
-					}
+					bone->node = node;
 				}
 			}
+
+			// Precompute the node hierarchy and compile the animations of the nodes,
+			// so the evaluation doesn't need to traverse the hierarchy or search the parameters and the curves.
+			model.computeNodeHierarchy();
+			model.compileAnimations();
 		} catch (const ModelParseExcept& except) {
 			((void)except);
 			// SGE_DEBUG_ERR("%s: Failed with exception:\n", __func__);
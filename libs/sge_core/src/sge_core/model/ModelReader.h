@@ -3,6 +3,7 @@
 #include "Model.h"
 #include "sge_core/sgecore_api.h"
 #include "sge_renderer/renderer/renderer.h"
+#include "sge_utils/utils/vector_map.h"
 
 namespace sge {
 
@@ -23,19 +24,50 @@ namespace Model {
 		ModelReader() {}
 		~ModelReader() {}
 
+		/// Loads the model from the stream. If @sgedev is nullptr, the GPU resources of the model aren't created and the model
+		/// keeps all of its CPU data until createRenderResources() is called. This allows loading the file on a thread that
+		/// cannot use the device.
 		bool Load(const LoadSettings loadSets, SGEDevice* sgedev, IReadStream* const irs, Model& model);
 
+		/// Creates the GPU resources of a model loaded without a device.
+		static void createRenderResources(SGEDevice* sgedev, Model& model);
+
 	  private:
+		struct BinaryTables;
+
+		void LoadJsonHeader(const LoadSettings& loadSets, SGEDevice* sgedev, Model& model, vector_map<Bone*, int>& bone2nodeResolve);
+		void LoadBinaryHeader(const LoadSettings& loadSets, SGEDevice* sgedev, Model& model, vector_map<Bone*, int>& bone2nodeResolve);
+
+		/// Loads the vertex and the index buffers of the mesh data, after its meshes are loaded, and creates the GPU resources.
+		void LoadMeshDataBuffers(
+		    const LoadSettings& loadSets, SGEDevice* sgedev, MeshData& meshData, const int vertexDataChunkId, const int indexDataChunkId);
+
+		static bool shouldKeepCPUBuffers(const LoadSettings& loadSets, const MeshData& meshData);
+		static void createRenderResources(SGEDevice* sgedev,
+		                                  const LoadSettings& loadSets,
+		                                  MeshData& meshData,
+		                                  const char* vertexData,
+		                                  size_t vertexDataSizeBytes,
+		                                  const char* indexData,
+		                                  size_t indexDataSizeBytes);
+
 		IReadStream* irs;
-		std::vector<DataChunkDesc> dataChunksDesc;
+		size_t dataChunksOffset = 0;                   // The location of the data chunks in the stream.
+		vector_map<int, DataChunkDesc> dataChunksDesc; // The data chunks by id.
 
 		const DataChunkDesc& FindDataChunkDesc(const int chunkId) const;
 
-		// CAUTION: These functions assume that irs points at the BEGINING of data chunks.
+		/// Returns the data of the chunk if the stream is in memory, without copying it, otherwise nullptr.
+		const char* GetDataChunkMemory(const int chunkId, size_t& outSizeBytes);
+
 		template <typename T>
 		void LoadDataChunk(std::vector<T>& resultBuffer, const int chunkId);
 		void LoadDataChunkRaw(void* const ptr, const size_t ptrExpectedSize, const int chunkId);
 		bool LoadParamBlock(const JsonValue* jParamBlock, ParameterBlock& paramBlock);
+		void LoadBinaryParamBlock(const BinaryTables& tables,
+		                          const uint32 firstParameter,
+		                          const uint32 numParameters,
+		                          ParameterBlock& paramBlock);
 	};
 
 } // namespace Model
@@ -1,12 +1,96 @@
 #include <sge_utils/utils/FileStream.h>
 #include <sge_utils/utils/json.h>
+#include <unordered_map>
 
 #include "Model.h"
+#include "ModelBinaryFormat.h"
 #include "ModelWriter.h"
 
 
 namespace sge {
 
+namespace {
+	const char* UnformType2String(const UniformType::Enum ut) {
+		switch (ut) {
+			case UniformType::Uint16:
+				return "uint16";
+			case UniformType::Uint:
+				return "uint32";
+			case UniformType::Float2:
+				return "float2";
+			case UniformType::Float3:
+				return "float3";
+			case UniformType::Float4:
+				return "float4";
+		}
+
+		sgeAssert(false);
+		return nullptr;
+	}
+
+	const char* PrimitiveTopology2String(const PrimitiveTopology::Enum ut) {
+		switch (ut) {
+			case PrimitiveTopology::TriangleList:
+				return "TriangleList";
+		}
+
+		sgeAssert(false);
+		return nullptr;
+	}
+
+	/// Writes @numBytes zero bytes, used for aligning the data in the binary files.
+	void writePadding(IWriteStream* iws, size_t numBytes) {
+		const char zeros[Model::kMdlBinaryAlignment] = {0};
+		while (numBytes > 0) {
+			const size_t numBytesToWrite = std::min(numBytes, sizeof(zeros));
+			iws->write(zeros, numBytesToWrite);
+			numBytes -= numBytesToWrite;
+		}
+	}
+
+	size_t alignBytes(const size_t numBytes, const size_t alignment) {
+		return (numBytes + alignment - 1) / alignment * alignment;
+	}
+} // namespace
+
+/// The records of the binary header, see ModelBinaryFormat.h.
+struct ModelWriter::BinaryTables {
+	/// Adds the string to the string table (if it isn't already there) and returns its offset.
+	uint32 addString(const std::string& str) {
+		auto itr = stringOffsets.find(str);
+		if (itr != stringOffsets.end()) {
+			return itr->second;
+		}
+
+		const uint32 offset = uint32(strings.size());
+		strings.insert(strings.end(), str.c_str(), str.c_str() + str.size() + 1);
+		stringOffsets[str] = offset;
+		return offset;
+	}
+
+	std::vector<char> strings;
+	std::unordered_map<std::string, uint32> stringOffsets;
+
+	std::vector<Model::MdlDataChunk> dataChunks;
+	std::vector<Model::MdlAnimation> animations;
+	std::vector<Model::MdlMaterial> materials;
+	std::vector<Model::MdlParameter> parameters;
+	std::vector<Model::MdlCurve> curves;
+	std::vector<Model::MdlMeshData> meshesData;
+	std::vector<Model::MdlMesh> meshes;
+	std::vector<Model::MdlVertexDecl> vertexDecls;
+	std::vector<Model::MdlBone> bones;
+	std::vector<Model::MdlNode> nodes;
+	std::vector<Model::MdlMeshAttachment> meshAttachments;
+	std::vector<sint32> childNodes;
+	std::vector<Model::MdlCollisionMesh> convexHulls;
+	std::vector<Model::MdlCollisionMesh> concaveHulls;
+	std::vector<Model::MdlCollisionShape> collisionBoxes;
+	std::vector<Model::MdlCollisionShape> collisionCapsules;
+	std::vector<Model::MdlCollisionShape> collisionCylinders;
+	std::vector<Model::MdlCollisionShape> collisionSpheres;
+};
+
 int ModelWriter::NewChunkFromPtr(const void* const ptr, const size_t sizeBytes) {
 	const int newChunkId = (dataChunks.size() == 0) ? 0 : dataChunks.back().id + 1;
 	dataChunks.emplace_back(DataChunk(newChunkId, ptr, sizeBytes));
@@ -190,34 +274,6 @@ void ModelWriter::GenerateMaterials() {
 }
 
 void ModelWriter::GenerateMeshesData() {
-	auto UnformType2String = [](const UniformType::Enum ut) -> const char* {
-		switch (ut) {
-			case UniformType::Uint16:
-				return "uint16";
-			case UniformType::Uint:
-				return "uint32";
-			case UniformType::Float2:
-				return "float2";
-			case UniformType::Float3:
-				return "float3";
-			case UniformType::Float4:
-				return "float4";
-		}
-
-		sgeAssert(false);
-		return nullptr;
-	};
-
-	auto PrimitiveTopology2String = [](const PrimitiveTopology::Enum ut) -> const char* {
-		switch (ut) {
-			case PrimitiveTopology::TriangleList:
-				return "TriangleList";
-		}
-
-		sgeAssert(false);
-		return nullptr;
-	};
-
 	JsonValue* jMeshesData = root->setMember("meshesData", jvb(JID_ARRAY));
 
 	for (auto const& meshData : model->m_meshesData) {
@@ -385,13 +441,16 @@ void ModelWriter::GenerateCollisionData() {
 	}
 }
 
-bool ModelWriter::write(const Model::Model& modelToWrite, IWriteStream* iws) {
-	if (iws == nullptr) {
-		return false;
+void ModelWriter::LayoutDataChunks(const size_t alignment) {
+	size_t offsetBytesAccum = 0;
+	for (DataChunk& chunk : dataChunks) {
+		chunk.byteOffset = alignBytes(offsetBytesAccum, alignment);
+		offsetBytesAccum = chunk.byteOffset + chunk.sizeBytes;
 	}
+}
 
+void ModelWriter::writeJsonHeader(IWriteStream* iws) {
 	root = jvb(JID_MAP);
-	this->model = &modelToWrite;
 
 	GenerateAnimations();
 	GenerateNodeHierarchy();
@@ -403,29 +462,283 @@ bool ModelWriter::write(const Model::Model& modelToWrite, IWriteStream* iws) {
 	// Generate the json that describes the data chunks.
 	JsonValue* const jDataChunkDesc = root->setMember("dataChunksDesc", jvb(JID_ARRAY));
 
-	size_t offsetBytesAccum = 0;
+	LayoutDataChunks(1);
 	for (const DataChunk& chunk : dataChunks) {
 		// Output layout [ ... id, offset, size, ... ]
 		jDataChunkDesc->arrPush(jvb(chunk.id));
-		jDataChunkDesc->arrPush(jvb((int)offsetBytesAccum));
+		jDataChunkDesc->arrPush(jvb((int)chunk.byteOffset));
 		jDataChunkDesc->arrPush(jvb((int)chunk.sizeBytes));
-
-		offsetBytesAccum += chunk.sizeBytes;
 	}
 
 	// Now write the json header.
 	JsonWriter jsonWriter;
 	jsonWriter.write(iws, root, true);
+}
+
+void ModelWriter::WriteBinaryParamBlock(const ParameterBlock& paramBlock, BinaryTables& tables) {
+	for (const auto& itr : paramBlock) {
+		const Parameter& param = itr.second;
+
+		Model::MdlParameter mdlParam = {};
+		mdlParam.name = tables.addString(itr.first);
+		mdlParam.type = tables.addString(ParameterType::info(param.GetType()).name);
+		mdlParam.staticString = Model::kMdlNoString;
+
+		if (param.GetType() == ParameterType::String) {
+			mdlParam.staticString = tables.addString((const char*)param.GetStaticValue());
+		} else if (param.GetType() < ParameterType::NumParams) {
+			memcpy(mdlParam.staticValue, param.GetStaticValue(), ParameterType::SizeBytes(param.GetType()));
+		} else {
+			sgeAssert(false && "Unknown parameter type");
+		}
+
+		mdlParam.firstCurve = uint32(tables.curves.size());
+		mdlParam.numCurves = uint32(param.GetNumCurves());
+		for (int iCurve = 0; iCurve < param.GetNumCurves(); ++iCurve) {
+			const ParameterCurve* curve = param.GetCurve(iCurve);
+			sgeAssert(curve->debug_VerifyData());
+
+			Model::MdlCurve mdlCurve;
+			mdlCurve.name = tables.addString(param.GetCurveName(iCurve));
+			mdlCurve.keyframesChunkId = NewChunkFromStdVector(curve->keys);
+			mdlCurve.valuesChunkId = NewChunkFromStdVector(curve->data);
+			tables.curves.push_back(mdlCurve);
+		}
+
+		tables.parameters.push_back(mdlParam);
+	}
+}
+
+void ModelWriter::writeBinaryHeader(IWriteStream* iws) {
+	BinaryTables tables;
+
+	// Animations.
+	for (const Model::AnimationInfo& animation : model->m_animations) {
+		Model::MdlAnimation mdlAnimation;
+		mdlAnimation.curveName = tables.addString(animation.curveName);
+		mdlAnimation.startTime = animation.startTime;
+		mdlAnimation.duration = animation.duration;
+		tables.animations.push_back(mdlAnimation);
+	}
+
+	// Nodes, their parameters, mesh attachments and child nodes.
+	for (const Model::Node* const node : model->m_nodes) {
+		Model::MdlNode mdlNode;
+		mdlNode.id = node->id;
+		mdlNode.name = tables.addString(node->name);
+
+		mdlNode.firstParameter = uint32(tables.parameters.size());
+		WriteBinaryParamBlock(node->paramBlock, tables);
+		mdlNode.numParameters = uint32(tables.parameters.size()) - mdlNode.firstParameter;
+
+		mdlNode.firstMeshAttachment = uint32(tables.meshAttachments.size());
+		mdlNode.numMeshAttachments = uint32(node->meshAttachments.size());
+		for (const Model::MeshAttachment& attachment : node->meshAttachments) {
+			Model::MdlMeshAttachment mdlAttachment;
+			mdlAttachment.meshId = attachment.mesh->id;
+			mdlAttachment.materialId = attachment.material ? attachment.material->id : -1;
+			tables.meshAttachments.push_back(mdlAttachment);
+		}
+
+		mdlNode.firstChildNode = uint32(tables.childNodes.size());
+		mdlNode.numChildNodes = uint32(node->childNodes.size());
+		for (const Model::Node* const childNode : node->childNodes) {
+			tables.childNodes.push_back(childNode->id);
+		}
+
+		tables.nodes.push_back(mdlNode);
+	}
+
+	// Materials.
+	for (const Model::Material* const mtl : model->m_materials) {
+		Model::MdlMaterial mdlMaterial;
+		mdlMaterial.id = mtl->id;
+		mdlMaterial.name = tables.addString(mtl->name);
+		mdlMaterial.firstParameter = uint32(tables.parameters.size());
+		WriteBinaryParamBlock(mtl->paramBlock, tables);
+		mdlMaterial.numParameters = uint32(tables.parameters.size()) - mdlMaterial.firstParameter;
+		tables.materials.push_back(mdlMaterial);
+	}
+
+	// Mesh data, the meshes, their vertex declarations and bones.
+	for (const Model::MeshData* const meshData : model->m_meshesData) {
+		Model::MdlMeshData mdlMeshData;
+		mdlMeshData.vertexDataChunkId = NewChunkFromStdVector(meshData->vertexBufferRaw);
+		mdlMeshData.indexDataChunkId = meshData->indexBufferRaw.empty() ? -1 : NewChunkFromStdVector(meshData->indexBufferRaw);
+		mdlMeshData.firstMesh = uint32(tables.meshes.size());
+		mdlMeshData.numMeshes = uint32(meshData->meshes.size());
+		tables.meshesData.push_back(mdlMeshData);
+
+		for (const Model::Mesh* const mesh : meshData->meshes) {
+			Model::MdlMesh mdlMesh;
+			mdlMesh.id = mesh->id;
+			mdlMesh.name = tables.addString(mesh->name);
+			mdlMesh.primitiveTopology = tables.addString(PrimitiveTopology2String(mesh->primTopo));
+			mdlMesh.vbByteOffset = mesh->vbByteOffset;
+			mdlMesh.ibByteOffset = mesh->ibByteOffset;
+			mdlMesh.ibFormat = Model::kMdlNoString;
+			if (mesh->ibFmt != UniformType::Unknown) {
+				mdlMesh.ibFormat = tables.addString(UnformType2String(mesh->ibFmt));
+			}
+			mdlMesh.numElements = mesh->numElements;
+			mdlMesh.numVertices = mesh->numVertices;
+			mdlMesh.materialId = mesh->pMaterial ? mesh->pMaterial->id : -1;
+
+			mdlMesh.firstVertexDecl = uint32(tables.vertexDecls.size());
+			mdlMesh.numVertexDecls = uint32(mesh->vertexDecl.size());
+			for (const VertexDecl& decl : mesh->vertexDecl) {
+				Model::MdlVertexDecl mdlDecl;
+				mdlDecl.semantic = tables.addString(decl.semantic);
+				mdlDecl.byteOffset = uint32(decl.byteOffset);
+				mdlDecl.format = tables.addString(UnformType2String(decl.format));
+				tables.vertexDecls.push_back(mdlDecl);
+			}
+
+			mdlMesh.firstBone = uint32(tables.bones.size());
+			mdlMesh.numBones = uint32(mesh->bones.size());
+			for (const Model::Bone& bone : mesh->bones) {
+				static_assert(sizeof(bone.offsetMatrix) == sizeof(Model::MdlBone::offsetMatrix), "The offset matrix layout has changed!");
+
+				Model::MdlBone mdlBone;
+				mdlBone.nodeId = bone.node->id;
+				mdlBone.vertexIdsChunkId = NewChunkFromStdVector(bone.vertexIds);
+				mdlBone.weightsChunkId = NewChunkFromStdVector(bone.weights);
+				memcpy(mdlBone.offsetMatrix, &bone.offsetMatrix, sizeof(mdlBone.offsetMatrix));
+				tables.bones.push_back(mdlBone);
+			}
+
+			memcpy(mdlMesh.aaboxMin, mesh->aabox.min.data, sizeof(mdlMesh.aaboxMin));
+			memcpy(mdlMesh.aaboxMax, mesh->aabox.max.data, sizeof(mdlMesh.aaboxMax));
+
+			tables.meshes.push_back(mdlMesh);
+		}
+	}
+
+	// Collision geometry.
+	for (const Model::CollisionMesh& hull : model->m_convexHulls) {
+		tables.convexHulls.push_back({NewChunkFromStdVector(hull.vertices), NewChunkFromStdVector(hull.indices)});
+	}
+
+	for (const Model::CollisionMesh& hull : model->m_concaveHulls) {
+		tables.concaveHulls.push_back({NewChunkFromStdVector(hull.vertices), NewChunkFromStdVector(hull.indices)});
+	}
+
+	const auto newCollisionShape = [&tables](const std::string& name, const transf3d& transform) -> Model::MdlCollisionShape {
+		Model::MdlCollisionShape mdlShape = {};
+		mdlShape.name = tables.addString(name);
+		memcpy(mdlShape.position, transform.p.data, sizeof(mdlShape.position));
+		memcpy(mdlShape.rotation, transform.r.data, sizeof(mdlShape.rotation));
+		memcpy(mdlShape.scaling, transform.s.data, sizeof(mdlShape.scaling));
+		return mdlShape;
+	};
+
+	for (const Model::CollisionShapeBox& shape : model->m_collisionBoxes) {
+		Model::MdlCollisionShape mdlShape = newCollisionShape(shape.name, shape.transform);
+		memcpy(mdlShape.halfDiagonal, shape.halfDiagonal.data, sizeof(mdlShape.halfDiagonal));
+		tables.collisionBoxes.push_back(mdlShape);
+	}
+
+	for (const Model::CollisionShapeCapsule& shape : model->m_collisionCapsules) {
+		Model::MdlCollisionShape mdlShape = newCollisionShape(shape.name, shape.transform);
+		mdlShape.halfHeight = shape.halfHeight;
+		mdlShape.radius = shape.radius;
+		tables.collisionCapsules.push_back(mdlShape);
+	}
+
+	for (const Model::CollisionShapeCylinder& shape : model->m_collisionCylinders) {
+		Model::MdlCollisionShape mdlShape = newCollisionShape(shape.name, shape.transform);
+		memcpy(mdlShape.halfDiagonal, shape.halfDiagonal.data, sizeof(mdlShape.halfDiagonal));
+		tables.collisionCylinders.push_back(mdlShape);
+	}
+
+	for (const Model::CollisionShapeSphere& shape : model->m_collisionSpheres) {
+		Model::MdlCollisionShape mdlShape = newCollisionShape(shape.name, shape.transform);
+		mdlShape.radius = shape.radius;
+		tables.collisionSpheres.push_back(mdlShape);
+	}
+
+	// The data chunks, all of them are known at this point.
+	LayoutDataChunks(Model::kMdlBinaryAlignment);
+	for (const DataChunk& chunk : dataChunks) {
+		sgeAssert(chunk.byteOffset + chunk.sizeBytes <= UINT32_MAX);
+		tables.dataChunks.push_back({chunk.id, uint32(chunk.byteOffset), uint32(chunk.sizeBytes)});
+	}
+
+	// Lay out the tables after the header.
+	Model::MdlBinaryHeader header = {};
+	memcpy(header.magic, Model::kMdlBinaryMagic, sizeof(header.magic));
+	header.version = Model::kMdlBinaryVersion;
+	header.rootNodeId = model->m_rootNode ? model->m_rootNode->id : -1;
+	header.numTables = Model::MdlTable_Count;
+
+	std::vector<char> headerData(alignBytes(sizeof(header), Model::kMdlBinaryAlignment), 0);
+
+	const auto addTable = [&header, &headerData](const Model::MdlTable table, const auto& records) -> void {
+		const size_t recordSizeBytes = sizeof(records[0]);
+		const size_t tableSizeBytes = records.size() * recordSizeBytes;
+
+		header.tables[table].byteOffset = uint32(headerData.size());
+		header.tables[table].numRecords = uint32(records.size());
+		header.tables[table].recordSizeBytes = uint32(recordSizeBytes);
+
+		headerData.resize(alignBytes(headerData.size() + tableSizeBytes, Model::kMdlBinaryAlignment), 0);
+		if (tableSizeBytes != 0) {
+			memcpy(headerData.data() + header.tables[table].byteOffset, records.data(), tableSizeBytes);
+		}
+	};
+
+	addTable(Model::MdlTable_Strings, tables.strings);
+	addTable(Model::MdlTable_DataChunks, tables.dataChunks);
+	addTable(Model::MdlTable_Animations, tables.animations);
+	addTable(Model::MdlTable_Materials, tables.materials);
+	addTable(Model::MdlTable_Parameters, tables.parameters);
+	addTable(Model::MdlTable_Curves, tables.curves);
+	addTable(Model::MdlTable_MeshesData, tables.meshesData);
+	addTable(Model::MdlTable_Meshes, tables.meshes);
+	addTable(Model::MdlTable_VertexDecls, tables.vertexDecls);
+	addTable(Model::MdlTable_Bones, tables.bones);
+	addTable(Model::MdlTable_Nodes, tables.nodes);
+	addTable(Model::MdlTable_MeshAttachments, tables.meshAttachments);
+	addTable(Model::MdlTable_ChildNodes, tables.childNodes);
+	addTable(Model::MdlTable_ConvexHulls, tables.convexHulls);
+	addTable(Model::MdlTable_ConcaveHulls, tables.concaveHulls);
+	addTable(Model::MdlTable_CollisionBoxes, tables.collisionBoxes);
+	addTable(Model::MdlTable_CollisionCapsules, tables.collisionCapsules);
+	addTable(Model::MdlTable_CollisionCylinders, tables.collisionCylinders);
+	addTable(Model::MdlTable_CollisionSpheres, tables.collisionSpheres);
+
+	header.headerSizeBytes = uint32(headerData.size());
+	memcpy(headerData.data(), &header, sizeof(header));
+
+	iws->write(headerData.data(), headerData.size());
+}
+
+bool ModelWriter::write(const Model::Model& modelToWrite, IWriteStream* iws, HeaderFormat headerFormat) {
+	if (iws == nullptr) {
+		return false;
+	}
+
+	this->model = &modelToWrite;
+	dataChunks.clear();
+
+	if (headerFormat == HeaderFormat_Binary) {
+		writeBinaryHeader(iws);
+	} else {
+		writeJsonHeader(iws);
+	}
 
-	// And now write the data chunks data.
+	// And now write the data chunks data, at the offsets specified in the header.
+	size_t offsetBytes = 0;
 	for (const DataChunk& chunk : dataChunks) {
+		writePadding(iws, chunk.byteOffset - offsetBytes);
 		iws->write((char*)chunk.data, chunk.sizeBytes);
+		offsetBytes = chunk.byteOffset + chunk.sizeBytes;
 	}
 
 	return true;
 }
 
-bool ModelWriter::write(const Model::Model& modelToWrite, const char* const filename) {
+bool ModelWriter::write(const Model::Model& modelToWrite, const char* const filename, HeaderFormat headerFormat) {
 	if (filename == nullptr) {
 		return false;
 	}
@@ -436,6 +749,6 @@ bool ModelWriter::write(const Model::Model& modelToWrite, const char* const file
 		return false;
 	}
 
-	return write(modelToWrite, &fws);
+	return write(modelToWrite, &fws, headerFormat);
 }
 } // namespace sge
@@ -24,15 +24,33 @@ class SGE_CORE_API ModelWriter {
 		int id;
 		const void* data;
 		size_t sizeBytes;
+		size_t byteOffset = 0; // The offset from the beginning of the data chunks, see LayoutDataChunks().
+	};
+
+	/// The format of the file header, see ModelBinaryFormat.h. Both are supported by ModelReader.
+	enum HeaderFormat {
+		HeaderFormat_Binary, // Fixed-size tables that are loaded without parsing.
+		HeaderFormat_Json,   // The legacy human readable header, useful for debugging.
 	};
 
 	ModelWriter() {}
 	~ModelWriter() {}
 
-	bool write(const Model::Model& modelToWrite, IWriteStream* iws);
-	bool write(const Model::Model& modelToWrite, const char* const filename);
+	bool write(const Model::Model& modelToWrite, IWriteStream* iws, HeaderFormat headerFormat = HeaderFormat_Binary);
+	bool write(const Model::Model& modelToWrite, const char* const filename, HeaderFormat headerFormat = HeaderFormat_Binary);
 
   private:
+	struct BinaryTables;
+
+	void writeJsonHeader(IWriteStream* iws);
+	void writeBinaryHeader(IWriteStream* iws);
+
+	// Adds the parameters of the block (and their curves) to the end of the binary tables, and adds the data chunks.
+	void WriteBinaryParamBlock(const ParameterBlock& paramBlock, BinaryTables& tables);
+
+	// Computes DataChunk::byteOffset of all data chunks.
+	void LayoutDataChunks(const size_t alignment);
+
 	// Returns the chunk id.
 	int NewChunkFromPtr(const void* const ptr, const size_t sizeBytes);
 
@@ -0,0 +1,85 @@
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "Model.h"
+#include "NodeRemap.h"
+
+namespace sge {
+namespace Model {
+
+	namespace {
+		std::mutex g_nodeRemapsMutex;
+		std::map<std::pair<const Model*, const Model*>, std::shared_ptr<const NodeRemap>> g_nodeRemaps;
+
+		std::shared_ptr<const NodeRemap> buildNodeRemap(const Model& target, const Model& source) {
+			std::shared_ptr<NodeRemap> remap = std::make_shared<NodeRemap>();
+			remap->targetRevision = target.m_revision;
+			remap->sourceRevision = source.m_revision;
+			remap->sourceNodeIndices.resize(target.m_nodes.size(), -1);
+
+			if (&target == &source) {
+				for (int iNode = 0; iNode < int(target.m_nodes.size()); ++iNode) {
+					remap->sourceNodeIndices[iNode] = iNode;
+				}
+				return remap;
+			}
+
+			// CAUTION: Currently the retargeting is mapping node-to-node using names.
+			// This is highly unreliable as there may be multiple nodes with the same name in a single model.
+			// A possible fix is to search these nodes using the hierarchy
+			// for example if we are looking for a node named "hand":
+			// "upper_torso|left_arm|hand".
+			// If there are multiple nodes with the same name, the first one is used.
+			std::unordered_map<std::string, int> sourceNodeIndicesByName;
+			sourceNodeIndicesByName.reserve(source.m_nodes.size());
+			for (int iSourceNode = 0; iSourceNode < int(source.m_nodes.size()); ++iSourceNode) {
+				sourceNodeIndicesByName.emplace(source.m_nodes[iSourceNode]->name, iSourceNode);
+			}
+
+			for (int iNode = 0; iNode < int(target.m_nodes.size()); ++iNode) {
+				auto itr = sourceNodeIndicesByName.find(target.m_nodes[iNode]->name);
+				if (itr != sourceNodeIndicesByName.end()) {
+					remap->sourceNodeIndices[iNode] = itr->second;
+				}
+			}
+
+			return remap;
+		}
+	} // namespace
+
+	bool NodeRemap::isUpToDate(const Model& target, const Model& source) const {
+		return targetRevision == target.m_revision && sourceRevision == source.m_revision &&
+		       sourceNodeIndices.size() == target.m_nodes.size();
+	}
+
+	std::shared_ptr<const NodeRemap> findNodeRemap(const Model& target, const Model& source) {
+		const std::lock_guard<std::mutex> lock(g_nodeRemapsMutex);
+
+		std::shared_ptr<const NodeRemap>& remap = g_nodeRemaps[std::make_pair(&target, &source)];
+		if (!remap || !remap->isUpToDate(target, source)) {
+			remap = buildNodeRemap(target, source);
+		}
+
+		return remap;
+	}
+
+	void invalidateNodeRemaps(const Model& model) {
+		const std::lock_guard<std::mutex> lock(g_nodeRemapsMutex);
+
+		// Every model calls this when destroyed, most of them never used any remap tables.
+		if (g_nodeRemaps.empty()) {
+			return;
+		}
+
+		for (auto itr = g_nodeRemaps.begin(); itr != g_nodeRemaps.end();) {
+			if (itr->first.first == &model || itr->first.second == &model) {
+				itr = g_nodeRemaps.erase(itr);
+			} else {
+				++itr;
+			}
+		}
+	}
+
+} // namespace Model
+} // namespace sge
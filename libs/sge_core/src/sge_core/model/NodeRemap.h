@@ -0,0 +1,37 @@
+#pragma once
+
+#include "sge_core/sgecore_api.h"
+#include "sge_utils/sge_utils.h"
+#include <memory>
+#include <vector>
+
+namespace sge {
+namespace Model {
+
+	struct Model;
+
+	/// Maps the nodes of a target model to the nodes of a source model, used when a model gets animated with the animations
+	/// of another model. The nodes are matched by name once, when the table is built, so evaluating with it needs no string work.
+	struct SGE_CORE_API NodeRemap {
+		/// Returns true if the table was built for the current nodes of the models, see Model::m_revision.
+		bool isUpToDate(const Model& target, const Model& source) const;
+
+	  public:
+		uint32 targetRevision = 0;
+		uint32 sourceRevision = 0;
+
+		/// The index of the node in the source model for every node in the target model, -1 if missing.
+		std::vector<int> sourceNodeIndices;
+	};
+
+	/// Returns the remap table of the specified models. The tables are shared between all users of the same pair of models,
+	/// they get built on the first request and rebuilt when one of the models changes its nodes (for example when reloaded).
+	/// Thread safe.
+	SGE_CORE_API std::shared_ptr<const NodeRemap> findNodeRemap(const Model& target, const Model& source);
+
+	/// Drops all cached remap tables involving the specified model. Called when the model gets unloaded or destroyed.
+	/// The users already holding a table can keep using it until they notice it is out of date.
+	SGE_CORE_API void invalidateNodeRemaps(const Model& model);
+
+} // namespace Model
+} // namespace sge
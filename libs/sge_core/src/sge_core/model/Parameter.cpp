@@ -56,7 +56,32 @@ bool ParameterCurve::Add(float key, const void* const value) {
 	return true;
 }
 
-bool ParameterCurve::Evaluate(float time, void* dest) const {
+int findKeyIndex(const float* const keyTimes, const int numKeys, const float time, int& keyCursor) {
+	// The number of keys the cursor may advance before falling back to binary search.
+	const int kMaxLinearSteps = 4;
+
+	int keyIdx = keyCursor;
+	if (keyIdx >= 0 && keyIdx <= numKeys && (keyIdx == 0 || keyTimes[keyIdx - 1] < time)) {
+		for (int iStep = 0; keyIdx < numKeys && keyTimes[keyIdx] < time; ++iStep) {
+			if (iStep == kMaxLinearSteps) {
+				keyIdx = -1;
+				break;
+			}
+			++keyIdx;
+		}
+	} else {
+		keyIdx = -1;
+	}
+
+	if (keyIdx < 0) {
+		keyIdx = int(std::lower_bound(keyTimes, keyTimes + numKeys, time) - keyTimes);
+	}
+
+	keyCursor = keyIdx;
+	return keyIdx;
+}
+
+bool ParameterCurve::Evaluate(float time, void* dest, int* keyCursor) const {
 	if (type == ParameterType::String) {
 		// String parameters are not animatable currently.
 		return false;
@@ -69,21 +94,12 @@ bool ParameterCurve::Evaluate(float time, void* dest) const {
 
 	const int dataSize = ParameterType::SizeBytes(type);
 
-#if 0
-	// Find the 1st larger element we interpolate will in [keyIdx-1, keyIdx] interval.
-	// [TODO] Implement a better than linear search here.
-	int keyIdx = keys.size();
-
-	for(int t = 0; t < (int)keys.size(); ++t) {
-		if(keys[t] >= time) {
-			keyIdx = t;
-			break;
-		}
+	int keyIdx;
+	if (keyCursor != nullptr) {
+		keyIdx = findKeyIndex(keys.data(), int(keys.size()), time, *keyCursor);
+	} else {
+		keyIdx = int(std::lower_bound(keys.begin(), keys.end(), time) - keys.begin());
 	}
-#else
-	const auto itr = std::lower_bound(keys.begin(), keys.end(), time);
-	int keyIdx = int(itr - keys.begin());
-#endif
 
 	if (keyIdx == 0) {
 		// The requested evaluation time is before the 1st keyframe.
@@ -60,6 +60,12 @@ struct SGE_CORE_API ParameterType {
 	virtual void operator()() = 0;
 };
 
+/// Returns the index of the 1st key with time not less than @time, as std::lower_bound would.
+/// @keyCursor should be the result of the previous search in the same keys. The search starts from it and moves forward,
+/// which is amortized O(1) for animations played forward frame after frame. When the time jumps too far (seeking, looping)
+/// a binary search is used. The result is also stored in @keyCursor. Use -1 if there is no previous search.
+SGE_CORE_API int findKeyIndex(const float* keyTimes, int numKeys, float time, int& keyCursor);
+
 struct SGE_CORE_API ParameterCurve {
 	ParameterType::Enum type;
 	std::vector<float> keys;
@@ -76,7 +82,9 @@ struct SGE_CORE_API ParameterCurve {
 	bool TAdd(float key, const T& v) {
 		return Add(key, (void*)&v);
 	}
-	bool Evaluate(float key, void* dest) const;
+	/// Evaluates the curve at the specified time.
+	/// @keyCursor is an optional cursor of the key search, kept between evaluations by the caller, see findKeyIndex().
+	bool Evaluate(float key, void* dest, int* keyCursor = nullptr) const;
 
 	bool debug_VerifyData() const;
 };
@@ -19,16 +19,28 @@ using namespace sge;
 //-----------------------------------------------------------------------------
 void ConstantColorShader::drawGeometry(
     const RenderDestination& rdest, const mat4f& projView, const mat4f& world, const Geometry& geometry, const vec4f& shadingColor) {
+	enum : int {
+		OPT_Skinned,
+	};
+
 	enum : int {
 		uColor,
 		uWorld,
 		uProjView,
+		uSkinningBones,
 	};
 
 	if (shadingPermut.isValid() == false) {
 		shadingPermut = ShadingProgramPermuator();
 
-		static const std::vector<OptionPermuataor::OptionDesc> compileTimeOptions = {};
+		static const std::vector<OptionPermuataor::OptionDesc> compileTimeOptions = {
+#if !defined(__EMSCRIPTEN__)
+		    {OPT_Skinned, "OPT_Skinned", {"0", "1"}},
+#else
+		    // GLES targets skin on the CPU.
+		    {OPT_Skinned, "OPT_Skinned", {"0"}},
+#endif
+		};
 
 		// clang-format off
 		// Caution: It is important that the order of the elements here MATCHES the order in the enum above.
@@ -36,6 +48,7 @@ void ConstantColorShader::drawGeometry(
 		    {uColor, "uColor"},
 		    {uWorld, "uWorld"},
 		    {uProjView, "uProjView"},
+		    {uSkinningBones, "uSkinningBones"},
 		};
 		// clang-format on
 
@@ -43,7 +56,11 @@ void ConstantColorShader::drawGeometry(
 		shadingPermut->createFromFile(sgedev, "core_shaders/ConstantColor.shader", compileTimeOptions, uniformsToCache);
 	}
 
-	const int iShaderPerm = shadingPermut->getCompileTimeOptionsPerm().computePermutationIndex(nullptr, 0);
+	const OptionPermuataor::OptionChoice optionChoice[] = {
+	    {OPT_Skinned, geometry.skinningBones != nullptr ? 1 : 0},
+	};
+
+	const int iShaderPerm = shadingPermut->getCompileTimeOptionsPerm().computePermutationIndex(optionChoice, SGE_ARRSZ(optionChoice));
 	const ShadingProgramPermuator::Permutation& shaderPerm = shadingPermut->getShadersPerPerm()[iShaderPerm];
 
 	DrawCall dc;
@@ -51,6 +68,7 @@ void ConstantColorShader::drawGeometry(
 	stateGroup.setProgram(shaderPerm.shadingProgram.GetPtr());
 	stateGroup.setVBDeclIndex(geometry.vertexDeclIndex);
 	stateGroup.setVB(0, geometry.vertexBuffer, uint32(geometry.vbByteOffset), geometry.stride);
+	stateGroup.setVB(2, geometry.skinningVertexBuffer, 0, geometry.skinningVertexBuffer ? sizeof(SkinningVertex) : 0);
 	stateGroup.setPrimitiveTopology(geometry.topology);
 	if (geometry.ibFmt != UniformType::Unknown) {
 		stateGroup.setIB(geometry.indexBuffer, geometry.ibFmt, geometry.ibByteOffset);
@@ -68,6 +86,9 @@ void ConstantColorShader::drawGeometry(
 	shaderPerm.bind<24>(uniforms, uWorld, (void*)&world);
 	shaderPerm.bind<24>(uniforms, uProjView, (void*)&projView);
 	shaderPerm.bind<24>(uniforms, uColor, (void*)&shadingColor);
+	if (geometry.skinningBones != nullptr) {
+		shaderPerm.bind<24>(uniforms, uSkinningBones, (void*)geometry.skinningBones);
+	}
 
 	// Lights and draw call.
 	dc.setUniforms(uniforms.data(), uniforms.size());
@@ -85,7 +106,7 @@ void ConstantColorShader::drawGeometry(
 void ConstantColorShader::draw(
     const RenderDestination& rdest, const mat4f& projView, const mat4f& preRoot, const EvaluatedModel& model, const vec4f& shadingColor) {
 	for (int iNode = 0; iNode < model.m_nodes.size(); ++iNode) {
-		const EvaluatedNode& evalNode = model.m_nodes.valueAtIdx(iNode);
+		const EvaluatedNode& evalNode = model.m_nodes[iNode];
 
 		for (int iMesh = 0; iMesh < evalNode.attachedMeshes.size(); ++iMesh) {
 			const EvaluatedMeshAttachment& meshAttachment = evalNode.attachedMeshes[iMesh];
@@ -14,9 +14,113 @@
 
 using namespace sge;
 
+static_assert(Model::kMaxGpuSkinningBones == kMaxSkinningBones, "The C++ and the shaders must agree on the number of skinning bones");
+
+namespace {
+/// The compile time options of FWDDefault_shading.shader needed for drawing a geometry with some material.
+struct FWDShadingOptions {
+	int optUseNormalMap = 0;
+	int optDiffuseColorSrc = kDiffuseColorSrcConstant;
+	int optLighting = kLightingShaded;
+	int optSkinned = 0;
+};
+
+FWDShadingOptions
+    computeFWDShadingOptions(SGEDevice* const sgedev, const Geometry* geometry, const Material& material, const InstanceDrawMods& mods) {
+	FWDShadingOptions options;
+
+	const std::vector<VertexDecl>& vertexDecl = sgedev->getVertexDeclFromIndex(geometry->vertexDeclIndex);
+
+	if (material.special == Material::special_none) {
+		if (!material.diffuseTexture) {
+			bool hasVertexColor = false;
+			for (const VertexDecl& decl : vertexDecl) {
+				if (decl.semantic == "a_color") {
+					hasVertexColor = true;
+					break;
+				}
+			}
+			if (hasVertexColor) {
+				options.optDiffuseColorSrc = kDiffuseColorSrcVertex;
+			}
+		}
+		if (material.diffuseTexture)
+			options.optDiffuseColorSrc = kDiffuseColorSrcTexture;
+		if (material.diffuseTextureX && material.diffuseTextureY && material.diffuseTextureZ) {
+			options.optDiffuseColorSrc = kDiffuseColorSrcTriplanarTex;
+		}
+	} else if (material.special == Material::special_fluid) {
+		options.optDiffuseColorSrc = kDiffuseColorSrcFluid;
+	}
+
+	options.optLighting = (mods.forceNoLighting ? kLightingForceNoLighting : kLightingShaded);
+	options.optUseNormalMap = !!(geometry->vertexDeclHasTangentSpace && material.texNormalMap);
+	options.optSkinned = geometry->skinningBones != nullptr ? 1 : 0;
+
+	return options;
+}
+} // namespace
+
 //-----------------------------------------------------------------------------
 // BasicModelDraw
 //-----------------------------------------------------------------------------
+int BasicModelDraw::computeShadingPermutationKey(SGEDevice* const sgedev,
+                                                 const GeneralDrawMod& generalMods,
+                                                 const Geometry* geometry,
+                                                 const Material& material,
+                                                 const InstanceDrawMods& mods) const {
+	if (generalMods.isRenderingShadowMap) {
+		// The shadow map shaders depend only on the skinning and on the type of the light, which is the same for the whole shadow map.
+		return geometry->skinningBones != nullptr ? 1 : 0;
+	}
+
+	const FWDShadingOptions options = computeFWDShadingOptions(sgedev, geometry, material, mods);
+	return options.optUseNormalMap | (options.optDiffuseColorSrc << 1) | (options.optLighting << 4) | (options.optSkinned << 6);
+}
+
+Material BasicModelDraw::getMeshMaterial(const EvaluatedMeshAttachment& meshAttachment,
+                                         const std::vector<MaterialOverride>* mtlOverrides) const {
+	Material material;
+
+	if (meshAttachment.pMaterial) {
+		auto itr = mtlOverrides ? std::find_if(mtlOverrides->begin(), mtlOverrides->end(),
+		                                       [&meshAttachment](const MaterialOverride& v) -> bool {
+			                                       return v.name == meshAttachment.pMaterial->name;
+		                                       })
+		                        : std::vector<MaterialOverride>::const_iterator();
+
+		if (!mtlOverrides || itr == mtlOverrides->end()) {
+			material.diffuseColor = meshAttachment.pMaterial->diffuseColor;
+			material.metalness = meshAttachment.pMaterial->metallic;
+			material.roughness = meshAttachment.pMaterial->roughness;
+
+			material.diffuseTexture =
+			    isAssetLoaded(meshAttachment.pMaterial->diffuseTexture) && meshAttachment.pMaterial->diffuseTexture->asTextureView()
+			        ? meshAttachment.pMaterial->diffuseTexture->asTextureView()->GetPtr()
+			        : nullptr;
+
+			material.texNormalMap =
+			    isAssetLoaded(meshAttachment.pMaterial->texNormalMap) && meshAttachment.pMaterial->texNormalMap->asTextureView()
+			        ? meshAttachment.pMaterial->texNormalMap->asTextureView()->GetPtr()
+			        : nullptr;
+
+			material.texMetalness =
+			    isAssetLoaded(meshAttachment.pMaterial->texMetallic) && meshAttachment.pMaterial->texMetallic->asTextureView()
+			        ? meshAttachment.pMaterial->texMetallic->asTextureView()->GetPtr()
+			        : nullptr;
+
+			material.texRoughness =
+			    isAssetLoaded(meshAttachment.pMaterial->texRoughness) && meshAttachment.pMaterial->texRoughness->asTextureView()
+			        ? meshAttachment.pMaterial->texRoughness->asTextureView()->GetPtr()
+			        : nullptr;
+		} else {
+			material = itr->mtl;
+		}
+	}
+
+	return material;
+}
+
 void BasicModelDraw::drawGeometry(const RenderDestination& rdest,
                                   const vec3f& camPos,
                                   const vec3f& camLookDir,
@@ -27,12 +131,51 @@ void BasicModelDraw::drawGeometry(const RenderDestination& rdest,
                                   const Material& material,
                                   const InstanceDrawMods& mods) {
 	if (generalMods.isRenderingShadowMap) {
-		drawGeometry_FWDBuildShadowMap(rdest, camPos, camLookDir, projView, world, generalMods, geometry, material, mods);
+		drawGeometry_FWDBuildShadowMap(rdest, camPos, camLookDir, projView, world, generalMods, geometry, material, mods, nullptr);
 	} else {
-		drawGeometry_FWDShading(rdest, camPos, camLookDir, projView, world, generalMods, geometry, material, mods);
+		drawGeometry_FWDShading(rdest, camPos, camLookDir, projView, world, generalMods, geometry, material, mods, nullptr);
 	}
 }
 
+void BasicModelDraw::drawGeometryInstanced(const RenderDestination& rdest,
+                                           const vec3f& camPos,
+                                           const vec3f& camLookDir,
+                                           const mat4f& projView,
+                                           const GeneralDrawMod& generalMods,
+                                           const Geometry* geometry,
+                                           const Material& material,
+                                           const InstanceDrawMods& mods,
+                                           const InstancedDrawDesc& instances) {
+	sgeAssert(instances.instanceBuffer != nullptr && instances.numInstances > 0);
+
+	// The world transform comes from the instance data.
+	const mat4f world = mat4f::getIdentity();
+	if (generalMods.isRenderingShadowMap) {
+		drawGeometry_FWDBuildShadowMap(rdest, camPos, camLookDir, projView, world, generalMods, geometry, material, mods, &instances);
+	} else {
+		drawGeometry_FWDShading(rdest, camPos, camLookDir, projView, world, generalMods, geometry, material, mods, &instances);
+	}
+}
+
+VertexDeclIndex BasicModelDraw::getInstancedVertexDeclIndex(SGEDevice* const sgedev, const VertexDeclIndex geometryVertexDeclIndex) {
+	VertexDeclIndex& instancedDeclIndex = instancedVertexDeclIndices[geometryVertexDeclIndex];
+	if (instancedDeclIndex == VertexDeclIndex_Null) {
+		std::vector<VertexDecl> decl = sgedev->getVertexDeclFromIndex(geometryVertexDeclIndex);
+
+		// Semantics must not end with a digit as Direct3D treats it as a semantic index.
+		decl.push_back(VertexDecl(1, "a_instWorldX", UniformType::Float4, 0, 1));
+		decl.push_back(VertexDecl(1, "a_instWorldY", UniformType::Float4, 16, 1));
+		decl.push_back(VertexDecl(1, "a_instWorldZ", UniformType::Float4, 32, 1));
+		decl.push_back(VertexDecl(1, "a_instWorldW", UniformType::Float4, 48, 1));
+		decl.push_back(VertexDecl(1, "a_instTint", UniformType::Float4, 64, 1));
+		static_assert(sizeof(ModelInstanceData) == 80, "The vertex declaration above must match ModelInstanceData");
+
+		instancedDeclIndex = sgedev->getVertexDeclIndex(decl.data(), int(decl.size()));
+	}
+
+	return instancedDeclIndex;
+}
+
 
 void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rdest,
                                                     const vec3f& camPos,
@@ -42,12 +185,15 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
                                                     const GeneralDrawMod& generalMods,
                                                     const Geometry* geometry,
                                                     const Material& UNUSED(material),
-                                                    const InstanceDrawMods& mods) {
+                                                    const InstanceDrawMods& mods,
+                                                    const InstancedDrawDesc* instances) {
 	enum {
 		OPT_LightType,
+		OPT_Instanced,
+		OPT_Skinned,
 	};
 
-	enum : int { uWorld, uProjView, uPointLightPositionWs, uPointLightFarPlaneDistance };
+	enum : int { uWorld, uProjView, uPointLightPositionWs, uPointLightFarPlaneDistance, uSkinningBones };
 
 	if (shadingPermutFWDBuildShadowMaps.isValid() == false) {
 		shadingPermutFWDBuildShadowMaps = ShadingProgramPermuator();
@@ -56,6 +202,13 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
 		    {OPT_LightType,
 		     "OPT_LightType",
 		     {SGE_MACRO_STR(FWDDBSM_OPT_LightType_SpotOrDirectional), SGE_MACRO_STR(FWDDBSM_OPT_LightType_Point)}},
+		    {OPT_Instanced, "OPT_Instanced", {"0", "1"}},
+#if !defined(__EMSCRIPTEN__)
+		    {OPT_Skinned, "OPT_Skinned", {"0", "1"}},
+#else
+		    // GLES targets skin on the CPU.
+		    {OPT_Skinned, "OPT_Skinned", {"0"}},
+#endif
 		};
 
 		static const std::vector<ShadingProgramPermuator::Unform> uniformsToCache = {
@@ -63,6 +216,7 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
 		    {uProjView, "projView"},
 		    {uPointLightPositionWs, "uPointLightPositionWs"},
 		    {uPointLightFarPlaneDistance, "uPointLightFarPlaneDistance"},
+		    {uSkinningBones, "uSkinningBones"},
 		};
 
 		SGEDevice* const sgedev = rdest.getDevice();
@@ -72,6 +226,8 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
 
 	const OptionPermuataor::OptionChoice optionChoice[] = {
 	    {OPT_LightType, generalMods.isShadowMapForPointLight ? FWDDBSM_OPT_LightType_Point : FWDDBSM_OPT_LightType_SpotOrDirectional},
+	    {OPT_Instanced, instances != nullptr ? 1 : 0},
+	    {OPT_Skinned, geometry->skinningBones != nullptr ? 1 : 0},
 	};
 
 	const int iShaderPerm =
@@ -89,11 +245,22 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
 		shaderPerm.bind<8>(uniforms, uPointLightFarPlaneDistance, (void*)&generalMods.shadowMapPointLightDepthRange);
 	}
 
+	if (geometry->skinningBones != nullptr) {
+		shaderPerm.bind<8>(uniforms, uSkinningBones, (void*)geometry->skinningBones);
+	}
+
 	// Feed the draw call data to the state group.
 	stateGroup.setProgram(shaderPerm.shadingProgram.GetPtr());
 	stateGroup.setPrimitiveTopology(PrimitiveTopology::TriangleList);
-	stateGroup.setVBDeclIndex(geometry->vertexDeclIndex);
 	stateGroup.setVB(0, geometry->vertexBuffer, uint32(geometry->vbByteOffset), geometry->stride);
+	if (instances != nullptr) {
+		stateGroup.setVBDeclIndex(getInstancedVertexDeclIndex(rdest.getDevice(), geometry->vertexDeclIndex));
+		stateGroup.setVB(1, instances->instanceBuffer, instances->byteOffset, sizeof(ModelInstanceData));
+	} else {
+		stateGroup.setVBDeclIndex(geometry->vertexDeclIndex);
+		stateGroup.setVB(1, nullptr, 0, 0);
+	}
+	stateGroup.setVB(2, geometry->skinningVertexBuffer, 0, geometry->skinningVertexBuffer ? sizeof(SkinningVertex) : 0);
 
 	RasterizerState* rasterState = nullptr;
 	if (mods.forceNoCulling) {
@@ -103,7 +270,7 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
 		// *opposing to the regular rendering which uses front faces... duh).
 		// This is done to avoid the Shadow Acne artifacts caused by floating point
 		// innacuraties introduced by the depth texture.
-		bool flipCulling = determinant(world) > 0.f;
+		bool flipCulling = (instances ? instances->worldDeterminant : determinant(world)) > 0.f;
 
 		// Caution: [POINT_LIGHT_SHADOWMAP_TRIANGLE_WINING_FLIP]
 		// Triangle winding would need an aditional flip based on the rendering API.
@@ -126,10 +293,11 @@ void BasicModelDraw::drawGeometry_FWDBuildShadowMap(const RenderDestination& rde
 	dc.setUniforms(uniforms.data(), uniforms.size());
 	dc.setStateGroup(&stateGroup);
 
+	const int numInstances = instances ? instances->numInstances : 1;
 	if (geometry->ibFmt != UniformType::Unknown) {
-		dc.drawIndexed(geometry->numElements, 0, 0);
+		dc.drawIndexed(geometry->numElements, 0, 0, numInstances);
 	} else {
-		dc.draw(geometry->numElements, 0);
+		dc.draw(geometry->numElements, 0, numInstances);
 	}
 
 	// Exexute the draw call.
@@ -144,11 +312,14 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
                                              const GeneralDrawMod& generalMods,
                                              const Geometry* geometry,
                                              const Material& material,
-                                             const InstanceDrawMods& mods) {
+                                             const InstanceDrawMods& mods,
+                                             const InstancedDrawDesc* instances) {
 	enum : int {
 		OPT_UseNormalMap,
 		OPT_DiffuseColorSrc,
 		OPT_Lighting,
+		OPT_Instanced,
+		OPT_Skinned,
 		kNumOptions,
 	};
 
@@ -191,6 +362,16 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		uMetalness,
 		uRoughness,
 		uPBRMtlFlags,
+		uClusterLights,
+		uClusterLightsSampler,
+		uClusterRanges,
+		uClusterRangesSampler,
+		uClusterLightIndices,
+		uClusterLightIndicesSampler,
+		uClusterView,
+		uClusterGrid,
+		uClusterDepthParams,
+		uSkinningBones,
 	};
 
 	if (shadingPermutFWDShading.isValid() == false) {
@@ -199,7 +380,21 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		static const std::vector<OptionPermuataor::OptionDesc> compileTimeOptions = {
 		    {OPT_UseNormalMap, "OPT_UseNormalMap", {"0", "1"}},
 		    {OPT_DiffuseColorSrc, "OPT_DiffuseColorSrc", {"0", "1", "2", "3", "4"}},
+#if !defined(__EMSCRIPTEN__)
+		    {OPT_Lighting,
+		     "OPT_Lighting",
+		     {SGE_MACRO_STR(kLightingShaded), SGE_MACRO_STR(kLightingForceNoLighting), SGE_MACRO_STR(kLightingShadedClustered)}},
+#else
+		    // GLES targets do not support clustered lighting, every light is drawn in a separate pass.
 		    {OPT_Lighting, "OPT_Lighting", {SGE_MACRO_STR(kLightingShaded), SGE_MACRO_STR(kLightingForceNoLighting)}},
+#endif
+		    {OPT_Instanced, "OPT_Instanced", {"0", "1"}},
+#if !defined(__EMSCRIPTEN__)
+		    {OPT_Skinned, "OPT_Skinned", {"0", "1"}},
+#else
+		    // GLES targets skin on the CPU.
+		    {OPT_Skinned, "OPT_Skinned", {"0"}},
+#endif
 		};
 
 		// clang-format off
@@ -244,6 +439,16 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		    {uMetalness, "uMetalness"},
 		    {uRoughness, "uRoughness"},
 		    {uPBRMtlFlags, "uPBRMtlFlags"},
+		    {uClusterLights, "uClusterLights"},
+		    {uClusterLightsSampler, "uClusterLights_sampler"},
+		    {uClusterRanges, "uClusterRanges"},
+		    {uClusterRangesSampler, "uClusterRanges_sampler"},
+		    {uClusterLightIndices, "uClusterLightIndices"},
+		    {uClusterLightIndicesSampler, "uClusterLightIndices_sampler"},
+		    {uClusterView, "uClusterView"},
+		    {uClusterGrid, "uClusterGrid"},
+		    {uClusterDepthParams, "uClusterDepthParams"},
+		    {uSkinningBones, "uSkinningBones"},
 		};
 		// clang-format on
 
@@ -253,39 +458,24 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 
 	SGEDevice* const sgedev = rdest.getDevice();
 
-	const std::vector<VertexDecl>& vertexDecl = sgedev->getVertexDeclFromIndex(geometry->vertexDeclIndex);
-
-	int optDiffuseColorSrc = kDiffuseColorSrcConstant;
-	if (material.special == Material::special_none) {
-		if (!material.diffuseTexture) {
-			bool hasVertexColor = false;
-			for (const VertexDecl& decl : vertexDecl) {
-				if (decl.semantic == "a_color") {
-					hasVertexColor = true;
-					break;
-				}
-			}
-			if (hasVertexColor) {
-				optDiffuseColorSrc = kDiffuseColorSrcVertex;
-			}
-		}
-		if (material.diffuseTexture)
-			optDiffuseColorSrc = kDiffuseColorSrcTexture;
-		if (material.diffuseTextureX && material.diffuseTextureY && material.diffuseTextureZ) {
-			optDiffuseColorSrc = kDiffuseColorSrcTriplanarTex;
-		}
-	} else if (material.special == Material::special_fluid) {
-		optDiffuseColorSrc = kDiffuseColorSrcFluid;
-	}
-
-	const int optLighting = (mods.forceNoLighting ? kLightingForceNoLighting : kLightingShaded);
+	const FWDShadingOptions options = computeFWDShadingOptions(sgedev, geometry, material, mods);
+	const int optDiffuseColorSrc = options.optDiffuseColorSrc;
+	const int optUseNormalMap = options.optUseNormalMap;
 
-	const int optUseNormalMap = !!(geometry->vertexDeclHasTangentSpace && material.texNormalMap);
+#if !defined(__EMSCRIPTEN__)
+	const ClusteredLightingData* const clusteredLighting =
+	    (options.optLighting == kLightingShaded) ? generalMods.clusteredLighting : nullptr;
+#else
+	const ClusteredLightingData* const clusteredLighting = nullptr;
+#endif
+	const int optLighting = clusteredLighting ? kLightingShadedClustered : options.optLighting;
 
 	const OptionPermuataor::OptionChoice optionChoice[kNumOptions] = {
 	    {OPT_UseNormalMap, optUseNormalMap},
 	    {OPT_DiffuseColorSrc, optDiffuseColorSrc},
 	    {OPT_Lighting, optLighting},
+	    {OPT_Instanced, instances != nullptr ? 1 : 0},
+	    {OPT_Skinned, options.optSkinned},
 	};
 
 	const int iShaderPerm =
@@ -295,8 +485,15 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 	DrawCall dc;
 
 	stateGroup.setProgram(shaderPerm.shadingProgram.GetPtr());
-	stateGroup.setVBDeclIndex(geometry->vertexDeclIndex);
 	stateGroup.setVB(0, geometry->vertexBuffer, uint32(geometry->vbByteOffset), geometry->stride);
+	if (instances != nullptr) {
+		stateGroup.setVBDeclIndex(getInstancedVertexDeclIndex(sgedev, geometry->vertexDeclIndex));
+		stateGroup.setVB(1, instances->instanceBuffer, instances->byteOffset, sizeof(ModelInstanceData));
+	} else {
+		stateGroup.setVBDeclIndex(geometry->vertexDeclIndex);
+		stateGroup.setVB(1, nullptr, 0, 0);
+	}
+	stateGroup.setVB(2, geometry->skinningVertexBuffer, 0, geometry->skinningVertexBuffer ? sizeof(SkinningVertex) : 0);
 	stateGroup.setPrimitiveTopology(geometry->topology);
 	if (geometry->ibFmt != UniformType::Unknown) {
 		stateGroup.setIB(geometry->indexBuffer, geometry->ibFmt, geometry->ibByteOffset);
@@ -312,7 +509,7 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		// *opposing to the regular rendering which uses front faces... duh).
 		// This is done to avoid the Shadow Acne artifacts caused by floating point
 		// innacuraties introduced by the depth texture.
-		bool flipCulling = determinant(world) > 0.f;
+		bool flipCulling = (instances ? instances->worldDeterminant : determinant(world)) > 0.f;
 
 		// Caution: [POINT_LIGHT_SHADOWMAP_TRIANGLE_WINING_FLIP]
 		// Triangle winding would need an aditional flip based on the rendering API.
@@ -395,6 +592,10 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 
 	shaderPerm.bind<64>(uniforms, uDarkSpotPositonWs, (void*)&generalMods.darkSpotPosition);
 
+	if (options.optSkinned) {
+		shaderPerm.bind<64>(uniforms, uSkinningBones, (void*)geometry->skinningBones);
+	}
+
 	if (emptyCubeShadowMap.IsResourceValid() == false) {
 		TextureDesc texDesc;
 		texDesc.textureType = UniformType::TextureCube;
@@ -416,15 +617,35 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		sgeAssert(uniforms.back().bindLocation.isNull() == false && uniforms.back().bindLocation.uniformType != 0);
 	}
 
+	// The clustered lights are applied only with the 1st light, the other passes skip them by having no slices.
+	const vec4f skipClusteredLightsGrid(0.f);
+	if (clusteredLighting != nullptr) {
+		shaderPerm.bind<64>(uniforms, uClusterLights, (void*)clusteredLighting->lights);
+		shaderPerm.bind<64>(uniforms, uClusterRanges, (void*)clusteredLighting->clusterRanges);
+		shaderPerm.bind<64>(uniforms, uClusterLightIndices, (void*)clusteredLighting->lightIndices);
+#ifdef SGE_RENDERER_D3D11
+		shaderPerm.bind<64>(uniforms, uClusterLightsSampler, (void*)clusteredLighting->lights->getSamplerState());
+		shaderPerm.bind<64>(uniforms, uClusterRangesSampler, (void*)clusteredLighting->clusterRanges->getSamplerState());
+		shaderPerm.bind<64>(uniforms, uClusterLightIndicesSampler, (void*)clusteredLighting->lightIndices->getSamplerState());
+#endif
+		shaderPerm.bind<64>(uniforms, uClusterView, (void*)&clusteredLighting->view);
+		shaderPerm.bind<64>(uniforms, uClusterDepthParams, (void*)&clusteredLighting->depthParams);
+	}
+
 	// Lights and draw call.
+	const int numInstances = instances ? instances->numInstances : 1;
 	const int preLightsNumUnuforms = uniforms.size();
 	for (int iLight = 0; iLight < generalMods.lightsCount; ++iLight) {
 		const ShadingLightData& shadingLight = *generalMods.ppLightData[iLight];
 		// Delete the uniforms form the previous light.
 		uniforms.resize(preLightsNumUnuforms);
 
+		if (clusteredLighting != nullptr) {
+			shaderPerm.bind<64>(uniforms, uClusterGrid, (iLight == 0) ? (void*)&clusteredLighting->grid : (void*)&skipClusteredLightsGrid);
+		}
+
 		// Do the ambient lighting only with the 1st light.
-		if (optLighting == kLightingShaded) {
+		if (optLighting == kLightingShaded || optLighting == kLightingShadedClustered) {
 			if (iLight == 0) {
 				shaderPerm.bind<64>(uniforms, uAmbientLightColor, (void*)&generalMods.ambientLightColor);
 				shaderPerm.bind<64>(uniforms, uRimLightColorWWidth, (void*)&generalMods.uRimLightColorWWidth);
@@ -469,9 +690,9 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		dc.setStateGroup(&stateGroup);
 
 		if (geometry->ibFmt != UniformType::Unknown) {
-			dc.drawIndexed(geometry->numElements, 0, 0);
+			dc.drawIndexed(geometry->numElements, 0, 0, numInstances);
 		} else {
-			dc.draw(geometry->numElements, 0);
+			dc.draw(geometry->numElements, 0, numInstances);
 		}
 
 		rdest.sgecon->executeDrawCall(dc, rdest.frameTarget, &rdest.viewport);
@@ -481,6 +702,10 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 	// then there were no draw call created. However we need to draw the object
 	// in order for it to affect the z-depth or even get light by the ambient lighting.
 	if (generalMods.lightsCount == 0) {
+		if (clusteredLighting != nullptr) {
+			shaderPerm.bind<64>(uniforms, uClusterGrid, (void*)&clusteredLighting->grid);
+		}
+
 		shaderPerm.bind<64>(uniforms, uAmbientLightColor, (void*)&generalMods.ambientLightColor);
 		shaderPerm.bind<64>(uniforms, uRimLightColorWWidth, (void*)&generalMods.uRimLightColorWWidth);
 
@@ -496,9 +721,9 @@ void BasicModelDraw::drawGeometry_FWDShading(const RenderDestination& rdest,
 		dc.setStateGroup(&stateGroup);
 
 		if (geometry->ibFmt != UniformType::Unknown) {
-			dc.drawIndexed(geometry->numElements, 0, 0);
+			dc.drawIndexed(geometry->numElements, 0, 0, numInstances);
 		} else {
-			dc.draw(geometry->numElements, 0);
+			dc.draw(geometry->numElements, 0, numInstances);
 		}
 
 		rdest.sgecon->executeDrawCall(dc, rdest.frameTarget, &rdest.viewport);
@@ -515,50 +740,14 @@ void BasicModelDraw::draw(const RenderDestination& rdest,
                           const InstanceDrawMods& mods,
                           const std::vector<MaterialOverride>* mtlOverrides) {
 	for (int iNode = 0; iNode < model.m_nodes.size(); ++iNode) {
-		const EvaluatedNode& evalNode = model.m_nodes.valueAtIdx(iNode);
+		const EvaluatedNode& evalNode = model.m_nodes[iNode];
 
 		for (int iMesh = 0; iMesh < evalNode.attachedMeshes.size(); ++iMesh) {
 			const EvaluatedMeshAttachment& meshAttachment = evalNode.attachedMeshes[iMesh];
 			Model::Mesh* const mesh = evalNode.attachedMeshes[iMesh].pMesh->pReferenceMesh;
 			mat4f const finalTrasform = (mesh->bones.size() == 0) ? preRoot * evalNode.evalGlobalTransform : preRoot;
 
-			Material material;
-
-			if (meshAttachment.pMaterial) {
-				auto itr = mtlOverrides ? std::find_if(mtlOverrides->begin(), mtlOverrides->end(),
-				                                       [&meshAttachment](const MaterialOverride& v) -> bool {
-					                                       return v.name == meshAttachment.pMaterial->name;
-				                                       })
-				                        : std::vector<MaterialOverride>::iterator();
-
-				if (!mtlOverrides || itr == mtlOverrides->end()) {
-					material.diffuseColor = meshAttachment.pMaterial->diffuseColor;
-					material.metalness = meshAttachment.pMaterial->metallic;
-					material.roughness = meshAttachment.pMaterial->roughness;
-
-					material.diffuseTexture =
-					    isAssetLoaded(meshAttachment.pMaterial->diffuseTexture) && meshAttachment.pMaterial->diffuseTexture->asTextureView()
-					        ? meshAttachment.pMaterial->diffuseTexture->asTextureView()->GetPtr()
-					        : nullptr;
-
-					material.texNormalMap =
-					    isAssetLoaded(meshAttachment.pMaterial->texNormalMap) && meshAttachment.pMaterial->texNormalMap->asTextureView()
-					        ? meshAttachment.pMaterial->texNormalMap->asTextureView()->GetPtr()
-					        : nullptr;
-
-					material.texMetalness =
-					    isAssetLoaded(meshAttachment.pMaterial->texMetallic) && meshAttachment.pMaterial->texMetallic->asTextureView()
-					        ? meshAttachment.pMaterial->texMetallic->asTextureView()->GetPtr()
-					        : nullptr;
-
-					material.texRoughness =
-					    isAssetLoaded(meshAttachment.pMaterial->texRoughness) && meshAttachment.pMaterial->texRoughness->asTextureView()
-					        ? meshAttachment.pMaterial->texRoughness->asTextureView()->GetPtr()
-					        : nullptr;
-				} else {
-					material = itr->mtl;
-				}
-			}
+			const Material material = getMeshMaterial(meshAttachment, mtlOverrides);
 
 			drawGeometry(rdest, camPos, camLookDir, projView, finalTrasform, generalMods, &meshAttachment.pMesh->geom, material, mods);
 		}
@@ -6,6 +6,7 @@
 #include "sge_utils/math/mat4.h"
 #include "sge_utils/utils/OptionPermutator.h"
 #include "sge_utils/utils/optional.h"
+#include <map>
 
 namespace sge {
 
@@ -39,6 +40,22 @@ struct ShadingLightData {
 	AABox3f lightBoxWs;
 };
 
+/// The unshadowed lights assigned to the clusters (froxels) of the view frustum, used for shading all of them in a single pass.
+/// The clusters are uniform in NDC (x,y) and exponential in the view space depth. The data is built by LightClusters in sge_engine.
+struct ClusteredLightingData {
+	// RGBA32F, a column per light, the rows are: position and type, color and flags, spot direction and cosine, range.
+	Texture* lights = nullptr;
+	// RGBA32F, a texel per cluster, (x,y) are the offset and the count of its lights in @lightIndices.
+	// The texture has a column per (x,y) tile and a row per depth slice.
+	Texture* clusterRanges = nullptr;
+	// R32F, the indices of the lights of all clusters.
+	Texture* lightIndices = nullptr;
+
+	mat4f view = mat4f::getIdentity(); // The view matrix of the camera the clusters are built for.
+	vec4f grid = vec4f(0.f);           // (numTilesX, numTilesY, numSlices, lightIndices width).
+	vec4f depthParams = vec4f(0.f);    // (near, numSlices / log(far / near), lights width, lightIndices height).
+};
+
 //------------------------------------------------------------
 // GeneralDrawMod
 //------------------------------------------------------------
@@ -54,6 +71,10 @@ struct GeneralDrawMod {
 
 	int lightsCount = 0;
 	const ShadingLightData** ppLightData = nullptr;
+
+	// If specified the lights in it are applied in the same pass as the first light in @ppLightData,
+	// these lights should not be in @ppLightData. Ignored if the clustered lighting is not supported by the platform.
+	const ClusteredLightingData* clusteredLighting = nullptr;
 };
 
 struct InstanceDrawMods {
@@ -64,6 +85,22 @@ struct InstanceDrawMods {
 	bool forceNoCulling = false;
 };
 
+/// The per-instance data of instanced draws, stored in a vertex buffer. See BasicModelDraw::drawGeometryInstanced.
+struct ModelInstanceData {
+	vec4f worldColumns[4];  // The columns of the world transform.
+	vec4f diffuseColorTint; // Used instead of Material::diffuseColor.
+};
+
+/// Describes the instances of an instanced draw.
+struct InstancedDrawDesc {
+	Buffer* instanceBuffer = nullptr; // A vertex buffer holding ModelInstanceData for every instance.
+	uint32 byteOffset = 0;            // The byte offset of the first instance in @instanceBuffer.
+	int numInstances = 0;
+	// The determinant of the world transforms, only its sign is used for choosing the culling.
+	// All instances in a single draw must have determinants with the same sign.
+	float worldDeterminant = 1.f;
+};
+
 //------------------------------------------------------------
 // BasicModelDraw
 //------------------------------------------------------------
@@ -91,6 +128,30 @@ struct SGE_CORE_API BasicModelDraw {
 	                  const Material& material,
 	                  const InstanceDrawMods& mods);
 
+	/// Draws multiple instances of the geometry with a single draw call (per light) with the hardware instancing.
+	/// The world transforms and the diffuse color tints of the instances come from the instance buffer,
+	/// the rest of the material, the modifications and the lights are shared between all instances.
+	void drawGeometryInstanced(const RenderDestination& rdest,
+	                           const vec3f& camPos,
+	                           const vec3f& camLookDir,
+	                           const mat4f& projView,
+	                           const GeneralDrawMod& generalMods,
+	                           const Geometry* geometry,
+	                           const Material& material,
+	                           const InstanceDrawMods& mods,
+	                           const InstancedDrawDesc& instances);
+
+	/// Returns the material that draw() would use for the specified mesh.
+	Material getMeshMaterial(const EvaluatedMeshAttachment& meshAttachment, const std::vector<MaterialOverride>* mtlOverrides) const;
+
+	/// Returns a small number (less than 256) identifying the shader permutation that drawGeometry() would use.
+	/// Draws with equal keys use the same shading program. Used for sorting draws to minimize the state changes.
+	int computeShadingPermutationKey(SGEDevice* const sgedev,
+	                                 const GeneralDrawMod& generalMods,
+	                                 const Geometry* geometry,
+	                                 const Material& material,
+	                                 const InstanceDrawMods& mods) const;
+
   private:
 	void drawGeometry_FWDShading(const RenderDestination& rdest,
 	                             const vec3f& camPos,
@@ -100,7 +161,8 @@ struct SGE_CORE_API BasicModelDraw {
 	                             const GeneralDrawMod& generalMods,
 	                             const Geometry* geometry,
 	                             const Material& material,
-	                             const InstanceDrawMods& mods);
+	                             const InstanceDrawMods& mods,
+	                             const InstancedDrawDesc* instances);
 
 	void drawGeometry_FWDBuildShadowMap(const RenderDestination& rdest,
 	                                    const vec3f& camPos,
@@ -110,13 +172,18 @@ struct SGE_CORE_API BasicModelDraw {
 	                                    const GeneralDrawMod& generalMods,
 	                                    const Geometry* geometry,
 	                                    const Material& material,
-	                                    const InstanceDrawMods& mods);
+	                                    const InstanceDrawMods& mods,
+	                                    const InstancedDrawDesc* instances);
+
+	/// Returns the vertex declaration of the geometry extended with ModelInstanceData in the vertex buffer slot 1.
+	VertexDeclIndex getInstancedVertexDeclIndex(SGEDevice* const sgedev, const VertexDeclIndex geometryVertexDeclIndex);
 
   private:
 	bool isInitialized = false;
 	Optional<ShadingProgramPermuator> shadingPermutFWDShading;
 	Optional<ShadingProgramPermuator> shadingPermutFWDBuildShadowMaps;
 	GpuHandle<Texture> emptyCubeShadowMap;
+	std::map<VertexDeclIndex, VertexDeclIndex> instancedVertexDeclIndices;
 	StateGroup stateGroup;
 };
 
@@ -18,6 +18,7 @@ ReflBlock()
 		ReflMember(Actor, m_logicTransform)
 		ReflMember(Actor, m_bindingToParentTransform).addMemberFlag(MFF_NonEditable)
 		ReflMember(Actor, m_bindingIgnoreRotation)
+		ReflMember(Actor, m_isStatic).setPrettyName("Static")
 	;
 }
 // clang-format on
@@ -68,9 +69,19 @@ void Actor::setOrientation(const quatf& r, bool killVelocity) {
 }
 
 void Actor::setTransformEx(const transf3d& newTransform, bool killVelocity, bool recomputeBinding, bool shouldChangeRigidBodyTransform) {
-	transf3d oldTransform = m_logicTransform;
+	setTransformNoPropagation(newTransform, killVelocity, recomputeBinding, shouldChangeRigidBodyTransform);
+
+	// Move all the children (and their children) based on their binding transforms.
+	getWorld()->propagateTransformToDescendants(*this, killVelocity, recomputeBinding);
+}
+
+void Actor::setTransformNoPropagation(const transf3d& newTransform,
+                                      bool killVelocity,
+                                      bool recomputeBinding,
+                                      bool shouldChangeRigidBodyTransform) {
 	m_isTrasformAsMtxValid = false;
 	m_logicTransform = newTransform;
+	m_transformChangeIndex++;
 
 	if (shouldChangeRigidBodyTransform) {
 		TraitRigidBody* const traitRB = getTrait<TraitRigidBody>(this);
@@ -93,25 +104,6 @@ void Actor::setTransformEx(const transf3d& newTransform, bool killVelocity, bool
 			}
 		}
 	}
-
-	const vector_set<ObjectId>* pAllChildren = getWorld()->getChildensOf(getId());
-	if (pAllChildren != nullptr) {
-		sgeAssert(pAllChildren->size() != 0); // The pointer should be null in that case!
-		for (int t = 0; t < pAllChildren->size(); ++t) {
-			Actor* const child = getWorld()->getActorById(pAllChildren->data()[t]);
-			if (child) {
-				transf3d childNewTransformWS;
-				if (child->m_bindingIgnoreRotation) {
-					childNewTransformWS = child->getTransform();
-					childNewTransformWS.p = m_logicTransform.s * child->m_bindingToParentTransform.p + m_logicTransform.p;
-				} else {
-					childNewTransformWS = transf3d::applyBindingTransform(child->m_bindingToParentTransform, m_logicTransform);
-				}
-				child->setTransformEx(childNewTransformWS, killVelocity, recomputeBinding, true);
-				//}
-			}
-		}
-	}
 }
 
 //--------------------------------------------------------------------
@@ -42,11 +42,22 @@ struct SGE_ENGINE_API Actor : public GameObject {
 
 	void setTransformEx(const transf3d& transform, bool killVelocity, bool recomputeBinding, bool shouldChangeRigidBodyTransform);
 
+	/// Same as setTransformEx but the children of the actor are not moved.
+	/// Used by GameWorld::propagateTransformToDescendants when propagating the transforms, you probably want setTransformEx.
+	void setTransformNoPropagation(const transf3d& transform, bool killVelocity, bool recomputeBinding, bool shouldChangeRigidBodyTransform);
+
 	// Returns the aabb in object space. The box may be empty if not applicable.
 	// This is not intended for physics or any game logic.
 	// This should be used for the editor and the rendering.
 	virtual AABox3f getBBoxOS() const = 0;
 
+	/// Static actors are expected to not move during the gameplay.
+	/// The renderer uses that to cache the shadow maps they cast.
+	bool isStatic() const { return m_isStatic; }
+
+	/// Returns a number that is incremented every time the transform of the actor changes.
+	uint32 getTransformChangeIndex() const { return m_transformChangeIndex; }
+
 	virtual int getNumItemsInMode(EditMode const mode) const {
 		if (mode == editMode_actors)
 			return 1;
@@ -87,6 +98,8 @@ struct SGE_ENGINE_API Actor : public GameObject {
 	transf3d m_logicTransform = transf3d::getIdentity();
 	transf3d m_bindingToParentTransform = transf3d::getIdentity();
 	bool m_bindingIgnoreRotation = false;
+	bool m_isStatic = false;
+	uint32 m_transformChangeIndex = 0;
 	mutable mat4f m_trasformAsMtx;
 	mutable bool m_isTrasformAsMtxValid = false;
 };
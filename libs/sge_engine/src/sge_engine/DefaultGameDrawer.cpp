@@ -6,6 +6,7 @@
 #include "sge_engine/GameWorld.h"
 #include "sge_engine/IWorldScript.h"
 #include "sge_engine/Physics.h"
+#include "sge_engine/ShadowCasterCulling.h"
 #include "sge_engine/actors/ABlockingObstacle.h"
 #include "sge_engine/actors/ACRSpline.h"
 #include "sge_engine/actors/ACamera.h"
@@ -25,6 +26,7 @@
 #include "sge_utils/math/Frustum.h"
 #include "sge_utils/math/color.h"
 #include "sge_utils/utils/FileStream.h"
+#include "sge_utils/utils/hash_combine.h"
 
 // Caution:
 // this include is an exception do not include anything else like it.
@@ -40,7 +42,12 @@ static inline const vec4f kSecondarySelectionColor = colorFromIntRgba(245, 158,
 struct AInvisibleRigidObstacle;
 
 void DefaultGameDrawer::prepareForNewFrame() {
+	// The stamps are shared by all drawers, as the models drawn by one of them might get drawn by another.
+	static int s_lastFrameStamp = 0;
+	m_frameStamp = ++s_lastFrameStamp;
+
 	shadingLights.clear();
+	m_renderQueueStats.reset();
 
 	if (m_skySphereVB.IsResourceValid() == false) {
 		m_skySphereVB = getCore()->getDevice()->requestResource<Buffer>();
@@ -61,6 +68,15 @@ void DefaultGameDrawer::prepareForNewFrame() {
 }
 
 void DefaultGameDrawer::updateShadowMaps(const GameDrawSets& drawSets) {
+	// Release the shadow maps of the lights that no longer exist.
+	for (auto itr = perLightShadowFrameTarget.begin(); itr != perLightShadowFrameTarget.end();) {
+		if (getWorld()->getActorById(itr->first) == nullptr) {
+			itr = perLightShadowFrameTarget.erase(itr);
+		} else {
+			++itr;
+		}
+	}
+
 	const std::vector<GameObject*>* const allLights = getWorld()->getObjects(sgeTypeId(ALight));
 	if (allLights == nullptr) {
 		return;
@@ -108,87 +124,55 @@ void DefaultGameDrawer::updateShadowMaps(const GameDrawSets& drawSets) {
 
 		lsi.buildInfo = shadowMapBuildInfoOpt.get();
 
-		// Create the appropriatley sized frame target for the shadow map.
-		if (isPointLight) {
-			// No regular shadow maps are needed so relese them.
-			lsi.frameTarget.Release();
-
-			const int shadowMapWidth = lightDesc.shadowMapRes;
-			const int shadowMapHegiht = lightDesc.shadowMapRes;
-
-
-			const bool shouldCreateNewShadowMapTexture = lsi.pointLightDepthTexture.IsResourceValid() == false ||
-			                                             lsi.pointLightDepthTexture->getDesc().textureType != UniformType::TextureCube ||
-			                                             lsi.pointLightDepthTexture->getDesc().textureCube.width != shadowMapWidth ||
-			                                             lsi.pointLightDepthTexture->getDesc().textureCube.height != shadowMapHegiht;
-
-			if (shouldCreateNewShadowMapTexture) {
-				TextureDesc texDesc;
-				texDesc.textureType = UniformType::TextureCube;
-				texDesc.format = TextureFormat::D24_UNORM_S8_UINT;
-				texDesc.usage = TextureUsage::DepthStencilResource;
-				texDesc.textureCube.width = shadowMapWidth;
-				texDesc.textureCube.height = shadowMapHegiht;
-				texDesc.textureCube.arraySize = 1;
-				texDesc.textureCube.numMips = 1;
-				texDesc.textureCube.sampleQuality = 0;
-				texDesc.textureCube.numSamples = 1;
+		// Find the casters that could be seen by the light, only these are going to be drawn in its shadow map.
+		gatherShadowCasters(*light, lsi.buildInfo, lsi);
 
-				lsi.pointLightDepthTexture = getCore()->getDevice()->requestResource<Texture>();
-				[[maybe_unused]] const bool succeeded = lsi.pointLightDepthTexture->create(texDesc, nullptr);
-				sgeAssert(succeeded);
-
-
-				for (int iSignedAxis = 0; iSignedAxis < SGE_ARRSZ(lsi.pointLightFrameTargets); ++iSignedAxis) {
-					// Destroy the prevously existing frame target for the face.
-					lsi.pointLightFrameTargets[iSignedAxis].Release();
-
-					// Create the new one.
-					GpuHandle<FrameTarget>& faceFrameTarget = lsi.pointLightFrameTargets[iSignedAxis];
-					faceFrameTarget = getCore()->getDevice()->requestResource<FrameTarget>();
+		// Find if the static casters of the light have changed since the static shadow map was rendered
+		// and if there are any dynamic casters that need to be drawn on top of it.
+		bool hasDynamicCasters = false;
+		const uint64 staticCastersHash = computeStaticShadowCastersHash(*light, lsi.buildInfo, hasDynamicCasters);
 
-					TargetDesc faceTargetDesc;
-					faceTargetDesc.baseTextureType = UniformType::TextureCube;
-					faceTargetDesc.textureCube.face = SignedAxis(iSignedAxis);
-					faceTargetDesc.textureCube.mipLevel = 0;
+		lsi.hasDynamicCasters = hasDynamicCasters;
 
-					[[maybe_unused]] const bool targetSucceeded =
-					    faceFrameTarget->create(0, nullptr, nullptr, lsi.pointLightDepthTexture, faceTargetDesc);
+		// Create the appropriatley sized frame targets for the shadow map.
+		const int shadowMapRes = lightDesc.shadowMapRes;
+		if (isPointLight) {
+			// No regular shadow maps are needed so relese them.
+			lsi.frameTarget.Release();
+			lsi.staticFrameTarget.Release();
 
-					sgeAssert(targetSucceeded);
-				}
+			if (createPointLightShadowMap(lsi.staticPointLightDepthTexture, lsi.staticPointLightFrameTargets, shadowMapRes)) {
+				lsi.isStaticShadowMapValid = false;
 			}
 
+			// The final shadow map is needed only if there are dynamic casters, otherwise the static one is used directly.
+			if (hasDynamicCasters) {
+				createPointLightShadowMap(lsi.pointLightDepthTexture, lsi.pointLightFrameTargets, shadowMapRes);
+			}
 		} else {
 			// No point light frame targets are going to be needed so release them.
 			for (int t = 0; t < SGE_ARRSZ(lsi.pointLightFrameTargets); ++t) {
 				lsi.pointLightFrameTargets[t].Release();
+				lsi.staticPointLightFrameTargets[t].Release();
 			}
 
 			lsi.pointLightDepthTexture.Release();
+			lsi.staticPointLightDepthTexture.Release();
 
-			// Create the shadow map frame target (with texture) for the shadow map.
-			const int shadowMapWidth = lightDesc.shadowMapRes;
-			const int shadowMapHegiht = lightDesc.shadowMapRes;
-
-			GpuHandle<FrameTarget>& shadowFrameTarget = lsi.frameTarget;
-
-			const bool shouldCreateNewShadowMapTexture = shadowFrameTarget.IsResourceValid() == false ||
-			                                             shadowFrameTarget->getWidth() != shadowMapWidth ||
-			                                             shadowFrameTarget->getHeight() != shadowMapHegiht;
+			if (createShadowMap(lsi.staticFrameTarget, shadowMapRes)) {
+				lsi.isStaticShadowMapValid = false;
+			}
 
-			if (shouldCreateNewShadowMapTexture) {
-				// Caution, TODO: On Safari (the web browser) I've read that it needs a color render target.
-				// Keep that in mind when testing and developing.
-				shadowFrameTarget = getCore()->getDevice()->requestResource<FrameTarget>();
-				shadowFrameTarget->create2D(shadowMapWidth, shadowMapHegiht, TextureFormat::Unknown, TextureFormat::D24_UNORM_S8_UINT);
+			if (hasDynamicCasters) {
+				createShadowMap(lsi.frameTarget, shadowMapRes);
 			}
 		}
 
+		const bool needsStaticShadowMapUpdate = lsi.isStaticShadowMapValid == false || lsi.staticCastersHash != staticCastersHash;
 
 		// Draw the shadow map to the created frame target.
-		const auto drawShadowMapFromCamera = [this, &lsi](const RenderDestination& rendDest, ICamera* gameCamera,
-		                                                  ICamera* drawCamera) -> void {
+		const auto drawShadowMapFromCamera = [this, &lsi](const RenderDestination& rendDest, ICamera* gameCamera, ICamera* drawCamera,
+		                                                  const std::vector<Actor*>* shadowCasters) -> void {
 			GameDrawSets drawShadowSets;
 
 			drawShadowSets.gameCamera = gameCamera;
@@ -196,31 +180,56 @@ void DefaultGameDrawer::updateShadowMaps(const GameDrawSets& drawSets) {
 			drawShadowSets.rdest = rendDest;        // RenderDestination(getCore()->getDevice()->getContext(), resultFrameTarget);
 			drawShadowSets.quickDraw = &getCore()->getQuickDraw();
 			drawShadowSets.shadowMapBuildInfo = &lsi.buildInfo;
+			drawShadowSets.shadowCasters = shadowCasters;
 
 			drawWorld(drawShadowSets, drawReason_gameplayShadow);
 		};
 
+		SGEContext* const sgecon = getCore()->getDevice()->getContext();
+
 		if (shadowMapBuildInfoOpt->isPointLight) {
 			for (int iSignedAxis = 0; iSignedAxis < signedAxis_numElements; ++iSignedAxis) {
-				// Clear the pre-existing state.
-				GpuHandle<FrameTarget>& faceFrameTarget = lsi.pointLightFrameTargets[iSignedAxis];
-				getCore()->getDevice()->getContext()->clearColor(faceFrameTarget, 0, vec4f(0.f).data);
-				getCore()->getDevice()->getContext()->clearDepth(faceFrameTarget, 1.f);
+				ICamera* const faceCamera = &shadowMapBuildInfoOpt->pointLightShadowMapCameras[iSignedAxis];
+				GpuHandle<FrameTarget>& staticFaceFrameTarget = lsi.staticPointLightFrameTargets[iSignedAxis];
 
-				// Render the scene for the current face of the cube map.
-				RenderDestination rdest(getCore()->getDevice()->getContext(), faceFrameTarget);
-				drawShadowMapFromCamera(rdest, gameCamera, &shadowMapBuildInfoOpt->pointLightShadowMapCameras[iSignedAxis]);
+				if (needsStaticShadowMapUpdate) {
+					// Clear the pre-existing state.
+					sgecon->clearColor(staticFaceFrameTarget, 0, vec4f(0.f).data);
+					sgecon->clearDepth(staticFaceFrameTarget, 1.f);
+
+					// Render the static casters for the current face of the cube map.
+					drawShadowMapFromCamera(RenderDestination(sgecon, staticFaceFrameTarget), gameCamera, faceCamera,
+					                        getShadowCastersForFace(iSignedAxis, true));
+				}
+
+				if (hasDynamicCasters) {
+					// Start from the static shadow map and add the dynamic casters on top of it.
+					GpuHandle<FrameTarget>& faceFrameTarget = lsi.pointLightFrameTargets[iSignedAxis];
+					sgecon->copyDepthStencil(faceFrameTarget, staticFaceFrameTarget);
+					drawShadowMapFromCamera(RenderDestination(sgecon, faceFrameTarget), gameCamera, faceCamera,
+					                        getShadowCastersForFace(iSignedAxis, false));
+				}
 			}
 		} else {
-			// Clear the pre-existing state.
-			getCore()->getDevice()->getContext()->clearColor(lsi.frameTarget, 0, vec4f(0.f).data);
-			getCore()->getDevice()->getContext()->clearDepth(lsi.frameTarget, 1.f);
-
 			// Non-point lights have only one camera that uses the whole texture for storing the shadow map.
-			RenderDestination rdest(getCore()->getDevice()->getContext(), lsi.frameTarget);
-			drawShadowMapFromCamera(rdest, gameCamera, &shadowMapBuildInfoOpt->shadowMapCamera);
+			ICamera* const camera = &shadowMapBuildInfoOpt->shadowMapCamera;
+
+			if (needsStaticShadowMapUpdate) {
+				// Clear the pre-existing state.
+				sgecon->clearColor(lsi.staticFrameTarget, 0, vec4f(0.f).data);
+				sgecon->clearDepth(lsi.staticFrameTarget, 1.f);
+
+				drawShadowMapFromCamera(RenderDestination(sgecon, lsi.staticFrameTarget), gameCamera, camera, getShadowCastersForFace(0, true));
+			}
+
+			if (hasDynamicCasters) {
+				sgecon->copyDepthStencil(lsi.frameTarget, lsi.staticFrameTarget);
+				drawShadowMapFromCamera(RenderDestination(sgecon, lsi.frameTarget), gameCamera, camera, getShadowCastersForFace(0, false));
+			}
 		}
 
+		lsi.staticCastersHash = staticCastersHash;
+		lsi.isStaticShadowMapValid = true;
 		lsi.isCorrectlyUpdated = true;
 	}
 
@@ -252,15 +261,19 @@ void DefaultGameDrawer::updateShadowMaps(const GameDrawSets& drawSets) {
 		int flags = 0;
 		LightShadowInfo& lsi = perLightShadowFrameTarget[light->getId()];
 		if (lightDesc.hasShadows && lsi.isCorrectlyUpdated) {
+			// Without dynamic casters the cached static shadow map is used directly.
 			if (lsi.buildInfo.isPointLight) {
-				if (lsi.pointLightDepthTexture.IsResourceValid()) {
-					shadingLight.shadowMap = lsi.pointLightDepthTexture;
+				const GpuHandle<Texture>& depthTexture =
+				    lsi.hasDynamicCasters ? lsi.pointLightDepthTexture : lsi.staticPointLightDepthTexture;
+				if (depthTexture.IsResourceValid()) {
+					shadingLight.shadowMap = depthTexture;
 					shadingLight.shadowMapProjView = mat4f::getIdentity(); // Not used.
 					flags |= kLightFlg_HasShadowMap;
 				}
 			} else {
-				if (lsi.frameTarget.IsResourceValid()) {
-					shadingLight.shadowMap = lsi.frameTarget->getDepthStencil();
+				const GpuHandle<FrameTarget>& frameTarget = lsi.hasDynamicCasters ? lsi.frameTarget : lsi.staticFrameTarget;
+				if (frameTarget.IsResourceValid()) {
+					shadingLight.shadowMap = frameTarget->getDepthStencil();
 					shadingLight.shadowMapProjView = lsi.buildInfo.shadowMapCamera.getProjView();
 					flags |= kLightFlg_HasShadowMap;
 				}
@@ -280,23 +293,33 @@ void DefaultGameDrawer::updateShadowMaps(const GameDrawSets& drawSets) {
 	m_shadingLightPerObject.reserve(shadingLights.size());
 }
 
+/// Computes a sphere in world space containing the bounding box of the actor. Returns false if the box is empty.
+static bool getActorBoundingSphereWs(const Actor* actor, vec3f& outPosition, float& outRadius) {
+	const AABox3f bboxOS = actor->getBBoxOS();
+	if (bboxOS.IsEmpty()) {
+		return false;
+	}
+
+	const transf3d& tr = actor->getTransform();
+
+	// We can technically transform the box in world space and then take the bounding sphere, however
+	// transforming 8 verts is a perrty costly operation (and we do not need all the data).
+	// So instead of that we "manually compute the sphere here.
+	// Note: is that really faster?!
+	vec3f const bboxCenterOS = bboxOS.center();
+	quatf const bbSpherePosQ = tr.r * quatf(bboxCenterOS * tr.s, 0.f) * conjugate(tr.r);
+	outPosition = bbSpherePosQ.xyz() + tr.p;
+	outRadius = bboxOS.halfDiagonal().length() * tr.s.componentMaxAbs();
+	return true;
+}
+
 bool DefaultGameDrawer::isInFrustum(const GameDrawSets& drawSets, Actor* actor) const {
 	// If the camera frustum is present, try to clip the object.
 	const Frustum* const pFrustum = drawSets.drawCamera->getFrustumWS();
-	const AABox3f bboxOS = actor->getBBoxOS();
 	if (pFrustum != nullptr) {
-		if (!bboxOS.IsEmpty()) {
-			const transf3d& tr = actor->getTransform();
-
-			// We can technically transform the box in world space and then take the bounding sphere, however
-			// transforming 8 verts is a perrty costly operation (and we do not need all the data).
-			// So instead of that we "manually compute the sphere here.
-			// Note: is that really faster?!
-			vec3f const bboxCenterOS = bboxOS.center();
-			quatf const bbSpherePosQ = tr.r * quatf(bboxCenterOS * tr.s, 0.f) * conjugate(tr.r);
-			vec3f const bbSpherePos = bbSpherePosQ.xyz() + tr.p;
-			float const bbSphereRadius = bboxOS.halfDiagonal().length() * tr.s.componentMaxAbs();
-
+		vec3f bbSpherePos;
+		float bbSphereRadius = 0.f;
+		if (getActorBoundingSphereWs(actor, bbSpherePos, bbSphereRadius)) {
 			if (pFrustum->isSphereOutside(bbSpherePos, bbSphereRadius)) {
 				return false;
 			}
@@ -306,12 +329,185 @@ bool DefaultGameDrawer::isInFrustum(const GameDrawSets& drawSets, Actor* actor)
 	return true;
 }
 
+bool DefaultGameDrawer::isShadowCaster(Actor* actor) {
+	return getTrait<TraitModel>(actor) != nullptr || getTrait<TraitMultiModel>(actor) != nullptr ||
+	       getTrait<TraitRenderableGeom>(actor) != nullptr || getTrait<TraitTexturedPlane>(actor) != nullptr ||
+	       getTrait<TraitParticles>(actor) != nullptr || getTrait<TraitParticles2>(actor) != nullptr ||
+	       actor->getType() == sgeTypeId(ABlockingObstacle);
+}
+
+void DefaultGameDrawer::gatherShadowCasters(const ALight& light, const ShadowMapBuildInfo& buildInfo, LightShadowInfo& lsi) {
+	m_shadowCasters.clear();
+	m_shadowCasterFaceMasks.clear();
+	lsi.numCasters = 0;
+	lsi.numCulledCasters = 0;
+
+	const LightDesc& lightDesc = light.getLightDesc();
+	const vec3f lightPos = light.getTransform().p;
+	const vec3f lightDir = light.getTransformMtx().c0.xyz().normalized0();
+	const int allFacesMask = buildInfo.isPointLight ? (1 << signedAxis_numElements) - 1 : 1;
+
+	getWorld()->iterateOverPlayingObjects(
+	    [&](GameObject* object) -> bool {
+		    Actor* const actor = object->getActor();
+		    if (actor == nullptr || isShadowCaster(actor) == false) {
+			    return true;
+		    }
+
+		    // Actors without bounds are drawn in every face.
+		    int faceMask = allFacesMask;
+
+		    vec3f bbSpherePos;
+		    float bbSphereRadius = 0.f;
+		    if (getActorBoundingSphereWs(actor, bbSpherePos, bbSphereRadius)) {
+			    if (lightDesc.type == light_point) {
+				    const bool isInRange = isSphereInPointLightRange(lightPos, lightDesc.range, bbSpherePos, bbSphereRadius);
+				    faceMask = isInRange ? getPointLightShadowFacesMask(lightPos, bbSpherePos, bbSphereRadius) : 0;
+			    } else if (lightDesc.type == light_spot) {
+				    const bool isInCone = isSphereInSpotLightCone(lightPos, lightDir, lightDesc.spotLightAngle, lightDesc.range,
+				                                                  bbSpherePos, bbSphereRadius);
+				    faceMask = isInCone ? 1 : 0;
+			    } else {
+				    const bool isInFrustum = buildInfo.shadowMapCamera.getFrustumWS()->isSphereOutside(bbSpherePos, bbSphereRadius) == false;
+				    faceMask = isInFrustum ? 1 : 0;
+			    }
+		    }
+
+		    if (faceMask == 0) {
+			    lsi.numCulledCasters++;
+			    return true;
+		    }
+
+		    m_shadowCasters.push_back(actor);
+		    m_shadowCasterFaceMasks.push_back(faceMask);
+		    lsi.numCasters++;
+
+		    return true;
+	    },
+	    false);
+}
+
+const std::vector<Actor*>* DefaultGameDrawer::getShadowCastersForFace(int iFace, bool isStatic) {
+	m_shadowCastersForFace.clear();
+	for (size_t iCaster = 0; iCaster < m_shadowCasters.size(); ++iCaster) {
+		Actor* const actor = m_shadowCasters[iCaster];
+		if ((m_shadowCasterFaceMasks[iCaster] & (1 << iFace)) != 0 && actor->isStatic() == isStatic) {
+			m_shadowCastersForFace.push_back(actor);
+		}
+	}
+
+	return &m_shadowCastersForFace;
+}
+
+uint64 DefaultGameDrawer::computeStaticShadowCastersHash(const ALight& light,
+                                                         const ShadowMapBuildInfo& buildInfo,
+                                                         bool& hasDynamicCasters) const {
+	const auto hashBytes = [](uint64 seed, const void* data, int numBytes) -> uint64 {
+		return hash_combine(seed, uint64(hash_djb2(static_cast<const char*>(data), numBytes)));
+	};
+
+	// The cameras used for rendering the shadow map.
+	const int numCameras = buildInfo.isPointLight ? signedAxis_numElements : 1;
+	const RawCamera* const cameras = buildInfo.isPointLight ? buildInfo.pointLightShadowMapCameras : &buildInfo.shadowMapCamera;
+
+	uint64 hash = uint64(light.getLightDesc().shadowMapRes);
+	for (int iCamera = 0; iCamera < numCameras; ++iCamera) {
+		const mat4f projView = cameras[iCamera].getProjView();
+		hash = hashBytes(hash, &projView, sizeof(projView));
+	}
+
+	hasDynamicCasters = false;
+	for (const Actor* const actor : m_shadowCasters) {
+		if (actor->isStatic() == false) {
+			hasDynamicCasters = true;
+			continue;
+		}
+
+		const AABox3f bboxOS = actor->getBBoxOS();
+		hash = hash_combine(hash, uint64(actor->getId().id));
+		hash = hash_combine(hash, uint64(actor->getTransformChangeIndex()));
+		hash = hash_combine(hash, uint64(actor->getDirtyIndex()));
+		hash = hashBytes(hash, &bboxOS, sizeof(bboxOS));
+	}
+
+	return hash;
+}
+
+bool DefaultGameDrawer::createPointLightShadowMap(GpuHandle<Texture>& depthTexture,
+                                                  GpuHandle<FrameTarget> faceFrameTargets[],
+                                                  int resolution) {
+	const bool shouldCreateNewShadowMapTexture = depthTexture.IsResourceValid() == false ||
+	                                             depthTexture->getDesc().textureType != UniformType::TextureCube ||
+	                                             depthTexture->getDesc().textureCube.width != resolution ||
+	                                             depthTexture->getDesc().textureCube.height != resolution;
+
+	if (shouldCreateNewShadowMapTexture == false) {
+		return false;
+	}
+
+	TextureDesc texDesc;
+	texDesc.textureType = UniformType::TextureCube;
+	texDesc.format = TextureFormat::D24_UNORM_S8_UINT;
+	texDesc.usage = TextureUsage::DepthStencilResource;
+	texDesc.textureCube.width = resolution;
+	texDesc.textureCube.height = resolution;
+	texDesc.textureCube.arraySize = 1;
+	texDesc.textureCube.numMips = 1;
+	texDesc.textureCube.sampleQuality = 0;
+	texDesc.textureCube.numSamples = 1;
+
+	depthTexture = getCore()->getDevice()->requestResource<Texture>();
+	[[maybe_unused]] const bool succeeded = depthTexture->create(texDesc, nullptr);
+	sgeAssert(succeeded);
+
+	for (int iSignedAxis = 0; iSignedAxis < signedAxis_numElements; ++iSignedAxis) {
+		// Destroy the prevously existing frame target for the face.
+		faceFrameTargets[iSignedAxis].Release();
+
+		// Create the new one.
+		GpuHandle<FrameTarget>& faceFrameTarget = faceFrameTargets[iSignedAxis];
+		faceFrameTarget = getCore()->getDevice()->requestResource<FrameTarget>();
+
+		TargetDesc faceTargetDesc;
+		faceTargetDesc.baseTextureType = UniformType::TextureCube;
+		faceTargetDesc.textureCube.face = SignedAxis(iSignedAxis);
+		faceTargetDesc.textureCube.mipLevel = 0;
+
+		[[maybe_unused]] const bool targetSucceeded = faceFrameTarget->create(0, nullptr, nullptr, depthTexture, faceTargetDesc);
+
+		sgeAssert(targetSucceeded);
+	}
+
+	return true;
+}
+
+bool DefaultGameDrawer::createShadowMap(GpuHandle<FrameTarget>& frameTarget, int resolution) {
+	const bool shouldCreateNewShadowMapTexture =
+	    frameTarget.IsResourceValid() == false || frameTarget->getWidth() != resolution || frameTarget->getHeight() != resolution;
+
+	if (shouldCreateNewShadowMapTexture == false) {
+		return false;
+	}
+
+	// Caution, TODO: On Safari (the web browser) I've read that it needs a color render target.
+	// Keep that in mind when testing and developing.
+	frameTarget = getCore()->getDevice()->requestResource<FrameTarget>();
+	frameTarget->create2D(resolution, resolution, TextureFormat::Unknown, TextureFormat::D24_UNORM_S8_UINT);
+	return true;
+}
+
 void DefaultGameDrawer::fillGeneralModsWithLights(Actor* actor, GeneralDrawMod& generalMods) {
 	// Find all the lights that can affect this object.
 	m_shadingLightPerObject.clear();
 	AABox3f bboxOS = actor->getBBoxOS();
 	AABox3f actorBBoxWs = bboxOS.getTransformed(actor->getTransformMtx());
-	for (const ShadingLightData& shadingLight : shadingLights) {
+	const bool skipClusteredLights = generalMods.clusteredLighting != nullptr;
+	for (size_t iLight = 0; iLight < shadingLights.size(); ++iLight) {
+		const ShadingLightData& shadingLight = shadingLights[iLight];
+		if (skipClusteredLights && m_isShadingLightClustered[iLight]) {
+			continue;
+		}
+
 		if (shadingLight.lightBoxWs.IsEmpty() || shadingLight.lightBoxWs.overlaps(actorBBoxWs)) {
 			m_shadingLightPerObject.emplace_back(&shadingLight);
 		}
@@ -321,6 +517,34 @@ void DefaultGameDrawer::fillGeneralModsWithLights(Actor* actor, GeneralDrawMod&
 	generalMods.lightsCount = int(m_shadingLightPerObject.size());
 }
 
+const ClusteredLightingData* DefaultGameDrawer::buildLightClusters(const GameDrawSets& drawSets) {
+#if !defined(__EMSCRIPTEN__)
+	m_clusteredLights.clear();
+	m_isShadingLightClustered.assign(shadingLights.size(), false);
+
+	// Lights with shadow maps are still drawn in a separate pass each.
+	for (size_t iLight = 0; iLight < shadingLights.size(); ++iLight) {
+		const ShadingLightData& shadingLight = shadingLights[iLight];
+		const bool hasShadowMap = (int(shadingLight.lightColorWFlags.w) & kLightFlg_HasShadowMap) != 0;
+		if (hasShadowMap == false && m_clusteredLights.size() < LightClusters::kMaxLights) {
+			m_clusteredLights.push_back(&shadingLight);
+			m_isShadingLightClustered[iLight] = true;
+		}
+	}
+
+	if (m_clusteredLights.empty()) {
+		return nullptr;
+	}
+
+	m_lightClusters.build(drawSets.drawCamera->getView(), drawSets.drawCamera->getProj(), m_clusteredLights.data(),
+	                      int(m_clusteredLights.size()));
+	return m_lightClusters.upload(drawSets.rdest.sgecon);
+#else
+	// GLES targets do not support clustered lighting, every light is drawn in a separate pass.
+	return nullptr;
+#endif
+}
+
 
 void DefaultGameDrawer::drawWorld(const GameDrawSets& drawSets, const DrawReason drawReason) {
 	texturedPlanes.clear();
@@ -333,60 +557,70 @@ void DefaultGameDrawer::drawWorld(const GameDrawSets& drawSets, const DrawReason
 
 	specialDrawnActors.clear();
 
-	getWorld()->iterateOverPlayingObjects(
-	    [&](GameObject* object) -> bool {
-		    // TODO: Skip this check for whole types. We know they are not actors...
-		    Actor* actor = object->getActor();
-
-		    if (actor == nullptr) {
-			    return true;
-		    }
+	const auto addActorForDrawing = [&](Actor* actor) -> void {
+		bool hasNone = true;
+		if (TraitParticles* const trait = getTrait<TraitParticles>(actor)) {
+			particles.push_back(trait);
+			hasNone = false;
+		}
+		if (TraitParticles2* const trait = getTrait<TraitParticles2>(actor)) {
+			particles2.push_back(trait);
+			hasNone = false;
+		}
+		if (TraitModel* const trait = getTrait<TraitModel>(actor)) {
+			staticModels.push_back(trait);
+			hasNone = false;
+		}
+		if (TraitMultiModel* const trait = getTrait<TraitMultiModel>(actor)) {
+			multiModels.push_back(trait);
+			hasNone = false;
+		}
+		if (TraitRenderableGeom* const trait = getTrait<TraitRenderableGeom>(actor)) {
+			renderableGeoms.push_back(trait);
+			hasNone = false;
+		}
+		if (TraitTexturedPlane* const trait = getTrait<TraitTexturedPlane>(actor)) {
+			texturedPlanes.push_back(trait);
+			hasNone = false;
+		}
+		if (drawReason_IsEditOrSelection(drawReason)) {
+			// Editor only traits, no need to draw them otherwise.
+			if (TraitViewportIcon* const trait = getTrait<TraitViewportIcon>(actor)) {
+				viewportIcons.push_back(trait);
+				hasNone = false;
+			}
+		}
 
-		    if (isInFrustum(drawSets, actor) == false) {
-			    return true;
-		    }
+		if (hasNone || actor->getType() == sgeTypeId(AInvisibleRigidObstacle) || actor->getType() == sgeTypeId(ALine) ||
+		    actor->getType() == sgeTypeId(ACRSpline)) {
+			specialDrawnActors.push_back(actor);
+		}
+	};
 
-		    bool hasNone = true;
-		    if (TraitParticles* const trait = getTrait<TraitParticles>(actor)) {
-			    particles.push_back(trait);
-			    hasNone = false;
-		    }
-		    if (TraitParticles2* const trait = getTrait<TraitParticles2>(actor)) {
-			    particles2.push_back(trait);
-			    hasNone = false;
-		    }
-		    if (TraitModel* const trait = getTrait<TraitModel>(actor)) {
-			    staticModels.push_back(trait);
-			    hasNone = false;
-		    }
-		    if (TraitMultiModel* const trait = getTrait<TraitMultiModel>(actor)) {
-			    multiModels.push_back(trait);
-			    hasNone = false;
-		    }
-		    if (TraitRenderableGeom* const trait = getTrait<TraitRenderableGeom>(actor)) {
-			    renderableGeoms.push_back(trait);
-			    hasNone = false;
-		    }
-		    if (TraitTexturedPlane* const trait = getTrait<TraitTexturedPlane>(actor)) {
-			    texturedPlanes.push_back(trait);
-			    hasNone = false;
-		    }
-		    if (drawReason_IsEditOrSelection(drawReason)) {
-			    // Editor only traits, no need to draw them otherwise.
-			    if (TraitViewportIcon* const trait = getTrait<TraitViewportIcon>(actor)) {
-				    viewportIcons.push_back(trait);
-				    hasNone = false;
+	if (drawSets.shadowCasters != nullptr) {
+		// The casters are already culled against the camera of the shadow map.
+		for (Actor* const actor : *drawSets.shadowCasters) {
+			addActorForDrawing(actor);
+		}
+	} else {
+		getWorld()->iterateOverPlayingObjects(
+		    [&](GameObject* object) -> bool {
+			    // TODO: Skip this check for whole types. We know they are not actors...
+			    Actor* actor = object->getActor();
+
+			    if (actor == nullptr) {
+				    return true;
 			    }
-		    }
 
-		    if (hasNone || actor->getType() == sgeTypeId(AInvisibleRigidObstacle) || actor->getType() == sgeTypeId(ALine) ||
-		        actor->getType() == sgeTypeId(ACRSpline)) {
-			    specialDrawnActors.push_back(actor);
-		    }
+			    if (isInFrustum(drawSets, actor) == false) {
+				    return true;
+			    }
 
-		    return true;
-	    },
-	    false);
+			    addActorForDrawing(actor);
+			    return true;
+		    },
+		    false);
+	}
 
 	const vec4f wireframeColor = (drawReason == drawReason_wireframePrimary) ? kPrimarySelectionColor : kSecondarySelectionColor;
 
@@ -406,6 +640,11 @@ void DefaultGameDrawer::drawWorld(const GameDrawSets& drawSets, const DrawReason
 	generalMods.ambientLightColor = getWorld()->m_ambientLight;
 	generalMods.uRimLightColorWWidth = vec4f(getWorld()->m_rimLight, getWorld()->m_rimCosineWidth);
 
+	// The lights without shadow maps are applied in a single pass using the light clusters.
+	if (drawReason_IsGameOrEditNoShadowPass(drawReason)) {
+		generalMods.clusteredLighting = buildLightClusters(drawSets);
+	}
+
 	// Perform the drawing.
 	// Caution: Keep in mind that the order of drawing these is important as some of them
 	// use special alpha blending (for example particles).
@@ -420,16 +659,21 @@ void DefaultGameDrawer::drawWorld(const GameDrawSets& drawSets, const DrawReason
 		drawTraitTexturedPlane(trait, drawSets, generalMods, drawReason);
 	}
 
+	// Models are drawn via the render queue, which sorts them to minimize the state changes.
 	for (TraitModel* trait : staticModels) {
 		fillGeneralModsWithLights(trait->getActor(), generalMods);
-		drawTraitStaticModel(trait, drawSets, generalMods, drawReason);
+		if (enqueueTraitStaticModel(trait, drawSets, generalMods, drawReason) == false) {
+			drawTraitStaticModel(trait, drawSets, generalMods, drawReason);
+		}
 	}
 
 	for (TraitMultiModel* trait : multiModels) {
 		fillGeneralModsWithLights(trait->getActor(), generalMods);
-		drawTraitMultiModel(trait, drawSets, generalMods, drawReason);
+		enqueueTraitMultiModel(trait, drawSets, generalMods);
 	}
 
+	flushRenderQueue(drawSets, generalMods);
+
 	for (TraitRenderableGeom* trait : renderableGeoms) {
 		fillGeneralModsWithLights(trait->getActor(), generalMods);
 		drawTraitRenderableGeom(trait, drawSets, generalMods);
@@ -508,8 +752,8 @@ void DefaultGameDrawer::drawWorld(const GameDrawSets& drawSets, const DrawReason
 
 	getCore()->getDebugDraw().draw(drawSets.rdest, drawSets.drawCamera->getProjView());
 
-	for (ObjectId scriptObj : getWorld()->m_scriptObjects) {
-		if (IWorldScript* script = dynamic_cast<IWorldScript*>(getWorld()->getObjectById(scriptObj))) {
+	for (int iScript = 0; iScript < int(getWorld()->m_scriptObjects.size()); ++iScript) {
+		if (IWorldScript* script = getWorld()->getWorldScript(iScript)) {
 			script->onPostDraw(drawSets);
 		}
 	}
@@ -640,73 +884,18 @@ void DefaultGameDrawer::drawTraitStaticModel(TraitModel* modelTrait,
 	PAsset const asset = modelTrait->getAssetProperty().getAsset();
 
 	if (isAssetLoaded(asset) && asset->getType() == AssetType::Model) {
-		AssetModel* const model = modelTrait->getAssetProperty().getAssetModel();
-
 		std::vector<MaterialOverride> mtlOverrides;
-		for (auto& mtlOverride : modelTrait->m_materialOverrides) {
-			GameObject* const mtlProvider = getWorld()->getObjectById(mtlOverride.materialObjId);
-			OMaterial* mtl = dynamic_cast<OMaterial*>(mtlProvider);
-			if (mtl) {
-				MaterialOverride ovr;
-				ovr.name = mtlOverride.materialName;
-				ovr.mtl = mtl->getMaterial();
-
-				mtlOverrides.push_back(ovr);
-			}
-		}
-
-		if (!drawReason_IsWireframe(drawReason)) {
-			if (modelTrait->useSkeleton) {
-				if (model && model->sharedEval.isInitialized()) {
-					// Compute the overrdies.
-					vector_map<const Model::Node*, mat4f> boneOverrides;
-					modelTrait->computeSkeleton(boneOverrides);
-					// Draw
-					const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
-					model->sharedEval.evaluate(boneOverrides);
-					m_modeldraw.draw(drawSets.rdest, camPos, camLookDir, drawSets.drawCamera->getProjView(), n2w, generalMods,
-					                 model->sharedEval, modelTrait->instanceDrawMods, &mtlOverrides);
-				}
-			} else if (modelTrait->animationName.empty()) {
-				if (model && model->staticEval.isInitialized()) {
-					const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
-					m_modeldraw.draw(drawSets.rdest, camPos, camLookDir, drawSets.drawCamera->getProjView(), n2w, generalMods,
-					                 model->staticEval, modelTrait->instanceDrawMods, &mtlOverrides);
-				}
+		getMaterialOverrides(modelTrait, mtlOverrides);
+
+		// Animated models are evaluated once per frame and reused by every pass.
+		const EvaluatedModel* const evalModel = modelTrait->getEvaluatedModel(m_frameStamp);
+		if (evalModel != nullptr) {
+			const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
+			if (!drawReason_IsWireframe(drawReason)) {
+				m_modeldraw.draw(drawSets.rdest, camPos, camLookDir, drawSets.drawCamera->getProjView(), n2w, generalMods, *evalModel,
+				                 modelTrait->instanceDrawMods, &mtlOverrides);
 			} else {
-				if (model && model->sharedEval.isInitialized()) {
-					const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
-					model->sharedEval.evaluate(modelTrait->animationName.c_str(), modelTrait->animationTime);
-					m_modeldraw.draw(drawSets.rdest, camPos, camLookDir, drawSets.drawCamera->getProjView(), n2w, generalMods,
-					                 model->sharedEval, modelTrait->instanceDrawMods, &mtlOverrides); // TODO force no lighting in mods
-				}
-			}
-		} else {
-			if (modelTrait->useSkeleton) {
-				if (model && model->sharedEval.isInitialized()) {
-					// Compute the overrdies.
-					vector_map<const Model::Node*, mat4f> boneOverrides;
-					modelTrait->computeSkeleton(boneOverrides);
-
-					// Draw
-					const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
-					model->sharedEval.evaluate(boneOverrides);
-					m_constantColorShader.draw(drawSets.rdest, drawSets.drawCamera->getProjView(), n2w, model->sharedEval,
-					                           generalMods.highlightColor);
-				}
-			} else if (modelTrait->animationName.empty()) {
-				if (model && model->staticEval.isInitialized()) {
-					const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
-					m_constantColorShader.draw(drawSets.rdest, drawSets.drawCamera->getProjView(), n2w, model->staticEval,
-					                           generalMods.highlightColor);
-				}
-			} else {
-				if (model && model->sharedEval.isInitialized()) {
-					const mat4f n2w = actor->getTransformMtx() * modelTrait->m_additionalTransform;
-					model->sharedEval.evaluate(modelTrait->animationName.c_str(), modelTrait->animationTime);
-					m_constantColorShader.draw(drawSets.rdest, drawSets.drawCamera->getProjView(), n2w, model->sharedEval,
-					                           generalMods.highlightColor);
-				}
+				m_constantColorShader.draw(drawSets.rdest, drawSets.drawCamera->getProjView(), n2w, *evalModel, generalMods.highlightColor);
 			}
 		}
 	} else if (isAssetLoaded(asset) && asset->getType() == AssetType::TextureView) {
@@ -892,6 +1081,301 @@ void DefaultGameDrawer::drawANavMesh(ANavMesh* navMesh,
 	}
 }
 
+void DefaultGameDrawer::getMaterialOverrides(TraitModel* modelTrait, std::vector<MaterialOverride>& outMtlOverrides) {
+	outMtlOverrides.clear();
+	for (auto& mtlOverride : modelTrait->m_materialOverrides) {
+		GameObject* const mtlProvider = getWorld()->getObjectById(mtlOverride.materialObjId, mtlOverride.materialObjHint);
+		OMaterial* mtl = dynamic_cast<OMaterial*>(mtlProvider);
+		if (mtl) {
+			MaterialOverride ovr;
+			ovr.name = mtlOverride.materialName;
+			ovr.mtl = mtl->getMaterial();
+
+			outMtlOverrides.push_back(ovr);
+		}
+	}
+}
+
+bool DefaultGameDrawer::enqueueTraitStaticModel(TraitModel* modelTrait,
+                                                const GameDrawSets& drawSets,
+                                                const GeneralDrawMod& generalMods,
+                                                DrawReason const drawReason) {
+	if (modelTrait->getRenderable() == false) {
+		return true;
+	}
+
+	// Wireframes are drawn with a different shader.
+	if (drawReason_IsWireframe(drawReason)) {
+		return false;
+	}
+
+	PAsset const asset = modelTrait->getAssetProperty().getAsset();
+	if (isAssetLoaded(asset) == false || asset->getType() != AssetType::Model) {
+		return false;
+	}
+
+	// Animated models have their own evaluated state, which stays unchanged until the queue is flushed.
+	const EvaluatedModel* const evalModel = modelTrait->getEvaluatedModel(m_frameStamp);
+	if (evalModel != nullptr) {
+		getMaterialOverrides(modelTrait, m_tempMtlOverrides);
+
+		const mat4f n2w = modelTrait->getActor()->getTransformMtx() * modelTrait->m_additionalTransform;
+		enqueueEvaluatedModel(drawSets, generalMods, n2w, *evalModel, modelTrait->instanceDrawMods, &m_tempMtlOverrides);
+	}
+
+	return true;
+}
+
+void DefaultGameDrawer::enqueueTraitMultiModel(TraitMultiModel* multiModelTrait,
+                                               const GameDrawSets& drawSets,
+                                               const GeneralDrawMod& generalMods) {
+	Actor* actor = multiModelTrait->getActor();
+
+	for (TraitMultiModel::Element& elem : multiModelTrait->models) {
+		if (elem.isRenderable) {
+			AssetModel* const model = elem.assetProperty.getAssetModel();
+			if (model && model->staticEval.isInitialized()) {
+				mat4f n2w;
+				if (elem.isAdditionalTransformInWorldSpace)
+					n2w = elem.additionalTransform;
+				else
+					n2w = actor->getTransformMtx() * elem.additionalTransform;
+
+				enqueueEvaluatedModel(drawSets, generalMods, n2w, model->staticEval, InstanceDrawMods(), nullptr); // TODO MODS
+			}
+		}
+	}
+}
+
+void DefaultGameDrawer::enqueueEvaluatedModel(const GameDrawSets& drawSets,
+                                              const GeneralDrawMod& generalMods,
+                                              const mat4f& preRoot,
+                                              const EvaluatedModel& model,
+                                              const InstanceDrawMods& mods,
+                                              const std::vector<MaterialOverride>* mtlOverrides) {
+	const vec3f camPos = drawSets.drawCamera->getCameraPosition();
+	const vec3f camLookDir = drawSets.drawCamera->getCameraLookDir();
+
+	// All meshes of the model share the lights affecting the object.
+	const int firstLight = int(m_queuedDrawLights.size());
+	m_queuedDrawLights.insert(m_queuedDrawLights.end(), generalMods.ppLightData, generalMods.ppLightData + generalMods.lightsCount);
+
+	for (int iNode = 0; iNode < model.m_nodes.size(); ++iNode) {
+		const EvaluatedNode& evalNode = model.m_nodes[iNode];
+
+		for (const EvaluatedMeshAttachment& meshAttachment : evalNode.attachedMeshes) {
+			const Model::Mesh* const mesh = meshAttachment.pMesh->pReferenceMesh;
+
+			QueuedDraw draw;
+			draw.geometry = &meshAttachment.pMesh->geom;
+			draw.material = m_modeldraw.getMeshMaterial(meshAttachment, mtlOverrides);
+			draw.world = (mesh->bones.size() == 0) ? preRoot * evalNode.evalGlobalTransform : preRoot;
+			draw.worldDeterminant = determinant(draw.world);
+			draw.mods = mods;
+			draw.shaderKey =
+			    m_modeldraw.computeShadingPermutationKey(drawSets.rdest.getDevice(), generalMods, draw.geometry, draw.material, mods);
+			draw.firstLight = firstLight;
+			draw.numLights = generalMods.lightsCount;
+
+			const bool isTranslucent = draw.material.diffuseColor.w < 1.f || mods.forceAdditiveBlending;
+			const RenderPass pass = isTranslucent ? renderPass_translucent : renderPass_opaque;
+
+			const Material& mtl = draw.material;
+			const uint32 materialKey = RenderQueue::hashPointer(mtl.diffuseTexture) ^ RenderQueue::hashPointer(mtl.texNormalMap) ^
+			                           RenderQueue::hashPointer(mtl.texMetalness) ^ RenderQueue::hashPointer(mtl.texRoughness);
+			const uint32 meshKey = RenderQueue::hashPointer(draw.geometry->vertexBuffer);
+			const float depth = dot(draw.world.extractTranslation() - camPos, camLookDir);
+
+			m_renderQueue.add(RenderQueue::makeSortKey(pass, uint32(draw.shaderKey), materialKey, meshKey, depth),
+			                  uint32(m_queuedDraws.size()));
+			m_queuedDraws.push_back(draw);
+		}
+	}
+}
+
+void DefaultGameDrawer::flushRenderQueue(const GameDrawSets& drawSets, const GeneralDrawMod& generalMods) {
+	if (m_queuedDraws.empty()) {
+		m_queuedDrawLights.clear();
+		return;
+	}
+
+	const auto isSameShader = [](const QueuedDraw& a, const QueuedDraw& b) -> bool { return a.shaderKey == b.shaderKey; };
+	const auto isSameMaterial = [](const QueuedDraw& a, const QueuedDraw& b) -> bool {
+		return a.material.diffuseTexture == b.material.diffuseTexture && a.material.texNormalMap == b.material.texNormalMap &&
+		       a.material.texMetalness == b.material.texMetalness && a.material.texRoughness == b.material.texRoughness;
+	};
+	const auto isSameMesh = [](const QueuedDraw& a, const QueuedDraw& b) -> bool {
+		return a.geometry->vertexBuffer == b.geometry->vertexBuffer && a.geometry->indexBuffer == b.geometry->indexBuffer;
+	};
+
+	// Checks if the draws could be drawn with a single instanced draw, where only the world transform and
+	// the diffuse color could differ between the instances.
+	const auto isSameMatrix = [](const mat4f& a, const mat4f& b) -> bool {
+		return a.c0 == b.c0 && a.c1 == b.c1 && a.c2 == b.c2 && a.c3 == b.c3;
+	};
+
+	const auto canBeInstancedTogether = [this, &isSameMatrix](const QueuedDraw& a, const QueuedDraw& b) -> bool {
+		const Material& ma = a.material;
+		const Material& mb = b.material;
+		const bool isSameMaterialExceptTint =
+		    ma.special == mb.special && ma.texNormalMap == mb.texNormalMap && ma.diffuseTexture == mb.diffuseTexture &&
+		    ma.diffuseTextureX == mb.diffuseTextureX && ma.diffuseTextureY == mb.diffuseTextureY &&
+		    ma.diffuseTextureZ == mb.diffuseTextureZ && ma.texMetalness == mb.texMetalness && ma.texRoughness == mb.texRoughness &&
+		    ma.diffuseTexXYZScaling == mb.diffuseTexXYZScaling && ma.fluidColor0 == mb.fluidColor0 && ma.fluidColor1 == mb.fluidColor1 &&
+		    ma.metalness == mb.metalness && ma.roughness == mb.roughness && isSameMatrix(ma.uvwTransform, mb.uvwTransform);
+
+		const bool isSameMods = isSameMatrix(a.mods.uvwTransform, b.mods.uvwTransform) && a.mods.gameTime == b.mods.gameTime &&
+		                        a.mods.forceNoLighting == b.mods.forceNoLighting &&
+		                        a.mods.forceAdditiveBlending == b.mods.forceAdditiveBlending &&
+		                        a.mods.forceNoCulling == b.mods.forceNoCulling;
+
+		const bool isSameLights =
+		    a.numLights == b.numLights && std::equal(m_queuedDrawLights.begin() + a.firstLight,
+		                                             m_queuedDrawLights.begin() + a.firstLight + a.numLights,
+		                                             m_queuedDrawLights.begin() + b.firstLight);
+
+		// The culling depends on the sign of the determinant and it is shared by all instances.
+		const bool isSameWinding = (a.worldDeterminant > 0.f) == (b.worldDeterminant > 0.f);
+
+		return a.geometry == b.geometry && a.shaderKey == b.shaderKey && isSameMaterialExceptTint && isSameMods && isSameLights &&
+		       isSameWinding;
+	};
+
+	// Count the state changes in scene order, to know how many of them the sorting avoids.
+	int numShaderChangesUnsorted = 0;
+	int numMaterialChangesUnsorted = 0;
+	int numMeshChangesUnsorted = 0;
+	for (size_t t = 1; t < m_queuedDraws.size(); ++t) {
+		numShaderChangesUnsorted += isSameShader(m_queuedDraws[t - 1], m_queuedDraws[t]) ? 0 : 1;
+		numMaterialChangesUnsorted += isSameMaterial(m_queuedDraws[t - 1], m_queuedDraws[t]) ? 0 : 1;
+		numMeshChangesUnsorted += isSameMesh(m_queuedDraws[t - 1], m_queuedDraws[t]) ? 0 : 1;
+	}
+
+	m_renderQueue.sort();
+
+	const std::vector<RenderQueue::Item>& items = m_renderQueue.getItems();
+
+	// The sorting places the draws with the same state next to each other, find the runs that could be instanced
+	// and gather the data of their instances, so it could be uploaded with a single map.
+	m_instancedBatches.clear();
+	m_instanceData.clear();
+	for (int iItem = 0; iItem < int(items.size());) {
+		const QueuedDraw& firstDraw = m_queuedDraws[items[iItem].drawIndex];
+
+		int iEnd = iItem + 1;
+		while (iEnd < int(items.size()) && canBeInstancedTogether(firstDraw, m_queuedDraws[items[iEnd].drawIndex])) {
+			++iEnd;
+		}
+
+		if (iEnd - iItem >= 2) {
+			InstancedBatch batch;
+			batch.firstItem = iItem;
+			batch.numItems = iEnd - iItem;
+			batch.firstInstance = int(m_instanceData.size());
+			m_instancedBatches.push_back(batch);
+
+			for (int t = iItem; t < iEnd; ++t) {
+				const QueuedDraw& draw = m_queuedDraws[items[t].drawIndex];
+
+				ModelInstanceData instance;
+				for (int iColumn = 0; iColumn < 4; ++iColumn) {
+					instance.worldColumns[iColumn] = draw.world.data[iColumn];
+				}
+				instance.diffuseColorTint = draw.material.diffuseColor;
+				m_instanceData.push_back(instance);
+			}
+		}
+
+		iItem = iEnd;
+	}
+
+	if (m_instanceData.empty() == false) {
+		uploadInstanceData(drawSets);
+	}
+
+	const vec3f camPos = drawSets.drawCamera->getCameraPosition();
+	const vec3f camLookDir = drawSets.drawCamera->getCameraLookDir();
+	const mat4f projView = drawSets.drawCamera->getProjView();
+
+	int numShaderChanges = 0;
+	int numMaterialChanges = 0;
+	int numMeshChanges = 0;
+	const QueuedDraw* prevDraw = nullptr;
+
+	GeneralDrawMod drawGeneralMods = generalMods;
+	int iNextBatch = 0;
+	for (int iItem = 0; iItem < int(items.size()); ++iItem) {
+		const QueuedDraw& draw = m_queuedDraws[items[iItem].drawIndex];
+
+		if (prevDraw != nullptr) {
+			numShaderChanges += isSameShader(*prevDraw, draw) ? 0 : 1;
+			numMaterialChanges += isSameMaterial(*prevDraw, draw) ? 0 : 1;
+			numMeshChanges += isSameMesh(*prevDraw, draw) ? 0 : 1;
+		}
+		prevDraw = &draw;
+
+		drawGeneralMods.ppLightData = m_queuedDrawLights.data() + draw.firstLight;
+		drawGeneralMods.lightsCount = draw.numLights;
+
+		if (iNextBatch < int(m_instancedBatches.size()) && m_instancedBatches[iNextBatch].firstItem == iItem) {
+			const InstancedBatch& batch = m_instancedBatches[iNextBatch];
+			iNextBatch++;
+
+			InstancedDrawDesc instances;
+			instances.instanceBuffer = m_instanceBuffer;
+			instances.byteOffset = uint32(batch.firstInstance * sizeof(ModelInstanceData));
+			instances.numInstances = batch.numItems;
+			instances.worldDeterminant = draw.worldDeterminant;
+
+			m_modeldraw.drawGeometryInstanced(drawSets.rdest, camPos, camLookDir, projView, drawGeneralMods, draw.geometry, draw.material,
+			                                  draw.mods, instances);
+
+			m_renderQueueStats.numInstancedBatches += 1;
+			m_renderQueueStats.numInstancedDraws += batch.numItems;
+
+			// The rest of the batch have the same state, so they cannot cause state changes.
+			iItem += batch.numItems - 1;
+			prevDraw = &m_queuedDraws[items[iItem].drawIndex];
+		} else {
+			m_modeldraw.drawGeometry(drawSets.rdest, camPos, camLookDir, projView, draw.world, drawGeneralMods, draw.geometry,
+			                         draw.material, draw.mods);
+		}
+	}
+
+	m_renderQueueStats.numDraws += int(m_queuedDraws.size());
+	m_renderQueueStats.numShaderChanges += numShaderChanges;
+	m_renderQueueStats.numMaterialChanges += numMaterialChanges;
+	m_renderQueueStats.numMeshChanges += numMeshChanges;
+	m_renderQueueStats.numShaderChangesAvoided += numShaderChangesUnsorted - numShaderChanges;
+	m_renderQueueStats.numMaterialChangesAvoided += numMaterialChangesUnsorted - numMaterialChanges;
+	m_renderQueueStats.numMeshChangesAvoided += numMeshChangesUnsorted - numMeshChanges;
+
+	m_renderQueue.clear();
+	m_queuedDraws.clear();
+	m_queuedDrawLights.clear();
+}
+
+void DefaultGameDrawer::uploadInstanceData(const GameDrawSets& drawSets) {
+	const size_t neededSizeBytes = m_instanceData.size() * sizeof(ModelInstanceData);
+
+	if (m_instanceBuffer.IsResourceValid() == false || m_instanceBuffer->getDesc().sizeBytes < neededSizeBytes) {
+		// Grow with some reserve, to avoid recreating the buffer every time a few more instances appear.
+		size_t sizeBytes = m_instanceBuffer.IsResourceValid() ? m_instanceBuffer->getDesc().sizeBytes : 256 * sizeof(ModelInstanceData);
+		while (sizeBytes < neededSizeBytes) {
+			sizeBytes *= 2;
+		}
+
+		m_instanceBuffer = drawSets.rdest.getDevice()->requestResource<Buffer>();
+		m_instanceBuffer->create(BufferDesc::GetDefaultVertexBuffer(sizeBytes, ResourceUsage::Dynamic), nullptr);
+	}
+
+	void* const mappedData = drawSets.rdest.sgecon->map(m_instanceBuffer, Map::WriteDiscard);
+	if_checked(mappedData) {
+		memcpy(mappedData, m_instanceData.data(), neededSizeBytes);
+		drawSets.rdest.sgecon->unMap(m_instanceBuffer);
+	}
+}
+
 void DefaultGameDrawer::drawTraitMultiModel(TraitMultiModel* multiModelTrait,
                                             const GameDrawSets& drawSets,
                                             const GeneralDrawMod& generalMods,
@@ -1227,13 +1711,13 @@ void DefaultGameDrawer::drawActorLegacy(Actor* actor,
 			ABone* const bone = static_cast<ABone*>(actor);
 			GameWorld* world = bone->getWorld();
 			float boneLength = 1.f;
-			const vector_set<ObjectId>* pChildren = world->getChildensOf(bone->getId());
-			if (pChildren != nullptr) {
+			const GameWorld::HierarchyRange children = world->getChildrenOf(bone);
+			if (children.isEmpty() == false) {
 				vec3f boneFromWs = bone->getPosition();
 
-				const vector_set<ObjectId>& children = *pChildren;
-				if (children.size() == 1) {
-					Actor* child = world->getActorById(children.getNth(0));
+				const bool hasSingleChild = ++children.begin() == children.end();
+				if (hasSingleChild) {
+					Actor* child = *children.begin();
 					if (child != nullptr) {
 						vec3f boneToWs = child->getPosition();
 						vec3f boneDirVectorWs = (boneToWs - boneFromWs);
@@ -1249,8 +1733,7 @@ void DefaultGameDrawer::drawActorLegacy(Actor* actor,
 						}
 					}
 				} else {
-					for (ObjectId childId : children) {
-						Actor* child = world->getActorById(childId);
+					for (Actor* const child : children) {
 						if (child != nullptr) {
 							vec3f boneToWs = child->getPosition();
 							drawSets.quickDraw->drawWiredAdd_Line(boneFromWs, boneToWs, wireframeColorInt);
@@ -4,6 +4,8 @@
 #include "sge_core/shaders/modeldraw.h"
 #include "sge_engine/GameDrawer.h"
 #include "sge_engine/GameWorld.h"
+#include "sge_engine/LightClusters.h"
+#include "sge_engine/RenderQueue.h"
 #include "sge_engine/TexturedPlaneDraw.h"
 #include "sge_engine/actors/ALight.h"
 #include "sge_engine/traits/TraitParticles.h"
@@ -21,12 +23,30 @@ struct TraitRenderableGeom;
 
 struct ANavMesh;
 
+/// The shadow maps of a light.
+/// The static casters are rendered in a separate cached shadow map that is updated only when the light or
+/// the static casters in its frustum change. The dynamic casters are drawn every frame over a copy of it.
 struct LightShadowInfo {
 	ShadowMapBuildInfo buildInfo;
 	GpuHandle<Texture> pointLightDepthTexture; // This could be a single 2D or a Cube texture depending on the light source.
 	GpuHandle<FrameTarget> pointLightFrameTargets[signedAxis_numElements];
 	GpuHandle<FrameTarget> frameTarget; // Regular frame target for spot and directional lights.
+
+	// The cached shadow map with only the static casters, same layout as above.
+	GpuHandle<Texture> staticPointLightDepthTexture;
+	GpuHandle<FrameTarget> staticPointLightFrameTargets[signedAxis_numElements];
+	GpuHandle<FrameTarget> staticFrameTarget;
+
+	/// The hash of the light cameras and the static casters used for rendering the cached shadow map.
+	uint64 staticCastersHash = 0;
+	bool isStaticShadowMapValid = false;
+	/// If false the static shadow map is used for shading directly.
+	bool hasDynamicCasters = false;
 	bool isCorrectlyUpdated = false;
+
+	// Profiling counters from the last update, the casters drawn in the shadow map and the ones culled before drawing.
+	int numCasters = 0;
+	int numCulledCasters = 0;
 };
 
 struct SGE_ENGINE_API DefaultGameDrawer : public IGameDrawer {
@@ -76,10 +96,87 @@ struct SGE_ENGINE_API DefaultGameDrawer : public IGameDrawer {
 	                  DrawReason const drawReason,
 	                  const uint32 wireframeColor);
 
+	/// Returns the counters of the render queue accumulated since the last call to prepareForNewFrame().
+	const RenderQueueStats& getRenderQueueStats() const { return m_renderQueueStats; }
+
   private:
 	bool isInFrustum(const GameDrawSets& drawSets, Actor* actor) const;
+
+	/// Returns true if the actor could be drawn in the shadow maps.
+	static bool isShadowCaster(Actor* actor);
+
+	/// Fills m_shadowCasters with the casters that could be seen by the light (using its range and cone) and
+	/// classifies them to the faces of the shadow map. Point lights have 6 faces, the other lights have only one.
+	void gatherShadowCasters(const ALight& light, const ShadowMapBuildInfo& buildInfo, LightShadowInfo& lsi);
+
+	/// Returns the static or the dynamic casters from m_shadowCasters that should be drawn in the specified face.
+	/// The result is valid until the next call.
+	const std::vector<Actor*>* getShadowCastersForFace(int iFace, bool isStatic);
+
+	/// Computes a hash of the light cameras and the static casters in m_shadowCasters (with their transforms).
+	/// If anything that affects the static shadow map changes the hash changes too.
+	/// @hasDynamicCasters is set to true if there are non-static casters in m_shadowCasters.
+	uint64 computeStaticShadowCastersHash(const ALight& light, const ShadowMapBuildInfo& buildInfo, bool& hasDynamicCasters) const;
+
+	/// (Re)creates the cube map shadow map and its face frame targets if their size doesn't match.
+	/// Returns true if new ones were created.
+	bool createPointLightShadowMap(GpuHandle<Texture>& depthTexture, GpuHandle<FrameTarget> faceFrameTargets[], int resolution);
+
+	/// (Re)creates the 2D shadow map frame target if its size doesn't match. Returns true if a new one was created.
+	bool createShadowMap(GpuHandle<FrameTarget>& frameTarget, int resolution);
+
+	/// Fills the lights affecting the actor. If @generalMods uses clustered lighting the lights in the clusters are skipped.
 	void fillGeneralModsWithLights(Actor* actor, GeneralDrawMod& generalMods);
 
+	/// Assigns the lights without shadow maps to the clusters of the draw camera and uploads them.
+	/// Returns nullptr if there are no such lights or if clustered lighting isn't supported.
+	const ClusteredLightingData* buildLightClusters(const GameDrawSets& drawSets);
+
+	/// Adds the meshes of the model to the render queue instead of drawing them immediately.
+	/// Returns false if the trait cannot be drawn via the render queue (for example if it is drawn as a wireframe),
+	/// in that case it should be drawn with drawTraitStaticModel().
+	bool enqueueTraitStaticModel(TraitModel* modelTrait,
+	                             const GameDrawSets& drawSets,
+	                             const GeneralDrawMod& generalMods,
+	                             DrawReason const drawReason);
+	void enqueueTraitMultiModel(TraitMultiModel* multiModelTrait, const GameDrawSets& drawSets, const GeneralDrawMod& generalMods);
+	void enqueueEvaluatedModel(const GameDrawSets& drawSets,
+	                           const GeneralDrawMod& generalMods,
+	                           const mat4f& preRoot,
+	                           const EvaluatedModel& model,
+	                           const InstanceDrawMods& mods,
+	                           const std::vector<MaterialOverride>* mtlOverrides);
+
+	/// Sorts and draws everything in the render queue and empties it.
+	/// Consecutive draws that differ only by their world transform and diffuse color are merged into instanced draws.
+	void flushRenderQueue(const GameDrawSets& drawSets, const GeneralDrawMod& generalMods);
+
+	/// Uploads m_instanceData to m_instanceBuffer, growing it if needed.
+	void uploadInstanceData(const GameDrawSets& drawSets);
+
+	/// Fills the material overrides specified in the trait.
+	void getMaterialOverrides(TraitModel* modelTrait, std::vector<MaterialOverride>& outMtlOverrides);
+
+	/// A draw waiting in the render queue.
+	struct QueuedDraw {
+		const Geometry* geometry = nullptr;
+		Material material;
+		mat4f world;
+		float worldDeterminant = 1.f;
+		InstanceDrawMods mods;
+		int shaderKey = 0;
+		// The lights affecting the draw are stored in m_queuedDrawLights.
+		int firstLight = 0;
+		int numLights = 0;
+	};
+
+	/// A range of sorted render queue items that are drawn with a single instanced draw.
+	struct InstancedBatch {
+		int firstItem = 0;
+		int numItems = 0;
+		int firstInstance = 0; // The index of the data of the first instance in m_instanceData.
+	};
+
   public:
 	BasicModelDraw m_modeldraw;
 	ConstantColorShader m_constantColorShader;
@@ -89,8 +186,17 @@ struct SGE_ENGINE_API DefaultGameDrawer : public IGameDrawer {
 	std::vector<ShadingLightData> shadingLights;
 	std::vector<const ShadingLightData*> m_shadingLightPerObject;
 
+	LightClusters m_lightClusters;
+	std::vector<const ShadingLightData*> m_clusteredLights;
+	std::vector<bool> m_isShadingLightClustered; ///< For every light in shadingLights, true if it is in m_lightClusters.
+
 	// TODO: find a proper place for this
-	std::map<ObjectId, LightShadowInfo> perLightShadowFrameTarget;
+	std::unordered_map<ObjectId, LightShadowInfo> perLightShadowFrameTarget;
+
+	// The shadow casters of the light that is currently being updated.
+	std::vector<Actor*> m_shadowCasters;
+	std::vector<int> m_shadowCasterFaceMasks; ///< For every caster a bit for every face of the shadow map that could see it.
+	std::vector<Actor*> m_shadowCastersForFace;
 
 	std::vector<TraitTexturedPlane*> texturedPlanes;
 	std::vector<TraitModel*> staticModels;
@@ -102,10 +208,23 @@ struct SGE_ENGINE_API DefaultGameDrawer : public IGameDrawer {
 
 	std::vector<Actor*> specialDrawnActors;
 
+	RenderQueue m_renderQueue;
+	std::vector<QueuedDraw> m_queuedDraws;
+	std::vector<const ShadingLightData*> m_queuedDrawLights;
+	std::vector<MaterialOverride> m_tempMtlOverrides;
+	RenderQueueStats m_renderQueueStats;
+	std::vector<InstancedBatch> m_instancedBatches;
+	std::vector<ModelInstanceData> m_instanceData;
+	GpuHandle<Buffer> m_instanceBuffer;
+
 	GpuHandle<Buffer> m_skySphereVB;
 	int m_skySphereNumVerts = 0;
 	VertexDeclIndex m_skySphereVBVertexDeclIdx;
 	GpuHandle<ShadingProgram> m_skyGradientShader;
+
+	/// Identifies the frame being drawn, used to evaluate the animated models once per frame.
+	/// Changes on every prepareForNewFrame(), even if the game is paused, and is unique across all drawers.
+	int m_frameStamp = 0;
 };
 
 } // namespace sge
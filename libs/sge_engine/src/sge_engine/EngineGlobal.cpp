@@ -114,6 +114,10 @@ void EngineGlobal::initialize() {
 }
 
 void EngineGlobal::update(float dt) {
+	// Finish loading the assets requested asynchronously, without stalling the frame for too long.
+	const float kAsyncAssetLoadsBudgetSeconds = 0.004f;
+	getCore()->getAssetLib()->finalizeAsyncLoads(kAsyncAssetLoadsBudgetSeconds);
+
 	// Delete expiered notification messages.
 	for (int t = 0; t < int(m_notifications.size()); ++t) {
 		m_notifications[t].timeDisplayed += dt;
@@ -45,8 +45,8 @@ void IGameDrawer::drawWorld(const GameDrawSets& drawSets, const DrawReason drawR
 	}
 
 	if (drawReason == drawReason_gameplay) {
-		for (ObjectId scriptObj : getWorld()->m_scriptObjects) {
-			if (IWorldScript* script = dynamic_cast<IWorldScript*>(getWorld()->getObjectById(scriptObj))) {
+		for (int iScript = 0; iScript < int(getWorld()->m_scriptObjects.size()); ++iScript) {
+			if (IWorldScript* script = getWorld()->getWorldScript(iScript)) {
 				script->onPostDraw(drawSets);
 			}
 		}
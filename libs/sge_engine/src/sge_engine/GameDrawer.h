@@ -2,6 +2,7 @@
 
 #include "Actor.h"
 #include "sge_renderer/renderer/renderer.h"
+#include <vector>
 
 namespace sge {
 
@@ -81,6 +82,9 @@ struct GameDrawSets {
 	ICamera* gameCamera = nullptr; // The camera that the player is going to be using.
 	IGameDrawer* gameDrawer = nullptr;
 	ShadowMapBuildInfo* shadowMapBuildInfo = nullptr; // The build info of the shadow map we are currenty rendering (if we do).
+	// If not null only these actors are drawn, without culling them against the draw camera.
+	// Used when rendering shadow maps, as the casters are culled per light beforehand.
+	const std::vector<Actor*>* shadowCasters = nullptr;
 };
 
 //--------------------------------------------------------------------
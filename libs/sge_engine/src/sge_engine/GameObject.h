@@ -47,39 +47,30 @@ struct ObjectId {
 
 DefineTypeIdInline(ObjectId, 20'03'06'0005);
 
-// struct ObjectIdHint {
-//	ObjectId id;
-//	TypeId type = nullptr;
-//	int index = -1;
-//
-//	ObjectIdHint() = default;
-//	ObjectIdHint(ObjectId id, TypeId type, int index)
-//	    : id(id)
-//	    , type(type)
-//	    , index(index) {
-//	}
-//
-//	bool isNull() const {
-//		return id.isNull();
-//	}
-//
-//	bool hasValidHint() {
-//		return type != nullptr && index >= 0;
-//	}
-//
-//	bool operator<(const ObjectIdHint& r) const {
-//		return id.id < r.id.id;
-//	}
-//	bool operator>(const ObjectIdHint& r) const {
-//		return id.id > r.id.id;
-//	}
-//	bool operator==(const ObjectIdHint& r) const {
-//		return id.id == r.id.id;
-//	}
-//	bool operator!=(const ObjectIdHint& r) const {
-//		return id.id != r.id.id;
-//	}
-//};
+//--------------------------------------------------------------------
+// ObjectHandle
+//--------------------------------------------------------------------
+
+/// @brief A generational handle to a game object living in a GameWorld.
+/// The handle stores the index of the slot that holds the object in the world and the generation of that slot.
+/// Every time an object gets deleted the generation of its slot changes, so a handle to a deleted object
+/// is detected even if the slot is later reused by another object.
+/// Resolve handles with GameWorld::getObjectByHandle() which is a single array access.
+/// Handles are runtime only, they are not saveable. Use ObjectId for serialization.
+struct ObjectHandle {
+	int slotIndex = -1;
+	int generation = 0;
+
+	ObjectHandle() = default;
+	ObjectHandle(int const slotIndex, int const generation)
+	    : slotIndex(slotIndex)
+	    , generation(generation) {}
+
+	bool isNull() const { return slotIndex < 0; }
+
+	bool operator==(const ObjectHandle& r) const { return slotIndex == r.slotIndex && generation == r.generation; }
+	bool operator!=(const ObjectHandle& r) const { return !(*this == r); }
+};
 
 //--------------------------------------------------------------------
 //
@@ -103,6 +94,8 @@ struct SGE_ENGINE_API GameObject : public NoncopyableMovable {
 
 	ObjectId getId() const { return m_id; }
 	TypeId getType() const { return m_type; }
+	/// Returns the index of the slot in the GameWorld holding this object. See ObjectHandle.
+	int getSlotIndex() const { return m_slotIndex; }
 	const std::string& getDisplayName() const { return m_displayName; }
 	const char* getDisplayNameCStr() const { return m_displayName.c_str(); }
 	void setDisplayName(std::string name) { m_displayName = std::move(name); }
@@ -162,7 +155,8 @@ struct SGE_ENGINE_API GameObject : public NoncopyableMovable {
 
   public: // TODO: private
 	ObjectId m_id;
-	TypeId m_type; // the QuickTypeId of the inherited class.
+	TypeId m_type;        // the QuickTypeId of the inherited class.
+	int m_slotIndex = -1; // The index of the slot in GameWorld::m_objectSlots holding this object.
 	int m_dirtyIndex = 0;
 
 	std::string m_displayName;
@@ -476,6 +476,228 @@ GameObject*
 	return deserializeObject(world, parser.getRoot(), shouldGenerateNewId, outOriginalId);
 }
 
+//----------------------------------------------------------------
+// Cloning
+//----------------------------------------------------------------
+
+/// A single step of cloning a value. See TypeClonePlan.
+struct CloneOp {
+	enum Kind {
+		kind_copyFn,         ///< Copy the value with TypeDesc::copyFn.
+		kind_objectId,       ///< Copy an ObjectId remapping it if needed.
+		kind_stdVector,      ///< Resize the std::vector and clone each of its elements.
+		kind_getterSetter,   ///< Copy a member via its MemberDesc::getDataFn/setDataFn.
+		kind_logicTransform, ///< Copy Actor::m_logicTransform via Actor::setTransform.
+	};
+
+	Kind kind = kind_copyFn;
+	/// The offset of the value from the start of the cloned type.
+	/// For kind_getterSetter this is the offset of the struct that owns the member.
+	int byteOffset = 0;
+	const TypeDesc* typeDesc = nullptr;
+	const MemberDesc* mfd = nullptr;
+	bool isPrefabDontCopy = false; ///< True if the value is (a part of) a member marked with MFF_PrefabDontCopy.
+};
+
+/// The steps needed to clone a value of some type. The steps of the members of nested structs are flattened into
+/// the plan of the containing type with their byte offsets adjusted, so cloning does not need to walk the reflection
+/// and lookup types. The kind_objectId steps form the table of ObjectId values that might need remapping.
+struct TypeClonePlan {
+	std::vector<CloneOp> ops;
+	bool hasObjectIds = false;
+	/// True if the plan is a single kind_copyFn step copying the whole value.
+	bool isWholeCopy = false;
+};
+
+static const TypeClonePlan& getClonePlan(const TypeDesc& typeDesc) {
+	if (typeDesc.clonePlan) {
+		return *typeDesc.clonePlan;
+	}
+
+	std::shared_ptr<TypeClonePlan> plan = std::make_shared<TypeClonePlan>();
+
+	if (typeDesc.typeId == sgeTypeId(ObjectId)) {
+		CloneOp op;
+		op.kind = CloneOp::kind_objectId;
+		op.typeDesc = &typeDesc;
+		plan->ops.push_back(op);
+		plan->hasObjectIds = true;
+	} else if (typeDesc.stdVectorUnderlayingType.isValid()) {
+		const TypeDesc* const elementTypeDesc = typeLib().find(typeDesc.stdVectorUnderlayingType);
+		sgeAssert(elementTypeDesc != nullptr);
+		plan->hasObjectIds = elementTypeDesc && getClonePlan(*elementTypeDesc).hasObjectIds;
+
+		// The vector could be copied as a whole only if its elements could.
+		const bool canCopyWhole = elementTypeDesc && getClonePlan(*elementTypeDesc).isWholeCopy && typeDesc.copyFn != nullptr;
+
+		CloneOp op;
+		op.kind = canCopyWhole ? CloneOp::kind_copyFn : CloneOp::kind_stdVector;
+		op.typeDesc = &typeDesc;
+		plan->ops.push_back(op);
+		plan->isWholeCopy = canCopyWhole;
+	} else if (typeDesc.members.empty()) {
+		// Primitive types, strings, enums, maps and so on. Types that cannot be copied are skipped,
+		// the same way the serialization skips the types it cannot save.
+		if (typeDesc.copyFn != nullptr) {
+			CloneOp op;
+			op.kind = CloneOp::kind_copyFn;
+			op.typeDesc = &typeDesc;
+			plan->ops.push_back(op);
+			plan->isWholeCopy = true;
+		}
+	} else {
+		// A struct, clone each member as the serialization does.
+		const bool isGameObject = typeDesc.doesInherits(sgeTypeId(GameObject));
+
+		// The struct could be copied as a whole only if that is exactly what cloning the members does.
+		// If the members don't cover the whole struct it has padding or state that isn't reflected, which
+		// must not be copied, so the member-wise cloning is used.
+		bool canCopyWhole = isGameObject == false && typeDesc.copyFn != nullptr;
+		int membersSizeBytes = 0;
+
+		for (const MemberDesc& mfd : typeDesc.members) {
+			if (mfd.isSaveable() == false) {
+				canCopyWhole = false;
+				continue;
+			}
+
+			const TypeDesc* const memberTypeDesc = typeLib().find(mfd.typeId);
+			if (memberTypeDesc == nullptr) {
+				SGE_DEBUG_ERR("[SERIALIZATION] Found a member without TypeDesc in type %s\n", typeDesc.name);
+				sgeAssert(false);
+				continue;
+			}
+
+			const TypeClonePlan& memberPlan = getClonePlan(*memberTypeDesc);
+			plan->hasObjectIds |= memberPlan.hasObjectIds;
+
+			CloneOp op;
+			op.typeDesc = memberTypeDesc;
+			op.isPrefabDontCopy = (mfd.flags & MFF_PrefabDontCopy) != 0;
+
+			canCopyWhole &= mfd.byteOffset >= 0 && memberPlan.isWholeCopy && op.isPrefabDontCopy == false;
+			membersSizeBytes += mfd.sizeBytes;
+
+			if (isGameObject && mfd.is(&Actor::m_logicTransform)) {
+				op.kind = CloneOp::kind_logicTransform;
+				op.byteOffset = mfd.byteOffset;
+				plan->ops.push_back(op);
+			} else if (mfd.byteOffset >= 0) {
+				for (const CloneOp& memberOp : memberPlan.ops) {
+					plan->ops.push_back(memberOp);
+					plan->ops.back().byteOffset += mfd.byteOffset;
+					plan->ops.back().isPrefabDontCopy |= op.isPrefabDontCopy;
+				}
+			} else if (mfd.getDataFn != nullptr && mfd.setDataFn != nullptr) {
+				op.kind = CloneOp::kind_getterSetter;
+				op.mfd = &mfd;
+				plan->ops.push_back(op);
+			}
+		}
+
+		// Game objects are never copied as a whole as they hold their id, world and so on.
+		if (canCopyWhole && membersSizeBytes == typeDesc.sizeBytes) {
+			CloneOp op;
+			op.kind = CloneOp::kind_copyFn;
+			op.typeDesc = &typeDesc;
+			plan->ops.assign(1, op);
+			plan->isWholeCopy = true;
+		}
+	}
+
+	typeDesc.clonePlan = plan;
+	return *plan;
+}
+
+static void executeClonePlan(const TypeClonePlan& plan,
+                             char* const dest,
+                             const char* const src,
+                             GameObject* const destObject,
+                             const bool isPrefabCopy,
+                             const std::unordered_map<ObjectId, ObjectId>* const idRemap) {
+	for (const CloneOp& op : plan.ops) {
+		if (isPrefabCopy && op.isPrefabDontCopy) {
+			continue;
+		}
+
+		char* const destValue = dest + op.byteOffset;
+		const char* const srcValue = src + op.byteOffset;
+
+		switch (op.kind) {
+			case CloneOp::kind_copyFn: {
+				op.typeDesc->copyFn(destValue, srcValue);
+			} break;
+			case CloneOp::kind_objectId: {
+				const ObjectId& srcId = *reinterpret_cast<const ObjectId*>(srcValue);
+				ObjectId& destId = *reinterpret_cast<ObjectId*>(destValue);
+				destId = srcId;
+				if (idRemap != nullptr) {
+					const auto itr = idRemap->find(srcId);
+					if (itr != idRemap->end()) {
+						destId = itr->second;
+					}
+				}
+			} break;
+			case CloneOp::kind_stdVector: {
+				const TypeDesc* const elementTypeDesc = typeLib().find(op.typeDesc->stdVectorUnderlayingType);
+				if_checked(elementTypeDesc) {
+					const TypeClonePlan& elementPlan = getClonePlan(*elementTypeDesc);
+					const size_t numElements = op.typeDesc->stdVectorSize(srcValue);
+					op.typeDesc->stdVectorResize(destValue, numElements);
+					for (size_t t = 0; t < numElements; ++t) {
+						char* const destElement = (char*)op.typeDesc->stdVectorGetElement(destValue, t);
+						const char* const srcElement = (const char*)op.typeDesc->stdVectorGetElementConst(srcValue, t);
+						executeClonePlan(elementPlan, destElement, srcElement, nullptr, false, idRemap);
+					}
+				}
+			} break;
+			case CloneOp::kind_getterSetter: {
+				char* const memberData = (char*)alloca(op.mfd->sizeBytes);
+				op.typeDesc->constructorFn(memberData);
+				op.mfd->getDataFn((void*)srcValue, memberData);
+
+				// Cloning a value into itself only remaps the ids in it.
+				const TypeClonePlan& memberPlan = getClonePlan(*op.typeDesc);
+				if (memberPlan.hasObjectIds && idRemap != nullptr) {
+					executeClonePlan(memberPlan, memberData, memberData, nullptr, false, idRemap);
+				}
+
+				op.mfd->setDataFn(destValue, memberData);
+				op.typeDesc->destructorFn(memberData);
+			} break;
+			case CloneOp::kind_logicTransform: {
+				Actor* const actor = destObject ? destObject->getActor() : nullptr;
+				if_checked(actor) { actor->setTransform(*reinterpret_cast<const transf3d*>(srcValue)); }
+			} break;
+		}
+	}
+}
+
+void cloneVariable(char* const dest,
+                   const char* const src,
+                   const TypeDesc* const typeDesc,
+                   const std::unordered_map<ObjectId, ObjectId>* idRemap) {
+	if_checked(dest && src && typeDesc) { executeClonePlan(getClonePlan(*typeDesc), dest, src, nullptr, false, idRemap); }
+}
+
+void cloneObjectMembers(GameObject* const destObject,
+                        const GameObject* const srcObject,
+                        const bool isPrefabCopy,
+                        const std::unordered_map<ObjectId, ObjectId>* idRemap) {
+	if (destObject == nullptr || srcObject == nullptr || destObject->getType() != srcObject->getType()) {
+		sgeAssert(false);
+		return;
+	}
+
+	const TypeDesc* const typeDesc = typeLib().find(srcObject->getType());
+	if_checked(typeDesc) {
+		executeClonePlan(getClonePlan(*typeDesc), (char*)destObject, (const char*)srcObject, destObject, isPrefabCopy, idRemap);
+	}
+
+	destObject->makeDirtyExternal();
+	destObject->onMemberChanged();
+}
+
 JsonValue* serializeGameWorld(const GameWorld* world, JsonValueBuffer& jvb) {
 	JsonValue* const jWorld = jvb(JID_MAP);
 
@@ -511,14 +733,19 @@ JsonValue* serializeGameWorld(const GameWorld* world, JsonValueBuffer& jvb) {
 	jWorld->setMember("worldScripts", serializeVariableT(world->m_scriptObjects, jvb));
 
 	// Hierarchical relationships.
-	// Do not serialize the m_parentOf as we can restore it by using this information.
+	// Only the children of each parent are serialized, the parent of each object can be restored by using this information.
 	JsonValue* const jHierarchy = jWorld->setMember("hierarchy", jvb(JID_ARRAY));
-	for (auto itr_parent2childs : world->m_childernOf) {
-		jHierarchy->arrPush(jvb(itr_parent2childs.first.id));
+	for (const GameWorld::ObjectSlot& slot : world->m_objectSlots) {
+		const GameWorld::HierarchyRange children = world->getChildrenOf(slot.object);
+		if (children.isEmpty()) {
+			continue;
+		}
+
+		jHierarchy->arrPush(jvb(slot.object->getId().id));
 		JsonValue* const jChilds = jHierarchy->arrPush(jvb(JID_ARRAY));
 
-		for (const ObjectId id : itr_parent2childs.second) {
-			jChilds->arrPush(jvb(id.id));
+		for (const Actor* const child : children) {
+			jChilds->arrPush(jvb(child->getId().id));
 		}
 	}
 
@@ -651,13 +878,18 @@ bool loadGameWorldFromStream(GameWorld* world, IReadStream* stream, const char*
 	if (jHierarchy) {
 		for (int iParent = 0; iParent < jHierarchy->arrSize(); iParent += 2) {
 			ObjectId const parentId(jHierarchy->arrAt(iParent)->getNumberAs<int>());
+			const GameObject* const parent = world->getObjectById(parentId);
 
-			auto& childList = world->m_childernOf[parentId];
 			const JsonValue* const jChildren = jHierarchy->arrAt(iParent + 1);
 			for (int iChild = 0; iChild < jChildren->arrSize(); ++iChild) {
 				ObjectId const childId(jChildren->arrAt(iChild)->getNumberAs<int>());
-				childList.add(childId);
-				world->m_parentOf[childId] = parentId;
+				const GameObject* const child = world->getObjectById(childId);
+
+				// The binding transforms are already loaded, so just link the objects without recomputing them.
+				if (parent && child) {
+					world->unlinkFromParentSlot(child->getSlotIndex());
+					world->linkToParentSlot(child->getSlotIndex(), parent->getSlotIndex());
+				}
 			}
 		}
 	}
@@ -3,6 +3,7 @@
 #include "sge_engine/TypeRegister.h"
 #include "sge_engine_api.h"
 #include <string>
+#include <unordered_map>
 
 namespace sge {
 
@@ -42,6 +43,21 @@ SGE_ENGINE_API GameObject*
 SGE_ENGINE_API JsonValue* serializeVariable(const TypeDesc* const typeDesc, const char* const data, JsonValueBuffer& jvb);
 SGE_ENGINE_API bool deserializeVariable(char* const valueData, const JsonValue* jValue, const TypeDesc* const typeDesc);
 
+/// Copies the value @src into @dest, both of type @typeDesc. The result is the same as serializing @src and deserializing
+/// the result into @dest, but without going through json. Values of types without ObjectId members are copied with TypeDesc::copyFn.
+/// @param [in] idRemap if not null, every ObjectId value found as a key in the map is replaced with the mapped value.
+SGE_ENGINE_API void cloneVariable(char* const dest, const char* const src, const TypeDesc* const typeDesc, const std::unordered_map<ObjectId, ObjectId>* idRemap);
+
+/// Copies the saveable members of @srcObject into @destObject, both objects must be of the same type.
+/// The result is the same as serializing @srcObject and deserializing it into @destObject, including calling
+/// GameObject::makeDirtyExternal and GameObject::onMemberChanged of @destObject afterwards.
+/// @param [in] isPrefabCopy if true the members marked with MFF_PrefabDontCopy are not copied.
+/// @param [in] idRemap if not null, every ObjectId value found as a key in the map is replaced with the mapped value.
+SGE_ENGINE_API void cloneObjectMembers(GameObject* const destObject,
+                                       const GameObject* const srcObject,
+                                       const bool isPrefabCopy,
+                                       const std::unordered_map<ObjectId, ObjectId>* idRemap);
+
 template <typename T>
 JsonValue* serializeVariableT(const T& value, JsonValueBuffer& jvb) {
 	return serializeVariable(typeLib().find(sgeTypeId(T)), (char*)&value, jvb);
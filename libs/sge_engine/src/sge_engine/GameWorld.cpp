@@ -13,6 +13,61 @@
 
 namespace sge {
 
+//-----------------------------------------------------------
+// WorldCommandBuffer
+//-----------------------------------------------------------
+void WorldCommandBuffer::createObject(TypeId const type, std::function<void(GameObject*)> onCreated) {
+	Command cmd;
+	cmd.type = Command::Type_CreateObject;
+	cmd.typeToCreate = type;
+	cmd.onCreated = std::move(onCreated);
+	m_commands.emplace_back(std::move(cmd));
+}
+
+void WorldCommandBuffer::killObject(ObjectId const id) {
+	Command cmd;
+	cmd.type = Command::Type_KillObject;
+	cmd.objectId = id;
+	m_commands.emplace_back(std::move(cmd));
+}
+
+void WorldCommandBuffer::setParentOf(ObjectId const child, ObjectId const newParent) {
+	Command cmd;
+	cmd.type = Command::Type_SetParent;
+	cmd.objectId = child;
+	cmd.newParentId = newParent;
+	m_commands.emplace_back(std::move(cmd));
+}
+
+void WorldCommandBuffer::applyAndClear(GameWorld& world) {
+	// Commands might record new commands (for example the onCreated callback), so do not use iterators.
+	for (int iCmd = 0; iCmd < int(m_commands.size()); ++iCmd) {
+		Command cmd = std::move(m_commands[iCmd]);
+		switch (cmd.type) {
+			case Command::Type_CreateObject: {
+				GameObject* const object = world.allocObject(cmd.typeToCreate);
+				if (object && cmd.onCreated) {
+					cmd.onCreated(object);
+				}
+			} break;
+			case Command::Type_KillObject: {
+				world.objectDelete(cmd.objectId);
+			} break;
+			case Command::Type_SetParent: {
+				// The objects might have been killed by the time the command gets applied.
+				world.setParentOf(cmd.objectId, cmd.newParentId, true);
+			} break;
+			default:
+				sgeAssert(false && "Unknown command type!");
+		}
+	}
+
+	m_commands.clear();
+}
+
+//-----------------------------------------------------------
+// GameWorld
+//-----------------------------------------------------------
 ObjectId GameWorld::getNewId() {
 	ObjectId id(m_nextObjectId);
 	m_nextObjectId++;
@@ -20,38 +75,18 @@ ObjectId GameWorld::getNewId() {
 }
 
 bool GameWorld::isIdTaken(ObjectId const id) const {
-	bool result = false;
-	iterateOverPlayingObjects(
-	    [&](const GameObject* obj) -> bool {
-		    if (obj->getId() == id) {
-			    result = true;
-			    return false;
-		    }
-
-		    return true;
-	    },
-	    true);
-
-
-	return result;
+	return m_objectsById.count(id) != 0;
 }
 
 GameObject* GameWorld::getObjectById(const ObjectId& id) {
 	debug.numCallsToGetObjectByIdThisFrame++;
 
-	GameObject* result = nullptr;
-	iterateOverPlayingObjects(
-	    [&](GameObject* obj) -> bool {
-		    if (obj->getId() == id) {
-			    result = obj;
-			    return false;
-		    }
-
-		    return true;
-	    },
-	    true);
+	const auto itr = m_objectsById.find(id);
+	if (itr == m_objectsById.end()) {
+		return nullptr;
+	}
 
-	return result;
+	return itr->second;
 }
 
 Actor* GameWorld::getActorById(const ObjectId& id) {
@@ -59,6 +94,40 @@ Actor* GameWorld::getActorById(const ObjectId& id) {
 	return obj ? obj->getActor() : nullptr;
 }
 
+GameObject* GameWorld::getObjectById(const ObjectId& id, ObjectHandle& hint) {
+	GameObject* const hintedObject = getObjectByHandle(hint);
+	if (hintedObject != nullptr && hintedObject->getId() == id) {
+		debug.numCallsToGetObjectByIdThisFrame++;
+		return hintedObject;
+	}
+
+	GameObject* const object = getObjectById(id);
+	hint = getObjectHandle(object);
+	return object;
+}
+
+Actor* GameWorld::getActorById(const ObjectId& id, ObjectHandle& hint) {
+	GameObject* obj = getObjectById(id, hint);
+	return obj ? obj->getActor() : nullptr;
+}
+
+ObjectHandle GameWorld::getObjectHandle(const ObjectId& id) {
+	return getObjectHandle(getObjectById(id));
+}
+
+ObjectHandle GameWorld::getObjectHandle(const GameObject* object) const {
+	if (object == nullptr || object->getSlotIndex() < 0 || object->getSlotIndex() >= int(m_objectSlots.size())) {
+		return ObjectHandle();
+	}
+
+	const ObjectSlot& slot = m_objectSlots[object->getSlotIndex()];
+	if (slot.object != object) {
+		return ObjectHandle();
+	}
+
+	return ObjectHandle(object->getSlotIndex(), slot.generation);
+}
+
 GameObject* GameWorld::getObjectByName(const char* name) {
 	GameObject* result = nullptr;
 	iterateOverPlayingObjects(
@@ -152,6 +221,8 @@ void GameWorld::iterateOverPlayingObjects(const std::function<bool(const GameObj
 }
 
 GameObject* GameWorld::allocObject(TypeId const type, ObjectId const specificId, const char* name) {
+	sgeAssert(m_isInParallelUpdate == false && "Use getCommandBuffer() in the parallel update phase!");
+
 	// If a specific id is desiered first check if this id is available for use.
 	if (!specificId.isNull()) {
 		if (isIdTaken(specificId)) {
@@ -183,7 +254,21 @@ GameObject* GameWorld::allocObject(TypeId const type, ObjectId const specificId,
 		object->worldInitializeMe(this, newObjectId, type, std::move(displayName));
 		object->create();
 
+		// Find a slot for the object, reuse the slots of deleted objects if possible.
+		int slotIndex = -1;
+		if (m_freeObjectSlots.empty() == false) {
+			slotIndex = m_freeObjectSlots.back();
+			m_freeObjectSlots.pop_back();
+		} else {
+			slotIndex = int(m_objectSlots.size());
+			m_objectSlots.emplace_back();
+		}
+
+		m_objectSlots[slotIndex].object = object;
+		object->m_slotIndex = slotIndex;
+
 		awaitsCreationObjects.push_back(object);
+		m_objectsById[newObjectId] = object;
 
 		return object;
 	}
@@ -204,9 +289,68 @@ Actor* GameWorld::allocActor(TypeId const type, ObjectId const specificId, const
 }
 
 void GameWorld::objectDelete(const ObjectId& id) {
+	sgeAssert(m_isInParallelUpdate == false && "Use getCommandBuffer() in the parallel update phase!");
 	objectsWantingPermanentKill.add(id);
 }
 
+WorldCommandBuffer& GameWorld::getCommandBuffer() {
+	if (m_commandBuffers.empty()) {
+		m_commandBuffers.resize(1);
+	}
+
+	const int threadIndex = m_jobSystem.getCurrentThreadIndex();
+	sgeAssert(threadIndex < int(m_commandBuffers.size()));
+	return m_commandBuffers[threadIndex];
+}
+
+JobSystem& GameWorld::getJobSystem() {
+	if (m_jobSystem.isCreated() == false) {
+		m_jobSystem.create(JobSystem::getRecommendedNumWorkers());
+	}
+
+	return m_jobSystem;
+}
+
+void GameWorld::applyCommandBuffers() {
+	sgeAssert(m_isInParallelUpdate == false);
+	for (WorldCommandBuffer& commandBuffer : m_commandBuffers) {
+		commandBuffer.applyAndClear(*this);
+	}
+}
+
+void GameWorld::updateObjectsInParallel(const std::vector<std::vector<GameObject*>*>& objectLists,
+                                        const GameUpdateSets& updateSets,
+                                        bool isPostUpdate) {
+	m_parallelUpdateObjects.clear();
+	for (const std::vector<GameObject*>* const objectsOfType : objectLists) {
+		m_parallelUpdateObjects.insert(m_parallelUpdateObjects.end(), objectsOfType->begin(), objectsOfType->end());
+	}
+
+	if (m_parallelUpdateObjects.empty() == false) {
+		JobSystem& jobSystem = getJobSystem();
+		if (int(m_commandBuffers.size()) < jobSystem.getNumThreads()) {
+			m_commandBuffers.resize(jobSystem.getNumThreads());
+		}
+
+		m_isInParallelUpdate = true;
+		jobSystem.parallelFor(int(m_parallelUpdateObjects.size()), m_parallelUpdateBatchSize, [&](int begin, int end) -> void {
+			for (int t = begin; t < end; ++t) {
+				GameObject* const object = m_parallelUpdateObjects[t];
+				sgeAssert(object != nullptr);
+				if (isPostUpdate) {
+					object->postUpdate(updateSets);
+				} else {
+					object->update(updateSets);
+				}
+			}
+		});
+		m_isInParallelUpdate = false;
+	}
+
+	// The sync point, all objects are done updating, it is safe to modify the world.
+	applyCommandBuffers();
+}
+
 void GameWorld::create() {
 	physicsWorld.create();
 	physicsWorld.dynamicsWorld->setGravity(toBullet(m_defaultGravity));
@@ -233,11 +377,29 @@ void GameWorld::clear() {
 	}
 
 	playingObjects.clear();
+	m_playingObjectsWithUpdate.clear();
+	m_playingObjectsWithPostUpdate.clear();
+	m_parallelPlayingObjectsWithUpdate.clear();
+	m_parallelPlayingObjectsWithPostUpdate.clear();
+	m_parallelUpdateObjects.clear();
+	m_commandBuffers.clear();
 
 	for (GameObject* const object : awaitsCreationObjects) {
 		delete object;
 	}
 	awaitsCreationObjects.clear();
+	m_objectsById.clear();
+
+	// Keep the slots, but change their generation, so existing handles would not point to the new objects.
+	m_freeObjectSlots.clear();
+	for (int iSlot = int(m_objectSlots.size()) - 1; iSlot >= 0; --iSlot) {
+		ObjectSlot& slot = m_objectSlots[iSlot];
+		const int generation = slot.generation;
+		slot = ObjectSlot();
+		slot.generation = generation + 1;
+		m_freeObjectSlots.push_back(iSlot);
+	}
+	m_scriptObjectsHints.clear();
 
 	m_nextNameIndex = 0;
 	totalStepsTaken = 0;
@@ -249,9 +411,6 @@ void GameWorld::clear() {
 	m_skyColorBottom = vec3f(0.419f);
 	m_skyColorTop = vec3f(0.133f);
 
-	m_childernOf.clear();
-	m_parentOf.clear();
-
 	physicsWorld.destroy();
 	m_physicsManifoldList.clear();
 
@@ -288,16 +447,44 @@ void GameWorld::update(const GameUpdateSets& updateSets) {
 	}
 
 	debug.numCallsToGetObjectByIdThisFrame = 0;
+	debug.numPropagatedTransformsThisFrame = 0;
 
 	// Update Audio device
-	getCore()->getAudioDevice()->setMasterVolume(m_masterVolume);
+	if (AudioDevice* const audioDevice = getCore()->getAudioDevice()) {
+		audioDevice->setMasterVolume(m_masterVolume);
+	}
 
 	m_cachedUpdateSets = updateSets;
 
 	// Add the objects that were created.
 	for (int t = 0; t < awaitsCreationObjects.size(); ++t) {
 		GameObject* const object = awaitsCreationObjects[t];
-		playingObjects[object->getType()].emplace_back(object);
+
+		auto itrPlayingOfType = playingObjects.find(object->getType());
+		if (itrPlayingOfType == playingObjects.end()) {
+			// This is the 1st object of its type, check if the type needs to get updated.
+			// Note: The pointers to the elements of std::unordered_map are stable even on rehashing.
+			itrPlayingOfType = playingObjects.emplace(object->getType(), std::vector<GameObject*>()).first;
+
+			const TypeDesc* const typeDesc = typeLib().find(object->getType());
+			if (typeDesc == nullptr || typeDesc->gameObjectDesc.overridesUpdate) {
+				if (typeDesc && typeDesc->gameObjectDesc.isUpdateThreadSafe) {
+					m_parallelPlayingObjectsWithUpdate.push_back(&itrPlayingOfType->second);
+				} else {
+					m_playingObjectsWithUpdate.push_back(&itrPlayingOfType->second);
+				}
+			}
+
+			if (typeDesc == nullptr || typeDesc->gameObjectDesc.overridesPostUpdate) {
+				if (typeDesc && typeDesc->gameObjectDesc.isPostUpdateThreadSafe) {
+					m_parallelPlayingObjectsWithPostUpdate.push_back(&itrPlayingOfType->second);
+				} else {
+					m_playingObjectsWithPostUpdate.push_back(&itrPlayingOfType->second);
+				}
+			}
+		}
+
+		itrPlayingOfType->second.emplace_back(object);
 		object->onPlayStateChanged(true);
 	}
 	awaitsCreationObjects.clear();
@@ -326,12 +513,22 @@ void GameWorld::update(const GameUpdateSets& updateSets) {
 						setParentOf(objectToKill->getId(), ObjectId());
 
 						// Unparent all childrend objects.
-						vector_set<ObjectId> childrenList = getChildensOfAsList(actorsOfType[t]->getId());
-						for (int iChild = 0; iChild < childrenList.size(); iChild++) {
-							setParentOf(childrenList.getNth(iChild), ObjectId());
+						for (int childSlot = m_objectSlots[objectToKill->getSlotIndex()].firstChildSlot; childSlot >= 0;
+						     childSlot = m_objectSlots[objectToKill->getSlotIndex()].firstChildSlot) {
+							setParentOf(m_objectSlots[childSlot].object->getId(), ObjectId());
 						}
 					}
 					actorsOfType.erase(actorsOfType.begin() + t);
+					m_objectsById.erase(objToKillId);
+
+					// Free the slot of the object. Changing the generation invalidates all handles pointing to the object.
+					ObjectSlot& slot = m_objectSlots[objectToKill->getSlotIndex()];
+					sgeAssert(slot.object == objectToKill);
+					sgeAssert(slot.parentSlot == -1 && slot.firstChildSlot == -1);
+					slot.object = nullptr;
+					slot.generation++;
+					m_freeObjectSlots.push_back(objectToKill->getSlotIndex());
+
 					delete objectToKill;
 					objectToKill = nullptr;
 					break;
@@ -342,8 +539,8 @@ void GameWorld::update(const GameUpdateSets& updateSets) {
 	objectsWantingPermanentKill.clear();
 
 	// Call pre update for scripts.
-	for (ObjectId scriptObj : m_scriptObjects) {
-		if (IWorldScript* script = dynamic_cast<IWorldScript*>(getObjectById(scriptObj))) {
+	for (int iScript = 0; iScript < int(m_scriptObjects.size()); ++iScript) {
+		if (IWorldScript* script = getWorldScript(iScript)) {
 			script->onPreUpdate(updateSets);
 		}
 	}
@@ -381,31 +578,33 @@ void GameWorld::update(const GameUpdateSets& updateSets) {
 			physicsWorld.dynamicsWorld->updateAabbs();
 		}
 
-		// Update the game objects.
-		for (auto& itrActorByType : playingObjects) {
-			// TODO: skip object that have no update.
-			// This might help:
-			// https://stackoverflow.com/questions/4741271/ways-to-detect-whether-a-c-virtual-function-has-been-redefined-in-a-derived-cl
-			for (int t = 0; t < itrActorByType.second.size(); ++t) {
-				GameObject* const object = itrActorByType.second[t];
+		// Update the game objects. Types that do not override update() are skipped.
+		for (std::vector<GameObject*>* const objectsOfType : m_playingObjectsWithUpdate) {
+			for (int t = 0; t < objectsOfType->size(); ++t) {
+				GameObject* const object = (*objectsOfType)[t];
 				sgeAssert(object != nullptr);
 				object->update(updateSets);
 			}
 		}
 
-		// Post-Update the game objects.
-		for (auto& itrActorByType : playingObjects) {
-			// TODO: skip object that have no update.
-			for (int t = 0; t < itrActorByType.second.size(); ++t) {
-				GameObject* const object = itrActorByType.second[t];
+		// Update the objects of thread-safe types in parallel.
+		updateObjectsInParallel(m_parallelPlayingObjectsWithUpdate, updateSets, false);
+
+		// Post-Update the game objects. Types that do not override postUpdate() are skipped.
+		for (std::vector<GameObject*>* const objectsOfType : m_playingObjectsWithPostUpdate) {
+			for (int t = 0; t < objectsOfType->size(); ++t) {
+				GameObject* const object = (*objectsOfType)[t];
 				sgeAssert(object != nullptr);
 				object->postUpdate(updateSets);
 			}
 		}
 
+		// Post-Update the objects of thread-safe types in parallel.
+		updateObjectsInParallel(m_parallelPlayingObjectsWithPostUpdate, updateSets, true);
+
 		// Call post update for scripts.
-		for (ObjectId scriptObj : m_scriptObjects) {
-			if (IWorldScript* script = dynamic_cast<IWorldScript*>(getObjectById(scriptObj))) {
+		for (int iScript = 0; iScript < int(m_scriptObjects.size()); ++iScript) {
+			if (IWorldScript* script = getWorldScript(iScript)) {
 				script->onPostUpdate(updateSets);
 			}
 		}
@@ -425,23 +624,12 @@ int GameWorld::getNextNameIndex() {
 }
 
 bool GameWorld::setParentOf(ObjectId const childId, ObjectId const newParentId, bool doNotAssert) {
-	// TODO: Circular hierarchy checks.
+	sgeAssert(m_isInParallelUpdate == false && "Use getCommandBuffer() in the parallel update phase!");
+
 	if (childId == newParentId) {
 		return false;
 	}
 
-	// The new parent must not be anywhere below the child in the hierarchy,
-	// as this would introduce circular references.
-	{
-		vector_set<ObjectId> allHeirarchyUnderChild;
-		getAllChildren(allHeirarchyUnderChild, childId);
-		const bool isNewPerentInTheHierarchyOfTheChild = allHeirarchyUnderChild.count(newParentId) != 0;
-
-		if (isNewPerentInTheHierarchyOfTheChild) {
-			return false;
-		}
-	}
-
 	Actor* const child = getActorById(childId);
 	if (child == nullptr) {
 		if (doNotAssert == false) {
@@ -450,29 +638,27 @@ bool GameWorld::setParentOf(ObjectId const childId, ObjectId const newParentId,
 		return false;
 	}
 
-	// Unparent from exsiting parent
-	{
-		auto itr = m_parentOf.find(childId);
-		if (itr != m_parentOf.end()) {
-			// Remove from the parent't list of child nodes.
-			const ObjectId oldParent = itr->second;
-			m_childernOf[oldParent].eraseKey(childId);
-			if (m_childernOf[oldParent].size() == 0) {
-				m_childernOf.erase(oldParent);
-			}
+	const Actor* const newParent = newParentId.isNull() ? nullptr : getActorById(newParentId);
 
-			m_parentOf.erase(itr);
+	// The new parent must not be anywhere below the child in the hierarchy,
+	// as this would introduce circular references. Walk up the ancestors of the new parent to check that.
+	if (newParent != nullptr) {
+		for (int ancestorSlot = newParent->getSlotIndex(); ancestorSlot >= 0; ancestorSlot = m_objectSlots[ancestorSlot].parentSlot) {
+			if (ancestorSlot == child->getSlotIndex()) {
+				return false;
+			}
 		}
 	}
 
+	// Unparent from exsiting parent
+	unlinkFromParentSlot(child->getSlotIndex());
+
 	// Attach to the new parent.
 	if (newParentId.isNull()) {
 		child->m_bindingToParentTransform = transf3d::getIdentity();
 	} else {
-		const Actor* const newParent = getActorById(newParentId);
 		if_checked(newParent) {
-			m_parentOf[childId] = newParentId;
-			m_childernOf[newParentId].add(childId);
+			linkToParentSlot(child->getSlotIndex(), newParent->getSlotIndex());
 
 			transf3d const parentWs = newParent->getTransform();
 			transf3d const bindingTransform = child->getTransform().computeBindingTransform(parentWs);
@@ -484,12 +670,58 @@ bool GameWorld::setParentOf(ObjectId const childId, ObjectId const newParentId,
 	return false;
 }
 
+void GameWorld::linkToParentSlot(int childSlot, int parentSlot) {
+	ObjectSlot& child = m_objectSlots[childSlot];
+	ObjectSlot& parent = m_objectSlots[parentSlot];
+	sgeAssert(child.parentSlot == -1 && child.nextSiblingSlot == -1 && child.prevSiblingSlot == -1);
+
+	child.parentSlot = parentSlot;
+	child.prevSiblingSlot = parent.lastChildSlot;
+	if (parent.lastChildSlot >= 0) {
+		m_objectSlots[parent.lastChildSlot].nextSiblingSlot = childSlot;
+	} else {
+		parent.firstChildSlot = childSlot;
+	}
+	parent.lastChildSlot = childSlot;
+}
+
+void GameWorld::unlinkFromParentSlot(int childSlot) {
+	ObjectSlot& child = m_objectSlots[childSlot];
+	if (child.parentSlot < 0) {
+		return;
+	}
+
+	ObjectSlot& parent = m_objectSlots[child.parentSlot];
+
+	if (child.prevSiblingSlot >= 0) {
+		m_objectSlots[child.prevSiblingSlot].nextSiblingSlot = child.nextSiblingSlot;
+	} else {
+		parent.firstChildSlot = child.nextSiblingSlot;
+	}
+
+	if (child.nextSiblingSlot >= 0) {
+		m_objectSlots[child.nextSiblingSlot].prevSiblingSlot = child.prevSiblingSlot;
+	} else {
+		parent.lastChildSlot = child.prevSiblingSlot;
+	}
+
+	child.parentSlot = -1;
+	child.nextSiblingSlot = -1;
+	child.prevSiblingSlot = -1;
+}
+
 ObjectId GameWorld::getParentId(ObjectId const child) const {
-	const auto itr = m_parentOf.find(child);
-	if (itr != m_parentOf.end())
-		return itr->second;
+	const auto itr = m_objectsById.find(child);
+	if (itr == m_objectsById.end()) {
+		return ObjectId();
+	}
+
+	const int parentSlot = m_objectSlots[itr->second->getSlotIndex()].parentSlot;
+	if (parentSlot < 0) {
+		return ObjectId();
+	}
 
-	return ObjectId();
+	return m_objectSlots[parentSlot].object->getId();
 }
 
 Actor* GameWorld::getParentActor(ObjectId const child) {
@@ -510,23 +742,105 @@ ObjectId GameWorld::getRootParentId(ObjectId child) const {
 	}
 }
 
-const vector_set<ObjectId>* GameWorld::getChildensOf(ObjectId const parent) const {
-	const auto itr = m_childernOf.find(parent);
-	if (itr == m_childernOf.end())
-		return nullptr;
+//-----------------------------------------------------------
+// GameWorld::HierarchyIterator
+//-----------------------------------------------------------
+Actor* GameWorld::HierarchyIterator::operator*() const {
+	sgeAssert(slotIndex >= 0);
+	return world->m_objectSlots[slotIndex].object->getActor();
+}
+
+GameWorld::HierarchyIterator& GameWorld::HierarchyIterator::operator++() {
+	sgeAssert(slotIndex >= 0);
+	const std::vector<ObjectSlot>& slots = world->m_objectSlots;
+
+	// When visiting all descendants go down first, this way the nodes are visited in depth-first pre-order.
+	if (visitDescendants && slots[slotIndex].firstChildSlot >= 0) {
+		slotIndex = slots[slotIndex].firstChildSlot;
+		return *this;
+	}
+
+	// Go to the next sibling, if there isn't one climb up until one of the ancestors (below the root) has a sibling.
+	int current = slotIndex;
+	while (true) {
+		if (slots[current].nextSiblingSlot >= 0) {
+			slotIndex = slots[current].nextSiblingSlot;
+			return *this;
+		}
+
+		current = slots[current].parentSlot;
+		if (visitDescendants == false || current == rootSlotIndex || current < 0) {
+			break;
+		}
+	}
 
-	return &itr->second;
+	slotIndex = -1;
+	return *this;
 }
 
-void GameWorld::getAllChildren(vector_set<ObjectId>& result, ObjectId const parent) const {
-	const auto itr = m_childernOf.find(parent);
-	if (itr == m_childernOf.end()) {
-		return;
+GameWorld::HierarchyRange GameWorld::getChildrenOf(const GameObject* parent) const {
+	HierarchyRange result;
+	if (parent && parent->getSlotIndex() >= 0) {
+		const int firstChildSlot = m_objectSlots[parent->getSlotIndex()].firstChildSlot;
+		if (firstChildSlot >= 0) {
+			result.beginItr = HierarchyIterator(this, firstChildSlot, parent->getSlotIndex(), false);
+		}
 	}
+	return result;
+}
+
+GameWorld::HierarchyRange GameWorld::getChildrenOf(ObjectId const parent) const {
+	const auto itr = m_objectsById.find(parent);
+	return getChildrenOf(itr != m_objectsById.end() ? itr->second : nullptr);
+}
 
-	for (const ObjectId id : itr->second) {
-		result.add(id);
-		getAllChildren(result, id);
+GameWorld::HierarchyRange GameWorld::getDescendantsOf(const GameObject* parent) const {
+	HierarchyRange result;
+	if (parent && parent->getSlotIndex() >= 0) {
+		const int firstChildSlot = m_objectSlots[parent->getSlotIndex()].firstChildSlot;
+		if (firstChildSlot >= 0) {
+			result.beginItr = HierarchyIterator(this, firstChildSlot, parent->getSlotIndex(), true);
+		}
+	}
+	return result;
+}
+
+GameWorld::HierarchyRange GameWorld::getDescendantsOf(ObjectId const parent) const {
+	const auto itr = m_objectsById.find(parent);
+	return getDescendantsOf(itr != m_objectsById.end() ? itr->second : nullptr);
+}
+
+void GameWorld::propagateTransformToDescendants(const Actor& parent, bool killVelocity, bool recomputeBinding) {
+	// The descendants are visited in depth-first pre-order by following the links in the slots,
+	// so every actor is moved after its parent has already been moved.
+	for (Actor* const child : getDescendantsOf(&parent)) {
+		const Actor* const childParent = m_objectSlots[m_objectSlots[child->getSlotIndex()].parentSlot].object->getActor();
+		const transf3d& parentTransform = childParent->getTransform();
+
+		transf3d childNewTransformWS;
+		if (child->m_bindingIgnoreRotation) {
+			childNewTransformWS = child->getTransform();
+			childNewTransformWS.p = parentTransform.s * child->m_bindingToParentTransform.p + parentTransform.p;
+		} else {
+			childNewTransformWS = transf3d::applyBindingTransform(child->m_bindingToParentTransform, parentTransform);
+		}
+
+		child->setTransformNoPropagation(childNewTransformWS, killVelocity, recomputeBinding, true);
+		debug.numPropagatedTransformsThisFrame++;
+	}
+}
+
+vector_set<ObjectId> GameWorld::getChildensOfAsList(ObjectId const parent) const {
+	vector_set<ObjectId> result;
+	for (const Actor* const child : getChildrenOf(parent)) {
+		result.add(child->getId());
+	}
+	return result;
+}
+
+void GameWorld::getAllChildren(vector_set<ObjectId>& result, ObjectId const parent) const {
+	for (const Actor* const descendant : getDescendantsOf(parent)) {
+		result.add(descendant->getId());
 	}
 }
 
@@ -604,37 +918,34 @@ void sge::GameWorld::instantiatePrefab(const GameWorld& prefabWorld,
 		return pOblectsToInstantiate->count(objectId) != 0;
 	};
 
+	// Allocate all new objects first, so the ids referencing other instantiated objects
+	// could be remapped while the members are getting copied.
+	std::vector<const GameObject*> prefabObjects;
+
 	auto processActor = [&](GameObject* prefabObject) -> void {
 		if (shouldInstantiateObject(prefabObject->getId()) == false) {
 			return;
 		}
 
-		// FIXME:
-		// Kind of a lazy solution here...
-		// To instantiate the entities from a prefab we serialize the entity we've just loaded in the prefabWorld
-		// and then deserialize it back in the current world, while creating a new entity id for it.
-		std::string serialziedPrefabObject = serializeObject(prefabObject);
-		ObjectId originalId;
-		GameObject* const newObject =
-		    deserializeObjectFromJson(this, serialziedPrefabObject.c_str(), shouldGenerateNewObjectIds, &originalId);
-
-		// Fill the output list of all created object ids
-		if (newObjectIds) {
-			newObjectIds->add(newObject->getId());
-		}
+		const ObjectId specificId = shouldGenerateNewObjectIds ? ObjectId() : prefabObject->getId();
+		GameObject* const newObject = allocObject(prefabObject->getType(), specificId);
 
 		if_checked(newObject) {
-			sgeAssert(originalId == prefabObject->getId());
-			oldToNew[originalId] = newObject->getId();
-
 			if (shouldGenerateNewObjectIds == false) {
 				sgeAssert(prefabObject->getId() == newObject->getId());
 			}
 
-			oldParentOf[newObject->getId()] = prefabWorld.getParentId(originalId);
-		}
+			// Fill the output list of all created object ids
+			if (newObjectIds) {
+				newObjectIds->add(newObject->getId());
+			}
+
+			oldToNew[prefabObject->getId()] = newObject->getId();
+			oldParentOf[newObject->getId()] = prefabWorld.getParentId(prefabObject->getId());
 
-		createdObjects.push_back(newObject);
+			prefabObjects.push_back(prefabObject);
+			createdObjects.push_back(newObject);
+		}
 	};
 
 	for (auto& playingActorsPerType : prefabWorld.playingObjects) {
@@ -647,61 +958,29 @@ void sge::GameWorld::instantiatePrefab(const GameWorld& prefabWorld,
 		processActor(prefabObject);
 	}
 
-	// Fix the object relationships stored as members in the entites themselves and also fix the
-	// object hierarchy.
-	for (GameObject* newObjectFromPrefab : createdObjects) {
-		MemberChain chain;
-
-		const TypeDesc* const typeDesc = typeLib().find(newObjectFromPrefab->getType());
-		if (typeDesc == nullptr) {
-			sgeAssert(false);
-			continue;
-		}
-
-		// Fix the relationships between objects in their members.
-		for (const MemberDesc& mfd : typeDesc->members) {
-			std::function<void(void*, const MemberChain&)> lambda = [&](void* root, const MemberChain& chain) -> void {
-				const TypeDesc* const typeDesc = chain.getType();
-				if (!typeDesc) {
-					return;
-				}
-
-				if (typeDesc->typeId == sgeTypeId(ObjectId)) {
-					ObjectId& idToReplace = *(ObjectId*)chain.follow(root);
-
-					const auto itr = oldToNew.find(idToReplace);
-					if (itr != std::end(oldToNew)) {
-						const ObjectId& newValue = itr->second;
-						idToReplace = newValue;
-					}
-				}
-			};
+	// Copy the members directly from the prefab objects. The relationships between the objects
+	// stored in their members get remapped to the new objects while copying.
+	for (size_t t = 0; t < createdObjects.size(); ++t) {
+		cloneObjectMembers(createdObjects[t], prefabObjects[t], shouldGenerateNewObjectIds, &oldToNew);
+	}
 
-			if ((mfd.flags & MFF_PrefabDontCopy) == 0) {
-				MemberChain chainMember;
-				chainMember.add(&mfd);
-				chainMember.forEachMember(newObjectFromPrefab, lambda);
+	// Fix the object hieirarchy, as it is not stored in the game objects themselves.
+	// Resolve the object hierarchy.
+	for (GameObject* const newObject : createdObjects) {
+		ObjectId originalParent = oldParentOf[newObject->getId()];
+		if (originalParent.isNull() == false) {
+			// Find the new actor that represents the parent.
+			const auto itrNewParent = oldToNew.find(originalParent);
+			if (itrNewParent != oldToNew.end()) {
+				setParentOf(newObject->getId(), itrNewParent->second);
 			}
 		}
+	}
 
-		// Fix the object hieirarchy, as it is not stored in the game objects themselves.
-		// Resolve the object hierarchy.
+	if (inspector != nullptr) {
+		inspector->deselectAll();
 		for (GameObject* const newObject : createdObjects) {
-			ObjectId originalParent = oldParentOf[newObject->getId()];
-			if (originalParent.isNull() == false) {
-				// Find the new actor that represents the parent.
-				const auto itrNewParent = oldToNew.find(originalParent);
-				if (itrNewParent != oldToNew.end()) {
-					setParentOf(newObject->getId(), itrNewParent->second);
-				}
-			}
-		}
-
-		if (inspector != nullptr) {
-			inspector->deselectAll();
-			for (GameObject* const newObject : createdObjects) {
-				inspector->select(newObject->getId());
-			}
+			inspector->select(newObject->getId());
 		}
 	}
 
@@ -762,6 +1041,20 @@ void GameWorld::removeRigidBodyManifold(RigidBody* const rb) {
 	m_physicsManifoldList.erase(itrFind);
 }
 
+IWorldScript* GameWorld::getWorldScript(int const iScript) {
+	if (iScript < 0 || iScript >= int(m_scriptObjects.size())) {
+		sgeAssert(false);
+		return nullptr;
+	}
+
+	// The script list could be modified by the user at any time, keep the hints in sync.
+	if (m_scriptObjectsHints.size() != m_scriptObjects.size()) {
+		m_scriptObjectsHints.resize(m_scriptObjects.size());
+	}
+
+	return dynamic_cast<IWorldScript*>(getObjectById(m_scriptObjects[iScript], m_scriptObjectsHints[iScript]));
+}
+
 void GameWorld::addPostSceneTask(IPostSceneUpdateTask* const task) {
 	if (task) {
 		m_postSceneUpdateTasks.emplace_back(task);
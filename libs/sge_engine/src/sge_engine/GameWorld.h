@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -12,6 +13,7 @@
 #include "sge_engine/Physics.h"
 #include "sge_renderer/renderer/renderer.h"
 #include "sge_utils/utils/Event.h"
+#include "sge_utils/utils/JobSystem.h"
 #include "sge_utils/utils/vector_set.h"
 
 namespace sge {
@@ -21,6 +23,7 @@ struct QuickDraw;
 struct GameWorld;
 struct GameInspector;
 struct IGameDrawer;
+struct IWorldScript;
 
 struct RigidBody;
 struct BulletPhysicsDebugDraw;
@@ -71,6 +74,43 @@ struct GameUpdateSets {
 	InputState is;        ///< The input state to be used when updateing the scene.
 };
 
+/// @brief Records changes to the GameWorld (spawning, killing and reparenting objects) to be applied later at a sync point.
+/// Used when the world cannot be modified directly, for example by objects updated in the parallel update phase.
+/// See GameWorld::getCommandBuffer().
+struct SGE_ENGINE_API WorldCommandBuffer {
+	/// Creates a new object of the specified type when the buffer gets applied.
+	/// @param [in] onCreated if specified gets called with the newly created object.
+	void createObject(TypeId const type, std::function<void(GameObject*)> onCreated = nullptr);
+
+	/// Calls GameWorld::objectDelete for the specified object when the buffer gets applied.
+	void killObject(ObjectId const id);
+
+	/// Calls GameWorld::setParentOf when the buffer gets applied.
+	void setParentOf(ObjectId const child, ObjectId const newParent);
+
+	/// Executes all recorded commands in the order they were recorded and clears the buffer.
+	void applyAndClear(GameWorld& world);
+
+	bool isEmpty() const { return m_commands.empty(); }
+
+  private:
+	struct Command {
+		enum Type {
+			Type_CreateObject,
+			Type_KillObject,
+			Type_SetParent,
+		};
+
+		Type type = Type_CreateObject;
+		TypeId typeToCreate;
+		std::function<void(GameObject*)> onCreated;
+		ObjectId objectId; ///< The object to be killed or the child to be reparented.
+		ObjectId newParentId;
+	};
+
+	std::vector<Command> m_commands;
+};
+
 /// @brief GameWorld is the main class that hold all alocated GameObject (Material, Scripts, Actors and so on),
 /// Maintains their lifetime, as well as stepping the game simulation.
 struct SGE_ENGINE_API GameWorld {
@@ -91,6 +131,15 @@ struct SGE_ENGINE_API GameWorld {
 	/// Steps the game simulation. GameInspectors may intercept the execution of that function.
 	void update(const GameUpdateSets& updateSets);
 
+  private:
+	/// Calls update()/postUpdate() for all objects in the specified lists using the job system.
+	void updateObjectsInParallel(const std::vector<std::vector<GameObject*>*>& objectLists, const GameUpdateSets& updateSets, bool isPostUpdate);
+
+	/// The sync point of the parallel update phase. Applies the command buffers of all threads.
+	void applyCommandBuffers();
+
+  public:
+
 	/// Returns an unique ID for the current scene.
 	ObjectId getNewId();
 
@@ -107,6 +156,17 @@ struct SGE_ENGINE_API GameWorld {
 		return dynamic_cast<T*>(allocObject(sgeTypeId(T), specificId, name));
 	}
 
+	/// Returns the command buffer of the calling thread. The buffers are applied at the sync points of update().
+	/// Objects updated in the parallel update phase must use it instead of modifying the world directly.
+	WorldCommandBuffer& getCommandBuffer();
+
+	/// Returns true while the objects of the thread-safe types are getting updated in parallel.
+	bool isInParallelUpdate() const { return m_isInParallelUpdate; }
+
+	/// Returns the job system of the world, creating it if needed.
+	/// Besides the parallel update phase it could be used for splitting any other heavy work (like CPU skinning) into jobs.
+	JobSystem& getJobSystem();
+
 	/// Permanently deletes the specified object, wthout giving it a chance of recovery.
 	/// Example usage: in gameplay when destroying bullets or killing enemies.
 	/// The object isn't going to be deleted immediatley, instead it is going to get added to a list of object that want to get killed.
@@ -119,6 +179,28 @@ struct SGE_ENGINE_API GameWorld {
 	/// if the object exist but it is not an actor the function will return nullptr.
 	Actor* getActorById(const ObjectId& id);
 
+	/// @brief Retrieves an object by id, using @hint to skip the id lookup.
+	/// If @hint does not point to the object with the specified id, the object is searched by id and @hint is updated.
+	/// Useful for ids that are used every frame, the caller stores the hint next to the id.
+	GameObject* getObjectById(const ObjectId& id, ObjectHandle& hint);
+	Actor* getActorById(const ObjectId& id, ObjectHandle& hint);
+
+	/// @brief Returns a handle to the object with the specified id or a null handle if there is no such object.
+	ObjectHandle getObjectHandle(const ObjectId& id);
+
+	/// @brief Returns a handle to the specified object or a null handle if the object is not in this world.
+	ObjectHandle getObjectHandle(const GameObject* object) const;
+
+	/// @brief Resolves a handle to an object. The function returns nullptr if the object pointed by the handle has been deleted.
+	GameObject* getObjectByHandle(const ObjectHandle& handle) {
+		if (handle.slotIndex < 0 || handle.slotIndex >= int(m_objectSlots.size())) {
+			return nullptr;
+		}
+
+		const ObjectSlot& slot = m_objectSlots[handle.slotIndex];
+		return slot.generation == handle.generation ? slot.object : nullptr;
+	}
+
 	/// Searches for an actor by name, the first actor with the specified name gets returned.
 	GameObject* getObjectByName(const char* name);
 	/// Searches for an actor by name, the first actor with the specified name gets returned.
@@ -189,12 +271,55 @@ struct SGE_ENGINE_API GameWorld {
 	/// @brief Returns the root parent (parent of the parent of the parent and so on) of the specified object.
 	ObjectId getRootParentId(ObjectId child) const;
 
+	/// @brief Iterates over the children (or all descendants) of an actor without allocating any memory.
+	/// The hierarchy must not be modified while iterating.
+	struct SGE_ENGINE_API HierarchyIterator {
+		HierarchyIterator() = default;
+		HierarchyIterator(const GameWorld* world, int slotIndex, int rootSlotIndex, bool visitDescendants)
+		    : world(world)
+		    , slotIndex(slotIndex)
+		    , rootSlotIndex(rootSlotIndex)
+		    , visitDescendants(visitDescendants) {}
+
+		Actor* operator*() const;
+		HierarchyIterator& operator++();
+		bool operator!=(const HierarchyIterator& other) const { return slotIndex != other.slotIndex; }
+		bool operator==(const HierarchyIterator& other) const { return slotIndex == other.slotIndex; }
+
+	  private:
+		const GameWorld* world = nullptr;
+		int slotIndex = -1;
+		int rootSlotIndex = -1; ///< The slot of the actor whose children are being iterated.
+		bool visitDescendants = false;
+	};
+
+	struct HierarchyRange {
+		HierarchyIterator begin() const { return beginItr; }
+		HierarchyIterator end() const { return HierarchyIterator(); }
+
+		bool isEmpty() const { return beginItr == HierarchyIterator(); }
+
+		HierarchyIterator beginItr;
+	};
+
+	/// @brief Returns a range over the direct children of the specified actor.
+	HierarchyRange getChildrenOf(const GameObject* parent) const;
+	HierarchyRange getChildrenOf(ObjectId const parent) const;
+
+	/// @brief Returns a range over all children and their children of the specified actor (in depth-first pre-order).
+	HierarchyRange getDescendantsOf(const GameObject* parent) const;
+	HierarchyRange getDescendantsOf(ObjectId const parent) const;
+
+	/// @brief Moves all descendants of @parent according to its current transform and their binding transforms.
+	/// Only the subtree of @parent is visited, so the cost does not depend on the rest of the world.
+	/// See Actor::setTransformEx for the meaning of the flags.
+	void propagateTransformToDescendants(const Actor& parent, bool killVelocity, bool recomputeBinding);
+
+	/// @brief Returns true if the specified actor has any children.
+	bool hasChildren(ObjectId const parent) const { return getChildrenOf(parent).isEmpty() == false; }
+
 	/// @brief Retrieves all childres of the specified object.
-	const vector_set<ObjectId>* getChildensOf(ObjectId const parent) const;
-	vector_set<ObjectId> getChildensOfAsList(ObjectId const parent) const {
-		const vector_set<ObjectId>* pList = getChildensOf(parent);
-		return pList ? *pList : vector_set<ObjectId>();
-	}
+	vector_set<ObjectId> getChildensOfAsList(ObjectId const parent) const;
 
 	/// @brief Returns all childrens and their childrens of the specified actor.
 	///        The values are appended to the list.
@@ -252,6 +377,10 @@ struct SGE_ENGINE_API GameWorld {
 
 	void toggleEditMode() { isEdited = !isEdited; }
 
+	/// @brief Returns the world script specified in m_scriptObjects at index @iScript.
+	/// The function returns nullptr if the object does not exist or if it is not a world script.
+	IWorldScript* getWorldScript(int const iScript);
+
 	/// @brief Adds a task to be executed after the scene update has finished.
 	/// @param task A pointer to DYNAMICALLY allocated with new to task to be executed.
 	///        Once done this funcion will call delete on that pointer.
@@ -301,12 +430,57 @@ struct SGE_ENGINE_API GameWorld {
 
 	std::vector<GameObject*> awaitsCreationObjects; // A set of object ready to start playing at the beginning of the next step.
 	std::unordered_map<TypeId, std::vector<GameObject*>> playingObjects; // All playing game object sorted by type.
+
+	/// Pointers to the lists in playingObjects, whose types override GameObject::update()/postUpdate().
+	/// Types that do not override them are never iterated when updating the world.
+	std::vector<std::vector<GameObject*>*> m_playingObjectsWithUpdate;
+	std::vector<std::vector<GameObject*>*> m_playingObjectsWithPostUpdate;
+
+	/// Same as above, but for the types that have declared their update()/postUpdate() thread-safe
+	/// (see GameObjectTypeDesc::isUpdateThreadSafe). These get updated in parallel after the rest of the objects.
+	std::vector<std::vector<GameObject*>*> m_parallelPlayingObjectsWithUpdate;
+	std::vector<std::vector<GameObject*>*> m_parallelPlayingObjectsWithPostUpdate;
+
+	/// The job system used for the parallel update phase. Created on demand, see getJobSystem().
+	JobSystem m_jobSystem;
+	/// The number of objects to be updated by a single job in the parallel update phase.
+	int m_parallelUpdateBatchSize = 64;
+	bool m_isInParallelUpdate = false;
+	/// A list of all objects to be updated in the current parallel update phase.
+	std::vector<GameObject*> m_parallelUpdateObjects;
+	/// A command buffer for each thread of m_jobSystem. See getCommandBuffer().
+	std::vector<WorldCommandBuffer> m_commandBuffers;
 	vector_set<ObjectId> objectsWantingPermanentKill; // A set of actors that are going to be compleatley deleted for the game world.
 
-	/// Hierarchical relationship between actors.
-	/// These two are deeply connected to one another!
-	std::unordered_map<ObjectId, vector_set<ObjectId>> m_childernOf;
-	std::unordered_map<ObjectId, ObjectId> m_parentOf;
+	/// All playing and awaiting creation objects indexed by their id.
+	/// Used by getObjectById() and isIdTaken() so they do not need to iterate over all objects.
+	std::unordered_map<ObjectId, GameObject*> m_objectsById;
+
+	/// A slot holding an object. See ObjectHandle.
+	/// The generation of the slot changes every time the object in it gets deleted.
+	/// The hierarchical relationship between actors is stored in the slots as well, as a linked list of children.
+	struct ObjectSlot {
+		GameObject* object = nullptr;
+		int generation = 1;
+
+		// Slot indices of the related objects, -1 if there isn't one.
+		int parentSlot = -1;
+		int firstChildSlot = -1;
+		int lastChildSlot = -1;
+		int nextSiblingSlot = -1;
+		int prevSiblingSlot = -1;
+	};
+
+	/// Attaches the object in slot @childSlot as the last child of the object in @parentSlot.
+	/// The child must not have a parent. Does not update any transforms, you probably want setParentOf().
+	void linkToParentSlot(int childSlot, int parentSlot);
+	/// Detaches the object in the specified slot from its parent (if any). Does not update any transforms.
+	void unlinkFromParentSlot(int childSlot);
+
+	/// All playing and awaiting creation objects stored in their slots.
+	/// Slots of deleted objects are reused, their indices are stored in m_freeObjectSlots.
+	std::vector<ObjectSlot> m_objectSlots;
+	std::vector<int> m_freeObjectSlots;
 
 	/// Physics
 	PhysicsWorld physicsWorld;
@@ -337,6 +511,8 @@ struct SGE_ENGINE_API GameWorld {
 
 	/// Script objects to get called.
 	std::vector<ObjectId> m_scriptObjects;
+	/// Cached handles for each object in m_scriptObjects, used with getObjectById() to avoid searching for them every frame.
+	std::vector<ObjectHandle> m_scriptObjectsHints;
 
 	/// True if the game is in edit mode
 	bool isEdited = true;
@@ -351,7 +527,9 @@ struct SGE_ENGINE_API GameWorld {
 
 	/// Debugging variables.
 	mutable struct {
-		int numCallsToGetObjectByIdThisFrame = 0;
+		std::atomic<int> numCallsToGetObjectByIdThisFrame = 0;
+		/// The number of descendants moved because one of their ancestors has moved.
+		std::atomic<int> numPropagatedTransformsThisFrame = 0;
 		/// Forces the update loop to sleep for the specified amount of miliseconds before upadating.
 		/// Useful for checking if game logic works for any timestep.
 		int forceSleepMs = 0;
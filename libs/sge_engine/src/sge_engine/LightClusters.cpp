@@ -0,0 +1,225 @@
+#include "LightClusters.h"
+#include "sge_engine/actors/ALight.h"
+#include <cfloat>
+
+namespace sge {
+
+namespace {
+/// Returns the index of the tile containing the specified NDC coordinate, clamped to the grid.
+int findTileIndex(float ndc, int numTiles) {
+	const int idx = int(floorf((ndc * 0.5f + 0.5f) * float(numTiles)));
+	return clamp(idx, 0, numTiles - 1);
+}
+
+int getClusterIndex(int x, int y, int z) {
+	return x + y * LightClusters::kNumTilesX + z * LightClusters::kNumTilesX * LightClusters::kNumTilesY;
+}
+} // namespace
+
+int LightClusters::findSliceIndex(float depth) const {
+	if (depth <= m_near) {
+		return 0;
+	}
+
+	const int idx = int(floorf(logf(depth / m_near) * m_sliceScale));
+	return clamp(idx, 0, kNumSlices - 1);
+}
+
+int LightClusters::findClusterIndex(const vec3f& posVS) const {
+	const float depth = -posVS.z;
+	if (depth < m_near || depth > m_far) {
+		return -1;
+	}
+
+	const vec4f posCS = m_proj * vec4f(posVS, 1.f);
+	const vec2f ndc = posCS.xy() / posCS.w;
+	if (ndc.x < -1.f || ndc.x > 1.f || ndc.y < -1.f || ndc.y > 1.f) {
+		return -1;
+	}
+
+	return getClusterIndex(findTileIndex(ndc.x, kNumTilesX), findTileIndex(ndc.y, kNumTilesY), findSliceIndex(depth));
+}
+
+bool LightClusters::computeLightClusterBox(const ShadingLightData& light, int boxMin[3], int boxMax[3]) const {
+	boxMin[0] = boxMin[1] = boxMin[2] = 0;
+	boxMax[0] = kNumTilesX - 1;
+	boxMax[1] = kNumTilesY - 1;
+	boxMax[2] = kNumSlices - 1;
+
+	if (light.lightPositionAndType.w == float(light_directional)) {
+		return true;
+	}
+
+	// Point and spot lights are bound by the sphere of their range.
+	const vec3f centerVS = m_view.transfPos(light.lightPositionAndType.xyz());
+	const float radius = light.lightXShadowRange.x;
+	const float depthMin = -centerVS.z - radius;
+	const float depthMax = -centerVS.z + radius;
+
+	if (radius <= 0.f || depthMax < m_near || depthMin > m_far) {
+		return false;
+	}
+
+	boxMin[2] = findSliceIndex(depthMin);
+	boxMax[2] = findSliceIndex(depthMax);
+
+	// If the sphere crosses the near plane its projection is unbounded, keep all tiles.
+	if (depthMin > m_near) {
+		// The projection of the box bounding the sphere in view space contains the projection of the sphere.
+		vec2f ndcMin(FLT_MAX);
+		vec2f ndcMax(-FLT_MAX);
+		for (int iCorner = 0; iCorner < 8; ++iCorner) {
+			const vec3f offset((iCorner & 1) ? radius : -radius, (iCorner & 2) ? radius : -radius, (iCorner & 4) ? radius : -radius);
+			const vec4f cornerCS = m_proj * vec4f(centerVS + offset, 1.f);
+			const vec2f cornerNDC = cornerCS.xy() / cornerCS.w;
+			ndcMin = ndcMin.ComponentMin(cornerNDC);
+			ndcMax = ndcMax.ComponentMax(cornerNDC);
+		}
+
+		if (ndcMax.x < -1.f || ndcMin.x > 1.f || ndcMax.y < -1.f || ndcMin.y > 1.f) {
+			return false;
+		}
+
+		boxMin[0] = findTileIndex(ndcMin.x, kNumTilesX);
+		boxMax[0] = findTileIndex(ndcMax.x, kNumTilesX);
+		boxMin[1] = findTileIndex(ndcMin.y, kNumTilesY);
+		boxMax[1] = findTileIndex(ndcMax.y, kNumTilesY);
+	}
+
+	return true;
+}
+
+void LightClusters::build(const mat4f& view, const mat4f& proj, const ShadingLightData* const* lights, int numLights) {
+	m_view = view;
+	m_proj = proj;
+
+	// Find the depth range of the frustum by unprojecting the near and the far planes.
+	const mat4f projInv = inverse(proj);
+	const float ndcNearZ = kIsTexcoordStyleD3D ? 0.f : -1.f;
+	const vec4f nearVS = projInv * vec4f(0.f, 0.f, ndcNearZ, 1.f);
+	const vec4f farVS = projInv * vec4f(0.f, 0.f, 1.f, 1.f);
+	m_near = maxOf(-nearVS.z / nearVS.w, 1e-3f);
+	m_far = maxOf(-farVS.z / farVS.w, m_near * 2.f);
+	m_sliceScale = float(kNumSlices) / logf(m_far / m_near);
+
+	m_numLights = minOf(numLights, kMaxLights);
+	m_numTruncatedLightIndices = 0;
+
+	m_lightsTexData.assign(kMaxLights * 4, vec4f(0.f));
+	m_clusterRangesTexData.assign(kNumClusters, vec4f(0.f));
+	m_lightIndicesTexData.resize(kMaxLightIndices);
+	m_clusterNumFilled.assign(kNumClusters, 0);
+	m_lightClusterBoxes.resize(m_numLights * 6);
+
+	// Store the lights and count the lights in every cluster.
+	for (int iLight = 0; iLight < m_numLights; ++iLight) {
+		const ShadingLightData& light = *lights[iLight];
+
+		m_lightsTexData[0 * kMaxLights + iLight] = light.lightPositionAndType;
+		m_lightsTexData[1 * kMaxLights + iLight] = light.lightColorWFlags;
+		m_lightsTexData[2 * kMaxLights + iLight] = light.lightSpotDirAndCosAngle;
+		m_lightsTexData[3 * kMaxLights + iLight] = light.lightXShadowRange;
+
+		int* const boxMin = &m_lightClusterBoxes[iLight * 6];
+		int* const boxMax = boxMin + 3;
+		if (computeLightClusterBox(light, boxMin, boxMax) == false) {
+			// An empty box.
+			boxMin[0] = 0;
+			boxMax[0] = -1;
+			continue;
+		}
+
+		for (int z = boxMin[2]; z <= boxMax[2]; ++z) {
+			for (int y = boxMin[1]; y <= boxMax[1]; ++y) {
+				for (int x = boxMin[0]; x <= boxMax[0]; ++x) {
+					m_clusterRangesTexData[getClusterIndex(x, y, z)].y += 1.f;
+				}
+			}
+		}
+	}
+
+	// Allocate the light indices of every cluster, truncating the ones that do not fit.
+	int offset = 0;
+	for (vec4f& clusterRange : m_clusterRangesTexData) {
+		const int numLightsInCluster = int(clusterRange.y);
+		const int numFitting = minOf(numLightsInCluster, kMaxLightIndices - offset);
+		m_numTruncatedLightIndices += numLightsInCluster - numFitting;
+
+		clusterRange.x = float(offset);
+		clusterRange.y = float(numFitting);
+		offset += numFitting;
+	}
+
+	// Write the light indices.
+	for (int iLight = 0; iLight < m_numLights; ++iLight) {
+		const int* const boxMin = &m_lightClusterBoxes[iLight * 6];
+		const int* const boxMax = boxMin + 3;
+
+		for (int z = boxMin[2]; z <= boxMax[2]; ++z) {
+			for (int y = boxMin[1]; y <= boxMax[1]; ++y) {
+				for (int x = boxMin[0]; x <= boxMax[0]; ++x) {
+					const int iCluster = getClusterIndex(x, y, z);
+					const vec4f& clusterRange = m_clusterRangesTexData[iCluster];
+					int& numFilled = m_clusterNumFilled[iCluster];
+					if (numFilled < int(clusterRange.y)) {
+						m_lightIndicesTexData[int(clusterRange.x) + numFilled] = float(iLight);
+						numFilled++;
+					}
+				}
+			}
+		}
+	}
+}
+
+const ClusteredLightingData* LightClusters::upload(SGEContext* const sgecon) {
+	SGEDevice* const sgedev = sgecon->getDevice();
+
+	const auto createTexture = [sgedev](GpuHandle<Texture>& texture, TextureFormat::Enum format, int width, int height) -> bool {
+		if (texture.IsResourceValid()) {
+			return true;
+		}
+
+		TextureDesc desc;
+		desc.textureType = UniformType::Texture2D;
+		desc.format = format;
+		desc.usage = TextureUsage::DynamicResource;
+		desc.texture2D = Texture2DDesc(width, height);
+
+		SamplerDesc sampler;
+		sampler.filter = TextureFilter::Min_Mag_Mip_Point;
+		sampler.addressModes[0] = TextureAddressMode::ClampEdge;
+		sampler.addressModes[1] = TextureAddressMode::ClampEdge;
+		sampler.addressModes[2] = TextureAddressMode::ClampEdge;
+
+		texture = sgedev->requestResource<Texture>();
+		return texture->create(desc, nullptr, sampler);
+	};
+
+	const bool texturesCreated =
+	    createTexture(m_lightsTex, TextureFormat::R32G32B32A32_FLOAT, kMaxLights, 4) &&
+	    createTexture(m_clusterRangesTex, TextureFormat::R32G32B32A32_FLOAT, kNumTilesX * kNumTilesY, kNumSlices) &&
+	    createTexture(m_lightIndicesTex, TextureFormat::R32_FLOAT, kLightIndicesTexWidth, kLightIndicesTexHeight);
+
+	if (texturesCreated == false) {
+		m_lightsTex.Release();
+		m_clusterRangesTex.Release();
+		m_lightIndicesTex.Release();
+		return nullptr;
+	}
+
+	sgecon->updateTextureData(m_lightsTex, TextureData(m_lightsTexData.data(), kMaxLights * sizeof(vec4f)));
+	sgecon->updateTextureData(m_clusterRangesTex,
+	                          TextureData(m_clusterRangesTexData.data(), kNumTilesX * kNumTilesY * sizeof(vec4f)));
+	sgecon->updateTextureData(m_lightIndicesTex, TextureData(m_lightIndicesTexData.data(), kLightIndicesTexWidth * sizeof(float)));
+
+	m_clusteredLightingData.lights = m_lightsTex;
+	m_clusteredLightingData.clusterRanges = m_clusterRangesTex;
+	m_clusteredLightingData.lightIndices = m_lightIndicesTex;
+	m_clusteredLightingData.view = m_view;
+	m_clusteredLightingData.grid = vec4f(float(kNumTilesX), float(kNumTilesY), float(kNumSlices), float(kLightIndicesTexWidth));
+	m_clusteredLightingData.depthParams = vec4f(m_near, m_sliceScale, float(kMaxLights), float(kLightIndicesTexHeight));
+
+	return &m_clusteredLightingData;
+}
+
+} // namespace sge
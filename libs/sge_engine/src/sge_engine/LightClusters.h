@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include "sge_core/shaders/modeldraw.h"
+#include "sge_engine/sge_engine_api.h"
+#include "sge_renderer/renderer/renderer.h"
+#include "sge_utils/math/mat4.h"
+
+namespace sge {
+
+/// @brief Assigns lights to the clusters (froxels) of the view frustum, so a pixel is shaded only by the lights
+/// whose range overlaps its cluster, all of them in a single pass.
+/// The frustum is divided uniformly in NDC (x,y) into tiles and exponentially by the view space depth into slices.
+/// The clusters are built on the CPU every frame and uploaded to textures, see ClusteredLightingData for the layout.
+/// Point and spot lights are bound by the sphere of their range, directional lights affect every cluster.
+struct SGE_ENGINE_API LightClusters {
+	static constexpr int kNumTilesX = 16;
+	static constexpr int kNumTilesY = 8;
+	static constexpr int kNumSlices = 24;
+	static constexpr int kNumClusters = kNumTilesX * kNumTilesY * kNumSlices;
+
+	/// The maximum number of lights that could be clustered, the rest are ignored.
+	static constexpr int kMaxLights = 256;
+
+	/// The size of the texture holding the light indices of all clusters.
+	/// If the clusters need more indices the lights of the last ones are truncated.
+	static constexpr int kLightIndicesTexWidth = 1024;
+	static constexpr int kLightIndicesTexHeight = 64;
+	static constexpr int kMaxLightIndices = kLightIndicesTexWidth * kLightIndicesTexHeight;
+
+	/// Assigns the lights to the clusters of the frustum defined by the specified matrices.
+	/// Lights with shadow maps are expected to be drawn separately and should not be passed here.
+	void build(const mat4f& view, const mat4f& proj, const ShadingLightData* const* lights, int numLights);
+
+	/// Uploads the result of the last build() to the GPU, creating the textures if needed.
+	/// Returns the data to be passed to the model drawing or nullptr if the textures could not be created.
+	const ClusteredLightingData* upload(SGEContext* const sgecon);
+
+	/// Returns the number of lights used in the last build().
+	int getNumLights() const { return m_numLights; }
+
+	/// Returns the number of light indices that did not fit in the light indices texture in the last build().
+	int getNumTruncatedLightIndices() const { return m_numTruncatedLightIndices; }
+
+	/// Returns the index of the cluster containing the specified point (in view space) or -1 if it is outside of the frustum.
+	/// The result matches the cluster computed by the shaders.
+	int findClusterIndex(const vec3f& posVS) const;
+
+	/// Returns the number of lights in the specified cluster.
+	int getClusterNumLights(int iCluster) const { return int(m_clusterRangesTexData[iCluster].y); }
+
+	/// Returns the index (in the array passed to build()) of a light in the specified cluster.
+	int getClusterLightIndex(int iCluster, int iLightInCluster) const {
+		return int(m_lightIndicesTexData[int(m_clusterRangesTexData[iCluster].x) + iLightInCluster]);
+	}
+
+  private:
+	/// Returns the index of the slice containing the specified view space depth (positive in front of the camera).
+	int findSliceIndex(float depth) const;
+
+	/// Computes the range of the clusters that could be affected by the specified light. Returns false if no cluster is affected.
+	bool computeLightClusterBox(const ShadingLightData& light, int boxMin[3], int boxMax[3]) const;
+
+  private:
+	mat4f m_view = mat4f::getIdentity();
+	mat4f m_proj = mat4f::getIdentity();
+	float m_near = 0.f;
+	float m_far = 0.f;
+	float m_sliceScale = 0.f; // kNumSlices / log(m_far / m_near).
+
+	int m_numLights = 0;
+	int m_numTruncatedLightIndices = 0;
+
+	/// The range of the affected clusters for every light, 6 numbers per light - the min and the max in every axis.
+	std::vector<int> m_lightClusterBoxes;
+
+	// The data to be uploaded, with the layout of the textures in ClusteredLightingData.
+	std::vector<vec4f> m_lightsTexData;
+	std::vector<vec4f> m_clusterRangesTexData;
+	std::vector<float> m_lightIndicesTexData;
+
+	/// The number of light indices already written for every cluster, used while building.
+	std::vector<int> m_clusterNumFilled;
+
+	GpuHandle<Texture> m_lightsTex;
+	GpuHandle<Texture> m_clusterRangesTex;
+	GpuHandle<Texture> m_lightIndicesTex;
+	ClusteredLightingData m_clusteredLightingData;
+};
+
+} // namespace sge
@@ -145,17 +145,13 @@ void findActorsOnTop(vector_map<Actor*, FindActorsOnTopResult>& result, Actor* c
 		}
 
 		// Now process the contacts of our children.
-		const vector_set<ObjectId>* pChildern = world.getChildensOf(rbContactsToProcess->actor->getId());
-		if (pChildern) {
-			for (const ObjectId childId : *pChildern) {
-				Actor* child = world.getActorById(childId);
-				sgeAssert(child != nullptr);
-				if (child) {
-					TraitRigidBody* childRBTrait = getTrait<TraitRigidBody>(child);
-					if (childRBTrait) {
-						processManifolds(childRBTrait->getRigidBody(),
-						                 parentIgnoreRotation || rbContactsToProcess->actor->m_bindingIgnoreRotation);
-					}
+		for (Actor* const child : world.getChildrenOf(rbContactsToProcess->actor)) {
+			sgeAssert(child != nullptr);
+			if (child) {
+				TraitRigidBody* childRBTrait = getTrait<TraitRigidBody>(child);
+				if (childRBTrait) {
+					processManifolds(childRBTrait->getRigidBody(),
+					                 parentIgnoreRotation || rbContactsToProcess->actor->m_bindingIgnoreRotation);
 				}
 			}
 		}
@@ -166,16 +162,12 @@ void findActorsOnTop(vector_map<Actor*, FindActorsOnTopResult>& result, Actor* c
 		processManifolds(rbTrait->getRigidBody(), false);
 	}
 
-	const vector_set<ObjectId>* pChildern = world.getChildensOf(rootActor->getId());
-	if (pChildern) {
-		for (const ObjectId childId : *pChildern) {
-			Actor* child = world.getActorById(childId);
-			sgeAssert(child != nullptr);
-			if (child) {
-				TraitRigidBody* childRBTrait = getTrait<TraitRigidBody>(child);
-				if (childRBTrait) {
-					processManifolds(childRBTrait->getRigidBody(), rootActor->m_bindingIgnoreRotation || child->m_bindingIgnoreRotation);
-				}
+	for (Actor* const child : world.getChildrenOf(rootActor)) {
+		sgeAssert(child != nullptr);
+		if (child) {
+			TraitRigidBody* childRBTrait = getTrait<TraitRigidBody>(child);
+			if (childRBTrait) {
+				processManifolds(childRBTrait->getRigidBody(), rootActor->m_bindingIgnoreRotation || child->m_bindingIgnoreRotation);
 			}
 		}
 	}
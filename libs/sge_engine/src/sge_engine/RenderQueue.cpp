@@ -0,0 +1,110 @@
+#include "RenderQueue.h"
+#include <cstdint>
+#include <cstring>
+
+namespace sge {
+
+namespace {
+// The layout of the sort key, from the most significant bits.
+constexpr int kPassBits = 2;
+constexpr int kShaderBits = 8;
+constexpr int kMaterialBits = 16;
+constexpr int kMeshBits = 14;
+constexpr int kDepthBits = 24;
+static_assert(kPassBits + kShaderBits + kMaterialBits + kMeshBits + kDepthBits == 64, "The sort key must use all 64 bits");
+
+constexpr uint64 lowBits(uint64 value, int numBits) {
+	return value & ((uint64(1) << numBits) - 1);
+}
+
+/// Quantizes the depth preserving its order. The bit pattern of non-negative floats increases with the value,
+/// so the upper bits (without the sign bit) could be used directly.
+uint64 quantizeDepth(float depth) {
+	if (!(depth > 0.f)) {
+		return 0; // Negative depths and NaNs.
+	}
+
+	uint32 bits = 0;
+	memcpy(&bits, &depth, sizeof(bits));
+	return lowBits(bits >> (31 - kDepthBits), kDepthBits);
+}
+} // namespace
+
+uint64 RenderQueue::makeSortKey(RenderPass pass, uint32 shaderKey, uint32 materialKey, uint32 meshKey, float depth) {
+	sgeAssert(shaderKey < (1 << kShaderBits));
+
+	const uint64 depthBits = quantizeDepth(depth);
+	uint64 key = lowBits(pass, kPassBits) << (64 - kPassBits);
+
+	if (pass == renderPass_opaque) {
+		// Group by state, front-to-back for the draws with the same state.
+		key |= lowBits(shaderKey, kShaderBits) << (kMaterialBits + kMeshBits + kDepthBits);
+		key |= lowBits(materialKey, kMaterialBits) << (kMeshBits + kDepthBits);
+		key |= lowBits(meshKey, kMeshBits) << kDepthBits;
+		key |= depthBits;
+	} else {
+		// Back-to-front, the state is used only for the draws with the same depth.
+		const uint64 invertedDepthBits = lowBits(~depthBits, kDepthBits);
+		key |= invertedDepthBits << (kShaderBits + kMaterialBits + kMeshBits);
+		key |= lowBits(shaderKey, kShaderBits) << (kMaterialBits + kMeshBits);
+		key |= lowBits(materialKey, kMaterialBits) << kMeshBits;
+		key |= lowBits(meshKey, kMeshBits);
+	}
+
+	return key;
+}
+
+uint32 RenderQueue::hashPointer(const void* ptr) {
+	// The finalizer of MurmurHash3, pointers are aligned so their lower bits are mostly zeros.
+	uint64 h = uint64(std::uintptr_t(ptr));
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	return uint32(h);
+}
+
+void RenderQueue::sort() {
+	const size_t numItems = m_items.size();
+	if (numItems < 2) {
+		return;
+	}
+
+	// Compute the histograms for all the 8 digits with a single pass.
+	constexpr int kNumDigits = 8;
+	uint32 histograms[kNumDigits][256];
+	memset(histograms, 0, sizeof(histograms));
+
+	for (const Item& item : m_items) {
+		for (int iDigit = 0; iDigit < kNumDigits; ++iDigit) {
+			histograms[iDigit][(item.sortKey >> (iDigit * 8)) & 0xFF]++;
+		}
+	}
+
+	m_sortScratch.resize(numItems);
+
+	for (int iDigit = 0; iDigit < kNumDigits; ++iDigit) {
+		uint32* const histogram = histograms[iDigit];
+		const int shift = iDigit * 8;
+
+		// If all keys have the same digit this pass would not change anything.
+		if (histogram[(m_items[0].sortKey >> shift) & 0xFF] == numItems) {
+			continue;
+		}
+
+		// Turn the histogram into offsets where each digit starts.
+		uint32 offset = 0;
+		for (int t = 0; t < 256; ++t) {
+			const uint32 count = histogram[t];
+			histogram[t] = offset;
+			offset += count;
+		}
+
+		for (const Item& item : m_items) {
+			m_sortScratch[histogram[(item.sortKey >> shift) & 0xFF]++] = item;
+		}
+
+		m_items.swap(m_sortScratch);
+	}
+}
+
+} // namespace sge
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "sge_engine/sge_engine_api.h"
+#include "sge_utils/sge_utils.h"
+
+namespace sge {
+
+/// The passes of the render queue, the draws of a pass are submitted before the draws of the next one.
+enum RenderPass : uint32 {
+	renderPass_opaque = 0,
+	renderPass_translucent = 1,
+};
+
+/// Counters describing how well the render queue has grouped the draws.
+/// A "change" happens when two consecutive draws use different shader, material or mesh.
+/// The avoided changes are the ones that would have happened if the draws were submitted in scene order.
+struct RenderQueueStats {
+	void reset() { *this = RenderQueueStats(); }
+
+	int numDraws = 0;
+	int numShaderChanges = 0;
+	int numMaterialChanges = 0;
+	int numMeshChanges = 0;
+	int numShaderChangesAvoided = 0;
+	int numMaterialChangesAvoided = 0;
+	int numMeshChangesAvoided = 0;
+	int numInstancedBatches = 0; ///< The number of instanced draws the queued draws were merged into.
+	int numInstancedDraws = 0;   ///< The number of queued draws that were drawn as a part of an instanced draw.
+};
+
+/// @brief A list of draws sorted by 64-bit keys before being submitted.
+/// The keys are composed (from the most significant bits) of the pass, the shader permutation, the material, the mesh and the depth.
+/// Opaque draws are grouped by their state and then sorted front-to-back to take advantage of the early depth test.
+/// Translucent draws are sorted back-to-front first as the correctness of the blending depends on it.
+/// The queue does not know what a draw is, it only sorts indices into a list of draws owned by the user.
+struct SGE_ENGINE_API RenderQueue {
+	struct Item {
+		uint64 sortKey = 0;
+		uint32 drawIndex = 0;
+	};
+
+	/// Composes a sort key. @shaderKey must be less than 256, @materialKey and @meshKey could be any number
+	/// (usually a hash), as only their lower bits are used, different materials or meshes could end up sharing a key,
+	/// which only makes the sorting less optimal. @depth is the distance to the camera along its view direction.
+	static uint64 makeSortKey(RenderPass pass, uint32 shaderKey, uint32 materialKey, uint32 meshKey, float depth);
+
+	/// Hashes a pointer to be used as material or mesh key.
+	static uint32 hashPointer(const void* ptr);
+
+	void clear() { m_items.clear(); }
+	void add(uint64 sortKey, uint32 drawIndex) { m_items.push_back(Item{sortKey, drawIndex}); }
+
+	/// Sorts the items by their keys with a stable LSD radix sort.
+	void sort();
+
+	const std::vector<Item>& getItems() const { return m_items; }
+
+  private:
+	std::vector<Item> m_items;
+	std::vector<Item> m_sortScratch;
+};
+
+} // namespace sge
@@ -0,0 +1,51 @@
+#include "ShadowCasterCulling.h"
+#include "sge_utils/math/common.h"
+
+namespace sge {
+
+bool isSphereInPointLightRange(const vec3f& lightPos, float range, const vec3f& spherePos, float sphereRadius) {
+	const float maxDistance = range + sphereRadius;
+	return (spherePos - lightPos).lengthSqr() <= maxDistance * maxDistance;
+}
+
+bool isSphereInSpotLightCone(
+    const vec3f& lightPos, const vec3f& lightDir, float spotLightAngle, float range, const vec3f& spherePos, float sphereRadius) {
+	const vec3f v = spherePos - lightPos;
+	const float distAlongDir = v.dot(lightDir);
+
+	// The sphere is behind the light or past its range.
+	if (distAlongDir < -sphereRadius || distAlongDir > range + sphereRadius) {
+		return false;
+	}
+
+	// The distance from the center of the sphere to the side of the cone (negative if inside).
+	const float distToAxis = sqrtf(maxOf(v.lengthSqr() - distAlongDir * distAlongDir, 0.f));
+	const float distToCone = cosf(spotLightAngle) * distToAxis - sinf(spotLightAngle) * distAlongDir;
+	return distToCone <= sphereRadius;
+}
+
+int getPointLightShadowFacesMask(const vec3f& lightPos, const vec3f& spherePos, float sphereRadius) {
+	const vec3f v = spherePos - lightPos;
+
+	// The frustum of each face is a pyramid with apex at the light bound by 4 planes at 45 degrees to the axis.
+	// For the face looking at +X these are the planes x = |y| and x = |z|, the distance to them is (x - |y|) / sqrt(2).
+	const float maxOffset = sphereRadius * sqrtf(2.f);
+
+	int mask = 0;
+	for (int iAxis = 0; iAxis < 3; ++iAxis) {
+		const float otherAxis0 = fabsf(v[(iAxis + 1) % 3]);
+		const float otherAxis1 = fabsf(v[(iAxis + 2) % 3]);
+
+		if (v[iAxis] - otherAxis0 >= -maxOffset && v[iAxis] - otherAxis1 >= -maxOffset) {
+			mask |= 1 << (axis_x_pos + iAxis);
+		}
+
+		if (-v[iAxis] - otherAxis0 >= -maxOffset && -v[iAxis] - otherAxis1 >= -maxOffset) {
+			mask |= 1 << (axis_x_neg + iAxis);
+		}
+	}
+
+	return mask;
+}
+
+} // namespace sge
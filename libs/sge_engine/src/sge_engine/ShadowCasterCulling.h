@@ -0,0 +1,24 @@
+#pragma once
+
+#include "sge_engine/sge_engine_api.h"
+#include "sge_utils/math/vec3.h"
+
+namespace sge {
+
+/// Functions for finding the casters that could be seen by the cameras used for rendering the shadow map of a light.
+/// The casters are bound by spheres. All tests are conservative, they could keep a caster that isn't really seen
+/// but never cull one that is.
+
+/// Returns true if the sphere overlaps the range of a point light.
+SGE_ENGINE_API bool isSphereInPointLightRange(const vec3f& lightPos, float range, const vec3f& spherePos, float sphereRadius);
+
+/// Returns true if the sphere overlaps the cone of a spot light.
+/// @spotLightAngle is the angle between the direction of the light and the side of the cone.
+SGE_ENGINE_API bool isSphereInSpotLightCone(
+    const vec3f& lightPos, const vec3f& lightDir, float spotLightAngle, float range, const vec3f& spherePos, float sphereRadius);
+
+/// Returns a bit mask with a bit for every face of a point light shadow cube map (indexed by SignedAxis)
+/// which 90 degrees camera frustum could see the sphere.
+SGE_ENGINE_API int getPointLightShadowFacesMask(const vec3f& lightPos, const vec3f& spherePos, float sphereRadius);
+
+} // namespace sge
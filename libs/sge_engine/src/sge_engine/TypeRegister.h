@@ -8,6 +8,7 @@
 #include <functional>
 #include <initializer_list>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <type_traits>
@@ -171,6 +172,7 @@ struct Script;
 struct GameUpdateSets;
 
 struct TypeDesc;
+struct TypeClonePlan;
 
 //-----------------------------------------------------
 //
@@ -240,8 +242,27 @@ namespace sge {
 // A special case of typedesc used for Game Objects. Ideally it shouldn't be described here.
 struct GameObjectTypeDesc {
 	const char* category = nullptr; // a category used in the interface for grouping of game objects in menus.
+
+	// True if the type overrides GameObject::update/postUpdate. The GameWorld skips calling these for types that don't.
+	// Computed when the inheritance is registered, types that do not register any inheritance are assumed to override them.
+	bool overridesUpdate = true;
+	bool overridesPostUpdate = true;
+
+	// True if GameObject::update/postUpdate of the type are thread-safe and could be called in the parallel update phase of
+	// the GameWorld. These functions must only modify the object itself and do not change the world directly,
+	// spawning, killing and reparenting objects must be done via GameWorld::getCommandBuffer().
+	bool isUpdateThreadSafe = false;
+	bool isPostUpdateThreadSafe = false;
 };
 
+/// Used for finding the class that declares a particular update method (see TypeDesc::inherits).
+/// The template argument is deduced from a pointer to the method, so the result is the last class in the hierarchy
+/// that has declared (overridden) that method.
+template <typename TDeclaringClass>
+TDeclaringClass* sge_updateFnDeclaringClass(void (TDeclaringClass::*)(const GameUpdateSets&)) {
+	return nullptr;
+}
+
 struct SGE_ENGINE_API TypeDesc {
 	static std::string computePrettyName(const char* const name);
 
@@ -455,6 +476,14 @@ struct SGE_ENGINE_API TypeDesc {
 		return *this;
 	}
 
+	/// Declares if the update()/postUpdate() of the game object type could be called in the parallel update phase.
+	/// See GameObjectTypeDesc::isUpdateThreadSafe.
+	TypeDesc& gameObjectThreadSafeUpdate(bool isUpdateThreadSafe, bool isPostUpdateThreadSafe) {
+		gameObjectDesc.isUpdateThreadSafe = isUpdateThreadSafe;
+		gameObjectDesc.isPostUpdateThreadSafe = isPostUpdateThreadSafe;
+		return *this;
+	}
+
 	/// Registers an enum value associated to with this type.
 	TypeDesc& addEnumMember(int member, const char* name);
 
@@ -526,6 +555,10 @@ struct SGE_ENGINE_API TypeDesc {
 
 	// GameObject specific.
 	GameObjectTypeDesc gameObjectDesc;
+
+	// A cache of the steps needed to clone a value of this type, built on first use by cloneVariable (see GameSerialization.h).
+	// It lives here so it gets discarded when the type gets registered again (for example when a plugin is reloaded).
+	mutable std::shared_ptr<const TypeClonePlan> clonePlan;
 };
 
 } // namespace sge
@@ -655,6 +688,12 @@ inline TypeDesc& TypeDesc::inherits() {
 	TypeId const superclassId = sgeTypeId(TParent);
 	superclasses.push_back({superclassId, byteOffset});
 
+	// Game objects that do not override the update methods do not need to get updated at all.
+	if constexpr (std::is_base_of<GameObject, T>::value) {
+		gameObjectDesc.overridesUpdate = !std::is_same<decltype(sge_updateFnDeclaringClass(&T::update)), GameObject*>::value;
+		gameObjectDesc.overridesPostUpdate = !std::is_same<decltype(sge_updateFnDeclaringClass(&T::postUpdate)), GameObject*>::value;
+	}
+
 	return *this;
 }
 
@@ -52,28 +52,31 @@ bool assetPicker(
 		for (int iType = 0; iType < numAssetTypes; ++iType) {
 			const AssetType assetType = assetTypes[iType];
 			if (ImGui::BeginMenu(assetType_getName(assetType))) {
-				for (auto& itr : assetLibrary->getAllAssets(assetType)) {
-					if (!filter.PassFilter(itr.first.c_str())) {
+				// Picking an asset might load it and add new assets to the library, so iterate by index.
+				const std::vector<std::shared_ptr<Asset>>& allAssets = assetLibrary->getAllAssets(assetType);
+				for (size_t iAsset = 0; iAsset < allAssets.size(); ++iAsset) {
+					const std::shared_ptr<Asset> asset = allAssets[iAsset];
+					const std::string& pathToAsset = asset->getPath();
+					if (!filter.PassFilter(pathToAsset.c_str())) {
 						continue;
 					}
 
-					std::shared_ptr<Asset>& asset = itr.second;
 					if (assetType == AssetType::TextureView) {
 						if (isAssetLoadFailed(asset) == false) {
 							if (!isAssetLoaded(asset)) {
-								if (ImGui::Button(itr.first.c_str(), ImVec2(48, 48))) {
+								if (ImGui::Button(pathToAsset.c_str(), ImVec2(48, 48))) {
 									getCore()->getAssetLib()->getAsset(AssetType::TextureView, asset->getPath().c_str(), true);
 								}
 							} else if (isAssetLoaded(asset)) {
 								if (ImGui::ImageButton(asset->asTextureView()->GetPtr(), ImVec2(48, 48))) {
-									assetPath = itr.first;
+									assetPath = pathToAsset;
 									wasAssetPicked = true;
 								}
 							}
 
 							if (ImGui::IsItemHovered()) {
 								ImGui::BeginTooltip();
-								ImGui::Text(itr.first.c_str());
+								ImGui::Text(pathToAsset.c_str());
 								ImGui::EndTooltip();
 							}
 
@@ -93,12 +96,12 @@ bool assetPicker(
 
 						ImGui::SameLine();
 
-						bool selected = itr.first == assetPath;
-						if (ImGui::Selectable(itr.first.c_str(), &selected, ImGuiSelectableFlags_DontClosePopups)) {
+						bool selected = pathToAsset == assetPath;
+						if (ImGui::Selectable(pathToAsset.c_str(), &selected, ImGuiSelectableFlags_DontClosePopups)) {
 							if (!isAssetLoaded(asset)) {
 								getCore()->getAssetLib()->getAsset(AssetType::Model, asset->getPath().c_str(), true);
 							} else {
-								assetPath = itr.first;
+								assetPath = pathToAsset;
 								wasAssetPicked = true;
 							}
 						}
@@ -138,12 +141,12 @@ bool assetPicker(
 
 					} else {
 						// Generic for all asset types.
-						if (itr.first == assetPath) {
-							ImGui::TextUnformatted(itr.first.c_str());
+						if (pathToAsset == assetPath) {
+							ImGui::TextUnformatted(pathToAsset.c_str());
 						} else {
 							bool selected = false;
-							if (ImGui::Selectable(itr.first.c_str(), &selected)) {
-								assetPath = itr.first;
+							if (ImGui::Selectable(pathToAsset.c_str(), &selected)) {
+								assetPath = pathToAsset;
 								wasAssetPicked = true;
 							}
 						}
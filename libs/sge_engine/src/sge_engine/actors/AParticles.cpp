@@ -14,6 +14,7 @@ DefineTypeId(AParticles, 20'03'02'0052);
 ReflBlock() {
 	// AParticles
 	ReflAddActor(AParticles)
+		.gameObjectThreadSafeUpdate(false, true)
 		ReflMember(AParticles, m_particles)
 	;
 }
@@ -232,8 +233,13 @@ void AParticles::doAttributeEditor(GameInspector* inspector) {
 	}
 }
 
+void AParticles::update(const GameUpdateSets& u) {
+	// The assets cannot be updated in the parallel update phase, do it here.
+	m_particles.updateAssets(u);
+}
+
 void AParticles::postUpdate(const GameUpdateSets& u) {
-	m_particles.update(u);
+	m_particles.simulate(u);
 }
 
 } // namespace sge
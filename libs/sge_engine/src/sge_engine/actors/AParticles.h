@@ -11,6 +11,7 @@ DefineTypeIdExists(AParticles);
 struct SGE_ENGINE_API AParticles : public Actor, public IActorCustomAttributeEditorTrait {
 	AABox3f getBBoxOS() const final;
 	void create() final;
+	void update(const GameUpdateSets& u) final;
 	void postUpdate(const GameUpdateSets& u) final;
 
 	virtual void doAttributeEditor(GameInspector* inspector) final;
@@ -1,5 +1,6 @@
 #include "TraitModel.h"
 #include "IconsForkAwesome/IconsForkAwesome.h"
+#include "sge_core/ICore.h"
 #include "sge_core/SGEImGui.h"
 #include "sge_engine/EngineGlobal.h"
 #include "sge_engine/GameInspector.h"
@@ -128,6 +129,38 @@ void TraitModel::computeSkeleton(vector_map<const Model::Node*, mat4f>& boneOver
 }
 
 
+const EvaluatedModel* TraitModel::getEvaluatedModel(int frameStamp) {
+	AssetModel* const assetModel = m_assetProperty.getAssetModel();
+	if (assetModel == nullptr || assetModel->staticEval.isInitialized() == false) {
+		return nullptr;
+	}
+
+	if (isAnimated() == false) {
+		return &assetModel->staticEval;
+	}
+
+	// The model may have been changed since the last evaluation.
+	if (m_evalModel.m_model != &assetModel->model) {
+		m_evalModel.m_jobSystem = &getWorldFromObject()->getJobSystem();
+		m_evalModel.initialize(getCore()->getAssetLib(), &assetModel->model);
+		m_evalModelFrameStamp = -1;
+	}
+
+	if (m_evalModelFrameStamp != frameStamp) {
+		m_evalModelFrameStamp = frameStamp;
+
+		if (useSkeleton) {
+			vector_map<const Model::Node*, mat4f> boneOverrides;
+			computeSkeleton(boneOverrides);
+			m_evalModel.evaluate(boneOverrides);
+		} else {
+			m_evalModel.evaluate(animationName.c_str(), animationTime);
+		}
+	}
+
+	return &m_evalModel;
+}
+
 void editTraitStaticModel(GameInspector& inspector, GameObject* actor, MemberChain chain) {
 	TraitModel& traitStaticModel = *(TraitModel*)chain.follow(actor);
 
@@ -81,6 +81,14 @@ struct SGE_ENGINE_API TraitModel : public Trait {
 	void computeNodeToBoneIds();
 	void computeSkeleton(vector_map<const Model::Node*, mat4f>& boneOverrides);
 
+	/// Returns true if the pose of the model is evaluated per instance (it is animated or uses an external skeleton).
+	bool isAnimated() const { return useSkeleton || animationName.empty() == false; }
+
+	/// Returns the evaluated model to be drawn for this instance or nullptr if there is no loaded model.
+	/// Non-animated models use the shared staticEval of the asset. Animated ones have their own pose,
+	/// evaluated at most once per @frameStamp so every render pass in the frame reuses it.
+	const EvaluatedModel* getEvaluatedModel(int frameStamp);
+
   private:
 	bool updateAssetProperty() { return m_assetProperty.update(); }
 
@@ -94,6 +102,7 @@ struct SGE_ENGINE_API TraitModel : public Trait {
 	struct MaterialOverride {
 		std::string materialName;
 		ObjectId materialObjId;
+		ObjectHandle materialObjHint; ///< Not saved, used to avoid searching for the material object on every draw.
 	};
 
 	mat4f m_additionalTransform = mat4f::getIdentity();
@@ -112,6 +121,11 @@ struct SGE_ENGINE_API TraitModel : public Trait {
 	ObjectId rootSkeletonId;
 	std::unordered_map<const Model::Node*, ObjectId> nodeToBoneId;
 
+	/// The evaluated pose of this instance, used only if the model is animated.
+	EvaluatedModel m_evalModel;
+	/// The frame stamp of the last evaluation of m_evalModel.
+	int m_evalModelFrameStamp = -1;
+
 	/// @brief A struct holding the rendering options of a sprite or a texture in 3D.
 	struct ImageSettings {
 		/// @brief Computes the object-to-node transformation of the sprite so i has its origin in the deisiered location.
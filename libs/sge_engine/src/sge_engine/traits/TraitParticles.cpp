@@ -427,6 +427,11 @@ ParticleGroupState::SpriteRendData*
 //--------------------------------------------------------------
 
 void TraitParticles::update(const GameUpdateSets& u) {
+	updateAssets(u);
+	simulate(u);
+}
+
+void TraitParticles::updateAssets(const GameUpdateSets& u) {
 	if (u.isGamePaused() || !m_isEnabled) {
 		return;
 	}
@@ -434,7 +439,15 @@ void TraitParticles::update(const GameUpdateSets& u) {
 	for (ParticleGroupDesc& desc : m_pgroups) {
 		desc.m_particleModel.update();
 		desc.m_particlesSprite.update();
+	}
+}
 
+void TraitParticles::simulate(const GameUpdateSets& u) {
+	if (u.isGamePaused() || !m_isEnabled) {
+		return;
+	}
+
+	for (ParticleGroupDesc& desc : m_pgroups) {
 		// TODO: handle duplicated names!
 		m_pgroupState[desc.m_name].update(m_isInWorldSpace, getActor()->getTransformMtx(), desc, u.dt);
 	}
@@ -151,7 +151,15 @@ DefineTypeIdExists(TraitParticles);
 struct SGE_ENGINE_API TraitParticles : public Trait {
 	SGE_TraitDecl_Full(TraitParticles);
 
+	/// Updates the assets used by the particles and simulates them.
 	void update(const GameUpdateSets& u);
+
+	/// Updates the assets used by the particle groups. Uses the asset library, so it is not thread-safe.
+	void updateAssets(const GameUpdateSets& u);
+
+	/// Simulates the particles. Touches only the trait itself, so different traits could be simulated in parallel.
+	void simulate(const GameUpdateSets& u);
+
 	AABox3f getBBoxOS() const;
 
   public:
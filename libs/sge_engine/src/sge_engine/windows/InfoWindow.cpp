@@ -41,6 +41,8 @@ void InfoWindow::update(SGEContext* const UNUSED(sgecon), const InputState& UNUS
 		ImGui::DragFloat("FPS", &fps, 1.f, 0.f, 0.f, "%.1f");
 
 		ImGui::Value("Draw Calls Count", framestats.numDrawCalls);
+		ImGui::Value("Instanced Draw Calls Count", framestats.numInstancedDrawCalls);
+		ImGui::Value("Instances Count", (int)framestats.numInstancesDrawn);
 		ImGui::Value("Primitives Count", (int)framestats.numPrimitiveDrawn);
 		ImGui::Value("VSync Enabled", getCore()->getDevice()->getVsync());
 
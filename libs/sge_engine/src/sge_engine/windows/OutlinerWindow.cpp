@@ -65,9 +65,9 @@ void OutlinerWindow::update(SGEContext* const UNUSED(sgecon), const InputState&
 
 			bool shouldShowChildren = true;
 			bool passesFilter = shouldIgnoreFiler || nodeNamesFilter.PassFilter(currentEntity->getDisplayNameCStr());
-			const vector_set<ObjectId>* pAllChildObjects = world->getChildensOf(currentEntity->getId());
+			const GameWorld::HierarchyRange allChildObjects = world->getChildrenOf(currentEntity);
 
-			if (!pAllChildObjects || pAllChildObjects->empty()) {
+			if (allChildObjects.isEmpty()) {
 				treeNodeFlags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 			}
 
@@ -153,9 +153,8 @@ void OutlinerWindow::update(SGEContext* const UNUSED(sgecon), const InputState&
 
 			// The the tree node is opened (by clicking the arrow) add the GUI for children objects in the hierarchy.
 			if (shouldShowChildren) {
-				if (pAllChildObjects && pAllChildObjects->empty() == false) {
-					for (ObjectId childId : *pAllChildObjects) {
-						GameObject* child = world->getObjectById(childId);
+				if (allChildObjects.isEmpty() == false) {
+					for (Actor* const child : allChildObjects) {
 						addChildObjects(child, passesFilter);
 					}
 
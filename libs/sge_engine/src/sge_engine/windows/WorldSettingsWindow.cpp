@@ -105,7 +105,8 @@ void WorldSettingsWindow::update(SGEContext* const UNUSED(sgecon), const InputSt
 		}
 
 		if (ImGui::CollapsingHeader(ICON_FK_BUG " Debugging")) {
-			ImGui::Text("Num find object calls %d", m_inspector.getWorld()->debug.numCallsToGetObjectByIdThisFrame);
+			ImGui::Text("Num find object calls %d", m_inspector.getWorld()->debug.numCallsToGetObjectByIdThisFrame.load());
+			ImGui::Text("Num propagated transforms %d", m_inspector.getWorld()->debug.numPropagatedTransformsThisFrame.load());
 			ImGui::InputInt("MS Delay", &m_inspector.getWorld()->debug.forceSleepMs, 1, 10);
 		}
 
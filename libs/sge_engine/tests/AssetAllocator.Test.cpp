@@ -0,0 +1,59 @@
+#include "doctest/doctest.h"
+#include "sge_core/AssetLibrary.h"
+#include <algorithm>
+#include <random>
+
+using namespace sge;
+
+namespace {
+int g_numAliveAssets = 0;
+
+struct TrackedAsset {
+	TrackedAsset() { g_numAliveAssets++; }
+	~TrackedAsset() { g_numAliveAssets--; }
+
+	int value = 0;
+};
+} // namespace
+
+TEST_CASE("TAssetAllocatorDefault random allocations stress") {
+	const int kNumAssets = 100000;
+	std::mt19937 rng(42);
+
+	g_numAliveAssets = 0;
+	TAssetAllocatorDefault<TrackedAsset> allocator;
+
+	std::vector<TrackedAsset*> assets;
+	for (int t = 0; t < kNumAssets; ++t) {
+		assets.push_back((TrackedAsset*)allocator.allocate());
+		assets.back()->value = t;
+	}
+	CHECK(g_numAliveAssets == kNumAssets);
+	CHECK(allocator.getNumAllocated() == size_t(kNumAssets));
+
+	// Free the half of the assets in random order and allocate new ones in their place.
+	std::shuffle(assets.begin(), assets.end(), rng);
+	const int kNumFreed = kNumAssets / 2;
+	for (int t = 0; t < kNumFreed; ++t) {
+		allocator.deallocate(assets[t]);
+		assets[t] = (TrackedAsset*)allocator.allocate();
+		assets[t]->value = -1;
+	}
+	CHECK(g_numAliveAssets == kNumAssets);
+	CHECK(allocator.getNumAllocated() == size_t(kNumAssets));
+
+	// The assets that weren't freed are untouched.
+	bool areRemainingValid = true;
+	for (int t = kNumFreed; t < kNumAssets; ++t) {
+		areRemainingValid &= assets[t]->value >= 0;
+	}
+	CHECK(areRemainingValid);
+
+	// Free everything in random order.
+	std::shuffle(assets.begin(), assets.end(), rng);
+	for (TrackedAsset* const asset : assets) {
+		allocator.deallocate(asset);
+	}
+	CHECK(g_numAliveAssets == 0);
+	CHECK(allocator.getNumAllocated() == 0);
+}
@@ -0,0 +1,133 @@
+#include "doctest/doctest.h"
+#include "sge_core/AssetLibrary.h"
+#include "sge_utils/utils/FileStream.h"
+#include "sge_utils/utils/timer.h"
+#include <filesystem>
+
+using namespace sge;
+
+namespace {
+std::string writeTestFile(const char* const filename, const std::string& contents) {
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "sge_asset_registry_test";
+	std::filesystem::create_directories(dir);
+
+	const std::string path = (dir / filename).generic_string();
+	FileWriteStream fws;
+	fws.open(path.c_str());
+	fws.write(contents.data(), contents.size());
+	return path;
+}
+} // namespace
+
+TEST_CASE("AssetLibrary handles") {
+	// Text assets don't need a device, so no device is used.
+	AssetLibrary assetLib(nullptr);
+
+	const std::string pathA = writeTestFile("a.txt", "Text A");
+	const std::string pathB = writeTestFile("b.txt", "Text B");
+
+	SUBCASE("Handles match the path lookups") {
+		const AssetHandle handleA = assetLib.getAssetHandle(AssetType::Text, pathA.c_str(), true);
+		const AssetHandle handleB = assetLib.getAssetHandle(AssetType::Text, pathB.c_str(), true);
+		REQUIRE(handleA.isValid());
+		REQUIRE(handleB.isValid());
+		CHECK(handleA != handleB);
+
+		std::shared_ptr<Asset> assetA = assetLib.getAsset(handleA);
+		REQUIRE(isAssetLoaded(assetA, AssetType::Text));
+		CHECK(*assetA->asText() == "Text A");
+		CHECK(*assetLib.getAsset(handleB)->asText() == "Text B");
+
+		CHECK(assetLib.getAsset(AssetType::Text, pathA.c_str(), true).get() == assetA.get());
+		CHECK(assetLib.getAsset(pathA.c_str(), false).get() == assetA.get());
+		CHECK(assetLib.getAssetHandle(AssetType::Text, pathA.c_str(), false) == handleA);
+		CHECK(assetLib.getAllAssets(AssetType::Text).size() == 2);
+	}
+
+	SUBCASE("Different paths to the same file") {
+		std::shared_ptr<Asset> assetA = assetLib.getAsset(AssetType::Text, pathA.c_str(), true);
+		REQUIRE(isAssetLoaded(assetA));
+
+		const std::string pathAWithDots = (std::filesystem::path(pathA).parent_path() / "." / "a.txt").generic_string();
+		const std::string pathARelative = std::filesystem::relative(pathA).generic_string();
+		CHECK(assetLib.getAsset(AssetType::Text, pathAWithDots.c_str(), true).get() == assetA.get());
+		CHECK(assetLib.getAsset(AssetType::Text, pathARelative.c_str(), true).get() == assetA.get());
+		CHECK(assetLib.getAllAssets(AssetType::Text).size() == 1);
+	}
+
+	SUBCASE("Missing assets") {
+		CHECK(assetLib.getAssetHandle(AssetType::Text, pathA.c_str(), false).isValid() == false);
+		CHECK(assetLib.getAsset(AssetType::Text, pathA.c_str(), false).get() == nullptr);
+		CHECK(assetLib.getAsset(AssetHandle()).get() == nullptr);
+
+		// The same path as a different asset type is a different asset.
+		const AssetHandle handleText = assetLib.getAssetHandle(AssetType::Text, pathA.c_str(), true);
+		CHECK(assetLib.getAssetHandle(AssetType::Sprite, pathA.c_str(), false).isValid() == false);
+		CHECK(assetLib.getAssetHandle(AssetType::Text, pathA.c_str(), false) == handleText);
+	}
+
+	SUBCASE("Handles survive reloading and new assets") {
+		const AssetHandle handleA = assetLib.getAssetHandle(AssetType::Text, pathA.c_str(), true);
+		Asset* const assetA = assetLib.getAsset(handleA).get();
+
+		// The runtime assets are keyed by the specified path, use normalized paths so they could be found by path.
+		const std::string runtimeDir = std::filesystem::relative(std::filesystem::path(pathA).parent_path()).generic_string();
+		for (int iAsset = 0; iAsset < 1000; ++iAsset) {
+			const std::string path = runtimeDir + "/runtime_" + std::to_string(iAsset) + ".txt";
+			REQUIRE(assetLib.makeRuntimeAsset(AssetType::Text, path.c_str()).get() != nullptr);
+		}
+
+		CHECK(assetLib.getAsset(handleA).get() == assetA);
+		CHECK(assetLib.loadAsset(assetA));
+		CHECK(assetLib.getAsset(handleA).get() == assetA);
+		CHECK(*assetA->asText() == "Text A");
+
+		// Runtime assets are found by their path.
+		const std::string runtimePath = runtimeDir + "/runtime_500.txt";
+		std::shared_ptr<Asset> runtimeAsset = assetLib.getAsset(AssetType::Text, runtimePath.c_str(), false);
+		REQUIRE(runtimeAsset.get() != nullptr);
+		CHECK(runtimeAsset->getPath() == runtimePath);
+		CHECK(assetLib.getAllAssets(AssetType::Text).size() == 1001);
+	}
+}
+
+TEST_CASE("AssetLibrary lookup benchmark" * doctest::skip()) {
+	AssetLibrary assetLib(nullptr);
+
+	const int kNumAssets = 20000;
+	const int kNumLookups = 1000000;
+
+	// The runtime assets are keyed by the specified path, use normalized paths so they could be found by path.
+	const std::string dir = std::filesystem::relative(std::filesystem::temp_directory_path()).generic_string();
+
+	std::vector<std::string> paths;
+	for (int iAsset = 0; iAsset < kNumAssets; ++iAsset) {
+		paths.push_back(dir + "/sge_benchmark_asset_" + std::to_string(iAsset) + ".txt");
+		assetLib.makeRuntimeAsset(AssetType::Text, paths.back().c_str());
+	}
+
+	// The first lookup of every path normalizes it through the file system, the later lookups are cached.
+	std::vector<AssetHandle> handles;
+	const float firstLookupStartTime = Timer::now_seconds();
+	for (const std::string& path : paths) {
+		handles.push_back(assetLib.getAssetHandle(AssetType::Text, path.c_str(), false));
+	}
+	const float firstLookupTime = Timer::now_seconds() - firstLookupStartTime;
+
+	size_t numFound = 0;
+	const float pathLookupStartTime = Timer::now_seconds();
+	for (int iLookup = 0; iLookup < kNumLookups; ++iLookup) {
+		numFound += assetLib.getAsset(AssetType::Text, paths[(size_t(iLookup) * 7919) % kNumAssets].c_str(), false) ? 1 : 0;
+	}
+	const float pathLookupTime = Timer::now_seconds() - pathLookupStartTime;
+
+	const float handleLookupStartTime = Timer::now_seconds();
+	for (int iLookup = 0; iLookup < kNumLookups; ++iLookup) {
+		numFound += assetLib.getAsset(handles[(size_t(iLookup) * 7919) % kNumAssets]) ? 1 : 0;
+	}
+	const float handleLookupTime = Timer::now_seconds() - handleLookupStartTime;
+
+	CHECK(numFound == size_t(kNumLookups) * 2);
+	MESSAGE(kNumAssets << " assets, first lookups " << firstLookupTime * 1000.f << "ms; " << kNumLookups << " lookups: by path "
+	                   << pathLookupTime * 1000.f << "ms, by handle " << handleLookupTime * 1000.f << "ms");
+}
@@ -0,0 +1,88 @@
+#include "doctest/doctest.h"
+#include "sge_core/AssetLibrary.h"
+#include "sge_utils/utils/FileStream.h"
+#include <filesystem>
+
+using namespace sge;
+
+namespace {
+std::string writeTestFile(const char* const filename, const std::string& contents) {
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "sge_async_asset_loading_test";
+	std::filesystem::create_directories(dir);
+
+	const std::string path = (dir / filename).generic_string();
+	FileWriteStream fws;
+	fws.open(path.c_str());
+	fws.write(contents.data(), contents.size());
+	return path;
+}
+} // namespace
+
+TEST_CASE("AssetLibrary async loading") {
+	// Text assets don't need a device, so no device is used.
+	AssetLibrary assetLib(nullptr);
+
+	const std::string pathA = writeTestFile("a.txt", "Text A");
+	const std::string pathB = writeTestFile("b.txt", "Text B");
+	const std::string pathMissing = (std::filesystem::temp_directory_path() / "sge_async_asset_loading_test/missing.txt").generic_string();
+
+	SUBCASE("Status transitions") {
+		std::shared_ptr<Asset> assetA = assetLib.getAssetAsync(AssetType::Text, pathA.c_str());
+		std::shared_ptr<Asset> assetMissing = assetLib.getAssetAsync(AssetType::Text, pathMissing.c_str());
+		REQUIRE(assetA.get() != nullptr);
+		REQUIRE(assetMissing.get() != nullptr);
+
+		// Nothing is finished until the loads get finalized.
+		CHECK(assetA->getStatus() == AssetStatus::Loading);
+		CHECK(assetMissing->getStatus() == AssetStatus::Loading);
+		CHECK(isAssetLoaded(assetA) == false);
+		CHECK(assetLib.getNumPendingAsyncLoads() == 2);
+
+		assetLib.waitForAsyncLoads();
+		CHECK(assetLib.getNumPendingAsyncLoads() == 0);
+
+		REQUIRE(isAssetLoaded(assetA));
+		CHECK(*assetA->asText() == "Text A");
+		CHECK(assetMissing->getStatus() == AssetStatus::LoadFailed);
+
+		// Loaded assets are returned without loading them again.
+		CHECK(assetLib.getAssetAsync(AssetType::Text, pathA.c_str()).get() == assetA.get());
+		CHECK(assetLib.getNumPendingAsyncLoads() == 0);
+	}
+
+	SUBCASE("No duplicate loads") {
+		std::shared_ptr<Asset> assetA = assetLib.getAssetAsync(AssetType::Text, pathA.c_str());
+		CHECK(assetLib.getAssetAsync(AssetType::Text, pathA.c_str()).get() == assetA.get());
+		CHECK(assetLib.getAssetAsync(pathA.c_str()).get() == assetA.get());
+		CHECK(assetLib.getAsset(AssetType::Text, pathA.c_str(), false).get() == assetA.get());
+		CHECK(assetLib.getNumPendingAsyncLoads() == 1);
+
+		// The loading threads may still be working, finalizing never blocks.
+		while (assetLib.getNumPendingAsyncLoads() != 0) {
+			assetLib.finalizeAsyncLoads(0.f);
+		}
+
+		CHECK(isAssetLoaded(assetA));
+		CHECK(*assetA->asText() == "Text A");
+	}
+
+	SUBCASE("Synchronous requests finish the pending loads") {
+		std::shared_ptr<Asset> assetA = assetLib.getAssetAsync(AssetType::Text, pathA.c_str());
+		std::shared_ptr<Asset> assetB = assetLib.getAssetAsync(AssetType::Text, pathB.c_str());
+
+		std::shared_ptr<Asset> assetBSync = assetLib.getAsset(AssetType::Text, pathB.c_str(), true);
+		CHECK(assetBSync.get() == assetB.get());
+		REQUIRE(isAssetLoaded(assetB));
+		CHECK(*assetB->asText() == "Text B");
+		CHECK(assetLib.getNumPendingAsyncLoads() <= 1);
+
+		assetLib.waitForAsyncLoads();
+		CHECK(isAssetLoaded(assetA));
+	}
+
+	SUBCASE("Pending loads are dropped with the library") {
+		AssetLibrary otherAssetLib(nullptr);
+		std::shared_ptr<Asset> assetA = otherAssetLib.getAssetAsync(AssetType::Text, pathA.c_str());
+		CHECK(assetA->getStatus() == AssetStatus::Loading);
+	}
+}
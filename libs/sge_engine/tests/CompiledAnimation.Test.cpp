@@ -0,0 +1,244 @@
+#include "doctest/doctest.h"
+#include "sge_core/model/Model.h"
+
+#include <chrono>
+#include <random>
+
+using namespace sge;
+
+namespace {
+/// Creates a model with a chain of nodes, animated by 2 animations stored one after another in the curve "take".
+/// Some of the nodes have no keys for some of the channels, so their static values must be used.
+void createAnimatedModel(Model::Model& model, int numNodes, int numKeys, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+	const auto randomVec3 = [&]() -> vec3f { return vec3f(dist(rng), dist(rng), dist(rng)); };
+	const auto randomQuat = [&]() -> quatf { return quatf::getAxisAngle(randomVec3().normalized0(), dist(rng) * 3.f); };
+
+	model.m_animations.push_back(Model::AnimationInfo("take", 0.f, 1.f));
+	model.m_animations.push_back(Model::AnimationInfo("take", 1.f, 1.f));
+
+	for (int iNode = 0; iNode < numNodes; ++iNode) {
+		Model::Node* const node = model.m_containerNode.new_element();
+		node->id = iNode;
+		node->name = "node" + std::to_string(iNode);
+
+		const vec3f staticTranslation = randomVec3();
+		const quatf staticRotation = randomQuat();
+		const vec3f staticScaling = vec3f(1.f) + randomVec3() * 0.1f;
+
+		Parameter* const translation = node->paramBlock.FindParameter("translation", ParameterType::Float3, &staticTranslation);
+		Parameter* const rotation = node->paramBlock.FindParameter("rotation", ParameterType::Quaternion, &staticRotation);
+		Parameter* const scaling = node->paramBlock.FindParameter("scaling", ParameterType::Float3, &staticScaling);
+
+		// Every 3rd node has static translation, every 5th static scaling.
+		if (iNode % 3 != 0) {
+			translation->CreateCurve("take");
+		}
+		rotation->CreateCurve("take");
+		if (iNode % 5 != 0) {
+			scaling->CreateCurve("take");
+		}
+
+		for (int iKey = 0; iKey < numKeys; ++iKey) {
+			const float keyTime = 2.f * float(iKey) / float(numKeys - 1);
+			if (ParameterCurve* const curve = translation->GetCurve("take")) {
+				curve->TAdd(keyTime, randomVec3());
+			}
+			rotation->GetCurve("take")->TAdd(keyTime, randomQuat());
+			if (ParameterCurve* const curve = scaling->GetCurve("take")) {
+				curve->TAdd(keyTime, vec3f(1.f) + randomVec3() * 0.1f);
+			}
+		}
+
+		if (iNode == 0) {
+			model.m_rootNode = node;
+		} else {
+			model.m_nodes.back()->childNodes.push_back(node);
+		}
+		model.m_nodes.push_back(node);
+	}
+}
+
+/// Evaluates the local transform of the node directly from its parameters.
+transf3d evaluateNodeParameters(const Model::Node* node, const char* curveName, float time) {
+	transf3d result;
+	node->paramBlock.FindParameter("translation")->Evalute(&result.p, curveName, time);
+	node->paramBlock.FindParameter("rotation")->Evalute(&result.r, curveName, time);
+	node->paramBlock.FindParameter("scaling")->Evalute(&result.s, curveName, time);
+	return result;
+}
+
+bool isAboutTheSame(const transf3d& a, const transf3d& b) {
+	const float kEps = 1e-5f;
+	// The quaternions q and -q represent the same rotation, slerp may return either of them when sampling exactly at a key.
+	const float rotationsDot = a.r.x * b.r.x + a.r.y * b.r.y + a.r.z * b.r.z + a.r.w * b.r.w;
+	return (a.p - b.p).length() < kEps && (a.s - b.s).length() < kEps && fabsf(fabsf(rotationsDot) - 1.f) < kEps;
+}
+} // namespace
+
+TEST_CASE("CompiledAnimation matches the parameters") {
+	Model::Model model;
+	createAnimatedModel(model, 20, 7, 13);
+
+	CHECK(model.hasCompiledAnimations() == false);
+	model.compileAnimations();
+	REQUIRE(model.hasCompiledAnimations());
+	REQUIRE(model.m_compiledAnimations.size() == 2);
+	CHECK(model.m_compiledStaticMoment.getNumNodes() == 20);
+
+	// The tracks without keys in the curve fallback to a single key with the static value.
+	const Model::CompiledAnimation& firstAnimation = model.m_compiledAnimations[0];
+	CHECK(firstAnimation.getKeyRange(3, Model::AnimationChannel_Translation).numKeys == 1);
+	CHECK(firstAnimation.getKeyRange(4, Model::AnimationChannel_Translation).numKeys == 7);
+	CHECK(firstAnimation.getKeyRange(5, Model::AnimationChannel_Scaling).numKeys == 1);
+
+	bool allNodesMatch = true;
+	for (int iAnim = 0; iAnim < 2; ++iAnim) {
+		const Model::AnimationInfo& animInfo = model.m_animations[iAnim];
+		const Model::CompiledAnimation& animation = model.m_compiledAnimations[iAnim];
+
+		// Sample outside of the animation as well, the values should be clamped.
+		for (float time = -0.25f; time <= 1.25f; time += 0.01f) {
+			for (int iNode = 0; iNode < int(model.m_nodes.size()); ++iNode) {
+				const transf3d expected = evaluateNodeParameters(model.m_nodes[iNode], "take", time + animInfo.startTime);
+				allNodesMatch &= isAboutTheSame(animation.evaluateNode(iNode, time), expected);
+			}
+		}
+	}
+	CHECK(allNodesMatch);
+
+	bool allStaticNodesMatch = true;
+	std::vector<transf3d> staticMoment(model.m_nodes.size());
+	model.m_compiledStaticMoment.evaluateNodes(0.f, staticMoment.data());
+	for (int iNode = 0; iNode < int(model.m_nodes.size()); ++iNode) {
+		allStaticNodesMatch &= isAboutTheSame(staticMoment[iNode], evaluateNodeParameters(model.m_nodes[iNode], nullptr, 0.f));
+	}
+	CHECK(allStaticNodesMatch);
+
+	// Missing animations use the static moment.
+	CHECK(&model.findCompiledAnimation("missing") == &model.m_compiledStaticMoment);
+	CHECK(&model.findCompiledAnimation("") == &model.m_compiledStaticMoment);
+}
+
+TEST_CASE("findKeyIndex matches std::lower_bound") {
+	const float keyTimes[] = {0.f, 0.1f, 0.2f, 0.5f, 0.6f, 0.61f, 0.9f, 1.f};
+	const int numKeys = SGE_ARRSZ(keyTimes);
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(-0.2f, 1.2f);
+
+	// Forward playback with small steps, seeks, loops and sampling exactly at the keys.
+	std::vector<float> sampleTimes;
+	for (float time = -0.1f; time < 1.1f; time += 0.013f) {
+		sampleTimes.push_back(time);
+	}
+	for (int t = 0; t < 100; ++t) {
+		sampleTimes.push_back(dist(rng));
+	}
+	for (int t = 0; t < numKeys; ++t) {
+		sampleTimes.push_back(keyTimes[t]);
+	}
+
+	bool allMatch = true;
+	int keyCursor = -1;
+	for (const float time : sampleTimes) {
+		const int expected = int(std::lower_bound(keyTimes, keyTimes + numKeys, time) - keyTimes);
+		allMatch &= findKeyIndex(keyTimes, numKeys, time, keyCursor) == expected;
+		allMatch &= keyCursor == expected;
+	}
+	CHECK(allMatch);
+
+	// Invalid cursors fallback to binary search.
+	keyCursor = 100;
+	CHECK(findKeyIndex(keyTimes, numKeys, 0.55f, keyCursor) == 4);
+	keyCursor = -5;
+	CHECK(findKeyIndex(keyTimes, numKeys, 0.55f, keyCursor) == 4);
+}
+
+TEST_CASE("CompiledAnimation with key cursors") {
+	Model::Model model;
+	createAnimatedModel(model, 20, 31, 21);
+	model.compileAnimations();
+
+	const Model::CompiledAnimation& animation = model.m_compiledAnimations[0];
+	std::vector<int> keyCursors(animation.keyRanges.size(), -1);
+	std::vector<transf3d> pose(animation.getNumNodes());
+
+	// Play the animation looping twice, the cursors are reset on every loop.
+	bool allNodesMatch = true;
+	for (float time = 0.f; time < 2.f; time += 1.f / 60.f) {
+		const float loopTime = fmodf(time, animation.duration);
+		animation.evaluateNodes(loopTime, pose.data(), keyCursors.data());
+		for (int iNode = 0; iNode < animation.getNumNodes(); ++iNode) {
+			allNodesMatch &= isAboutTheSame(pose[iNode], animation.evaluateNode(iNode, loopTime));
+		}
+	}
+	CHECK(allNodesMatch);
+
+	// The curves use the same cursor.
+	const ParameterCurve* const curve = model.m_nodes[1]->paramBlock.FindParameter("translation")->GetCurve("take");
+	REQUIRE(curve != nullptr);
+	bool allCurveSamplesMatch = true;
+	int curveKeyCursor = -1;
+	for (float time = 0.f; time < 2.f; time += 1.f / 60.f) {
+		vec3f withCursor;
+		vec3f withoutCursor;
+		curve->Evaluate(time, &withCursor, &curveKeyCursor);
+		curve->Evaluate(time, &withoutCursor);
+		allCurveSamplesMatch &= withCursor == withoutCursor;
+	}
+	CHECK(allCurveSamplesMatch);
+}
+
+// A benchmark comparing the evaluation of the compiled animations to the evaluation of the parameters.
+// Skipped by default, run it with --no-skip.
+TEST_CASE("CompiledAnimation benchmark" * doctest::skip()) {
+	const int numSkeletons = 1000;
+	const int numBones = 60;
+
+	Model::Model model;
+	createAnimatedModel(model, numBones, 30, 17);
+	model.compileAnimations();
+
+	std::vector<transf3d> pose(numBones);
+
+	const auto parametersStart = std::chrono::high_resolution_clock::now();
+	for (int iSkeleton = 0; iSkeleton < numSkeletons; ++iSkeleton) {
+		const float time = float(iSkeleton) / float(numSkeletons);
+		for (int iNode = 0; iNode < numBones; ++iNode) {
+			pose[iNode] = evaluateNodeParameters(model.m_nodes[iNode], "take", time);
+		}
+	}
+	const auto parametersEnd = std::chrono::high_resolution_clock::now();
+
+	const Model::CompiledAnimation& animation = model.findCompiledAnimation("take");
+	const auto compiledStart = std::chrono::high_resolution_clock::now();
+	for (int iSkeleton = 0; iSkeleton < numSkeletons; ++iSkeleton) {
+		const float time = float(iSkeleton) / float(numSkeletons);
+		animation.evaluateNodes(time, pose.data());
+	}
+	const auto compiledEnd = std::chrono::high_resolution_clock::now();
+
+	// Every skeleton keeps its own key cursors, as an EvaluatedModel would.
+	std::vector<std::vector<int>> keyCursors(numSkeletons, std::vector<int>(animation.keyRanges.size(), -1));
+	const int numFrames = 10;
+	const auto cursorsStart = std::chrono::high_resolution_clock::now();
+	for (int iFrame = 0; iFrame < numFrames; ++iFrame) {
+		for (int iSkeleton = 0; iSkeleton < numSkeletons; ++iSkeleton) {
+			const float time = float(iSkeleton) / float(numSkeletons) + float(iFrame) / 60.f;
+			animation.evaluateNodes(time, pose.data(), keyCursors[iSkeleton].data());
+		}
+	}
+	const auto cursorsEnd = std::chrono::high_resolution_clock::now();
+
+	const double parametersMs = std::chrono::duration<double, std::milli>(parametersEnd - parametersStart).count();
+	const double compiledMs = std::chrono::duration<double, std::milli>(compiledEnd - compiledStart).count();
+	const double cursorsMs = std::chrono::duration<double, std::milli>(cursorsEnd - cursorsStart).count() / numFrames;
+	MESSAGE("Evaluating " << numSkeletons << " skeletons with " << numBones << " bones: parameters " << parametersMs << "ms, compiled "
+	                      << compiledMs << "ms, compiled with key cursors " << cursorsMs << "ms");
+
+	const float lastTime = float(numSkeletons - 1) / float(numSkeletons) + float(numFrames - 1) / 60.f;
+	CHECK(isAboutTheSame(pose.back(), evaluateNodeParameters(model.m_nodes.back(), "take", lastTime)));
+}
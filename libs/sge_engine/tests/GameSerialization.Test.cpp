@@ -0,0 +1,177 @@
+#include "doctest/doctest.h"
+#include "sge_engine/GameSerialization.h"
+#include "sge_engine/GameWorld.h"
+#include "sge_engine/actors/ALocator.h"
+
+using namespace sge;
+
+//--------------------------------------------------------------------
+// Types used only for testing.
+//--------------------------------------------------------------------
+struct TestTargetRef {
+	ObjectId target;
+	float weight = 1.f;
+};
+
+/// A struct with state that isn't reflected, which must not be cloned.
+struct TestCachedState {
+	float weight = 1.f;
+	int cachedValue = 0;
+};
+
+struct TestReferencingActor : public ALocator {
+	ObjectId target;
+	std::vector<ObjectId> targetsList;
+	std::vector<TestTargetRef> weightedTargets;
+	std::string tag;
+	int counter = 0;
+	int notSaved = 0;
+};
+
+// clang-format off
+DefineTypeId(TestTargetRef, 21'10'22'0001);
+DefineTypeId(std::vector<TestTargetRef>, 21'10'22'0002);
+DefineTypeId(TestReferencingActor, 21'10'22'0003);
+DefineTypeId(TestCachedState, 21'10'22'0004);
+
+ReflBlock() {
+	ReflAddType(TestTargetRef)
+		ReflMember(TestTargetRef, target)
+		ReflMember(TestTargetRef, weight);
+	ReflAddType(std::vector<TestTargetRef>);
+	ReflAddType(TestCachedState)
+		ReflMember(TestCachedState, weight);
+	ReflAddType(TestReferencingActor) ReflInherits(TestReferencingActor, ALocator)
+		ReflMember(TestReferencingActor, target)
+		ReflMember(TestReferencingActor, targetsList)
+		ReflMember(TestReferencingActor, weightedTargets)
+		ReflMember(TestReferencingActor, tag)
+		ReflMember(TestReferencingActor, counter)
+		ReflMember(TestReferencingActor, notSaved).addMemberFlag(MFF_NonSaveable);
+}
+// clang-format on
+
+namespace {
+/// Creates a prefab with an actor referencing a locator, the locator is also a child of that actor.
+void createReferencingPrefab(GameWorld& prefabWorld) {
+	prefabWorld.create();
+
+	TestReferencingActor* const actor = prefabWorld.alloc<TestReferencingActor>();
+	ALocator* const locator = prefabWorld.alloc<ALocator>();
+	const ObjectId outsideId(123456);
+
+	actor->setPosition(vec3f(1.f, 2.f, 3.f));
+	locator->setPosition(vec3f(1.f, 2.f, 4.f));
+	prefabWorld.setParentOf(locator->getId(), actor->getId());
+
+	actor->target = locator->getId();
+	actor->targetsList = {locator->getId(), outsideId};
+	actor->weightedTargets = {TestTargetRef{locator->getId(), 0.5f}, TestTargetRef{outsideId, 2.f}};
+	actor->tag = "prefab";
+	actor->counter = 42;
+	actor->notSaved = 7;
+}
+} // namespace
+
+TEST_CASE("GameSerialization cloneVariable") {
+	TestTargetRef src{ObjectId(10), 3.f};
+	TestTargetRef dest;
+
+	SUBCASE("Without remapping") {
+		cloneVariable((char*)&dest, (const char*)&src, typeLib().find<TestTargetRef>(), nullptr);
+		CHECK(dest.target == ObjectId(10));
+		CHECK(dest.weight == 3.f);
+	}
+
+	SUBCASE("With remapping") {
+		const std::unordered_map<ObjectId, ObjectId> remap = {{ObjectId(10), ObjectId(20)}};
+		cloneVariable((char*)&dest, (const char*)&src, typeLib().find<TestTargetRef>(), &remap);
+		CHECK(dest.target == ObjectId(20));
+		CHECK(dest.weight == 3.f);
+	}
+
+	SUBCASE("Unreflected state isn't copied") {
+		const TestCachedState srcState{2.f, 5};
+		TestCachedState destState;
+		cloneVariable((char*)&destState, (const char*)&srcState, typeLib().find<TestCachedState>(), nullptr);
+		CHECK(destState.weight == 2.f);
+		CHECK(destState.cachedValue == 0);
+	}
+}
+
+TEST_CASE("GameWorld instantiatePrefab") {
+	GameWorld prefabWorld;
+	createReferencingPrefab(prefabWorld);
+
+	GameWorld world;
+	world.create();
+
+	SUBCASE("Members, references and hierarchy") {
+		vector_set<ObjectId> newObjectIds;
+		world.instantiatePrefab(prefabWorld, false, true, nullptr, &newObjectIds);
+		REQUIRE(newObjectIds.size() == 2);
+
+		TestReferencingActor* actor = nullptr;
+		ALocator* locator = nullptr;
+		for (const ObjectId id : newObjectIds) {
+			GameObject* const object = world.getObjectById(id);
+			REQUIRE(object != nullptr);
+			if (object->getType() == sgeTypeId(TestReferencingActor)) {
+				actor = static_cast<TestReferencingActor*>(object);
+			} else {
+				locator = static_cast<ALocator*>(object);
+			}
+		}
+
+		REQUIRE(actor != nullptr);
+		REQUIRE(locator != nullptr);
+
+		// References to objects in the prefab point to the new objects, the others are kept as they are.
+		CHECK(actor->target == locator->getId());
+		REQUIRE(actor->targetsList.size() == 2);
+		CHECK(actor->targetsList[0] == locator->getId());
+		CHECK(actor->targetsList[1] == ObjectId(123456));
+		REQUIRE(actor->weightedTargets.size() == 2);
+		CHECK(actor->weightedTargets[0].target == locator->getId());
+		CHECK(actor->weightedTargets[0].weight == 0.5f);
+		CHECK(actor->weightedTargets[1].target == ObjectId(123456));
+
+		CHECK(actor->tag == "prefab");
+		CHECK(actor->counter == 42);
+		CHECK(actor->notSaved == 0);
+
+		CHECK(world.getParentId(locator->getId()) == actor->getId());
+		CHECK(actor->getPosition() == vec3f(1.f, 2.f, 3.f));
+		CHECK(locator->getPosition() == vec3f(1.f, 2.f, 4.f));
+
+		// The hierarchy of the new objects must work as the original.
+		actor->setPosition(vec3f(0.f));
+		CHECK(locator->getPosition() == vec3f(0.f, 0.f, 1.f));
+	}
+
+	SUBCASE("Many instances in a single frame") {
+		const int numInstances = 1000;
+		for (int t = 0; t < numInstances; ++t) {
+			world.instantiatePrefab(prefabWorld, false, true, nullptr);
+		}
+		world.update(GameUpdateSets(0.f, true, InputState()));
+
+		const std::vector<GameObject*>* const actors = world.getObjects(sgeTypeId(TestReferencingActor));
+		const std::vector<GameObject*>* const locators = world.getObjects(sgeTypeId(ALocator));
+		REQUIRE(actors != nullptr);
+		REQUIRE(locators != nullptr);
+
+		int numActors = 0;
+		bool allReferencesAreValid = true;
+		for (GameObject* const object : *actors) {
+			const TestReferencingActor* const actor = static_cast<TestReferencingActor*>(object);
+			allReferencesAreValid &= world.getParentId(actor->target) == actor->getId();
+			allReferencesAreValid &= actor->weightedTargets.size() == 2 && actor->weightedTargets[0].target == actor->target;
+			numActors++;
+		}
+
+		CHECK(numActors == numInstances);
+		CHECK(allReferencesAreValid);
+		CHECK(locators->size() == numInstances);
+	}
+}
@@ -0,0 +1,367 @@
+#include "doctest/doctest.h"
+#include "sge_engine/GameWorld.h"
+#include "sge_engine/actors/ALocator.h"
+
+using namespace sge;
+
+namespace {
+void stepWorld(GameWorld& world) {
+	world.update(GameUpdateSets(0.f, true, InputState()));
+}
+} // namespace
+
+//--------------------------------------------------------------------
+// Types used only for testing.
+//--------------------------------------------------------------------
+struct TestUpdatingActor : public ALocator {
+	void update(const GameUpdateSets& UNUSED(u)) override { numUpdates++; }
+	int numUpdates = 0;
+};
+
+struct TestPostUpdatingActor : public TestUpdatingActor {
+	void postUpdate(const GameUpdateSets& UNUSED(u)) override { numPostUpdates++; }
+	int numPostUpdates = 0;
+};
+
+/// Updated in the parallel update phase, spawns and kills objects via the command buffers.
+struct TestThreadSafeActor : public ALocator {
+	void update(const GameUpdateSets& UNUSED(u)) override { numUpdates++; }
+
+	void postUpdate(const GameUpdateSets& UNUSED(u)) override {
+		numPostUpdates++;
+		if (shouldSpawn) {
+			const ObjectId parentId = getId();
+			getWorld()->getCommandBuffer().createObject(sgeTypeId(ALocator), [parentId](GameObject* spawned) -> void {
+				spawned->getWorld()->getCommandBuffer().setParentOf(spawned->getId(), parentId);
+			});
+			shouldSpawn = false;
+		}
+
+		if (shouldDie) {
+			getWorld()->getCommandBuffer().killObject(getId());
+		}
+	}
+
+	int numUpdates = 0;
+	int numPostUpdates = 0;
+	bool shouldSpawn = false;
+	bool shouldDie = false;
+};
+
+// clang-format off
+DefineTypeId(TestUpdatingActor, 21'10'17'0001);
+DefineTypeId(TestPostUpdatingActor, 21'10'17'0002);
+DefineTypeId(TestThreadSafeActor, 21'10'17'0003);
+
+ReflBlock() {
+	ReflAddType(TestUpdatingActor) ReflInherits(TestUpdatingActor, ALocator);
+	ReflAddType(TestPostUpdatingActor) ReflInherits(TestPostUpdatingActor, TestUpdatingActor);
+	ReflAddType(TestThreadSafeActor) ReflInherits(TestThreadSafeActor, ALocator)
+		.gameObjectThreadSafeUpdate(true, true);
+}
+// clang-format on
+
+TEST_CASE("GameWorld getObjectById create/kill/recreate") {
+	GameWorld world;
+	world.create();
+
+	ALocator* const a = world.alloc<ALocator>();
+	ALocator* const b = world.alloc<ALocator>();
+	ALocator* const c = world.alloc<ALocator>();
+	REQUIRE(a != nullptr);
+	REQUIRE(b != nullptr);
+	REQUIRE(c != nullptr);
+
+	const ObjectId idA = a->getId();
+	const ObjectId idB = b->getId();
+	const ObjectId idC = c->getId();
+
+	SUBCASE("Objects awaiting creation are found") {
+		CHECK(world.isIdTaken(idA));
+		CHECK(world.getObjectById(idA) == a);
+		CHECK(world.getObjectById(idB) == b);
+		CHECK(world.getActor<ALocator>(idC) == c);
+		CHECK(world.getObjectById(ObjectId()) == nullptr);
+		CHECK(world.getObjectById(world.getNewId()) == nullptr);
+	}
+
+	SUBCASE("Playing objects are found") {
+		stepWorld(world);
+		CHECK(world.awaitsCreationObjects.empty());
+		CHECK(world.getObjectById(idA) == a);
+		CHECK(world.getObjectById(idB) == b);
+		CHECK(world.getObjectById(idC) == c);
+	}
+
+	SUBCASE("Killed objects are removed") {
+		stepWorld(world);
+		world.objectDelete(idB);
+
+		// The object is deleted at the beginning of the next update.
+		CHECK(world.getObjectById(idB) == b);
+
+		stepWorld(world);
+		CHECK_FALSE(world.isIdTaken(idB));
+		CHECK(world.getObjectById(idB) == nullptr);
+		CHECK(world.getObjectById(idA) == a);
+		CHECK(world.getObjectById(idC) == c);
+	}
+
+	SUBCASE("Killed ids could be recreated") {
+		stepWorld(world);
+		for (int iCycle = 0; iCycle < 8; ++iCycle) {
+			world.objectDelete(idB);
+			stepWorld(world);
+			CHECK(world.getObjectById(idB) == nullptr);
+
+			ALocator* const recreated = world.alloc<ALocator>(idB);
+			REQUIRE(recreated != nullptr);
+			CHECK(recreated->getId() == idB);
+			CHECK(world.getObjectById(idB) == recreated);
+
+			stepWorld(world);
+			CHECK(world.getObjectById(idB) == recreated);
+		}
+
+		CHECK(world.getObjectById(idA) == a);
+		CHECK(world.getObjectById(idC) == c);
+	}
+
+	SUBCASE("Lookups are counted") {
+		world.debug.numCallsToGetObjectByIdThisFrame = 0;
+		world.getObjectById(idA);
+		world.getActorById(idC);
+		CHECK(world.debug.numCallsToGetObjectByIdThisFrame == 2);
+	}
+
+	SUBCASE("Clearing the world drops all ids") {
+		stepWorld(world);
+		world.clear();
+		CHECK_FALSE(world.isIdTaken(idA));
+		CHECK(world.getObjectById(idA) == nullptr);
+		CHECK(world.getObjectById(idB) == nullptr);
+		CHECK(world.getObjectById(idC) == nullptr);
+	}
+}
+
+TEST_CASE("GameWorld ObjectHandle") {
+	GameWorld world;
+	world.create();
+
+	ALocator* const a = world.alloc<ALocator>();
+	ALocator* const b = world.alloc<ALocator>();
+	REQUIRE(a != nullptr);
+	REQUIRE(b != nullptr);
+	const ObjectId idB = b->getId();
+
+	const ObjectHandle handleA = world.getObjectHandle(a->getId());
+	const ObjectHandle handleB = world.getObjectHandle(b);
+	CHECK_FALSE(handleA.isNull());
+	CHECK(handleA != handleB);
+	CHECK(world.getObjectByHandle(handleA) == a);
+	CHECK(world.getObjectByHandle(handleB) == b);
+	CHECK(world.getObjectByHandle(ObjectHandle()) == nullptr);
+	CHECK(world.getObjectHandle(ObjectId()).isNull());
+
+	SUBCASE("Handles to deleted objects are detected") {
+		stepWorld(world);
+		world.objectDelete(idB);
+		stepWorld(world);
+		CHECK(world.getObjectByHandle(handleB) == nullptr);
+
+		// The new object reuses the slot of the deleted one, the old handle should still be invalid.
+		ALocator* const c = world.alloc<ALocator>();
+		REQUIRE(c != nullptr);
+		CHECK(c->getSlotIndex() == handleB.slotIndex);
+		CHECK(world.getObjectByHandle(handleB) == nullptr);
+		CHECK(world.getObjectByHandle(world.getObjectHandle(c)) == c);
+		CHECK(world.getObjectByHandle(handleA) == a);
+	}
+
+	SUBCASE("Hinted lookups") {
+		ObjectHandle hint;
+		CHECK(world.getObjectById(idB, hint) == b);
+		CHECK(hint == handleB);
+
+		// With a valid hint the id lookup should be skipped, but the call is still counted.
+		world.debug.numCallsToGetObjectByIdThisFrame = 0;
+		CHECK(world.getObjectById(idB, hint) == b);
+		CHECK(world.debug.numCallsToGetObjectByIdThisFrame == 1);
+
+		// Recreating the object with the same id must not resolve to the deleted object.
+		stepWorld(world);
+		world.objectDelete(idB);
+		stepWorld(world);
+		CHECK(world.getObjectById(idB, hint) == nullptr);
+		CHECK(hint.isNull());
+
+		ALocator* const recreated = world.alloc<ALocator>(idB);
+		REQUIRE(recreated != nullptr);
+		CHECK(world.getObjectById(idB, hint) == recreated);
+		CHECK(world.getObjectByHandle(handleB) == nullptr);
+	}
+
+	SUBCASE("Clearing the world invalidates all handles") {
+		world.clear();
+		CHECK(world.getObjectByHandle(handleA) == nullptr);
+		CHECK(world.getObjectByHandle(handleB) == nullptr);
+	}
+}
+
+TEST_CASE("GameWorld skips objects without update") {
+	const TypeDesc* const tdLocator = typeLib().find<ALocator>();
+	const TypeDesc* const tdUpdating = typeLib().find<TestUpdatingActor>();
+	const TypeDesc* const tdPostUpdating = typeLib().find<TestPostUpdatingActor>();
+	REQUIRE(tdLocator != nullptr);
+	REQUIRE(tdUpdating != nullptr);
+	REQUIRE(tdPostUpdating != nullptr);
+
+	CHECK_FALSE(tdLocator->gameObjectDesc.overridesUpdate);
+	CHECK_FALSE(tdLocator->gameObjectDesc.overridesPostUpdate);
+	CHECK(tdUpdating->gameObjectDesc.overridesUpdate);
+	CHECK_FALSE(tdUpdating->gameObjectDesc.overridesPostUpdate);
+	CHECK(tdPostUpdating->gameObjectDesc.overridesUpdate);
+	CHECK(tdPostUpdating->gameObjectDesc.overridesPostUpdate);
+
+	GameWorld world;
+	world.create();
+
+	for (int t = 0; t < 1000; ++t) {
+		world.alloc<ALocator>();
+	}
+
+	TestUpdatingActor* const updating = world.alloc<TestUpdatingActor>();
+	TestPostUpdatingActor* const postUpdating = world.alloc<TestPostUpdatingActor>();
+	REQUIRE(updating != nullptr);
+	REQUIRE(postUpdating != nullptr);
+
+	stepWorld(world);
+	stepWorld(world);
+
+	CHECK(updating->numUpdates == 2);
+	CHECK(postUpdating->numUpdates == 2);
+	CHECK(postUpdating->numPostUpdates == 2);
+
+	// Only the lists of the test types should be iterated, the locators should not be touched at all.
+	CHECK(world.m_playingObjectsWithUpdate.size() == 2);
+	CHECK(world.m_playingObjectsWithPostUpdate.size() == 1);
+	for (const std::vector<GameObject*>* objectsOfType : world.m_playingObjectsWithUpdate) {
+		CHECK(objectsOfType->size() == 1);
+	}
+
+	// Clearing the world should not leave any dangling lists.
+	world.clear();
+	CHECK(world.m_playingObjectsWithUpdate.empty());
+	CHECK(world.m_playingObjectsWithPostUpdate.empty());
+}
+
+TEST_CASE("GameWorld parallel update phase") {
+	GameWorld world;
+	world.create();
+
+	const int numObjects = 1000;
+	std::vector<TestThreadSafeActor*> objects;
+	for (int t = 0; t < numObjects; ++t) {
+		TestThreadSafeActor* const object = world.alloc<TestThreadSafeActor>();
+		REQUIRE(object != nullptr);
+		object->shouldSpawn = (t % 10) == 0;
+		object->shouldDie = (t % 4) == 0;
+		objects.push_back(object);
+	}
+
+	// The objects start playing and get updated.
+	stepWorld(world);
+	CHECK(world.m_parallelPlayingObjectsWithUpdate.size() == 1);
+	CHECK(world.m_parallelPlayingObjectsWithPostUpdate.size() == 1);
+
+	int numUpdatedOnce = 0;
+	for (TestThreadSafeActor* object : objects) {
+		numUpdatedOnce += (object->numUpdates == 1 && object->numPostUpdates == 1) ? 1 : 0;
+	}
+	CHECK(numUpdatedOnce == numObjects);
+
+	// The spawned objects are created and parented at the sync point.
+	CHECK(world.awaitsCreationObjects.size() == numObjects / 10);
+	for (GameObject* const spawned : world.awaitsCreationObjects) {
+		CHECK(spawned->getType() == sgeTypeId(ALocator));
+		const GameObject* const parent = world.getParentActor(spawned->getId());
+		REQUIRE(parent != nullptr);
+		CHECK(parent->getType() == sgeTypeId(TestThreadSafeActor));
+	}
+
+	// The killed objects are gone after the next update.
+	CHECK(world.objectsWantingPermanentKill.size() == numObjects / 4);
+	stepWorld(world);
+	CHECK(world.playingObjects[sgeTypeId(TestThreadSafeActor)].size() == numObjects - numObjects / 4);
+	CHECK(world.playingObjects[sgeTypeId(ALocator)].size() == numObjects / 10);
+}
+
+TEST_CASE("GameWorld hierarchy") {
+	GameWorld world;
+	world.create();
+
+	// root
+	// |- a
+	// |  |- a0
+	// |  |- a1
+	// |- b
+	//    |- b0
+	ALocator* const root = world.alloc<ALocator>();
+	ALocator* const a = world.alloc<ALocator>();
+	ALocator* const a0 = world.alloc<ALocator>();
+	ALocator* const a1 = world.alloc<ALocator>();
+	ALocator* const b = world.alloc<ALocator>();
+	ALocator* const b0 = world.alloc<ALocator>();
+
+	CHECK(world.setParentOf(a->getId(), root->getId()));
+	CHECK(world.setParentOf(b->getId(), root->getId()));
+	CHECK(world.setParentOf(a0->getId(), a->getId()));
+	CHECK(world.setParentOf(a1->getId(), a->getId()));
+	CHECK(world.setParentOf(b0->getId(), b->getId()));
+
+	const auto toList = [](const GameWorld::HierarchyRange& range) -> std::vector<Actor*> {
+		std::vector<Actor*> result;
+		for (Actor* actor : range) {
+			result.push_back(actor);
+		}
+		return result;
+	};
+
+	SUBCASE("Queries") {
+		CHECK(world.getParentId(a0->getId()) == a->getId());
+		CHECK(world.getParentId(root->getId()).isNull());
+		CHECK(world.getRootParentId(b0->getId()) == root->getId());
+		CHECK(world.hasChildren(a->getId()));
+		CHECK_FALSE(world.hasChildren(b0->getId()));
+
+		CHECK(toList(world.getChildrenOf(root)) == std::vector<Actor*>{a, b});
+		CHECK(toList(world.getDescendantsOf(root)) == std::vector<Actor*>{a, a0, a1, b, b0});
+		CHECK(toList(world.getDescendantsOf(a->getId())) == std::vector<Actor*>{a0, a1});
+		CHECK(toList(world.getDescendantsOf(b0)).empty());
+	}
+
+	SUBCASE("Cycles are rejected") {
+		CHECK_FALSE(world.setParentOf(root->getId(), a0->getId()));
+		CHECK_FALSE(world.setParentOf(a->getId(), a->getId()));
+		CHECK(world.getParentId(root->getId()).isNull());
+		CHECK(world.getParentId(a->getId()) == root->getId());
+	}
+
+	SUBCASE("Reparenting and unparenting") {
+		CHECK(world.setParentOf(a0->getId(), b->getId()));
+		CHECK(toList(world.getChildrenOf(a)) == std::vector<Actor*>{a1});
+		CHECK(toList(world.getChildrenOf(b)) == std::vector<Actor*>{b0, a0});
+
+		CHECK_FALSE(world.setParentOf(b->getId(), ObjectId()));
+		CHECK(toList(world.getChildrenOf(root)) == std::vector<Actor*>{a});
+		CHECK(world.getRootParentId(a0->getId()) == b->getId());
+	}
+
+	SUBCASE("Killing a parent unparents the children") {
+		world.objectDelete(a->getId());
+		world.update(GameUpdateSets(0.f, true, InputState()));
+		CHECK(world.getParentId(a0->getId()).isNull());
+		CHECK(world.getParentId(a1->getId()).isNull());
+		CHECK(toList(world.getDescendantsOf(root)) == std::vector<Actor*>{b, b0});
+	}
+}
@@ -0,0 +1,121 @@
+#include "doctest/doctest.h"
+#include "sge_engine/LightClusters.h"
+#include "sge_engine/actors/ALight.h"
+#include <random>
+
+using namespace sge;
+
+namespace {
+ShadingLightData makePointLight(const vec3f& position, float range) {
+	ShadingLightData light;
+	light.lightPositionAndType = vec4f(position, float(light_point));
+	light.lightColorWFlags = vec4f(1.f, 1.f, 1.f, 0.f);
+	light.lightXShadowRange = vec4f(range, 0.f, 0.f, 0.f);
+	return light;
+}
+
+bool isLightInCluster(const LightClusters& clusters, int iCluster, int iLight) {
+	for (int t = 0; t < clusters.getClusterNumLights(iCluster); ++t) {
+		if (clusters.getClusterLightIndex(iCluster, t) == iLight) {
+			return true;
+		}
+	}
+	return false;
+}
+} // namespace
+
+TEST_CASE("LightClusters assignment") {
+	// The camera is at the origin looking along -Z.
+	const mat4f view = mat4f::getIdentity();
+	const mat4f proj = mat4f::getPerspectiveFovRH(deg2rad(60.f), 16.f / 9.f, 0.1f, 1000.f, kIsTexcoordStyleD3D);
+
+	LightClusters clusters;
+
+	SUBCASE("A point light affects only the clusters near it") {
+		const ShadingLightData light = makePointLight(vec3f(0.f, 0.f, -10.f), 1.f);
+		const ShadingLightData* lights[] = {&light};
+		clusters.build(view, proj, lights, 1);
+
+		const int iLightCluster = clusters.findClusterIndex(vec3f(0.f, 0.f, -10.f));
+		REQUIRE(iLightCluster >= 0);
+		CHECK(isLightInCluster(clusters, iLightCluster, 0));
+
+		const int iFarCluster = clusters.findClusterIndex(vec3f(0.f, 0.f, -500.f));
+		REQUIRE(iFarCluster >= 0);
+		CHECK(clusters.getClusterNumLights(iFarCluster) == 0);
+
+		const int iSideCluster = clusters.findClusterIndex(vec3f(8.f, 0.f, -10.f));
+		REQUIRE(iSideCluster >= 0);
+		CHECK(clusters.getClusterNumLights(iSideCluster) == 0);
+	}
+
+	SUBCASE("Lights outside of the frustum affect nothing") {
+		const ShadingLightData behind = makePointLight(vec3f(0.f, 0.f, 10.f), 1.f);
+		const ShadingLightData aside = makePointLight(vec3f(100.f, 0.f, -10.f), 1.f);
+		const ShadingLightData* lights[] = {&behind, &aside};
+		clusters.build(view, proj, lights, 2);
+
+		int numIndices = 0;
+		for (int iCluster = 0; iCluster < LightClusters::kNumClusters; ++iCluster) {
+			numIndices += clusters.getClusterNumLights(iCluster);
+		}
+		CHECK(numIndices == 0);
+	}
+
+	SUBCASE("Directional lights affect all clusters") {
+		ShadingLightData light;
+		light.lightPositionAndType = vec4f(0.f, 1.f, 0.f, float(light_directional));
+		const ShadingLightData* lights[] = {&light};
+		clusters.build(view, proj, lights, 1);
+
+		bool allClustersHaveIt = true;
+		for (int iCluster = 0; iCluster < LightClusters::kNumClusters; ++iCluster) {
+			allClustersHaveIt &= isLightInCluster(clusters, iCluster, 0);
+		}
+		CHECK(allClustersHaveIt);
+	}
+
+	SUBCASE("The assignment is conservative") {
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> distXY(-20.f, 20.f);
+		std::uniform_real_distribution<float> distZ(-60.f, 2.f);
+		std::uniform_real_distribution<float> distRange(0.5f, 8.f);
+		std::uniform_real_distribution<float> dist01(0.f, 1.f);
+
+		const int numLights = 128;
+		std::vector<ShadingLightData> lightsData;
+		std::vector<const ShadingLightData*> lights;
+		for (int t = 0; t < numLights; ++t) {
+			lightsData.push_back(makePointLight(vec3f(distXY(rng), distXY(rng), distZ(rng)), distRange(rng)));
+		}
+		for (const ShadingLightData& light : lightsData) {
+			lights.push_back(&light);
+		}
+
+		clusters.build(view, proj, lights.data(), numLights);
+		REQUIRE(clusters.getNumTruncatedLightIndices() == 0);
+
+		// Every point in the range of a light must be in a cluster that has that light.
+		bool allPointsAreLit = true;
+		for (int iLight = 0; iLight < numLights; ++iLight) {
+			const vec3f center = lightsData[iLight].lightPositionAndType.xyz();
+			const float range = lightsData[iLight].lightXShadowRange.x;
+			for (int iPoint = 0; iPoint < 64; ++iPoint) {
+				const vec3f dir = vec3f(dist01(rng) - 0.5f, dist01(rng) - 0.5f, dist01(rng) - 0.5f).normalized0();
+				const vec3f point = center + dir * range * dist01(rng) * 0.999f;
+				const int iCluster = clusters.findClusterIndex(point);
+				if (iCluster >= 0) {
+					allPointsAreLit &= isLightInCluster(clusters, iCluster, iLight);
+				}
+			}
+		}
+		CHECK(allPointsAreLit);
+	}
+
+	SUBCASE("Too many lights are clamped") {
+		const ShadingLightData light = makePointLight(vec3f(0.f, 0.f, -10.f), 1.f);
+		std::vector<const ShadingLightData*> lights(LightClusters::kMaxLights + 10, &light);
+		clusters.build(view, proj, lights.data(), int(lights.size()));
+		CHECK(clusters.getNumLights() == LightClusters::kMaxLights);
+	}
+}
@@ -0,0 +1,283 @@
+#include "doctest/doctest.h"
+#include "sge_core/model/Model.h"
+#include "sge_core/model/ModelBinaryFormat.h"
+#include "sge_core/model/ModelReader.h"
+#include "sge_core/model/ModelWriter.h"
+#include "sge_utils/utils/FileStream.h"
+#include <filesystem>
+
+using namespace sge;
+
+namespace {
+std::vector<std::string> findEditorModelFiles() {
+	const std::filesystem::path dir = std::filesystem::path(__FILE__).parent_path() / ".." / "assets" / "editor" / "models";
+
+	std::vector<std::string> result;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".mdl") {
+			result.push_back(entry.path().generic_string());
+		}
+	}
+	return result;
+}
+
+/// Loads the model without creating its GPU resources, so all of its data stays on the CPU.
+bool loadModel(IReadStream& stream, Model::Model& model) {
+	Model::ModelReader modelReader;
+	return modelReader.Load(Model::LoadSettings(), nullptr, &stream, model);
+}
+
+/// Adds the kind of data the editor models don't have: collision geometry, bones, animations and string parameters.
+void addMissingModelData(Model::Model& model) {
+	// The JSON header stores the numbers with 6 decimal places, so the values must survive that.
+	const transf3d transform(vec3f(1.f, 2.f, 3.f), quatf(0.f, 0.6f, 0.f, 0.8f), vec3f(2.f));
+	model.m_collisionBoxes.emplace_back("box", transform, vec3f(1.f, 2.f, 3.f));
+	model.m_collisionCapsules.emplace_back("capsule", transform, 2.f, 0.5f);
+	model.m_collisionCylinders.emplace_back("cylinder", transform, vec3f(0.5f, 1.f, 0.5f));
+	model.m_collisionSpheres.emplace_back("sphere", transform, 3.f);
+	model.m_convexHulls.emplace_back(std::vector<vec3f>{vec3f(0.f), vec3f(1.f, 0.f, 0.f), vec3f(0.f, 1.f, 0.f)}, std::vector<int>{0, 1, 2});
+
+	Model::Node* const rootNode = model.m_rootNode;
+	rootNode->paramBlock.FindParameter("tag", ParameterType::String, "tagValue");
+
+	Parameter* const translation = rootNode->paramBlock.FindParameter("translation", ParameterType::Float3, vec3f(0.f).data);
+	REQUIRE(translation->CreateCurve("move"));
+	ParameterCurve& curve = *translation->GetCurve("move");
+	curve.type = ParameterType::Float3;
+	curve.TAdd(0.f, vec3f(0.f));
+	curve.TAdd(1.f, vec3f(1.f, 2.f, 3.f));
+	model.m_animations.emplace_back("move", 0.f, 1.f);
+
+	// Skinned meshes need a mesh data of their own.
+	for (Model::MeshData* const meshData : model.m_meshesData) {
+		if (meshData->meshes.size() == 1) {
+			Model::Bone bone;
+			bone.node = rootNode;
+			bone.offsetMatrix = mat4f::getTranslation(1.f, 2.f, 3.f);
+			bone.vertexIds = {0};
+			bone.weights = {1.f};
+			meshData->meshes[0]->bones.push_back(bone);
+			break;
+		}
+	}
+}
+
+void checkParamBlocksEqual(const ParameterBlock& a, const ParameterBlock& b) {
+	auto itrB = b.begin();
+	for (const auto& itrA : a) {
+		REQUIRE(itrB != b.end());
+		CHECK(itrA.first == itrB->first);
+
+		const Parameter& paramA = itrA.second;
+		const Parameter& paramB = itrB->second;
+		REQUIRE(paramA.GetType() == paramB.GetType());
+		if (paramA.GetType() == ParameterType::String) {
+			CHECK(std::string((const char*)paramA.GetStaticValue()) == (const char*)paramB.GetStaticValue());
+		} else {
+			CHECK(memcmp(paramA.GetStaticValue(), paramB.GetStaticValue(), ParameterType::SizeBytes(paramA.GetType())) == 0);
+		}
+
+		REQUIRE(paramA.GetNumCurves() == paramB.GetNumCurves());
+		for (int iCurve = 0; iCurve < paramA.GetNumCurves(); ++iCurve) {
+			CHECK(std::string(paramA.GetCurveName(iCurve)) == paramB.GetCurveName(iCurve));
+			CHECK(paramA.GetCurve(iCurve)->keys == paramB.GetCurve(iCurve)->keys);
+			CHECK(paramA.GetCurve(iCurve)->data == paramB.GetCurve(iCurve)->data);
+		}
+
+		++itrB;
+	}
+	CHECK(itrB == b.end());
+}
+
+void checkTransformsEqual(const transf3d& a, const transf3d& b) {
+	CHECK(a.p == b.p);
+	CHECK(a.r == b.r);
+	CHECK(a.s == b.s);
+}
+
+void checkModelsEqual(const Model::Model& a, const Model::Model& b) {
+	REQUIRE(a.m_rootNode != nullptr);
+	REQUIRE(b.m_rootNode != nullptr);
+	CHECK(a.m_rootNode->id == b.m_rootNode->id);
+
+	REQUIRE(a.m_animations.size() == b.m_animations.size());
+	for (size_t t = 0; t < a.m_animations.size(); ++t) {
+		CHECK(a.m_animations[t].curveName == b.m_animations[t].curveName);
+		CHECK(a.m_animations[t].startTime == b.m_animations[t].startTime);
+		CHECK(a.m_animations[t].duration == b.m_animations[t].duration);
+	}
+
+	REQUIRE(a.m_materials.size() == b.m_materials.size());
+	for (size_t t = 0; t < a.m_materials.size(); ++t) {
+		CHECK(a.m_materials[t]->id == b.m_materials[t]->id);
+		CHECK(a.m_materials[t]->name == b.m_materials[t]->name);
+		checkParamBlocksEqual(a.m_materials[t]->paramBlock, b.m_materials[t]->paramBlock);
+	}
+
+	REQUIRE(a.m_nodes.size() == b.m_nodes.size());
+	for (size_t t = 0; t < a.m_nodes.size(); ++t) {
+		const Model::Node& nodeA = *a.m_nodes[t];
+		const Model::Node& nodeB = *b.m_nodes[t];
+		CHECK(nodeA.id == nodeB.id);
+		CHECK(nodeA.name == nodeB.name);
+		checkParamBlocksEqual(nodeA.paramBlock, nodeB.paramBlock);
+
+		REQUIRE(nodeA.childNodes.size() == nodeB.childNodes.size());
+		for (size_t iChild = 0; iChild < nodeA.childNodes.size(); ++iChild) {
+			CHECK(nodeA.childNodes[iChild]->id == nodeB.childNodes[iChild]->id);
+		}
+
+		REQUIRE(nodeA.meshAttachments.size() == nodeB.meshAttachments.size());
+		for (size_t iAttachment = 0; iAttachment < nodeA.meshAttachments.size(); ++iAttachment) {
+			const Model::MeshAttachment& attachmentA = nodeA.meshAttachments[iAttachment];
+			const Model::MeshAttachment& attachmentB = nodeB.meshAttachments[iAttachment];
+			CHECK(attachmentA.mesh->id == attachmentB.mesh->id);
+			CHECK((attachmentA.material ? attachmentA.material->id : -1) == (attachmentB.material ? attachmentB.material->id : -1));
+		}
+	}
+
+	REQUIRE(a.m_meshesData.size() == b.m_meshesData.size());
+	for (size_t t = 0; t < a.m_meshesData.size(); ++t) {
+		const Model::MeshData& meshDataA = *a.m_meshesData[t];
+		const Model::MeshData& meshDataB = *b.m_meshesData[t];
+		CHECK(meshDataA.vertexBufferRaw == meshDataB.vertexBufferRaw);
+		CHECK(meshDataA.indexBufferRaw == meshDataB.indexBufferRaw);
+
+		REQUIRE(meshDataA.meshes.size() == meshDataB.meshes.size());
+		for (size_t iMesh = 0; iMesh < meshDataA.meshes.size(); ++iMesh) {
+			const Model::Mesh& meshA = *meshDataA.meshes[iMesh];
+			const Model::Mesh& meshB = *meshDataB.meshes[iMesh];
+			CHECK(meshA.id == meshB.id);
+			CHECK(meshA.name == meshB.name);
+			CHECK(meshA.primTopo == meshB.primTopo);
+			CHECK(meshA.vbByteOffset == meshB.vbByteOffset);
+			CHECK(meshA.ibByteOffset == meshB.ibByteOffset);
+			CHECK(meshA.ibFmt == meshB.ibFmt);
+			CHECK(meshA.numElements == meshB.numElements);
+			CHECK(meshA.numVertices == meshB.numVertices);
+			CHECK(meshA.stride == meshB.stride);
+			CHECK(meshA.vbPositionOffsetBytes == meshB.vbPositionOffsetBytes);
+			CHECK(meshA.vbNormalOffsetBytes == meshB.vbNormalOffsetBytes);
+			CHECK(meshA.vbUVOffsetBytes == meshB.vbUVOffsetBytes);
+			CHECK(meshA.aabox.min == meshB.aabox.min);
+			CHECK(meshA.aabox.max == meshB.aabox.max);
+			CHECK((meshA.pMaterial ? meshA.pMaterial->id : -1) == (meshB.pMaterial ? meshB.pMaterial->id : -1));
+
+			REQUIRE(meshA.vertexDecl.size() == meshB.vertexDecl.size());
+			for (size_t iDecl = 0; iDecl < meshA.vertexDecl.size(); ++iDecl) {
+				CHECK(meshA.vertexDecl[iDecl].semantic == meshB.vertexDecl[iDecl].semantic);
+				CHECK(meshA.vertexDecl[iDecl].byteOffset == meshB.vertexDecl[iDecl].byteOffset);
+				CHECK(meshA.vertexDecl[iDecl].format == meshB.vertexDecl[iDecl].format);
+			}
+
+			REQUIRE(meshA.bones.size() == meshB.bones.size());
+			for (size_t iBone = 0; iBone < meshA.bones.size(); ++iBone) {
+				CHECK(meshA.bones[iBone].node->id == meshB.bones[iBone].node->id);
+				CHECK(meshA.bones[iBone].vertexIds == meshB.bones[iBone].vertexIds);
+				CHECK(meshA.bones[iBone].weights == meshB.bones[iBone].weights);
+				CHECK(memcmp(&meshA.bones[iBone].offsetMatrix, &meshB.bones[iBone].offsetMatrix, sizeof(mat4f)) == 0);
+			}
+		}
+	}
+
+	REQUIRE(a.m_convexHulls.size() == b.m_convexHulls.size());
+	for (size_t t = 0; t < a.m_convexHulls.size(); ++t) {
+		CHECK(a.m_convexHulls[t].vertices == b.m_convexHulls[t].vertices);
+		CHECK(a.m_convexHulls[t].indices == b.m_convexHulls[t].indices);
+	}
+
+	REQUIRE(a.m_collisionBoxes.size() == b.m_collisionBoxes.size());
+	for (size_t t = 0; t < a.m_collisionBoxes.size(); ++t) {
+		CHECK(a.m_collisionBoxes[t].name == b.m_collisionBoxes[t].name);
+		checkTransformsEqual(a.m_collisionBoxes[t].transform, b.m_collisionBoxes[t].transform);
+		CHECK(a.m_collisionBoxes[t].halfDiagonal == b.m_collisionBoxes[t].halfDiagonal);
+	}
+
+	REQUIRE(a.m_collisionCapsules.size() == b.m_collisionCapsules.size());
+	for (size_t t = 0; t < a.m_collisionCapsules.size(); ++t) {
+		CHECK(a.m_collisionCapsules[t].name == b.m_collisionCapsules[t].name);
+		checkTransformsEqual(a.m_collisionCapsules[t].transform, b.m_collisionCapsules[t].transform);
+		CHECK(a.m_collisionCapsules[t].halfHeight == b.m_collisionCapsules[t].halfHeight);
+		CHECK(a.m_collisionCapsules[t].radius == b.m_collisionCapsules[t].radius);
+	}
+
+	REQUIRE(a.m_collisionCylinders.size() == b.m_collisionCylinders.size());
+	for (size_t t = 0; t < a.m_collisionCylinders.size(); ++t) {
+		CHECK(a.m_collisionCylinders[t].name == b.m_collisionCylinders[t].name);
+		checkTransformsEqual(a.m_collisionCylinders[t].transform, b.m_collisionCylinders[t].transform);
+		CHECK(a.m_collisionCylinders[t].halfDiagonal == b.m_collisionCylinders[t].halfDiagonal);
+	}
+
+	REQUIRE(a.m_collisionSpheres.size() == b.m_collisionSpheres.size());
+	for (size_t t = 0; t < a.m_collisionSpheres.size(); ++t) {
+		CHECK(a.m_collisionSpheres[t].name == b.m_collisionSpheres[t].name);
+		checkTransformsEqual(a.m_collisionSpheres[t].transform, b.m_collisionSpheres[t].transform);
+		CHECK(a.m_collisionSpheres[t].radius == b.m_collisionSpheres[t].radius);
+	}
+}
+} // namespace
+
+TEST_CASE("ModelWriter binary header round trip") {
+	const std::vector<std::string> modelFiles = findEditorModelFiles();
+	REQUIRE(modelFiles.empty() == false);
+
+	for (const std::string& path : modelFiles) {
+		INFO(path);
+
+		// The editor models use the legacy JSON header.
+		Model::Model legacyModel;
+		FileReadStream frs(path.c_str());
+		REQUIRE(loadModel(frs, legacyModel));
+		addMissingModelData(legacyModel);
+
+		for (const ModelWriter::HeaderFormat headerFormat : {ModelWriter::HeaderFormat_Binary, ModelWriter::HeaderFormat_Json}) {
+			INFO("Header format " << int(headerFormat));
+
+			WriteByteStream wbs;
+			ModelWriter modelWriter;
+			REQUIRE(modelWriter.write(legacyModel, &wbs, headerFormat));
+
+			const bool isBinaryHeader = memcmp(wbs.serializedData.data(), Model::kMdlBinaryMagic, sizeof(Model::kMdlBinaryMagic)) == 0;
+			CHECK(isBinaryHeader == (headerFormat == ModelWriter::HeaderFormat_Binary));
+
+			Model::Model writtenModel;
+			ReadByteStream rbs(wbs.serializedData);
+			REQUIRE(loadModel(rbs, writtenModel));
+			checkModelsEqual(legacyModel, writtenModel);
+			CHECK(writtenModel.hasNodeHierarchy());
+			CHECK(writtenModel.hasCompiledAnimations());
+		}
+	}
+}
+
+TEST_CASE("ModelReader rejects invalid binary headers") {
+	Model::Model model;
+	FileReadStream frs(findEditorModelFiles()[0].c_str());
+	REQUIRE(loadModel(frs, model));
+
+	WriteByteStream wbs;
+	REQUIRE(ModelWriter().write(model, &wbs));
+	std::vector<char> data = wbs.serializedData;
+
+	SUBCASE("Truncated file") {
+		data.resize(sizeof(Model::MdlBinaryHeader) + 8);
+		ReadByteStream rbs(data);
+		CHECK(loadModel(rbs, model) == false);
+	}
+
+	SUBCASE("Unsupported version") {
+		const uint32 version = Model::kMdlBinaryVersion + 1;
+		memcpy(data.data() + offsetof(Model::MdlBinaryHeader, version), &version, sizeof(version));
+		ReadByteStream rbs(data);
+		CHECK(loadModel(rbs, model) == false);
+	}
+
+	SUBCASE("Table outside of the header") {
+		Model::MdlBinaryHeader header;
+		memcpy(&header, data.data(), sizeof(header));
+		header.tables[Model::MdlTable_Nodes].numRecords = 1000000;
+		memcpy(data.data(), &header, sizeof(header));
+		ReadByteStream rbs(data);
+		CHECK(loadModel(rbs, model) == false);
+	}
+}
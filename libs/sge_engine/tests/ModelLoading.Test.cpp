@@ -0,0 +1,128 @@
+#include "doctest/doctest.h"
+#include "sge_core/model/Model.h"
+#include "sge_core/model/ModelReader.h"
+#include "sge_core/model/ModelWriter.h"
+#include "sge_utils/utils/FileStream.h"
+#include "sge_utils/utils/timer.h"
+#include <cstdlib>
+#include <filesystem>
+
+using namespace sge;
+
+namespace {
+/// Returns all .mdl files in the specified directory and its subdirectories.
+std::vector<std::string> findModelFiles(const std::filesystem::path& dir) {
+	std::vector<std::string> result;
+	if (std::filesystem::is_directory(dir)) {
+		for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(dir)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".mdl") {
+				result.push_back(entry.path().generic_string());
+			}
+		}
+	}
+	return result;
+}
+
+std::filesystem::path getEditorModelsDir() {
+	return std::filesystem::path(__FILE__).parent_path() / ".." / "assets" / "editor" / "models";
+}
+
+/// Loads the model without creating its GPU resources.
+template <typename TReadStream>
+bool loadModel(const std::string& path, Model::Model& model) {
+	TReadStream stream(path.c_str());
+	if (stream.isOpened() == false) {
+		return false;
+	}
+
+	Model::LoadSettings loadSettings;
+	Model::ModelReader modelReader;
+	return modelReader.Load(loadSettings, nullptr, &stream, model);
+}
+} // namespace
+
+TEST_CASE("ModelReader memory mapped loading") {
+	const std::vector<std::string> modelFiles = findModelFiles(getEditorModelsDir());
+	REQUIRE(modelFiles.empty() == false);
+
+	for (const std::string& path : modelFiles) {
+		INFO(path);
+
+		Model::Model modelFromFile;
+		Model::Model modelFromMapping;
+		REQUIRE(loadModel<FileReadStream>(path, modelFromFile));
+		REQUIRE(loadModel<MappedFileReadStream>(path, modelFromMapping));
+
+		CHECK(modelFromFile.m_nodes.size() == modelFromMapping.m_nodes.size());
+		CHECK(modelFromFile.m_animations.size() == modelFromMapping.m_animations.size());
+		REQUIRE(modelFromFile.m_meshesData.size() == modelFromMapping.m_meshesData.size());
+
+		for (int iMeshData = 0; iMeshData < int(modelFromFile.m_meshesData.size()); ++iMeshData) {
+			CHECK(modelFromFile.m_meshesData[iMeshData]->vertexBufferRaw == modelFromMapping.m_meshesData[iMeshData]->vertexBufferRaw);
+			CHECK(modelFromFile.m_meshesData[iMeshData]->indexBufferRaw == modelFromMapping.m_meshesData[iMeshData]->indexBufferRaw);
+		}
+	}
+}
+
+TEST_CASE("ModelReader loading benchmark" * doctest::skip()) {
+	// The models are taken from SGE_MODEL_BENCHMARK_DIR if specified, as the editor models are pretty small.
+	const char* const benchmarkDir = std::getenv("SGE_MODEL_BENCHMARK_DIR");
+	const std::vector<std::string> modelFiles = findModelFiles(benchmarkDir ? std::filesystem::path(benchmarkDir) : getEditorModelsDir());
+	REQUIRE(modelFiles.empty() == false);
+
+	size_t totalSizeBytes = 0;
+	for (const std::string& path : modelFiles) {
+		totalSizeBytes += size_t(std::filesystem::file_size(path));
+	}
+
+	const int kNumIterations = 5;
+
+	const auto measure = [&](auto loadFn) -> float {
+		const float startTime = Timer::now_seconds();
+		for (int iIteration = 0; iIteration < kNumIterations; ++iIteration) {
+			for (const std::string& path : modelFiles) {
+				Model::Model model;
+				loadFn(path, model);
+			}
+		}
+		return (Timer::now_seconds() - startTime) / float(kNumIterations);
+	};
+
+	const float fileStreamTime = measure(loadModel<FileReadStream>);
+	const float mappedStreamTime = measure(loadModel<MappedFileReadStream>);
+
+	MESSAGE("Loading " << modelFiles.size() << " models (" << totalSizeBytes / 1024 << " KiB): FileReadStream "
+	                   << fileStreamTime * 1000.f << "ms, MappedFileReadStream " << mappedStreamTime * 1000.f << "ms");
+
+	// Compare the JSON and the binary headers from memory, so the file system doesn't affect the result.
+	std::vector<std::vector<char>> jsonFiles;
+	std::vector<std::vector<char>> binaryFiles;
+	for (const std::string& path : modelFiles) {
+		Model::Model model;
+		loadModel<FileReadStream>(path, model);
+
+		WriteByteStream jsonStream;
+		WriteByteStream binaryStream;
+		ModelWriter().write(model, &jsonStream, ModelWriter::HeaderFormat_Json);
+		ModelWriter().write(model, &binaryStream, ModelWriter::HeaderFormat_Binary);
+		jsonFiles.push_back(std::move(jsonStream.serializedData));
+		binaryFiles.push_back(std::move(binaryStream.serializedData));
+	}
+
+	const auto measureInMemory = [&](const std::vector<std::vector<char>>& files) -> float {
+		const float startTime = Timer::now_seconds();
+		for (int iIteration = 0; iIteration < kNumIterations; ++iIteration) {
+			for (const std::vector<char>& file : files) {
+				ReadByteStream rbs(file);
+				Model::Model model;
+				Model::ModelReader().Load(Model::LoadSettings(), nullptr, &rbs, model);
+			}
+		}
+		return (Timer::now_seconds() - startTime) / float(kNumIterations);
+	};
+
+	const float jsonHeaderTime = measureInMemory(jsonFiles);
+	const float binaryHeaderTime = measureInMemory(binaryFiles);
+
+	MESSAGE("Loading from memory: JSON header " << jsonHeaderTime * 1000.f << "ms, binary header " << binaryHeaderTime * 1000.f << "ms");
+}
@@ -0,0 +1,60 @@
+#include "doctest/doctest.h"
+#include "sge_core/model/Model.h"
+
+using namespace sge;
+
+TEST_CASE("Model node hierarchy") {
+	// The nodes are stored in an order where the children come before their parents:
+	// root -> hips -> {spine -> head, leg}
+	Model::Model model;
+	const char* const nodeNames[] = {"head", "leg", "spine", "hips", "root", "unreachable"};
+	for (const char* const name : nodeNames) {
+		Model::Node* const node = model.m_containerNode.new_element();
+		node->name = name;
+		model.m_nodes.push_back(node);
+	}
+
+	Model::Node* const head = model.m_nodes[0];
+	Model::Node* const leg = model.m_nodes[1];
+	Model::Node* const spine = model.m_nodes[2];
+	Model::Node* const hips = model.m_nodes[3];
+	Model::Node* const root = model.m_nodes[4];
+
+	model.m_rootNode = root;
+	root->childNodes.push_back(hips);
+	hips->childNodes.push_back(spine);
+	hips->childNodes.push_back(leg);
+	spine->childNodes.push_back(head);
+
+	Model::MeshData* const meshData = model.m_containerMeshData.new_element();
+	Model::Mesh* const mesh = model.m_containerMesh.new_element();
+	mesh->bones.resize(2);
+	mesh->bones[0].node = spine;
+	mesh->bones[1].node = leg;
+	meshData->meshes.push_back(mesh);
+	model.m_meshesData.push_back(meshData);
+
+	CHECK(model.hasNodeHierarchy() == false);
+	model.computeNodeHierarchy();
+	REQUIRE(model.hasNodeHierarchy());
+
+	CHECK(model.m_nodeParentIndices == std::vector<int>{2, 3, 3, 4, -1, -1});
+
+	// Every reachable node comes after its parent, the unreachable ones are skipped.
+	REQUIRE(model.m_nodeOrder.size() == 5);
+	CHECK(model.m_nodeOrder[0] == 4);
+	std::vector<bool> isVisited(model.m_nodes.size(), false);
+	bool allParentsComeFirst = true;
+	for (const int iNode : model.m_nodeOrder) {
+		const int iParent = model.m_nodeParentIndices[iNode];
+		allParentsComeFirst &= iParent < 0 || isVisited[iParent];
+		isVisited[iNode] = true;
+	}
+	CHECK(allParentsComeFirst);
+
+	CHECK(mesh->bones[0].nodeIndex == 2);
+	CHECK(mesh->bones[1].nodeIndex == 1);
+
+	CHECK(model.findNodeIndex(hips) == 3);
+	CHECK(model.findNodeIndex(nullptr) == -1);
+}
@@ -0,0 +1,106 @@
+#include "doctest/doctest.h"
+#include "sge_core/model/Model.h"
+#include "sge_core/model/ModelPose.h"
+
+using namespace sge;
+
+namespace {
+bool isAboutTheSame(const transf3d& a, const transf3d& b) {
+	const float kEps = 1e-5f;
+	// The quaternions q and -q represent the same rotation.
+	const float rotationsDot = a.r.x * b.r.x + a.r.y * b.r.y + a.r.z * b.r.z + a.r.w * b.r.w;
+	return (a.p - b.p).length() < kEps && (a.s - b.s).length() < kEps && fabsf(fabsf(rotationsDot) - 1.f) < kEps;
+}
+
+ModelPose makePose(const std::vector<transf3d>& transforms) {
+	ModelPose pose;
+	pose.resize(int(transforms.size()));
+	for (int iNode = 0; iNode < int(transforms.size()); ++iNode) {
+		pose.setNodeTransform(iNode, transforms[iNode]);
+	}
+	return pose;
+}
+} // namespace
+
+TEST_CASE("ModelPose blending") {
+	const quatf rotationA = quatf::getAxisAngle(vec3f::getAxis(1), 0.5f);
+	const quatf rotationB = quatf::getAxisAngle(vec3f::getAxis(1), 1.5f);
+
+	const ModelPose a = makePose({transf3d(vec3f(0.f), rotationA, vec3f(1.f)), transf3d(vec3f(1.f, 0.f, 0.f))});
+	const ModelPose b = makePose({transf3d(vec3f(2.f), rotationB, vec3f(3.f)), transf3d(vec3f(3.f, 0.f, 0.f))});
+
+	ModelPose result;
+	result.setBlend(a, b, 0.f);
+	CHECK(isAboutTheSame(result.getNodeTransform(0), a.getNodeTransform(0)));
+
+	result.setBlend(a, b, 1.f);
+	CHECK(isAboutTheSame(result.getNodeTransform(0), b.getNodeTransform(0)));
+
+	result.setBlend(a, b, 0.5f);
+	CHECK(isAboutTheSame(result.getNodeTransform(0), transf3d(vec3f(1.f), quatf::getAxisAngle(vec3f::getAxis(1), 1.f), vec3f(2.f))));
+	CHECK(isAboutTheSame(result.getNodeTransform(1), transf3d(vec3f(2.f, 0.f, 0.f))));
+
+	SUBCASE("Masked blending affects only the nodes in the mask") {
+		const float nodeMask[] = {0.f, 1.f};
+		result = a;
+		result.setBlend(result, b, 1.f, nodeMask);
+		CHECK(isAboutTheSame(result.getNodeTransform(0), a.getNodeTransform(0)));
+		CHECK(isAboutTheSame(result.getNodeTransform(1), b.getNodeTransform(1)));
+	}
+}
+
+TEST_CASE("ModelPose additive") {
+	const quatf baseRotation = quatf::getAxisAngle(vec3f::getAxis(0), 0.3f);
+	const ModelPose base = makePose({transf3d(vec3f(1.f, 2.f, 3.f), baseRotation, vec3f(2.f))});
+
+	const quatf referenceRotation = quatf::getAxisAngle(vec3f::getAxis(1), 0.2f);
+	const quatf additiveRotation = referenceRotation * quatf::getAxisAngle(vec3f::getAxis(1), 0.4f);
+	const ModelPose reference = makePose({transf3d(vec3f(1.f), referenceRotation, vec3f(1.f))});
+	const ModelPose additive = makePose({transf3d(vec3f(1.f, 2.f, 1.f), additiveRotation, vec3f(1.5f))});
+
+	// Adding the reference itself doesn't change the pose.
+	ModelPose result = base;
+	result.addAdditive(reference, reference, 1.f);
+	CHECK(isAboutTheSame(result.getNodeTransform(0), base.getNodeTransform(0)));
+
+	result = base;
+	result.addAdditive(additive, reference, 1.f);
+	CHECK(isAboutTheSame(result.getNodeTransform(0),
+	                     transf3d(vec3f(1.f, 3.f, 3.f), baseRotation * quatf::getAxisAngle(vec3f::getAxis(1), 0.4f), vec3f(3.f))));
+
+	result = base;
+	result.addAdditive(additive, reference, 0.5f);
+	CHECK(isAboutTheSame(result.getNodeTransform(0),
+	                     transf3d(vec3f(1.f, 2.5f, 3.f), baseRotation * quatf::getAxisAngle(vec3f::getAxis(1), 0.2f), vec3f(2.5f))));
+
+	const float nodeMask[] = {0.f};
+	result = base;
+	result.addAdditive(additive, reference, 1.f, nodeMask);
+	CHECK(isAboutTheSame(result.getNodeTransform(0), base.getNodeTransform(0)));
+}
+
+TEST_CASE("ModelPose node mask") {
+	// root -> hips -> {spine -> head, leg}
+	Model::Model model;
+	const char* const nodeNames[] = {"root", "hips", "spine", "head", "leg"};
+	for (const char* const name : nodeNames) {
+		Model::Node* const node = model.m_containerNode.new_element();
+		node->name = name;
+		model.m_nodes.push_back(node);
+	}
+	model.m_rootNode = model.m_nodes[0];
+	model.m_nodes[0]->childNodes.push_back(model.m_nodes[1]);
+	model.m_nodes[1]->childNodes.push_back(model.m_nodes[2]);
+	model.m_nodes[1]->childNodes.push_back(model.m_nodes[4]);
+	model.m_nodes[2]->childNodes.push_back(model.m_nodes[3]);
+
+	std::vector<float> mask;
+	computeNodeMask(mask, model, model.FindFirstNodeByName("spine"));
+	CHECK(mask == std::vector<float>{0.f, 0.f, 1.f, 1.f, 0.f});
+
+	computeNodeMask(mask, model, model.m_rootNode);
+	CHECK(mask == std::vector<float>{1.f, 1.f, 1.f, 1.f, 1.f});
+
+	computeNodeMask(mask, model, nullptr);
+	CHECK(mask == std::vector<float>{0.f, 0.f, 0.f, 0.f, 0.f});
+}
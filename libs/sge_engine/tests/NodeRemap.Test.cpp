@@ -0,0 +1,83 @@
+#include "doctest/doctest.h"
+#include "sge_core/model/Model.h"
+#include "sge_core/model/NodeRemap.h"
+
+using namespace sge;
+
+namespace {
+/// Fills the model with a chain of nodes with the specified names, the first one being the root.
+void createNodeChain(Model::Model& model, const std::vector<std::string>& nodeNames) {
+	model = Model::Model();
+	for (const std::string& name : nodeNames) {
+		Model::Node* const node = model.m_containerNode.new_element();
+		node->name = name;
+		if (model.m_nodes.empty() == false) {
+			model.m_nodes.back()->childNodes.push_back(node);
+		}
+		model.m_nodes.push_back(node);
+	}
+
+	model.m_rootNode = model.m_nodes[0];
+	model.computeNodeHierarchy();
+}
+} // namespace
+
+TEST_CASE("NodeRemap") {
+	Model::Model animationModel;
+	createNodeChain(animationModel, {"root", "hips", "spine", "head"});
+
+	Model::Model skinA;
+	createNodeChain(skinA, {"root", "spine", "hips", "tail"});
+
+	Model::Model skinB;
+	createNodeChain(skinB, {"head", "root"});
+
+	const std::shared_ptr<const Model::NodeRemap> remapA = Model::findNodeRemap(skinA, animationModel);
+	REQUIRE(remapA.get() != nullptr);
+	CHECK(remapA->sourceNodeIndices == std::vector<int>{0, 2, 1, -1});
+	CHECK(remapA->isUpToDate(skinA, animationModel));
+
+	const std::shared_ptr<const Model::NodeRemap> remapB = Model::findNodeRemap(skinB, animationModel);
+	CHECK(remapB->sourceNodeIndices == std::vector<int>{3, 0});
+
+	const std::shared_ptr<const Model::NodeRemap> identityRemap = Model::findNodeRemap(animationModel, animationModel);
+	CHECK(identityRemap->sourceNodeIndices == std::vector<int>{0, 1, 2, 3});
+
+	SUBCASE("The tables are built once per pair of models") {
+		CHECK(Model::findNodeRemap(skinA, animationModel).get() == remapA.get());
+		CHECK(Model::findNodeRemap(skinB, animationModel).get() == remapB.get());
+	}
+
+	SUBCASE("Reloading a model rebuilds its tables") {
+		createNodeChain(animationModel, {"spine", "root"});
+		CHECK(remapA->isUpToDate(skinA, animationModel) == false);
+		CHECK(remapB->isUpToDate(skinB, animationModel) == false);
+
+		const std::shared_ptr<const Model::NodeRemap> reloadedRemapA = Model::findNodeRemap(skinA, animationModel);
+		CHECK(reloadedRemapA.get() != remapA.get());
+		CHECK(reloadedRemapA->sourceNodeIndices == std::vector<int>{1, 0, -1, -1});
+
+		// The old table stays valid for whoever still holds it.
+		CHECK(remapA->sourceNodeIndices == std::vector<int>{0, 2, 1, -1});
+	}
+
+	SUBCASE("Invalidating a model drops its tables") {
+		Model::invalidateNodeRemaps(animationModel);
+		const std::shared_ptr<const Model::NodeRemap> rebuiltRemapA = Model::findNodeRemap(skinA, animationModel);
+		CHECK(rebuiltRemapA.get() != remapA.get());
+		CHECK(rebuiltRemapA->sourceNodeIndices == remapA->sourceNodeIndices);
+	}
+
+	SUBCASE("Destroying a model drops its tables") {
+		std::weak_ptr<const Model::NodeRemap> tempRemap;
+		{
+			Model::Model tempModel;
+			createNodeChain(tempModel, {"hips"});
+			tempRemap = Model::findNodeRemap(tempModel, animationModel);
+			CHECK(tempRemap.expired() == false);
+		}
+		CHECK(tempRemap.expired());
+	}
+
+	Model::invalidateNodeRemaps(animationModel);
+}
@@ -0,0 +1,71 @@
+#include "doctest/doctest.h"
+#include "sge_engine/RenderQueue.h"
+#include <algorithm>
+#include <random>
+
+using namespace sge;
+
+TEST_CASE("RenderQueue sort keys") {
+	SUBCASE("Opaque draws are drawn before translucent ones") {
+		const uint64 opaque = RenderQueue::makeSortKey(renderPass_opaque, 255, 0xFFFFFFFF, 0xFFFFFFFF, 1e30f);
+		const uint64 translucent = RenderQueue::makeSortKey(renderPass_translucent, 0, 0, 0, 0.f);
+		CHECK(opaque < translucent);
+	}
+
+	SUBCASE("Opaque draws are grouped by state and then sorted front-to-back") {
+		const uint64 nearA = RenderQueue::makeSortKey(renderPass_opaque, 1, 10, 20, 1.f);
+		const uint64 farA = RenderQueue::makeSortKey(renderPass_opaque, 1, 10, 20, 100.f);
+		const uint64 nearB = RenderQueue::makeSortKey(renderPass_opaque, 2, 10, 20, 0.5f);
+		CHECK(nearA < farA);
+		CHECK(farA < nearB);
+
+		const uint64 otherMesh = RenderQueue::makeSortKey(renderPass_opaque, 1, 10, 21, 0.5f);
+		const uint64 otherMaterial = RenderQueue::makeSortKey(renderPass_opaque, 1, 11, 0, 0.5f);
+		CHECK(farA < otherMesh);
+		CHECK(otherMesh < otherMaterial);
+	}
+
+	SUBCASE("Translucent draws are sorted back-to-front") {
+		const uint64 nearDraw = RenderQueue::makeSortKey(renderPass_translucent, 0, 0, 0, 1.f);
+		const uint64 farDraw = RenderQueue::makeSortKey(renderPass_translucent, 5, 5, 5, 2.f);
+		CHECK(farDraw < nearDraw);
+	}
+
+	SUBCASE("Depths behind the camera are treated as zero") {
+		CHECK(RenderQueue::makeSortKey(renderPass_opaque, 0, 0, 0, -5.f) == RenderQueue::makeSortKey(renderPass_opaque, 0, 0, 0, 0.f));
+	}
+}
+
+TEST_CASE("RenderQueue radix sort") {
+	std::mt19937_64 rng(42);
+	RenderQueue queue;
+	std::vector<RenderQueue::Item> expected;
+
+	for (uint32 t = 0; t < 10000; ++t) {
+		// Use a small range for some of the keys so there are duplicates to verify the stability of the sort.
+		const uint64 key = (t % 3 == 0) ? (rng() % 16) : rng();
+		queue.add(key, t);
+		expected.push_back(RenderQueue::Item{key, t});
+	}
+
+	queue.sort();
+	std::stable_sort(expected.begin(), expected.end(),
+	                 [](const RenderQueue::Item& a, const RenderQueue::Item& b) -> bool { return a.sortKey < b.sortKey; });
+
+	REQUIRE(queue.getItems().size() == expected.size());
+	bool isSame = true;
+	for (size_t t = 0; t < expected.size(); ++t) {
+		isSame &= queue.getItems()[t].sortKey == expected[t].sortKey && queue.getItems()[t].drawIndex == expected[t].drawIndex;
+	}
+	CHECK(isSame);
+
+	// Keys that share all but the lowest bits skip most of the passes.
+	queue.clear();
+	queue.add(0xAB00000000000003ull, 0);
+	queue.add(0xAB00000000000001ull, 1);
+	queue.add(0xAB00000000000002ull, 2);
+	queue.sort();
+	CHECK(queue.getItems()[0].drawIndex == 1);
+	CHECK(queue.getItems()[1].drawIndex == 2);
+	CHECK(queue.getItems()[2].drawIndex == 0);
+}
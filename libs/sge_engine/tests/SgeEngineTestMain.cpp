@@ -0,0 +1,13 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "doctest/doctest.h"
+#include "sge_engine/TypeRegister.h"
+
+int main(int argc, char* argv[]) {
+	// The game object types need to be registered before any GameWorld could allocate them.
+	sge::typeLib().performRegistration();
+
+	doctest::Context ctx;
+	ctx.applyCommandLine(argc, argv);
+
+	return ctx.run();
+}
@@ -0,0 +1,70 @@
+#include "doctest/doctest.h"
+#include "sge_engine/ShadowCasterCulling.h"
+#include "sge_engine/actors/ALight.h"
+#include <random>
+
+using namespace sge;
+
+TEST_CASE("ShadowCasterCulling point light range") {
+	CHECK(isSphereInPointLightRange(vec3f(0.f), 10.f, vec3f(5.f, 0.f, 0.f), 1.f));
+	CHECK(isSphereInPointLightRange(vec3f(0.f), 10.f, vec3f(10.5f, 0.f, 0.f), 1.f));
+	CHECK(isSphereInPointLightRange(vec3f(0.f), 10.f, vec3f(11.5f, 0.f, 0.f), 1.f) == false);
+}
+
+TEST_CASE("ShadowCasterCulling spot light cone") {
+	const vec3f lightPos(0.f);
+	const vec3f lightDir(1.f, 0.f, 0.f);
+	const float angle = deg2rad(30.f);
+
+	CHECK(isSphereInSpotLightCone(lightPos, lightDir, angle, 10.f, vec3f(5.f, 0.f, 0.f), 0.5f));
+	// Behind the light.
+	CHECK(isSphereInSpotLightCone(lightPos, lightDir, angle, 10.f, vec3f(-5.f, 0.f, 0.f), 0.5f) == false);
+	// Past the range.
+	CHECK(isSphereInSpotLightCone(lightPos, lightDir, angle, 10.f, vec3f(12.f, 0.f, 0.f), 0.5f) == false);
+	// To the side of the cone, tan(30) * 5 is about 2.9.
+	CHECK(isSphereInSpotLightCone(lightPos, lightDir, angle, 10.f, vec3f(5.f, 5.f, 0.f), 0.5f) == false);
+	CHECK(isSphereInSpotLightCone(lightPos, lightDir, angle, 10.f, vec3f(5.f, 3.f, 0.f), 0.5f));
+	// Enclosing the apex.
+	CHECK(isSphereInSpotLightCone(lightPos, lightDir, angle, 10.f, vec3f(0.f, 1.f, 0.f), 2.f));
+}
+
+TEST_CASE("ShadowCasterCulling point light faces") {
+	SUBCASE("A sphere on an axis is seen only by that face") {
+		CHECK(getPointLightShadowFacesMask(vec3f(0.f), vec3f(5.f, 0.f, 0.f), 1.f) == (1 << axis_x_pos));
+		CHECK(getPointLightShadowFacesMask(vec3f(0.f), vec3f(0.f, 0.f, -5.f), 1.f) == (1 << axis_z_neg));
+	}
+
+	SUBCASE("A sphere containing the light is seen by all faces") {
+		CHECK(getPointLightShadowFacesMask(vec3f(0.f), vec3f(0.5f, 0.f, 0.f), 1.f) == (1 << signedAxis_numElements) - 1);
+	}
+
+	SUBCASE("The classification matches the frustums of the shadow map cameras") {
+		LightDesc lightDesc;
+		lightDesc.type = light_point;
+		lightDesc.hasShadows = true;
+		lightDesc.range = 50.f;
+
+		const transf3d lightTransform = transf3d::getIdentity();
+		const Optional<ShadowMapBuildInfo> buildInfo = lightDesc.buildShadowMapInfo(lightTransform, Frustum());
+		REQUIRE(buildInfo.isValid());
+
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> distPos(-20.f, 20.f);
+		std::uniform_real_distribution<float> distRadius(0.1f, 3.f);
+
+		// No face that sees the sphere should be culled.
+		bool isConservative = true;
+		for (int t = 0; t < 1000; ++t) {
+			const vec3f pos(distPos(rng), distPos(rng), distPos(rng));
+			const float radius = distRadius(rng);
+			const int mask = getPointLightShadowFacesMask(lightTransform.p, pos, radius);
+			for (int iFace = 0; iFace < signedAxis_numElements; ++iFace) {
+				const bool isSeen = buildInfo->pointLightShadowMapCameras[iFace].getFrustumWS()->isSphereOutside(pos, radius) == false;
+				if (isSeen && (mask & (1 << iFace)) == 0) {
+					isConservative = false;
+				}
+			}
+		}
+		CHECK(isConservative);
+	}
+}
@@ -0,0 +1,149 @@
+#include "doctest/doctest.h"
+#include "sge_engine/GameWorld.h"
+#include "sge_engine/actors/ALocator.h"
+
+using namespace sge;
+
+namespace {
+bool isAboutTheSame(const vec3f& a, const vec3f& b) {
+	return (a - b).length() < 1e-3f;
+}
+} // namespace
+
+TEST_CASE("TransformHierarchy propagation") {
+	GameWorld world;
+	world.create();
+
+	SUBCASE("Deep chain") {
+		// A chain of 10k actors, each one is a child of the previous one and is offset by 1 on the X axis.
+		const int numActors = 10000;
+		std::vector<ALocator*> actors;
+		for (int t = 0; t < numActors; ++t) {
+			ALocator* const actor = world.alloc<ALocator>();
+			REQUIRE(actor != nullptr);
+			actor->setPosition(vec3f(float(t), 0.f, 0.f));
+			if (t > 0) {
+				world.setParentOf(actor->getId(), actors.back()->getId());
+			}
+			actors.push_back(actor);
+		}
+
+		world.debug.numPropagatedTransformsThisFrame = 0;
+		actors[0]->setPosition(vec3f(0.f, 10.f, 0.f));
+		CHECK(world.debug.numPropagatedTransformsThisFrame == numActors - 1);
+		CHECK(isAboutTheSame(actors[1]->getPosition(), vec3f(1.f, 10.f, 0.f)));
+		CHECK(isAboutTheSame(actors.back()->getPosition(), vec3f(float(numActors - 1), 10.f, 0.f)));
+
+		// Moving a node in the middle should not affect the nodes above it.
+		actors[numActors / 2]->setPosition(vec3f(0.f));
+		CHECK(isAboutTheSame(actors[numActors / 2 - 1]->getPosition(), vec3f(float(numActors / 2 - 1), 10.f, 0.f)));
+		CHECK(isAboutTheSame(actors.back()->getPosition(), vec3f(float(numActors - 1 - numActors / 2), 0.f, 0.f)));
+	}
+
+	SUBCASE("Wide tree and reparenting") {
+		// A root with 100 children, each with 100 children of its own.
+		ALocator* const root = world.alloc<ALocator>();
+		ALocator* const otherRoot = world.alloc<ALocator>();
+		otherRoot->setPosition(vec3f(0.f, 0.f, 100.f));
+
+		std::vector<ALocator*> leaves;
+		for (int iChild = 0; iChild < 100; ++iChild) {
+			ALocator* const child = world.alloc<ALocator>();
+			world.setParentOf(child->getId(), root->getId());
+			for (int iLeaf = 0; iLeaf < 100; ++iLeaf) {
+				ALocator* const leaf = world.alloc<ALocator>();
+				world.setParentOf(leaf->getId(), child->getId());
+				leaves.push_back(leaf);
+			}
+		}
+
+		root->setPosition(vec3f(5.f, 0.f, 0.f));
+		bool allLeavesMoved = true;
+		for (ALocator* leaf : leaves) {
+			allLeavesMoved &= isAboutTheSame(leaf->getPosition(), vec3f(5.f, 0.f, 0.f));
+		}
+		CHECK(allLeavesMoved);
+
+		// Move one of the leaves to the other hierarchy, the hierarchy must get rebuilt.
+		ALocator* const movedLeaf = leaves[42];
+		world.setParentOf(movedLeaf->getId(), otherRoot->getId());
+		root->setPosition(vec3f(0.f));
+		otherRoot->setPosition(vec3f(0.f, 0.f, 200.f));
+		CHECK(isAboutTheSame(leaves[0]->getPosition(), vec3f(0.f)));
+		CHECK(isAboutTheSame(movedLeaf->getPosition(), vec3f(5.f, 0.f, 100.f)));
+
+		// Killed actors must not be moved.
+		world.objectDelete(leaves[0]->getId());
+		world.update(GameUpdateSets(0.f, true, InputState()));
+		world.debug.numPropagatedTransformsThisFrame = 0;
+		root->setPosition(vec3f(1.f, 0.f, 0.f));
+		CHECK(isAboutTheSame(leaves[1]->getPosition(), vec3f(1.f, 0.f, 0.f)));
+		CHECK(world.debug.numPropagatedTransformsThisFrame == 100 + 100 * 100 - 2);
+	}
+
+	SUBCASE("Spawning prefabs in a populated world") {
+		// A prefab with a root, 10 children and 2 children for each of them.
+		GameWorld prefabWorld;
+		prefabWorld.create();
+		ALocator* const prefabRoot = prefabWorld.alloc<ALocator>();
+		for (int iChild = 0; iChild < 10; ++iChild) {
+			ALocator* const child = prefabWorld.alloc<ALocator>();
+			child->setPosition(vec3f(1.f, 0.f, 0.f));
+			prefabWorld.setParentOf(child->getId(), prefabRoot->getId());
+			for (int iLeaf = 0; iLeaf < 2; ++iLeaf) {
+				ALocator* const leaf = prefabWorld.alloc<ALocator>();
+				leaf->setPosition(vec3f(1.f, 1.f, 0.f));
+				prefabWorld.setParentOf(leaf->getId(), child->getId());
+			}
+		}
+		const int numPrefabDescendants = 10 + 10 * 2;
+
+		// Spawns the prefab and moves its root, returns the number of transforms propagated by doing that.
+		const auto spawnAndMove = [&](const vec3f& position) -> int {
+			vector_set<ObjectId> newObjectIds;
+			world.instantiatePrefab(prefabWorld, false, true, nullptr, &newObjectIds);
+
+			world.debug.numPropagatedTransformsThisFrame = 0;
+			for (const ObjectId& id : newObjectIds) {
+				if (world.getParentId(id).isNull()) {
+					world.getActorById(id)->setPosition(position);
+				}
+			}
+			return world.debug.numPropagatedTransformsThisFrame;
+		};
+
+		CHECK(spawnAndMove(vec3f(0.f)) == numPrefabDescendants);
+
+		// Populate the world with 10k actors in hierarchies, moving a spawned prefab must not visit any of them.
+		for (int iRoot = 0; iRoot < 100; ++iRoot) {
+			ALocator* const root = world.alloc<ALocator>();
+			for (int iChild = 0; iChild < 99; ++iChild) {
+				world.setParentOf(world.alloc<ALocator>()->getId(), root->getId());
+			}
+		}
+
+		bool isPropagationLocal = true;
+		for (int iSpawn = 0; iSpawn < 1000; ++iSpawn) {
+			isPropagationLocal &= spawnAndMove(vec3f(float(iSpawn), 0.f, 0.f)) == numPrefabDescendants;
+		}
+		CHECK(isPropagationLocal);
+
+		// The last spawned prefab is moved with its children.
+		vector_set<ObjectId> newObjectIds;
+		world.instantiatePrefab(prefabWorld, false, true, nullptr, &newObjectIds);
+		ALocator* spawnedRoot = nullptr;
+		ALocator* spawnedLeaf = nullptr;
+		for (const ObjectId& id : newObjectIds) {
+			ALocator* const actor = static_cast<ALocator*>(world.getActorById(id));
+			if (world.getParentId(id).isNull()) {
+				spawnedRoot = actor;
+			} else if (world.hasChildren(id) == false) {
+				spawnedLeaf = actor;
+			}
+		}
+		REQUIRE(spawnedRoot != nullptr);
+		REQUIRE(spawnedLeaf != nullptr);
+		spawnedRoot->setPosition(vec3f(0.f, 0.f, 5.f));
+		CHECK(isAboutTheSame(spawnedLeaf->getPosition(), vec3f(1.f, 1.f, 5.f)));
+	}
+}
@@ -390,6 +390,33 @@ void SGEContextImmediateD3D11::clearDepth(FrameTarget* target, float depth) {
 		D3D11_GetImmContext()->ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH, depth, 0);
 }
 
+void SGEContextImmediateD3D11::copyDepthStencil(FrameTarget* dest, FrameTarget* src) {
+	ID3D11DepthStencilView* const destDsv = dest ? ((FrameTargetD3D11*)dest)->D3D11_GetDSV() : nullptr;
+	ID3D11DepthStencilView* const srcDsv = src ? ((FrameTargetD3D11*)src)->D3D11_GetDSV() : nullptr;
+
+	if_checked(destDsv && srcDsv) {
+		// The views could point to a single face of a cube texture, copy only the subresource they are using.
+		const auto getSubresource = [](ID3D11DepthStencilView* dsv, const Texture* texture) -> UINT {
+			const TextureDesc& texDesc = texture->getDesc();
+			const UINT numMips = texDesc.textureType == UniformType::TextureCube ? texDesc.textureCube.numMips : texDesc.texture2D.numMips;
+
+			D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc;
+			dsv->GetDesc(&dsvDesc);
+			if (dsvDesc.ViewDimension == D3D11_DSV_DIMENSION_TEXTURE2DARRAY) {
+				return D3D11CalcSubresource(dsvDesc.Texture2DArray.MipSlice, dsvDesc.Texture2DArray.FirstArraySlice, numMips);
+			}
+
+			return D3D11CalcSubresource(dsvDesc.Texture2D.MipSlice, 0, numMips);
+		};
+
+		TextureD3D11* const destTexture = (TextureD3D11*)dest->getDepthStencil();
+		TextureD3D11* const srcTexture = (TextureD3D11*)src->getDepthStencil();
+
+		D3D11_GetImmContext()->CopySubresourceRegion(destTexture->D3D11_GetTextureResource(), getSubresource(destDsv, destTexture), 0, 0, 0,
+		                                             srcTexture->D3D11_GetTextureResource(), getSubresource(srcDsv, srcTexture), nullptr);
+	}
+}
+
 void* SGEContextImmediateD3D11::map(Buffer* buffer, const Map::Enum map) {
 	return ((BufferD3D11*)buffer)->map(map, this);
 }
@@ -397,6 +424,25 @@ void SGEContextImmediateD3D11::unMap(Buffer* buffer) {
 	((BufferD3D11*)buffer)->unMap(this);
 }
 
+void SGEContextImmediateD3D11::updateTextureData(Texture* texture, const TextureData& textureData) {
+	TextureD3D11* const textureD3D11 = (TextureD3D11*)texture;
+	const TextureDesc& desc = textureD3D11->getDesc();
+
+	if_checked(desc.textureType == UniformType::Texture2D && desc.usage == TextureUsage::DynamicResource && textureData.data != nullptr) {
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		const HRESULT hr = D3D11_GetImmContext()->Map(textureD3D11->D3D11_GetTextureResource(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+		if_checked(SUCCEEDED(hr)) {
+			// The rows of the mapped texture may be padded.
+			for (int iRow = 0; iRow < desc.texture2D.height; ++iRow) {
+				memcpy((char*)mapped.pData + iRow * mapped.RowPitch, (const char*)textureData.data + iRow * textureData.rowByteSize,
+				       textureData.rowByteSize);
+			}
+
+			D3D11_GetImmContext()->Unmap(textureD3D11->D3D11_GetTextureResource(), 0);
+		}
+	}
+}
+
 //--------------------------------------------------------------------------
 void SGEContextImmediateD3D11::beginQuery(Query* const query) {
 	QueryD3D11* const queryImpl = (QueryD3D11*)query;
@@ -681,12 +727,14 @@ void SGEContextImmediateD3D11::executeDrawCall(DrawCall& drawCall,
 
 	// Execute the draw call.
 	size_t numPrimitivesDrawn = 0;
+	int numInstances = 1;
 
 	sgeAssert(drawCall.m_drawExec.IsValid());
 
 	if (drawCall.m_drawExec.GetType() == DrawExecDesc::Type_Linear) {
 		const auto& call = drawCall.m_drawExec.LinearCall();
 
+		numInstances = call.numInstances;
 		numPrimitivesDrawn = PrimitiveTopology::GetNumPrimitivesByPoints(stateGroup.m_primTopology, call.numVerts) * call.numInstances;
 
 		if (call.numInstances == 1) {
@@ -697,6 +745,7 @@ void SGEContextImmediateD3D11::executeDrawCall(DrawCall& drawCall,
 	} else if (drawCall.m_drawExec.GetType() == DrawExecDesc::Type_Indexed) {
 		const auto& call = drawCall.m_drawExec.IndexedCall();
 
+		numInstances = call.numInstances;
 		numPrimitivesDrawn = PrimitiveTopology::GetNumPrimitivesByPoints(stateGroup.m_primTopology, call.numIndices) * call.numInstances;
 
 		if (call.numInstances == 1) {
@@ -707,6 +756,8 @@ void SGEContextImmediateD3D11::executeDrawCall(DrawCall& drawCall,
 	}
 
 	this->getDeviceD3D11()->m_frameStatistics.numDrawCalls += 1;
+	this->getDeviceD3D11()->m_frameStatistics.numInstancedDrawCalls += numInstances > 1 ? 1 : 0;
+	this->getDeviceD3D11()->m_frameStatistics.numInstancesDrawn += numInstances;
 	this->getDeviceD3D11()->m_frameStatistics.numPrimitiveDrawn += numPrimitivesDrawn;
 }
 
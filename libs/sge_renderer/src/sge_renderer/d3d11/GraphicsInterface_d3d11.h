@@ -124,8 +124,11 @@ struct SGEContextImmediateD3D11 : public SGEContext {
 	void* map(Buffer* buffer, const Map::Enum map) final;
 	void unMap(Buffer* buffer) final;
 
+	void updateTextureData(Texture* texture, const TextureData& textureData) final;
+
 	void clearColor(FrameTarget* target, int index, const float rgba[4]) final;
 	void clearDepth(FrameTarget* target, float depth) final;
+	void copyDepthStencil(FrameTarget* dest, FrameTarget* src) final;
 
 	void executeDrawCall(DrawCall& drawCall,
 	                     FrameTarget* frameTarget,
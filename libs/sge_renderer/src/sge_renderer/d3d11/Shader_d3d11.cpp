@@ -145,8 +145,9 @@ ID3D11InputLayout* ShaderD3D11::D3D11_GetInputLayoutForVertexDeclIndex(const Ver
 		currentDesc.Format = UniformType_GetDX_DXGI_FORMAT(vertexDecl[t].format);
 		currentDesc.InputSlot = vertexDecl[t].bufferSlot;
 		currentDesc.AlignedByteOffset = (UINT)vertexDecl[t].byteOffset;
-		currentDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-		currentDesc.InstanceDataStepRate = 0;
+		currentDesc.InputSlotClass =
+		    vertexDecl[t].instanceStepRate > 0 ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+		currentDesc.InstanceDataStepRate = (UINT)vertexDecl[t].instanceStepRate;
 	}
 
 	// Create the InputLayout object.
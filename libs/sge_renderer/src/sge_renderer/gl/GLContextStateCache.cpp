@@ -100,7 +100,8 @@ void GLContextStateCache::SetVertexAttribSlotState(const bool bEnabled,
                                                    const GLenum type,
                                                    const GLboolean normalized,
                                                    const GLuint stride,
-                                                   const GLuint byteOffset) {
+                                                   const GLuint byteOffset,
+                                                   const GLuint divisor) {
 	VertexAttribSlotDesc& currentState = m_vertAttribPointers[index];
 
 	// If currently the slot is enabled just disable it and bypass the call to
@@ -140,6 +141,13 @@ void GLContextStateCache::SetVertexAttribSlotState(const bool bEnabled,
 			                      (GLvoid*)(std::ptrdiff_t(currentState.byteOffset)));
 			DumpAllGLErrors();
 		}
+
+		// The divisor isn't affected by glDisableVertexAttribArray, so it is updated only when it differs.
+		if (currentState.divisor != divisor) {
+			currentState.divisor = divisor;
+			glVertexAttribDivisor(index, divisor);
+			DumpAllGLErrors();
+		}
 	}
 }
 
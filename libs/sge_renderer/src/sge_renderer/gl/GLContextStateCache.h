@@ -41,14 +41,16 @@ struct GLContextStateCache {
 		                     GLenum a_type = GL_FLOAT, // GL_NONE isn't accepted by standard.
 		                     GLboolean a_normalized = GL_FALSE,
 		                     GLuint a_stride = 0,     // vertex buffer element size.
-		                     GLuint a_byteOffset = 0) // data offset in the buffer stride.
+		                     GLuint a_byteOffset = 0, // data offset in the buffer stride.
+		                     GLuint a_divisor = 0)    // 0 for per-vertex data, otherwise the number of instances per element.
 		    : isEnabled(a_enabled)
 		    , buffer(a_buffer)
 		    , size(a_size)
 		    , type(a_type)
 		    , normalized(a_normalized)
 		    , stride(a_stride)
-		    , byteOffset(a_byteOffset) {}
+		    , byteOffset(a_byteOffset)
+		    , divisor(a_divisor) {}
 
 		bool isEnabled;
 		GLuint buffer;
@@ -57,6 +59,7 @@ struct GLContextStateCache {
 		GLboolean normalized;
 		GLuint stride;
 		GLuint byteOffset;
+		GLuint divisor;
 	};
 
 	// Bond textures description.
@@ -100,6 +103,7 @@ struct GLContextStateCache {
 	//@index - attribute pointer index
 	//@enabled - should vertex attrib be enabled. If false or buffer == 0 then the call to glVertexAttribPointer is bypassed
 	//@attribData - glVertexAttribPointer arguments excluding index
+	//@divisor - glVertexAttribDivisor argument, 0 for per-vertex attributes.
 	// void BindVertexAttribPointer2(const GLuint index, const bool enabled, const VertexAttribPointerData2& attribData);
 	void SetVertexAttribSlotState(const bool bEnabled,
 	                              const GLuint index,
@@ -108,7 +112,8 @@ struct GLContextStateCache {
 	                              const GLenum type,
 	                              const GLboolean normalized,
 	                              const GLuint stride,
-	                              const GLuint byteOffset);
+	                              const GLuint byteOffset,
+	                              const GLuint divisor = 0);
 
 	// Bind the shading program
 	//@program - calls glUseProgram(program)
@@ -324,6 +324,24 @@ void SGEContextImmediate::clearDepth(FrameTarget* target, float depth) {
 #endif
 }
 
+void SGEContextImmediate::copyDepthStencil(FrameTarget* dest, FrameTarget* src) {
+	if_checked(dest && src && dest->isValid() && src->isValid()) {
+		const GLuint destFbo = ((FrameTargetGL*)dest)->GL_GetResource();
+		const GLuint srcFbo = ((FrameTargetGL*)src)->GL_GetResource();
+
+		// Bind the destination as both read and draw frame buffer (as the state cache expects it),
+		// and then override only the read one with the source.
+		GL_GetContextStateCache()->BindFBO(destFbo);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, srcFbo);
+
+		glBlitFramebuffer(0, 0, src->getWidth(), src->getHeight(), 0, 0, dest->getWidth(), dest->getHeight(),
+		                  GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, destFbo);
+		DumpAllGLErrors();
+	}
+}
+
 void* SGEContextImmediate::map(Buffer* buffer, const Map::Enum map) {
 	void* result = ((BufferGL*)buffer)->map(map);
 	DumpAllGLErrors();
@@ -335,6 +353,25 @@ void SGEContextImmediate::unMap(Buffer* buffer) {
 	DumpAllGLErrors();
 }
 
+void SGEContextImmediate::updateTextureData(Texture* texture, const TextureData& textureData) {
+	TextureGL* const textureGL = (TextureGL*)texture;
+	const TextureDesc& desc = textureGL->getDesc();
+
+	if_checked(desc.textureType == UniformType::Texture2D && desc.usage == TextureUsage::DynamicResource &&
+	           TextureFormat::IsBC(desc.format) == false && textureData.data != nullptr) {
+		GLint glInternalFormat;
+		GLenum glFormat, glType;
+		TextureFormat_GetGLNative(desc.format, glInternalFormat, glFormat, glType);
+
+		GLContextStateCache* const glcon = getDeviceImpl()->GL_GetContextStateCache();
+		glcon->BindTextureEx(GL_TEXTURE_2D, GL_TEXTURE0, textureGL->GL_GetResource());
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, desc.texture2D.width, desc.texture2D.height, glFormat, glType, textureData.data);
+		DumpAllGLErrors();
+	}
+}
+
 void SGEContextImmediate::executeDrawCall(DrawCall& drawCall,
                                           FrameTarget* frameTarget,
                                           const Rect2s* const pViewport,
@@ -360,18 +397,18 @@ void SGEContextImmediate::executeDrawCall(DrawCall& drawCall,
 			UniformType_ToGLUniformType(glAttribLayout[t].type, attrbType, attribAirty, attibNormalized);
 
 			GLuint const buffer = ((BufferGL*)(stateGroup->m_vertexBuffers[glAttribLayout[t].bufferSlot]))->GL_GetResource();
-			GLuint const byteOffset = glAttribLayout[t].byteOffset;
+			GLuint const byteOffset = glAttribLayout[t].byteOffset + stateGroup->m_vbOffsets[glAttribLayout[t].bufferSlot];
 			GLuint const stride = stateGroup->m_vbStrides[glAttribLayout[t].bufferSlot];
 
 			// Due to the lack of "glDrawElementsBaseVertex" under OpenGL ES*
-			// we are forced to add that offset here.
+			// we are forced to add that offset here. Per-instance attributes are not affected by the base vertex.
 			int drawIndexedBaseVertexAdditionOffset = 0;
-			if (drawCall.m_drawExec.GetType() == DrawExecDesc::Type_Indexed) {
+			if (drawCall.m_drawExec.GetType() == DrawExecDesc::Type_Indexed && glAttribLayout[t].divisor == 0) {
 				drawIndexedBaseVertexAdditionOffset = drawCall.m_drawExec.IndexedCall().startVertex * stride;
 			}
 
 			glcon->SetVertexAttribSlotState(buffer != 0, glAttribLayout[t].index, buffer, attribAirty, attrbType, attibNormalized, stride,
-			                                byteOffset + drawIndexedBaseVertexAdditionOffset);
+			                                byteOffset + drawIndexedBaseVertexAdditionOffset, glAttribLayout[t].divisor);
 		}
 	}
 
@@ -586,7 +623,12 @@ void SGEContextImmediate::executeDrawCall(DrawCall& drawCall,
 		numPrimitivesDrawn += drawCall.m_drawExec.LinearCall().numInstances * drawCall.m_drawExec.LinearCall().numVerts;
 	}
 
+	const int numInstances = drawCall.m_drawExec.GetType() == DrawExecDesc::Type_Indexed ? drawCall.m_drawExec.IndexedCall().numInstances
+	                                                                                     : drawCall.m_drawExec.LinearCall().numInstances;
+
 	getDeviceImpl()->m_frameStatistics.numDrawCalls += 1;
+	getDeviceImpl()->m_frameStatistics.numInstancedDrawCalls += numInstances > 1 ? 1 : 0;
+	getDeviceImpl()->m_frameStatistics.numInstancesDrawn += numInstances;
 	getDeviceImpl()->m_frameStatistics.numPrimitiveDrawn += numPrimitivesDrawn;
 }
 
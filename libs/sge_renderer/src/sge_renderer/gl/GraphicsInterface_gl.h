@@ -125,10 +125,13 @@ struct SGEContextImmediate : public SGEContextGL {
 
 	void clearColor(FrameTarget* target, int index, const float rgba[4]) final;
 	void clearDepth(FrameTarget* target, float depth) final;
+	void copyDepthStencil(FrameTarget* dest, FrameTarget* src) final;
 
 	void* map(Buffer* buffer, const Map::Enum map) final;
 	void unMap(Buffer* buffer) final;
 
+	void updateTextureData(Texture* texture, const TextureData& textureData) final;
+
 	void executeDrawCall(DrawCall& drawCall,
 	                     FrameTarget* frameTarget,
 	                     const Rect2s* const pViewport = nullptr,
@@ -55,6 +55,7 @@ bool VertexMapperGL::create(const ShadingProgram* shadingProgram, const VertexDe
 		layoutGL.index = attrib.attributeLocation;
 		layoutGL.byteOffset = int(declItr->byteOffset);
 		layoutGL.type = declItr->format;
+		layoutGL.divisor = GLuint(declItr->instanceStepRate);
 
 		m_glVertexLayout.push_back(layoutGL);
 	}
@@ -19,6 +19,7 @@ struct VertexMapperGL : public RAIResource {
 		GLuint index;
 		GLint byteOffset;
 		UniformType::Enum type;
+		GLuint divisor; // 0 for per-vertex attributes, see glVertexAttribDivisor.
 	};
 
 	VertexMapperGL() { destroy(); }
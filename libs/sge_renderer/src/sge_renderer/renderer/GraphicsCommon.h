@@ -674,26 +674,30 @@ struct VertexDecl {
 	std::string semantic;
 	UniformType::Enum format;
 	int byteOffset;
+	/// 0 if the element is per-vertex data, otherwise the element is per-instance data
+	/// and it advances once every @instanceStepRate instances.
+	short instanceStepRate = 0;
 
 	VertexDecl() = default;
 	~VertexDecl() = default;
 
-	VertexDecl(short bufferSlot, const char* semantic, UniformType::Enum format, short byteOffset)
+	VertexDecl(short bufferSlot, const char* semantic, UniformType::Enum format, short byteOffset, short instanceStepRate = 0)
 	    : bufferSlot(bufferSlot)
 	    , semantic(semantic ? semantic : "")
 	    , format(format)
-	    , byteOffset(byteOffset) {}
+	    , byteOffset(byteOffset)
+	    , instanceStepRate(instanceStepRate) {}
 
 	bool operator==(const VertexDecl& other) const {
 		return (bufferSlot == other.bufferSlot) && (semantic == other.semantic) && (byteOffset == other.byteOffset) &&
-		       (format == other.format);
+		       (format == other.format) && (instanceStepRate == other.instanceStepRate);
 	}
 
 	bool operator!=(const VertexDecl& other) const { return !operator==(other); }
 
 	bool operator<(const VertexDecl& ref) const {
 		return ref.bufferSlot > bufferSlot || ref.format > format || ref.byteOffset > byteOffset ||
-		       strcmp(ref.semantic.c_str(), semantic.c_str()) < 0;
+		       ref.instanceStepRate > instanceStepRate || strcmp(ref.semantic.c_str(), semantic.c_str()) < 0;
 	}
 
 	// Reorders the vertex declaration.
@@ -907,6 +911,8 @@ struct FrameStatistics {
 	void Reset() { *this = FrameStatistics(); }
 
 	int numDrawCalls = 0;
+	int numInstancedDrawCalls = 0; ///< The draw calls that have drawn more than one instance.
+	size_t numInstancesDrawn = 0;  ///< The instances drawn by all draw calls, non-instanced draw calls count as one.
 	size_t numPrimitiveDrawn = 0;
 	float lastPresentTime = 0;
 	float lastPresentDt = 0;
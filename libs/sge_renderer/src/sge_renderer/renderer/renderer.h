@@ -308,9 +308,15 @@ struct SGEContext {
 	virtual void* map(Buffer* buffer, const Map::Enum map) = 0;
 	virtual void unMap(Buffer* buffer) = 0;
 
+	// Textures.
+	// Replaces the whole contents of a 2D texture created with TextureUsage::DynamicResource and a single mip level.
+	virtual void updateTextureData(Texture* texture, const TextureData& textureData) = 0;
+
 	// Frame targets.
 	virtual void clearColor(FrameTarget* target, int index, const float rgba[4]) = 0;
 	virtual void clearDepth(FrameTarget* target, float depth) = 0;
+	// Copies the depth stencil of @src to the depth stencil of @dest. Both must have depth stencils with the same size and format.
+	virtual void copyDepthStencil(FrameTarget* dest, FrameTarget* src) = 0;
 
 	// Queries.
 	virtual void beginQuery(Query* const query) = 0;
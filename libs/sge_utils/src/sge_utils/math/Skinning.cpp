@@ -0,0 +1,130 @@
+#include "Skinning.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SGE_SKINNING_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SGE_SKINNING_NEON
+#include <arm_neon.h>
+#endif
+
+namespace sge {
+
+namespace {
+// A minimal wrapper of the 4-wide float vectors of the available instruction set.
+#if defined(SGE_SKINNING_SSE)
+typedef __m128 float4v;
+
+float4v load4(const float* p) {
+	return _mm_loadu_ps(p);
+}
+float4v splat(const float f) {
+	return _mm_set1_ps(f);
+}
+float4v mul(const float4v a, const float4v b) {
+	return _mm_mul_ps(a, b);
+}
+// Returns a * b + c.
+float4v madd(const float4v a, const float4v b, const float4v c) {
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+void store3(float* const p, const float4v v) {
+	alignas(16) float tmp[4];
+	_mm_store_ps(tmp, v);
+	p[0] = tmp[0];
+	p[1] = tmp[1];
+	p[2] = tmp[2];
+}
+#elif defined(SGE_SKINNING_NEON)
+typedef float32x4_t float4v;
+
+float4v load4(const float* p) {
+	return vld1q_f32(p);
+}
+float4v splat(const float f) {
+	return vdupq_n_f32(f);
+}
+float4v mul(const float4v a, const float4v b) {
+	return vmulq_f32(a, b);
+}
+// Returns a * b + c.
+float4v madd(const float4v a, const float4v b, const float4v c) {
+	return vmlaq_f32(c, a, b);
+}
+void store3(float* const p, const float4v v) {
+	float tmp[4];
+	vst1q_f32(tmp, v);
+	p[0] = tmp[0];
+	p[1] = tmp[1];
+	p[2] = tmp[2];
+}
+#else
+typedef vec4f float4v;
+
+float4v load4(const float* p) {
+	return vec4f(p[0], p[1], p[2], p[3]);
+}
+float4v splat(const float f) {
+	return vec4f(f);
+}
+float4v mul(const float4v a, const float4v b) {
+	return a * b;
+}
+// Returns a * b + c.
+float4v madd(const float4v a, const float4v b, const float4v c) {
+	return a * b + c;
+}
+void store3(float* const p, const float4v v) {
+	p[0] = v.x;
+	p[1] = v.y;
+	p[2] = v.z;
+}
+#endif
+} // namespace
+
+void skinVertices(const SkinningVerticesDesc& desc, int begin, int end) {
+	sgeAssert(desc.srcVertices && desc.destVertices && desc.skinningVertices && desc.bones);
+
+	const bool hasNormals = desc.normalByteOffset >= 0;
+
+	for (int iVertex = begin; iVertex < end; ++iVertex) {
+		const SkinningVertex& skinningVertex = desc.skinningVertices[iVertex];
+
+		const mat4f& bone0 = desc.bones[int(skinningVertex.bonesIds.x)];
+		const mat4f& bone1 = desc.bones[int(skinningVertex.bonesIds.y)];
+		const mat4f& bone2 = desc.bones[int(skinningVertex.bonesIds.z)];
+		const mat4f& bone3 = desc.bones[int(skinningVertex.bonesIds.w)];
+
+		const float4v weight0 = splat(skinningVertex.bonesWeights.x);
+		const float4v weight1 = splat(skinningVertex.bonesWeights.y);
+		const float4v weight2 = splat(skinningVertex.bonesWeights.z);
+		const float4v weight3 = splat(skinningVertex.bonesWeights.w);
+
+		// Blend the columns of the bone transforms into a single matrix.
+		float4v columns[4];
+		for (int iColumn = 0; iColumn < 4; ++iColumn) {
+			float4v column = mul(load4(&bone0.data[iColumn][0]), weight0);
+			column = madd(load4(&bone1.data[iColumn][0]), weight1, column);
+			column = madd(load4(&bone2.data[iColumn][0]), weight2, column);
+			column = madd(load4(&bone3.data[iColumn][0]), weight3, column);
+			columns[iColumn] = column;
+		}
+
+		const char* const srcVertex = desc.srcVertices + size_t(desc.stride) * size_t(iVertex);
+		char* const destVertex = desc.destVertices + size_t(desc.stride) * size_t(iVertex);
+
+		const float* const pos = (const float*)(srcVertex + desc.posByteOffset);
+		const float4v skinnedPos =
+		    madd(columns[0], splat(pos[0]), madd(columns[1], splat(pos[1]), madd(columns[2], splat(pos[2]), columns[3])));
+		store3((float*)(destVertex + desc.posByteOffset), skinnedPos);
+
+		if (hasNormals) {
+			const float* const normal = (const float*)(srcVertex + desc.normalByteOffset);
+			const float4v skinnedNormal =
+			    madd(columns[0], splat(normal[0]), madd(columns[1], splat(normal[1]), mul(columns[2], splat(normal[2]))));
+			store3((float*)(destVertex + desc.normalByteOffset), skinnedNormal);
+		}
+	}
+}
+
+} // namespace sge
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "mat4.h"
+
+namespace sge {
+
+/// The bones affecting a single vertex in linear blend skinning, up to 4 bones per vertex.
+/// The bone indices are stored as floats, so the same data could be used as a vertex attribute for skinning in the vertex shader.
+/// Unused bones should have zero weights.
+struct SkinningVertex {
+	vec4f bonesIds = vec4f(0.f);
+	vec4f bonesWeights = vec4f(0.f);
+};
+
+/// Describes the vertices to be skinned by skinVertices().
+/// The vertices are interleaved, the positions and the normals are float3 at the specified byte offsets in every vertex.
+struct SkinningVerticesDesc {
+	const char* srcVertices = nullptr; // The vertices in the bind pose.
+	char* destVertices = nullptr;      // The skinned vertices, only the positions and the normals are written.
+	int stride = 0;                    // The size of a whole vertex in bytes, the same for @srcVertices and @destVertices.
+	int posByteOffset = 0;
+	int normalByteOffset = -1; // Negative if the vertices have no normals.
+
+	const SkinningVertex* skinningVertices = nullptr; // The bones affecting each vertex.
+	const mat4f* bones = nullptr; // The global transform of each bone multiplied by its offset matrix.
+};
+
+/// Skins the vertices in range [begin, end) with linear blend skinning.
+/// The weighted bone transforms of a vertex are blended into a single matrix which then transforms the position and the normal.
+/// Uses SSE or NEON if available. The normals are not renormalized.
+void skinVertices(const SkinningVerticesDesc& desc, int begin, int end);
+
+} // namespace sge
@@ -30,6 +30,7 @@ struct ChunkContainer {
 		if (freeList.empty() == false) {
 			T* retval = at(freeList.back());
 			new (retval) T;
+			isFreed[freeList.back()] = false;
 			freeList.pop_back();
 			return retval;
 		}
@@ -38,6 +39,7 @@ struct ChunkContainer {
 			T* retval = &chunks.back()[lastChunkTouchCount];
 			new (retval) T;
 			lastChunkTouchCount += 1;
+			isFreed.push_back(false);
 			return retval;
 		}
 
@@ -49,20 +51,21 @@ struct ChunkContainer {
 
 	// Frees an element in the conteiner.
 	void free_element(const int idx) {
-		// Check if the element is already deleted.
-		auto itr = std::find(begin(freeList), end(freeList), idx);
-		if (itr != freeList.end()) {
+		if (idx < 0 || idx >= int(isFreed.size())) {
+			// Freeing an unallocated element.
+			sgeAssert(false);
 			return;
 		}
 
-		const size_t chunk = idx / CHUNK_SIZE;
-		sgeAssert(chunk < chunks.size());
+		// Check if the element is already deleted.
+		if (isFreed[idx]) {
+			return;
+		}
 
 		// Call the destructor and add it to the free list.
-		if (idx % CHUNK_SIZE < lastChunkTouchCount) {
-			chunks[chunk][idx % CHUNK_SIZE].~T();
-			freeList.push_back(idx);
-		}
+		chunks[idx / CHUNK_SIZE][idx % CHUNK_SIZE].~T();
+		isFreed[idx] = true;
+		freeList.push_back(idx);
 	}
 
 	// Find the index of a pointer.
@@ -89,10 +92,7 @@ struct ChunkContainer {
 		return ((int)chunks.size() - 1) * CHUNK_SIZE + lastChunkTouchCount;
 	}
 
-	bool is_in_freelist(const int idx) const {
-		auto itr = std::find(begin(freeList), end(freeList), idx);
-		return (itr != freeList.end());
-	}
+	bool is_in_freelist(const int idx) const { return idx >= 0 && idx < int(isFreed.size()) && isFreed[idx]; }
 
 	void free_element(T* const ptr) {
 		int idx = find_pointer_index(ptr);
@@ -120,6 +120,7 @@ struct ChunkContainer {
 
 		chunks.clear();
 		freeList.clear();
+		isFreed.clear();
 		lastChunkTouchCount = 0;
 	}
 
@@ -129,6 +130,7 @@ struct ChunkContainer {
   private:
 	std::vector<T*> chunks;      // The allocated chunks.
 	std::vector<int> freeList;   // List of free elements(in all chunks).
+	std::vector<bool> isFreed;   // For every touched element, true if it is in the free list.
 	int lastChunkTouchCount = 0; // The number of touched elements in the last chunk.
 };
 
@@ -13,12 +13,24 @@
 #pragma comment(lib, "Shlwapi.lib") // https://docs.microsoft.com/en-us/windows/win32/api/shlwapi/nf-shlwapi-pathfindfilenamea
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <sys/stat.h>
 #include <sys/types.h>
 #ifndef WIN32
 #include <unistd.h>
 #endif
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
 #include "sge_utils/utils/common.h"
 
 #include "FileStream.h"
@@ -234,6 +246,135 @@ sint64 FileReadStream::getFileModTime(const char* const filename) {
 	return 0; // TODO: is this really the invalid time?
 }
 
+//-------------------------------------------------------------------------
+// MappedFileReadStream
+//-------------------------------------------------------------------------
+bool MappedFileReadStream::open(const char* const filename) {
+	close();
+
+	if (filename == nullptr) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	HANDLE const hFile = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (::GetFileSizeEx(hFile, &fileSize) == FALSE) {
+		::CloseHandle(hFile);
+		return false;
+	}
+
+	m_file = hFile;
+	m_sizeBytes = size_t(fileSize.QuadPart);
+
+	// Empty files cannot be mapped, they are just opened with no data.
+	if (m_sizeBytes != 0) {
+		m_mapping = ::CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping != nullptr) {
+			m_data = (const char*)::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+
+		if (m_data == nullptr) {
+			close();
+			return false;
+		}
+	}
+#else
+	const int fd = ::open(filename, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0) {
+		::close(fd);
+		return false;
+	}
+
+	m_sizeBytes = size_t(fileStat.st_size);
+
+	// Empty files cannot be mapped, they are just opened with no data.
+	if (m_sizeBytes != 0) {
+		void* const mapped = mmap(nullptr, m_sizeBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED) {
+			::close(fd);
+			m_sizeBytes = 0;
+			return false;
+		}
+
+		m_data = (const char*)mapped;
+	}
+
+	// The mapping stays valid after closing the file.
+	::close(fd);
+#endif
+
+	m_isOpened = true;
+	m_pointer = 0;
+	return true;
+}
+
+void MappedFileReadStream::close() {
+#if defined(_WIN32)
+	if (m_data != nullptr) {
+		::UnmapViewOfFile(m_data);
+	}
+
+	if (m_mapping != nullptr) {
+		::CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+
+	if (m_file != nullptr) {
+		::CloseHandle(m_file);
+		m_file = nullptr;
+	}
+#else
+	if (m_data != nullptr) {
+		munmap((void*)m_data, m_sizeBytes);
+	}
+#endif
+
+	m_isOpened = false;
+	m_data = nullptr;
+	m_sizeBytes = 0;
+	m_pointer = 0;
+}
+
+size_t MappedFileReadStream::read(void* destination, size_t numBytes) {
+	const size_t numBytesToCopy = std::min(numBytes, m_sizeBytes - m_pointer);
+	if (numBytesToCopy != 0) {
+		memcpy(destination, m_data + m_pointer, numBytesToCopy);
+		m_pointer += numBytesToCopy;
+	}
+
+	return numBytesToCopy;
+}
+
+void MappedFileReadStream::seek(SeekOrigin origin, size_t bytes) {
+	switch (origin) {
+		case SeekOrigin::Begining:
+			m_pointer = bytes;
+			break;
+		case SeekOrigin::Current:
+			m_pointer += bytes;
+			break;
+		case SeekOrigin::End:
+			m_pointer = m_sizeBytes;
+			break;
+		default:
+			sgeAssert(false); // Should never happen.
+	}
+
+	if (m_pointer > m_sizeBytes) {
+		m_pointer = m_sizeBytes;
+	}
+}
+
 //-------------------------------------------------------------------------
 // FileWriteStream
 //-------------------------------------------------------------------------
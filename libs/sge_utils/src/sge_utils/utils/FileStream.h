@@ -72,6 +72,51 @@ class FileReadStream : public IReadStream {
 	size_t bufferFileOffset; // buffers location in the file
 };
 
+//-------------------------------------------------------------------------
+// MappedFileReadStream
+//-------------------------------------------------------------------------
+/// Reads a file by mapping it in memory (mmap or MapViewOfFile). The contents of the file could be used directly
+/// with getMemory(), without copying them, the pages get loaded by the OS when accessed.
+class MappedFileReadStream : public IReadStream {
+  public:
+	MappedFileReadStream() = default;
+	~MappedFileReadStream() { close(); }
+
+	MappedFileReadStream(const char* const filename)
+	    : MappedFileReadStream() {
+		open(filename);
+	}
+
+	MappedFileReadStream(const MappedFileReadStream&) = delete;
+	MappedFileReadStream& operator=(const MappedFileReadStream&) = delete;
+
+	/// Maps the whole file for reading. Returns false if the file cannot be opened or mapped.
+	bool open(const char* const filename);
+
+	/// Unmaps the file and reverts the object to its inital state.
+	void close();
+
+	bool isOpened() const { return m_isOpened; }
+
+	size_t read(void* destination, size_t numBytes) override;
+	size_t pointerOffset() override { return m_pointer; }
+	void seek(SeekOrigin origin, size_t bytes) override;
+
+	const char* getMemory() override { return m_data; }
+	size_t getMemorySizeBytes() override { return m_sizeBytes; }
+
+  private:
+	bool m_isOpened = false;
+	const char* m_data = nullptr; // The mapped file, nullptr for empty files.
+	size_t m_sizeBytes = 0;
+	size_t m_pointer = 0;
+
+#if defined(_WIN32)
+	void* m_file = nullptr;    // The HANDLE of the file.
+	void* m_mapping = nullptr; // The HANDLE of the file mapping.
+#endif
+};
+
 //-------------------------------------------------------------------------
 // FileWriteStream
 //-------------------------------------------------------------------------
@@ -21,6 +21,11 @@ class IReadStream {
 	virtual size_t read(void* destination, size_t numBytes) = 0;
 	virtual size_t pointerOffset() = 0;
 	virtual void seek(SeekOrigin origin, size_t bytes) = 0;
+
+	/// If the whole stream is in memory (like a memory mapped file) returns a pointer to its beginning, so it could be
+	/// used without copying, otherwise nullptr. The memory is valid while the stream is open.
+	virtual const char* getMemory() { return nullptr; }
+	virtual size_t getMemorySizeBytes() { return 0; }
 };
 
 class IWriteStream {
@@ -166,6 +171,9 @@ class ReadByteStream : public IReadStream {
 
 	inline size_t pointerOffset() { return pointer; }
 
+	const char* getMemory() override { return data; }
+	size_t getMemorySizeBytes() override { return dataSizeBytes; }
+
 	inline void seek(SeekOrigin origin, size_t bytes) {
 		switch (origin) {
 			case SeekOrigin::Begining:
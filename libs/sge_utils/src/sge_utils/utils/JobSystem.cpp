@@ -0,0 +1,175 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+namespace sge {
+
+namespace {
+	/// The job system that owns the current thread (if any) and the index of the thread in it.
+	thread_local const JobSystem* g_threadJobSystem = nullptr;
+	thread_local int g_threadIndex = 0;
+} // namespace
+
+void JobSystem::create(int numWorkers) {
+	destroy();
+
+#if defined(__EMSCRIPTEN__)
+	// Threads aren't available, everything gets executed on the calling thread.
+	numWorkers = 0;
+#endif
+
+	numWorkers = std::max(numWorkers, 0);
+
+	m_shouldExit = false;
+	m_numQueuedJobs = 0;
+
+	m_queues.resize(numWorkers + 1);
+	for (std::unique_ptr<JobQueue>& queue : m_queues) {
+		queue.reset(new JobQueue());
+	}
+
+	m_threads.reserve(numWorkers);
+	for (int t = 0; t < numWorkers; ++t) {
+		m_threads.emplace_back([this, t]() -> void { workerMain(t + 1); });
+	}
+}
+
+void JobSystem::destroy() {
+	{
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+		m_shouldExit = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+
+	m_threads.clear();
+	m_queues.clear();
+}
+
+int JobSystem::getCurrentThreadIndex() const {
+	return g_threadJobSystem == this ? g_threadIndex : 0;
+}
+
+int JobSystem::getRecommendedNumWorkers() {
+#if defined(__EMSCRIPTEN__)
+	return 0;
+#else
+	// Leave one hardware thread for the thread that submits the work.
+	const int numHardwareThreads = int(std::thread::hardware_concurrency());
+	return std::max(numHardwareThreads - 1, 0);
+#endif
+}
+
+void JobSystem::parallelFor(int numItems, int batchSize, const JobFn& fn) {
+	if (numItems <= 0) {
+		return;
+	}
+
+	batchSize = std::max(batchSize, 1);
+
+	// Do not bother with the queues if there is nobody to share the work with.
+	if (m_threads.empty() || numItems <= batchSize) {
+		fn(0, numItems);
+		return;
+	}
+
+	// Nested calls from a worker of this job system push to the worker's own queue, so the other threads could steal from it.
+	const int threadIndex = getCurrentThreadIndex();
+
+	const int numBatches = (numItems + batchSize - 1) / batchSize;
+	std::atomic<int> pendingJobs = numBatches;
+
+	// Distribute the batches among all the queues. The workers steal from the queues that end up with more work.
+	const int numQueues = int(m_queues.size());
+	for (int iBatch = 0; iBatch < numBatches; ++iBatch) {
+		Job job;
+		job.fn = &fn;
+		job.begin = iBatch * batchSize;
+		job.end = std::min(job.begin + batchSize, numItems);
+		job.pendingJobs = &pendingJobs;
+
+		JobQueue& queue = *m_queues[(threadIndex + iBatch) % numQueues];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.jobs.push_back(job);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_wakeLock);
+		m_numQueuedJobs += numBatches;
+	}
+	m_wakeCondition.notify_all();
+
+	// Participate in the execution until all of our jobs are done.
+	// The thread might execute jobs submitted by other parallelFor calls, that's fine as each job knows its own counter.
+	while (pendingJobs.load() > 0) {
+		Job job;
+		if (tryGetJob(threadIndex, job)) {
+			executeJob(job);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::workerMain(int workerIndex) {
+	g_threadJobSystem = this;
+	g_threadIndex = workerIndex;
+
+	while (true) {
+		Job job;
+		if (tryGetJob(workerIndex, job)) {
+			executeJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeLock);
+		m_wakeCondition.wait(lock, [this]() -> bool { return m_shouldExit || m_numQueuedJobs.load() > 0; });
+		if (m_shouldExit) {
+			break;
+		}
+	}
+
+	g_threadJobSystem = nullptr;
+	g_threadIndex = 0;
+}
+
+bool JobSystem::tryGetJob(int threadIndex, Job& outJob) {
+	if (m_numQueuedJobs.load() <= 0) {
+		return false;
+	}
+
+	// The owner takes the most recently pushed job, the thieves take the oldest one.
+	{
+		JobQueue& ownQueue = *m_queues[threadIndex];
+		std::lock_guard<std::mutex> guard(ownQueue.lock);
+		if (ownQueue.jobs.empty() == false) {
+			outJob = ownQueue.jobs.back();
+			ownQueue.jobs.pop_back();
+			m_numQueuedJobs--;
+			return true;
+		}
+	}
+
+	const int numQueues = int(m_queues.size());
+	for (int t = 1; t < numQueues; ++t) {
+		JobQueue& victimQueue = *m_queues[(threadIndex + t) % numQueues];
+		std::lock_guard<std::mutex> guard(victimQueue.lock);
+		if (victimQueue.jobs.empty() == false) {
+			outJob = victimQueue.jobs.front();
+			victimQueue.jobs.pop_front();
+			m_numQueuedJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::executeJob(const Job& job) {
+	(*job.fn)(job.begin, job.end);
+	job.pendingJobs->fetch_sub(1);
+}
+
+} // namespace sge
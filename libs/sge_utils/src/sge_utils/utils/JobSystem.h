@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sge_utils/sge_utils.h"
+
+namespace sge {
+
+/// A small work-stealing job system.
+/// Each thread participating in the system (the workers and the thread that submits the work) has its own queue of jobs.
+/// A thread executes the jobs from its own queue first and when it runs out of work it steals jobs from the other queues.
+/// The thread calling parallelFor participates in the execution and returns only when all the submitted jobs are done.
+struct JobSystem {
+	/// The function executed by the jobs, @begin and @end specify the range of items to be processed.
+	typedef std::function<void(int begin, int end)> JobFn;
+
+	JobSystem() = default;
+	~JobSystem() { destroy(); }
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/// Starts @numWorkers worker threads. With zero workers all the work is done by the calling thread.
+	void create(int numWorkers);
+	/// Waits for the workers to finish their current jobs and stops them.
+	void destroy();
+
+	bool isCreated() const { return m_queues.empty() == false; }
+	int getNumWorkers() const { return int(m_threads.size()); }
+
+	/// Returns the number of threads that could execute jobs (including the thread submitting the work).
+	int getNumThreads() const { return getNumWorkers() + 1; }
+
+	/// Returns the index of the calling thread in this job system.
+	/// The workers have indices in [1, getNumWorkers()], every other thread has index 0.
+	/// Useful for indexing per-thread data, which doesn't need any synchronization.
+	int getCurrentThreadIndex() const;
+
+	/// Splits the range [0, numItems) into batches of @batchSize items and executes @fn for each of them.
+	/// Returns when all batches are processed. Might be called from inside of a job.
+	void parallelFor(int numItems, int batchSize, const JobFn& fn);
+
+	/// Returns the number of worker threads recommended for the current machine.
+	static int getRecommendedNumWorkers();
+
+  private:
+	struct Job {
+		const JobFn* fn = nullptr;
+		int begin = 0;
+		int end = 0;
+		std::atomic<int>* pendingJobs = nullptr;
+	};
+
+	struct JobQueue {
+		std::mutex lock;
+		std::deque<Job> jobs;
+	};
+
+	void workerMain(int workerIndex);
+
+	/// Pops a job from the queue of the specified thread, or steals one from the other threads if there are none.
+	bool tryGetJob(int threadIndex, Job& outJob);
+	void executeJob(const Job& job);
+
+  private:
+	std::vector<std::thread> m_threads;
+	/// The queue at index 0 is used by the threads submitting the work, the rest are used by the workers.
+	std::vector<std::unique_ptr<JobQueue>> m_queues;
+
+	std::atomic<int> m_numQueuedJobs = 0;
+	std::mutex m_wakeLock;
+	std::condition_variable m_wakeCondition;
+	bool m_shouldExit = false;
+};
+
+} // namespace sge
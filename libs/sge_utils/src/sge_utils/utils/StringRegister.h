@@ -1,27 +1,53 @@
 #pragma once
 
-#include <algorithm>
-#include <map>
+#include <deque>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "sge_utils/sge_utils.h"
 
 namespace sge {
 
 // A class assigning a unique id for every requested string.
 // The zero is reserved and no string will be assigned with that variable.
+// The lookups are done by hashing and don't allocate, so the ids could be used for keying hash maps with strings.
 struct StringRegister {
-	int getIndex(const std::string& str) {
-		unsigned res = strings[str];
+	StringRegister() = default;
+
+	// The hash map references the stored strings, so copying would leave the copy referencing the strings of the original.
+	StringRegister(const StringRegister&) = delete;
+	StringRegister& operator=(const StringRegister&) = delete;
+
+	/// Returns the id of the string, assigning a new one if the string isn't registered yet.
+	int getIndex(const std::string_view str) {
+		const int existingIndex = findIndex(str);
+		if (existingIndex != 0) {
+			return existingIndex;
+		}
 
-		if (res != 0)
-			return res;
+		strings.emplace_back(str);
+		const int index = int(strings.size());
+		indices.emplace(std::string_view(strings.back()), index);
 
-		strings[str] = (int)strings.size();
+		return index;
+	}
+
+	/// Returns the id of the string, or zero if the string isn't registered.
+	int findIndex(const std::string_view str) const {
+		const auto itr = indices.find(str);
+		return itr != indices.end() ? itr->second : 0;
+	}
 
-		return (int)strings.size();
+	/// Returns the string with the specified id.
+	const std::string& getString(const int index) const {
+		sgeAssert(index > 0 && index <= int(strings.size()));
+		return strings[index - 1];
 	}
 
   private:
-	std::map<std::string, int> strings;
+	std::deque<std::string> strings;                   // The registered strings, the id of a string is its index + 1.
+	std::unordered_map<std::string_view, int> indices; // The ids by string, referencing @strings.
 };
 
 
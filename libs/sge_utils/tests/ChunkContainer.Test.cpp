@@ -0,0 +1,94 @@
+#include "sge_utils/utils/ChunkContainer.h"
+#include "doctest/doctest.h"
+
+#include <algorithm>
+#include <random>
+using namespace sge;
+
+namespace {
+int g_numAliveElements = 0;
+
+struct TrackedElement {
+	TrackedElement() { g_numAliveElements++; }
+	~TrackedElement() { g_numAliveElements--; }
+
+	int value = 0;
+};
+} // namespace
+
+TEST_CASE("ChunkContainer random allocations stress") {
+	const int kNumElements = 100000;
+	std::mt19937 rng(42);
+
+	g_numAliveElements = 0;
+	{
+		ChunkContainer<TrackedElement> container;
+
+		// While the free list is empty the elements are allocated one after another.
+		for (int t = 0; t < kNumElements; ++t) {
+			container.new_element()->value = t;
+		}
+		CHECK(g_numAliveElements == kNumElements);
+		CHECK(container.get_highest_count() == kNumElements);
+
+		std::vector<int> indices(kNumElements);
+		for (int t = 0; t < kNumElements; ++t) {
+			indices[t] = t;
+		}
+
+		// Free the half of the elements in random order.
+		std::shuffle(indices.begin(), indices.end(), rng);
+		const int kNumFreed = kNumElements / 2;
+		for (int t = 0; t < kNumFreed; ++t) {
+			container.free_element(indices[t]);
+		}
+		CHECK(g_numAliveElements == kNumElements - kNumFreed);
+		CHECK(container.is_in_freelist(indices[0]));
+		CHECK(container.is_in_freelist(indices[kNumFreed]) == false);
+
+		// Freeing an element twice does nothing.
+		container.free_element(indices[0]);
+		CHECK(g_numAliveElements == kNumElements - kNumFreed);
+
+		// The remaining elements are untouched.
+		bool areRemainingValid = true;
+		for (int t = kNumFreed; t < kNumElements; ++t) {
+			areRemainingValid &= container.at(indices[t])->value == indices[t];
+		}
+		CHECK(areRemainingValid);
+
+		// New elements reuse the freed ones.
+		for (int t = 0; t < kNumFreed; ++t) {
+			container.new_element();
+		}
+		CHECK(g_numAliveElements == kNumElements);
+		CHECK(container.get_highest_count() == kNumElements);
+		CHECK(container.is_in_freelist(indices[0]) == false);
+
+		// Free everything in random order, and then leave some elements for clear().
+		std::shuffle(indices.begin(), indices.end(), rng);
+		for (int t = 0; t < kNumElements; ++t) {
+			container.free_element(indices[t]);
+		}
+		CHECK(g_numAliveElements == 0);
+
+		for (int t = 0; t < kNumElements; ++t) {
+			container.new_element();
+		}
+		std::shuffle(indices.begin(), indices.end(), rng);
+		for (int t = 0; t < kNumFreed; ++t) {
+			container.free_element(indices[t]);
+		}
+		CHECK(g_numAliveElements == kNumElements - kNumFreed);
+
+		container.clear();
+		CHECK(g_numAliveElements == 0);
+		CHECK(container.get_highest_count() == 0);
+
+		// The elements left alive in every chunk are destroyed with the container.
+		for (int t = 0; t < ChunkContainer<TrackedElement>::CHUNK_SIZE * 3 / 2; ++t) {
+			container.new_element();
+		}
+	}
+	CHECK(g_numAliveElements == 0);
+}
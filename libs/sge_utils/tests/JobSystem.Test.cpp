@@ -0,0 +1,66 @@
+#include "sge_utils/utils/JobSystem.h"
+#include "doctest/doctest.h"
+
+#include <vector>
+using namespace sge;
+
+TEST_CASE("JobSystem parallelFor") {
+	JobSystem jobSystem;
+	jobSystem.create(3);
+	CHECK(jobSystem.getNumWorkers() == 3);
+	CHECK(jobSystem.getCurrentThreadIndex() == 0);
+
+	SUBCASE("Every item is processed exactly once") {
+		const int numItems = 10000;
+		std::vector<int> timesProcessed(numItems, 0);
+
+		jobSystem.parallelFor(numItems, 7, [&](int begin, int end) -> void {
+			for (int t = begin; t < end; ++t) {
+				timesProcessed[t]++;
+			}
+		});
+
+		bool allProcessedOnce = true;
+		for (int t = 0; t < numItems; ++t) {
+			allProcessedOnce &= timesProcessed[t] == 1;
+		}
+		CHECK(allProcessedOnce);
+	}
+
+	SUBCASE("Per-thread data") {
+		std::vector<int> sumPerThread(jobSystem.getNumThreads(), 0);
+
+		jobSystem.parallelFor(1000, 1, [&](int begin, int end) -> void {
+			const int threadIndex = jobSystem.getCurrentThreadIndex();
+			for (int t = begin; t < end; ++t) {
+				sumPerThread[threadIndex] += t;
+			}
+		});
+
+		int totalSum = 0;
+		for (int sum : sumPerThread) {
+			totalSum += sum;
+		}
+		CHECK(totalSum == 999 * 1000 / 2);
+	}
+
+	SUBCASE("Nested parallelFor") {
+		std::atomic<int> numProcessed = 0;
+		jobSystem.parallelFor(16, 1, [&](int, int) -> void {
+			jobSystem.parallelFor(100, 10, [&](int begin, int end) -> void { numProcessed += end - begin; });
+		});
+		CHECK(numProcessed.load() == 1600);
+	}
+
+	jobSystem.destroy();
+	CHECK(jobSystem.getNumWorkers() == 0);
+}
+
+TEST_CASE("JobSystem without workers") {
+	JobSystem jobSystem;
+	jobSystem.create(0);
+
+	int numProcessed = 0;
+	jobSystem.parallelFor(100, 10, [&](int begin, int end) -> void { numProcessed += end - begin; });
+	CHECK(numProcessed == 100);
+}
@@ -0,0 +1,68 @@
+#include "sge_utils/utils/FileStream.h"
+#include "doctest/doctest.h"
+
+#include <filesystem>
+#include <string>
+using namespace sge;
+
+namespace {
+std::string writeTestFile(const char* const filename, const std::string& contents) {
+	const std::filesystem::path dir = std::filesystem::temp_directory_path() / "sge_mapped_file_test";
+	std::filesystem::create_directories(dir);
+
+	const std::string path = (dir / filename).generic_string();
+	FileWriteStream fws;
+	fws.open(path.c_str());
+	fws.write(contents.data(), contents.size());
+	return path;
+}
+} // namespace
+
+TEST_CASE("MappedFileReadStream") {
+	const std::string contents = "0123456789abcdef";
+	const std::string path = writeTestFile("data.bin", contents);
+
+	MappedFileReadStream stream;
+	REQUIRE(stream.open(path.c_str()));
+	CHECK(stream.isOpened());
+
+	// The whole file is accessible without reading it.
+	REQUIRE(stream.getMemory() != nullptr);
+	REQUIRE(stream.getMemorySizeBytes() == contents.size());
+	CHECK(std::string(stream.getMemory(), stream.getMemorySizeBytes()) == contents);
+
+	char buffer[8] = {0};
+	CHECK(stream.read(buffer, 4) == 4);
+	CHECK(std::string(buffer, 4) == "0123");
+	CHECK(stream.pointerOffset() == 4);
+
+	stream.seek(SeekOrigin::Current, 6);
+	CHECK(stream.read(buffer, 2) == 2);
+	CHECK(std::string(buffer, 2) == "ab");
+
+	// Reading past the end reads only what is left.
+	stream.seek(SeekOrigin::Begining, 12);
+	CHECK(stream.read(buffer, 8) == 4);
+	CHECK(std::string(buffer, 4) == "cdef");
+	CHECK(stream.read(buffer, 8) == 0);
+
+	stream.close();
+	CHECK(stream.isOpened() == false);
+	CHECK(stream.getMemory() == nullptr);
+}
+
+TEST_CASE("MappedFileReadStream empty and missing files") {
+	const std::string emptyPath = writeTestFile("empty.bin", std::string());
+
+	MappedFileReadStream emptyStream(emptyPath.c_str());
+	CHECK(emptyStream.isOpened());
+	CHECK(emptyStream.getMemorySizeBytes() == 0);
+
+	char buffer[4];
+	CHECK(emptyStream.read(buffer, 4) == 0);
+
+	const std::string missingPath = (std::filesystem::temp_directory_path() / "sge_mapped_file_test/missing.bin").generic_string();
+	MappedFileReadStream missingStream;
+	CHECK(missingStream.open(missingPath.c_str()) == false);
+	CHECK(missingStream.isOpened() == false);
+}
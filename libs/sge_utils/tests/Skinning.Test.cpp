@@ -0,0 +1,193 @@
+#include "doctest/doctest.h"
+#include "sge_utils/math/Skinning.h"
+#include "sge_utils/math/transform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <random>
+#include <vector>
+using namespace sge;
+
+namespace {
+// The layout of the test vertices.
+struct TestVertex {
+	vec3f position;
+	vec3f normal;
+	vec2f uv;
+};
+
+struct TestBone {
+	mat4f transform;
+	std::vector<int> vertexIds;
+	std::vector<float> weights;
+};
+
+/// A mesh with random bones, every vertex is affected by 1 to 4 of them.
+struct TestSkinnedMesh {
+	std::vector<TestVertex> vertices;
+	std::vector<TestBone> bones;
+	std::vector<mat4f> boneTransforms;
+	std::vector<SkinningVertex> skinningVertices;
+
+	TestSkinnedMesh(int numVertices, int numBones, unsigned seed) {
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> dist(-1.f, 1.f);
+		std::uniform_real_distribution<float> dist01(0.f, 1.f);
+		std::uniform_int_distribution<int> distBone(0, numBones - 1);
+		std::uniform_int_distribution<int> distNumInfluences(1, 4);
+
+		bones.resize(numBones);
+		for (TestBone& bone : bones) {
+			const quatf rotation = quatf::getAxisAngle(vec3f(dist(rng), dist(rng), dist(rng)).normalized0(), dist(rng) * 3.f);
+			const transf3d transf(vec3f(dist(rng), dist(rng), dist(rng)) * 10.f, rotation, vec3f(0.5f + dist01(rng)));
+			bone.transform = transf.toMatrix();
+			boneTransforms.push_back(bone.transform);
+		}
+
+		vertices.resize(numVertices);
+		skinningVertices.resize(numVertices);
+		for (int iVertex = 0; iVertex < numVertices; ++iVertex) {
+			TestVertex& vertex = vertices[iVertex];
+			vertex.position = vec3f(dist(rng), dist(rng), dist(rng)) * 5.f;
+			vertex.normal = vec3f(dist(rng), dist(rng), dist(rng)).normalized0();
+			vertex.uv = vec2f(dist01(rng), dist01(rng));
+
+			// Pick distinct bones and normalized weights.
+			const int numInfluences = distNumInfluences(rng);
+			int boneIds[4] = {-1, -1, -1, -1};
+			float weights[4] = {0.f, 0.f, 0.f, 0.f};
+			float weightsSum = 0.f;
+			for (int t = 0; t < numInfluences; ++t) {
+				int iBone = distBone(rng);
+				while (std::find(boneIds, boneIds + t, iBone) != boneIds + t) {
+					iBone = (iBone + 1) % numBones;
+				}
+				boneIds[t] = iBone;
+				weights[t] = 0.1f + dist01(rng);
+				weightsSum += weights[t];
+			}
+
+			for (int t = 0; t < numInfluences; ++t) {
+				weights[t] /= weightsSum;
+				bones[boneIds[t]].vertexIds.push_back(iVertex);
+				bones[boneIds[t]].weights.push_back(weights[t]);
+				skinningVertices[iVertex].bonesIds[t] = float(boneIds[t]);
+				skinningVertices[iVertex].bonesWeights[t] = weights[t];
+			}
+		}
+	}
+
+	SkinningVerticesDesc getDesc(std::vector<TestVertex>& destVertices) const {
+		SkinningVerticesDesc desc;
+		desc.srcVertices = (const char*)vertices.data();
+		desc.destVertices = (char*)destVertices.data();
+		desc.stride = sizeof(TestVertex);
+		desc.posByteOffset = offsetof(TestVertex, position);
+		desc.normalByteOffset = offsetof(TestVertex, normal);
+		desc.skinningVertices = skinningVertices.data();
+		desc.bones = boneTransforms.data();
+		return desc;
+	}
+
+	/// The per-bone skinning that EvaluatedModel used to do, it accumulates the contribution of every bone to its vertices.
+	void skinPerBone(std::vector<TestVertex>& result) const {
+		result = vertices;
+		for (TestVertex& vertex : result) {
+			vertex.position = vec3f(0.f);
+			vertex.normal = vec3f(0.f);
+		}
+
+		for (const TestBone& bone : bones) {
+			for (size_t t = 0; t < bone.vertexIds.size(); ++t) {
+				const int vid = bone.vertexIds[t];
+				result[vid].position += mat_mul_pos(bone.transform, vertices[vid].position) * bone.weights[t];
+				result[vid].normal += mat_mul_dir(bone.transform, vertices[vid].normal) * bone.weights[t];
+			}
+		}
+	}
+};
+
+bool isAboutTheSame(const vec3f& a, const vec3f& b) {
+	const float tolerance = 1e-4f * maxOf(1.f, a.length());
+	return (a - b).length() <= tolerance;
+}
+} // namespace
+
+TEST_CASE("Skinning matches the per-bone skinning") {
+	const TestSkinnedMesh mesh(1000, 20, 42);
+
+	std::vector<TestVertex> expected;
+	mesh.skinPerBone(expected);
+
+	// Initialize the destination with the bind pose, as only the positions and the normals get written.
+	std::vector<TestVertex> skinned = mesh.vertices;
+	skinVertices(mesh.getDesc(skinned), 0, int(mesh.vertices.size()));
+
+	bool allPositionsMatch = true;
+	bool allNormalsMatch = true;
+	bool allUvsAreUntouched = true;
+	for (size_t t = 0; t < expected.size(); ++t) {
+		allPositionsMatch &= isAboutTheSame(skinned[t].position, expected[t].position);
+		allNormalsMatch &= isAboutTheSame(skinned[t].normal, expected[t].normal);
+		allUvsAreUntouched &= skinned[t].uv == mesh.vertices[t].uv;
+	}
+
+	CHECK(allPositionsMatch);
+	CHECK(allNormalsMatch);
+	CHECK(allUvsAreUntouched);
+
+	SUBCASE("Skinning in multiple ranges gives the same result") {
+		std::vector<TestVertex> skinnedInRanges = mesh.vertices;
+		const SkinningVerticesDesc desc = mesh.getDesc(skinnedInRanges);
+		for (int begin = 0; begin < int(mesh.vertices.size()); begin += 97) {
+			skinVertices(desc, begin, minOf(begin + 97, int(mesh.vertices.size())));
+		}
+
+		CHECK(memcmp(skinnedInRanges.data(), skinned.data(), skinned.size() * sizeof(TestVertex)) == 0);
+	}
+
+	SUBCASE("Vertices without normals") {
+		std::vector<TestVertex> skinnedNoNormals = mesh.vertices;
+		SkinningVerticesDesc desc = mesh.getDesc(skinnedNoNormals);
+		desc.normalByteOffset = -1;
+		skinVertices(desc, 0, int(mesh.vertices.size()));
+
+		bool allNormalsAreUntouched = true;
+		for (size_t t = 0; t < expected.size(); ++t) {
+			allNormalsAreUntouched &= skinnedNoNormals[t].normal == mesh.vertices[t].normal;
+			allPositionsMatch &= isAboutTheSame(skinnedNoNormals[t].position, expected[t].position);
+		}
+
+		CHECK(allNormalsAreUntouched);
+		CHECK(allPositionsMatch);
+	}
+}
+
+// A microbenchmark comparing skinVertices() to the per-bone skinning. Skipped by default, run it with --no-skip.
+TEST_CASE("Skinning benchmark" * doctest::skip()) {
+	const TestSkinnedMesh mesh(100000, 60, 7);
+	const int numIterations = 50;
+
+	std::vector<TestVertex> perBoneResult;
+	const auto perBoneStart = std::chrono::high_resolution_clock::now();
+	for (int t = 0; t < numIterations; ++t) {
+		mesh.skinPerBone(perBoneResult);
+	}
+	const auto perBoneEnd = std::chrono::high_resolution_clock::now();
+
+	std::vector<TestVertex> result = mesh.vertices;
+	const SkinningVerticesDesc desc = mesh.getDesc(result);
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int t = 0; t < numIterations; ++t) {
+		skinVertices(desc, 0, int(mesh.vertices.size()));
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	const double perBoneMs = std::chrono::duration<double, std::milli>(perBoneEnd - perBoneStart).count() / numIterations;
+	const double ms = std::chrono::duration<double, std::milli>(end - start).count() / numIterations;
+	MESSAGE("Skinning 100000 vertices: per-bone " << perBoneMs << "ms, skinVertices " << ms << "ms");
+
+	CHECK(isAboutTheSame(result[0].position, perBoneResult[0].position));
+}
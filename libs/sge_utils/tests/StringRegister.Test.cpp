@@ -0,0 +1,32 @@
+#include "sge_utils/utils/StringRegister.h"
+#include "doctest/doctest.h"
+
+#include <string>
+using namespace sge;
+
+TEST_CASE("StringRegister") {
+	StringRegister stringRegister;
+
+	CHECK(stringRegister.findIndex("a") == 0);
+
+	const int indexA = stringRegister.getIndex("a");
+	const int indexB = stringRegister.getIndex(std::string("b"));
+	CHECK(indexA != 0);
+	CHECK(indexB != 0);
+	CHECK(indexA != indexB);
+
+	CHECK(stringRegister.getIndex("a") == indexA);
+	CHECK(stringRegister.findIndex("b") == indexB);
+	CHECK(stringRegister.findIndex("c") == 0);
+	CHECK(stringRegister.findIndex("") == 0);
+
+	// The strings and their ids must stay valid while new strings are added.
+	for (int i = 0; i < 10000; ++i) {
+		stringRegister.getIndex("string_" + std::to_string(i));
+	}
+
+	CHECK(stringRegister.getString(indexA) == "a");
+	CHECK(stringRegister.getString(indexB) == "b");
+	CHECK(stringRegister.findIndex("a") == indexA);
+	CHECK(stringRegister.getString(stringRegister.findIndex("string_5000")) == "string_5000");
+}
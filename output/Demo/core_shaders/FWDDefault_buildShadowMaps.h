@@ -0,0 +1,8 @@
+#ifndef FWDDEFAULT_BUILDSHADOWMAPS_H
+#define FWDDEFAULT_BUILDSHADOWMAPS_H
+
+// OPT_LightType
+#define FWDDBSM_OPT_LightType_SpotOrDirectional 0
+#define FWDDBSM_OPT_LightType_Point 1
+
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef SKINNING_SHADER
+#define SKINNING_SHADER
+
+#include "ShadeCommon.h"
+
+//--------------------------------------------------------------------
+// Skinning in the vertex shader.
+// Every vertex is affected by up to 4 bones, their indices and weights come
+// from the a_bonesIds and a_bonesWeights vertex attributes.
+//--------------------------------------------------------------------
+#if OPT_Skinned == 1
+
+// The global transform of the bone node multiplied by the bone offset matrix, for every bone of the mesh.
+uniform float4x4 uSkinningBones[kMaxSkinningBones];
+
+float4x4 computeSkinningTransform(float4 bonesIds, float4 bonesWeights) {
+	float4x4 result = uSkinningBones[int(bonesIds.x)] * bonesWeights.x;
+	result += uSkinningBones[int(bonesIds.y)] * bonesWeights.y;
+	result += uSkinningBones[int(bonesIds.z)] * bonesWeights.z;
+	result += uSkinningBones[int(bonesIds.w)] * bonesWeights.w;
+	return result;
+}
+
+#endif
+
+#endif
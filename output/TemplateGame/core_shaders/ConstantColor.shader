@@ -0,0 +1,53 @@
+
+#include "skinning.shader"
+
+//--------------------------------------------------------------------
+// Uniforms
+//--------------------------------------------------------------------
+uniform float4x4 uProjView;
+uniform float4x4 uWorld;
+
+uniform float4 uColor;
+
+//--------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------
+struct VS_INPUT
+{
+	float3 a_position : a_position;
+#if OPT_Skinned == 1
+	float4 a_bonesIds : a_bonesIds;
+	float4 a_bonesWeights : a_bonesWeights;
+#endif
+};
+
+struct VS_OUTPUT {
+	float4 SV_Position : SV_Position;
+};
+
+
+VS_OUTPUT vsMain(VS_INPUT vsin)
+{
+	VS_OUTPUT res;
+
+#if OPT_Skinned == 1
+	const float4x4 skinning = computeSkinningTransform(vsin.a_bonesIds, vsin.a_bonesWeights);
+	const float3 position = mul(skinning, float4(vsin.a_position, 1.0)).xyz;
+#else
+	const float3 position = vsin.a_position;
+#endif
+
+	const float4 worldPos = mul(uWorld, float4(position, 1.0));
+	const float4 posProjSpace = mul(uProjView, worldPos);
+	res.SV_Position = posProjSpace;
+	
+	return res;
+}
+
+//--------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------
+float4 psMain(VS_OUTPUT IN) : SV_Target0
+{
+	return uColor;
+}